@@ -3,6 +3,7 @@
 #SBATCH --partition=medium
 #SBATCH --cpus-per-task=16
 #SBATCH --mem=200MB
+#SBATCH --requeue
 
 # #$SLURM_CPUS_PER_TASK variable
 
@@ -34,33 +35,79 @@ cd $current
 export LD_LIBRARY_PATH=$path_so
 
 
+# A requeued job resumes from the last checkpoint instead of starting again
+restart=""
+if [ -n "$SLURM_RESTART_COUNT" ] && [ -e $dirout/Checkpoint.cbi4 ]; then
+  restart="-restart"
+fi
+
+# The run stops with a checkpoint 10 minutes before the time limit of the job
+walltime=""
+margin=600
+if [ -n "$SLURM_JOB_ID" ]; then
+  left=$(squeue -h -j $SLURM_JOB_ID -o %L)
+  if [[ $left =~ ^([0-9]+-)?[0-9:]+$ ]]; then
+    days=0
+    if [[ $left == *-* ]]; then days=${left%%-*}; left=${left#*-}; fi
+    secs=0
+    IFS=: read -a parts <<< "$left"
+    for v in "${parts[@]}"; do secs=$((secs*60+10#$v)); done
+    secs=$((days*86400+secs-margin))
+    if [ $secs -gt 0 ]; then walltime="-walltime:$secs"; fi
+  fi
+fi
+
+
 # "dirout" is created to store results or it is cleaned if it already exists
 
 if [ ! -e $dirout ]; then
   mkdir $dirout
 fi
 diroutdata=${dirout}/data;
-if [ -e $diroutdata ]; then
-  rm $diroutdata/*.bi4
-  rm $diroutdata/*.obi4
-fi 
-mkdir $diroutdata
+if [ -z "$restart" ]; then
+  if [ -e $diroutdata ]; then
+    rm $diroutdata/*.bi4
+    rm $diroutdata/*.obi4
+  fi 
+  mkdir $diroutdata
+fi
 
 
 # CODES are executed according the selected parameters of execution in this testcase
 errcode=0
 
 # Executes GenCase4 to create initial files for simulation.
-if [ $errcode -eq 0 ]; then
+if [ $errcode -eq 0 ] && [ -z "$restart" ]; then
   $gencase Def $dirout/$name -save:all
   errcode=$?
 fi
 
 # Executes DualSPHysics to simulate SPH method.
+# SLURM also signals this script, so the solver runs in background and the
+# script forwards SIGTERM/SIGUSR1 and waits for its checkpoint before the requeue
+forward(){
+  kill -$1 $pid 2> /dev/null
+}
 if [ $errcode -eq 0 ]; then
-  $dualsphysicscpu -cpu $dirout/$name $dirout -dirdataout data -svres -sv:binx -ompthreads:$SLURM_CPUS_PER_TASK
+  $dualsphysicscpu -cpu $dirout/$name $dirout -dirdataout data -svres -sv:binx -ompthreads:$SLURM_CPUS_PER_TASK $walltime $restart &
+  pid=$!
+  trap "forward TERM" TERM
+  trap "forward USR1" USR1
+  wait $pid
   errcode=$?
-  echo errcode
+  # wait returns when a signal is trapped, the solver is still writing the checkpoint
+  while kill -0 $pid 2> /dev/null; do
+    wait $pid
+    errcode=$?
+  done
+  trap - TERM USR1
+  echo errcode $errcode
+fi
+
+# Exit code 3: stopped with a checkpoint (time limit or SIGTERM), the job continues later
+if [ $errcode -eq 3 ] && [ -n "$SLURM_JOB_ID" ]; then
+  scontrol requeue $SLURM_JOB_ID
+  exit 0
 fi
 
 # Executes PartVTK4 to create VTK files with particles.
@@ -34,6 +34,7 @@
 //:# - En el calculo de la matriz inversa puedes pasarle el determinante. (08-02-2017)
 //:# - Nuevas funciones IntersecPlaneLine(). (08-09-2016)
 //:# - Nuevas funciones MulMatrix3x3(), TrasMatrix3x3() y RotMatrix3x3(). (29-11-2017)
+//:# - Nuevas funciones EigenValuesSym3x3() y EigenVectorSym3x3(). (17-10-2026)
 //:#############################################################################
 
 /// \file FunctionsMath.h \brief Declares basic/general math functions.
@@ -464,6 +465,65 @@ inline tmatrix3f RotMatrix3x3(const tfloat3 &ang){
 }
 
 
+//==============================================================================
+/// Devuelve los autovalores de una matriz simetrica 3x3 en orden ascendente.
+/// Returns the eigenvalues of a symmetric matrix 3x3 in ascending order
+/// (closed form with the trigonometric solution of the characteristic cubic).
+//==============================================================================
+inline tdouble3 EigenValuesSym3x3(const tsymatrix3f &m){
+  const double a11=m.xx,a12=m.xy,a13=m.xz,a22=m.yy,a23=m.yz,a33=m.zz;
+  const double p1=a12*a12 + a13*a13 + a23*a23;
+  if(p1==0){//-Diagonal matrix.
+    double e0=a11,e1=a22,e2=a33,t;
+    if(e0>e1){ t=e0; e0=e1; e1=t; }
+    if(e1>e2){ t=e1; e1=e2; e2=t; }
+    if(e0>e1){ t=e0; e0=e1; e1=t; }
+    return(TDouble3(e0,e1,e2));
+  }
+  const double q=(a11+a22+a33)/3.;
+  const double b11=a11-q,b22=a22-q,b33=a33-q;
+  const double p=sqrt((b11*b11 + b22*b22 + b33*b33 + 2.*p1)/6.);
+  //-r=det((A-q*I)/p)/2 in [-1,1].
+  const double det=b11*(b22*b33-a23*a23) - a12*(a12*b33-a23*a13) + a13*(a12*a23-b22*a13);
+  double r=det/(2.*p*p*p);
+  r=(r<-1.? -1.: (r>1.? 1.: r));
+  const double phi=acos(r)/3.;
+  const double emax=q + 2.*p*cos(phi);
+  const double emin=q + 2.*p*cos(phi + (2.*PI/3.));
+  return(TDouble3(emin,3.*q-emax-emin,emax));
+}
+
+//==============================================================================
+/// Devuelve el autovector unitario de una matriz simetrica 3x3 para el autovalor
+/// indicado.
+/// Returns the unit eigenvector of a symmetric matrix 3x3 for the given
+/// eigenvalue. It uses the largest cross product of two rows of (A-eigval*I).
+/// For a double eigenvalue it returns a vector orthogonal to the rows and when
+/// all the eigenvalues are equal it returns (0,1,0).
+//==============================================================================
+inline tfloat3 EigenVectorSym3x3(const tsymatrix3f &m,double eigval){
+  const tdouble3 r0=TDouble3(m.xx-eigval,m.xy,m.xz);
+  const tdouble3 r1=TDouble3(m.xy,m.yy-eigval,m.yz);
+  const tdouble3 r2=TDouble3(m.xz,m.yz,m.zz-eigval);
+  const tdouble3 c01=ProductVec(r0,r1),c02=ProductVec(r0,r2),c12=ProductVec(r1,r2);
+  const double d01=ProductScalar(c01,c01),d02=ProductScalar(c02,c02),d12=ProductScalar(c12,c12);
+  const double n0=ProductScalar(r0,r0),n1=ProductScalar(r1,r1),n2=ProductScalar(r2,r2);
+  const double nmax=(n0>=n1? (n0>=n2? n0: n2): (n1>=n2? n1: n2));
+  const double dmax=(d01>=d02? (d01>=d12? d01: d12): (d02>=d12? d02: d12));
+  if(dmax>nmax*nmax*1e-12 && dmax>0){
+    const tdouble3 c=(dmax==d01? c01: (dmax==d02? c02: c12));
+    const double f=1./sqrt(dmax);
+    return(TFloat3(float(c.x*f),float(c.y*f),float(c.z*f)));
+  }
+  if(nmax==0)return(TFloat3(0,1,0));
+  //-Rows are parallel (double eigenvalue): any vector orthogonal to them.
+  const tdouble3 n=(nmax==n0? r0: (nmax==n1? r1: r2));
+  const tdouble3 ax=(fabs(n.x)<=fabs(n.y) && fabs(n.x)<=fabs(n.z)? TDouble3(1,0,0): (fabs(n.y)<=fabs(n.z)? TDouble3(0,1,0): TDouble3(0,0,1)));
+  const tdouble3 c=ProductVec(n,ax);
+  const double f=1./sqrt(ProductScalar(c,c));
+  return(TFloat3(float(c.x*f),float(c.y*f),float(c.z*f)));
+}
+
 //==============================================================================
 /// Devuelve proyeccion ortogonal del punto en el plano.
 /// Returns orthogonal projection of the point in the plane.
@@ -21,6 +21,10 @@
 #include "JArraysCpu.h"
 #include "Functions.h"
 #include <cstdio>
+#include <cstdlib>
+#ifdef _WIN32
+  #include <malloc.h>
+#endif
 #include <algorithm>
 
 using namespace std;
@@ -67,26 +71,22 @@ void JArraysCpuSize::FreeMemory(){
 }
 
 //==============================================================================
-/// Reserva memoria y devuelve puntero con memoria asignada.
-/// Allocates memory and returns pointers with allocated memory.
+/// Reserva memoria alineada a ALIGNBYTES y devuelve puntero con memoria asignada.
+/// Allocates memory aligned to ALIGNBYTES and returns pointers with allocated memory.
 //==============================================================================
 void* JArraysCpuSize::AllocPointer(unsigned size)const{
   void* pointer=NULL;
-  try{
-    switch(ElementSize){
-      case 1:   pointer=new char[size];      break;
-      case 2:   pointer=new word[size];      break;
-      case 4:   pointer=new int[size];       break;
-      case 8:   pointer=new double[size];    break;
-      case 12:  pointer=new int[size*3];     break;
-      case 16:  pointer=new int[size*4];     break;
-      case 24:  pointer=new double[size*3];  break;
-	  case 32:  pointer = new double[size * 4];  break;
-	  case 36:  pointer = new int[size * 9];  break;
-    }
-  }
-  catch(const std::bad_alloc){
-    RunException("AllocPointer","Cannot allocate the requested memory.");
+  switch(ElementSize){
+    case 1: case 2: case 4: case 8: case 12: case 16: case 24: case 32: case 36:
+    {
+      const size_t bytes=size_t(ElementSize)*GetStride(size);
+    #ifdef _WIN32
+      pointer=_aligned_malloc(bytes,ALIGNBYTES);
+    #else
+      if(posix_memalign(&pointer,ALIGNBYTES,bytes))pointer=NULL;
+    #endif
+      if(!pointer)RunException("AllocPointer","Cannot allocate the requested memory.");
+    }break;
   }
   if(!pointer)RunException("AllocPointer","The elementsize value is invalid.");
   return(pointer);
@@ -97,18 +97,11 @@ void* JArraysCpuSize::AllocPointer(unsigned size)const{
 /// Frees memory allocated to pointers.
 //==============================================================================
 void JArraysCpuSize::FreePointer(void* pointer)const{
-  switch(ElementSize){
-    case 1:   delete[] ((char*)pointer);    pointer=NULL;   break;
-    case 2:   delete[] ((word*)pointer);    pointer=NULL;   break;
-	case 4:   delete[]((int*)pointer);      pointer = NULL; break;
-    case 8:   delete[] ((double*)pointer);  pointer=NULL;   break;
-    case 12:  delete[] ((int*)pointer);     pointer=NULL;   break;
-    case 16:  delete[] ((int*)pointer);     pointer=NULL;   break;
-    case 24:  delete[] ((double*)pointer);  pointer=NULL;   break;
-	case 32:  delete[] ((double*)pointer);  pointer = NULL; break;
-	case 36:  delete[] ((int*)pointer);     pointer = NULL; break;
-  }
-  if(pointer)RunException("FreePointer","The elementsize value is invalid.");
+#ifdef _WIN32
+  _aligned_free(pointer);
+#else
+  free(pointer);
+#endif
 }
 
 //==============================================================================
@@ -21,6 +21,8 @@
 //:# =========
 //:# - Codigo creado a partir de JArraysGpu para usar con memoria CPU. (10-03-2014)
 //:# - Remplaza long long por llong. (01-10-2015)
+//:# - Los arrays se alinean a 64 bytes y su tamano a multiplos de 16 elementos
+//:#   para poder dividir los de 24 bytes en 6 streams de float (SoA). (17-10-2026)
 //:#############################################################################
 
 /// \file JArraysCpu.h \brief Declares the class \ref JArraysCpu.
@@ -43,7 +45,9 @@ protected:
   const unsigned ElementSize;
   unsigned ArraySize;
 
-  static const unsigned MAXPOINTERS=30;
+  static const unsigned MAXPOINTERS=48;
+  static const unsigned ALIGNBYTES=64;   ///<Alignment of the arrays in bytes.
+  static const unsigned ALIGNSIZE=16;    ///<Number of elements is a multiple of ALIGNSIZE so float streams stay aligned.
   void* Pointers[MAXPOINTERS];
   unsigned Count;
   unsigned CountUsed;
@@ -70,8 +74,9 @@ public:
 
   void SetArraySize(unsigned size);
   unsigned GetArraySize()const{ return(ArraySize); }
+  static unsigned GetStride(unsigned size){ return((size+ALIGNSIZE-1)/ALIGNSIZE*ALIGNSIZE); }
 
-  llong GetAllocMemoryCpu()const{ return((llong)(Count)*ElementSize*ArraySize); };
+  llong GetAllocMemoryCpu()const{ return((llong)(Count)*ElementSize*GetStride(ArraySize)); };
 
   void* Reserve();
   void Free(void *pointer);
@@ -115,6 +120,9 @@ public:
   void SetArraySize(unsigned size);
   unsigned GetArraySize()const{ return(Arrays1b->GetArraySize()); }
 
+  void* Reserve(TpArraySize tsize){ return(GetArrays(tsize)->Reserve()); }
+  void Free(TpArraySize tsize,void *pointer){ GetArrays(tsize)->Free(pointer); }
+
   byte*        ReserveByte(){       return((byte*)Arrays1b->Reserve());         }
   word*        ReserveWord(){       return((word*)Arrays2b->Reserve());         }
   unsigned*    ReserveUint(){       return((unsigned*)Arrays4b->Reserve());     }
@@ -128,6 +136,7 @@ public:
   tsymatrix3f* ReserveSymatrix3f() { return((tsymatrix3f*)Arrays24b->Reserve()); }
   //Matthias
   tmatrix3f*   ReserveMatrix3f_M() { return((tmatrix3f*)Arrays36b->Reserve()); }
+  tsymatrix3fsoa ReserveSymatrix3fSoa(){ return(TSymatrix3fSoa((float*)Arrays24b->Reserve(),JArraysCpuSize::GetStride(GetArraySize()))); }
   bool*        ReserveBool(){		return((bool*)Arrays1b->Reserve()); }
 
 #ifdef CODE_SIZE4
@@ -150,6 +159,7 @@ public:
   void Free(tsymatrix3f *pointer){ Arrays24b->Free(pointer); }
   // Matthias
   void Free(tmatrix3f *pointer)  { Arrays36b->Free(pointer); }
+  void Free(const tsymatrix3fsoa &m){ Arrays24b->Free(m.xx); }
 };
 #endif
 
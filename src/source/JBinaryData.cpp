@@ -19,6 +19,7 @@
 /// \file JBinaryData.cpp \brief Implements the class \ref JBinaryData.
 
 #include "JBinaryData.h"
+#include "JBinaryDataCodec.h"
 #include "Functions.h"
 
 #include <fstream>
@@ -28,6 +29,18 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <climits>
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -139,6 +152,7 @@ JBinaryDataArray::JBinaryDataArray(JBinaryData* parent,const std::string &name,J
   Hide=false;
   Pointer=NULL;
   ExternalPointer=false;
+  Stride=0;
   Count=Size=0;
   ClearFileData();
 }
@@ -293,6 +307,7 @@ void JBinaryDataArray::FreeMemory(){
   if(Pointer&&!ExternalPointer)FreePointer(Pointer);
   Pointer=NULL;
   ExternalPointer=false;
+  Stride=0;
   Count=0;
   Size=0;
 }
@@ -340,9 +355,9 @@ void JBinaryDataArray::ConfigExternalMemory(unsigned size,void* pointer){
 /// Configura acceso a datos en fichero.
 /// Set file data access.
 //==============================================================================
-void JBinaryDataArray::ConfigFileData(llong filepos,unsigned datacount,unsigned datasize){
+void JBinaryDataArray::ConfigFileData(llong filepos,unsigned datacount,unsigned datasize,bool datacomp){
   FreeMemory();
-  FileDataPos=filepos; FileDataCount=datacount; FileDataSize=datasize;
+  FileDataPos=filepos; FileDataCount=datacount; FileDataSize=datasize; FileDataComp=datacomp;
 }
 
 //==============================================================================
@@ -350,7 +365,7 @@ void JBinaryDataArray::ConfigFileData(llong filepos,unsigned datacount,unsigned
 /// Delete data file data access.
 //==============================================================================
 void JBinaryDataArray::ClearFileData(){
-  FileDataPos=-1; FileDataCount=FileDataSize=0;
+  FileDataPos=-1; FileDataCount=FileDataSize=0; FileDataComp=false;
 }
 
 //==============================================================================
@@ -362,12 +377,19 @@ void JBinaryDataArray::ReadFileData(bool resize){
   //printf("ReadFileData Parent_name:[%s] p:%p\n",Parent->GetName().c_str(),Parent);
   //printf("ReadFileData Parent2_name:[%s] p:%p\n",(Parent->GetParent()? Parent->GetParent()->GetName().c_str(): "none"),Parent->GetParent());
   //printf("ReadFileData root_name:[%s] p:%p\n",Parent->GetItemRoot()->GetName().c_str(),Parent->GetItemRoot());
+  if(FileDataPos<0)RunException(met,"The access information to data file is not available.");
+  //-Con fichero proyectado en memoria los datos se copian directamente. With a file mapped in memory the data is copied directly.
+  const byte *map=Parent->GetItemRoot()->GetFileMap();
+  if(map){
+    if(FileDataComp)AddDataCompressed(FileDataCount,map+FileDataPos,FileDataSize,resize);
+    else AddData(FileDataCount,map+FileDataPos,resize);
+    return;
+  }
   ifstream *pf=Parent->GetItemRoot()->GetFileStructure();
   if(!pf||!pf->is_open())RunException(met,"The file with data is not available.");
   //printf("ReadFileData[%s]> fpos:%llu count:%u size:%u\n",Name.c_str(),FileDataPos,FileDataCount,FileDataSize);
-  if(FileDataPos<0)RunException(met,"The access information to data file is not available.");
   pf->seekg(FileDataPos,ios::beg);
-  ReadData(FileDataCount,FileDataSize,pf,resize);
+  ReadData(FileDataCount,FileDataSize,pf,resize,FileDataComp);
 }
 
 //==============================================================================
@@ -376,8 +398,15 @@ void JBinaryDataArray::ReadFileData(bool resize){
 /// Add elements to the array of a file. 
 /// If ExternalPointer will not allow to resize the allocated memory.
 //==============================================================================
-void JBinaryDataArray::ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize){
-  if(count){
+void JBinaryDataArray::ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize,bool comp){
+  if(count&&comp){//-Datos comprimidos. Compressed data.
+    byte *buf=new byte[size];
+    pf->read((char*)buf,size);
+    try{ AddDataCompressed(count,buf,size,resize); }
+    catch(...){ delete[] buf; throw; }
+    delete[] buf;
+  }
+  else if(count){
     //-Reserva memoria si fuese necesario.
     CheckMemory(count,resize);
     //-Carga datos de fichero.
@@ -426,6 +455,23 @@ void JBinaryDataArray::AddData(unsigned count,const void* data,bool resize){
   }
 }
 
+//==============================================================================
+/// Aade elementos al array a partir de datos comprimidos con JBinaryDataCodec.
+/// Si es ExternalPointer no permite redimensionar la memoria asignada.
+/// Add elements to the array from data compressed with JBinaryDataCodec.
+/// If ExternalPointer will not allow to resize the allocated memory.
+//==============================================================================
+void JBinaryDataArray::AddDataCompressed(unsigned count,const byte* data,unsigned sizedata,bool resize){
+  const char met[]="AddDataCompressed";
+  if(Type==JBinaryDataDef::DatText)RunException(met,"Type of array is invalid for this function.");
+  if(count){
+    CheckMemory(count,resize);
+    const size_t stype=JBinaryDataDef::SizeOfType(Type);
+    if(!JBinaryDataCodec::Decompress(Type,count,data,sizedata,((byte*)Pointer)+stype*Count))RunException(met,"The compressed data is corrupted.");
+    Count+=count;
+  }
+}
+
 //==============================================================================
 /// Guarda datos como contenido del array.
 /// Save data as contents of the array.
@@ -441,6 +487,32 @@ void JBinaryDataArray::SetData(unsigned count,const void* data,bool externalpoin
   else AddData(count,data,true);
 }
 
+//==============================================================================
+/// Guarda datos de un puntero externo con stride bytes entre elementos (p.ej.
+/// una componente de un array de estructuras). Los datos no se copian.
+/// Save data of an external pointer with stride bytes between elements (e.g.
+/// one component of an array of structures). The data is not copied.
+//==============================================================================
+void JBinaryDataArray::SetDataStrided(unsigned count,const void* data,unsigned stride){
+  const unsigned stype=(unsigned)JBinaryDataDef::SizeOfType(Type);
+  if(Type==JBinaryDataDef::DatText||!stype)RunException("SetDataStrided","Type of array is invalid for this function.");
+  if(stride<stype)RunException("SetDataStrided","The stride is smaller than the size of type.");
+  SetData(count,data,true);
+  if(stride!=stype)Stride=stride;
+}
+
+//==============================================================================
+/// Copia count elementos contiguos desde ini de un array con stride.
+/// Copies count elements from ini of a strided array in contiguous memory.
+//==============================================================================
+void JBinaryDataArray::GetStridedData(unsigned ini,unsigned count,void* pointer)const{
+  const size_t stype=JBinaryDataDef::SizeOfType(Type);
+  const byte *src=(const byte*)Pointer+size_t(Stride?Stride:stype)*ini;
+  byte *dst=(byte*)pointer;
+  if(!Stride)memcpy(dst,src,stype*count);
+  else for(unsigned c=0;c<count;c++,src+=Stride,dst+=stype)memcpy(dst,src,stype);
+}
+
 //==============================================================================
 /// Aade un string al array.
 /// Si es ExternalPointer no permite redimensionar la memoria asignada.
@@ -479,6 +551,7 @@ void JBinaryDataArray::AddTexts(unsigned count,const std::string *strs,bool resi
 //==============================================================================
 const void* JBinaryDataArray::GetDataPointer()const{
   if(!DataInPointer())RunException("GetDataPointer","There are not available data in pointer.");
+  if(Stride)RunException("GetDataPointer","The data in pointer is strided, use GetDataCopy().");
   return(Pointer);
 }
 
@@ -496,16 +569,30 @@ unsigned JBinaryDataArray::GetDataCopy(unsigned size,void* pointer)const{
   unsigned count=0;
   if(DataInPointer()){
     count=GetCount();
-    if(size>=count)memcpy(pointer,Pointer,stype*count);
+    if(size>=count)GetStridedData(0,count,pointer);
   }
   else{
     count=FileDataCount;
-    if(size>=count){
+    const byte *map=Parent->GetItemRoot()->GetFileMap();
+    if(size>=count && map){
+      if(FileDataComp){
+        if(!JBinaryDataCodec::Decompress(GetType(),count,map+FileDataPos,FileDataSize,pointer))RunException(met,"The compressed data is corrupted.");
+      }
+      else memcpy(pointer,map+FileDataPos,stype*count);
+    }
+    else if(size>=count){
       ifstream *pf=Parent->GetItemRoot()->GetFileStructure();
       if(!pf||!pf->is_open())RunException(met,"The file with data is not available.");
       pf->seekg(FileDataPos,ios::beg);
       count=FileDataCount;
-      pf->read((char*)pointer,stype*count);
+      if(FileDataComp){
+        byte *buf=new byte[FileDataSize];
+        pf->read((char*)buf,FileDataSize);
+        const bool ok=JBinaryDataCodec::Decompress(GetType(),count,buf,FileDataSize,pointer);
+        delete[] buf;
+        if(!ok)RunException(met,"The compressed data is corrupted.");
+      }
+      else pf->read((char*)pointer,stype*count);
     }
   }
   if(size<count)RunException(met,"Size of array is not enough to store all data.");
@@ -523,9 +610,11 @@ JBinaryData::JBinaryData(std::string name):Name(name){
   ClassName="JBinaryData";
   Parent=NULL;
   FileStructure=NULL;
+  FileMap=NULL; FileMapSize=0; FileMapHandle=NULL;
   ValuesData=NULL;
   ValuesCacheReset();
   HideAll=HideValues=false;
+  CompressArrays=false;
   FmtFloat="%.7E";
   FmtDouble="%.15E";
 }
@@ -538,8 +627,10 @@ JBinaryData::JBinaryData(const JBinaryData &src){
   ClassName="JBinaryData";
   Parent=NULL;
   FileStructure=NULL;
+  FileMap=NULL; FileMapSize=0; FileMapHandle=NULL;
   ValuesData=NULL;
   ValuesCacheReset();
+  CompressArrays=false;
   *this=src;
 }
 
@@ -805,15 +896,16 @@ void JBinaryData::OutValue(unsigned &count,unsigned size,const byte *ptr){
 /// Introduce datos basicos de Array en ptr.
 /// Put basic data Array in ptr.
 //==============================================================================
-void JBinaryData::InArrayBase(unsigned &count,unsigned size,byte *ptr,const JBinaryDataArray *ar)const{
+void JBinaryData::InArrayBase(unsigned &count,unsigned size,byte *ptr,const JBinaryDataArray *ar,unsigned sizecomp)const{
   InStr(count,size,ptr,CodeArrayDef);
   InStr(count,size,ptr,ar->GetName());
   InBool(count,size,ptr,ar->GetHide());
-  InInt(count,size,ptr,int(ar->GetType()));
+  InInt(count,size,ptr,int(ar->GetType())|(sizecomp? JBinaryDataDef::FlagCompressed: 0));
   InUint(count,size,ptr,ar->GetCount());
-  //-Calcula e introduce size de los datos del array.
-  unsigned sizearraydata=0;
-  InArrayData(sizearraydata,0,NULL,ar);
+  //-Calcula e introduce size de los datos del array (comprimidos con sizecomp).
+  //-Computes and puts the size of the array data (compressed with sizecomp).
+  unsigned sizearraydata=sizecomp;
+  if(!sizecomp)InArrayData(sizearraydata,0,NULL,ar);
   InUint(count,size,ptr,sizearraydata);
 }
 //==============================================================================
@@ -829,6 +921,16 @@ void JBinaryData::InArrayData(unsigned &count,unsigned size,byte *ptr,const JBin
     const string *list=(string*)pointer;
     for(unsigned c=0;c<num;c++)InStr(count,size,ptr,list[c]);
   }
+  else if(ar->PointerIsStrided()){//-Array con stride. Strided array.
+    unsigned sizetype=(unsigned)JBinaryDataDef::SizeOfType(ar->GetType());
+    const unsigned sdat=sizetype*num;
+    if(ptr){
+      if(count+sdat>size)RunException("InArrayData","Insufficient memory for data.");
+      ar->GetStridedData(0,num,ptr+count);
+    }
+    if(count+sdat<count)RunException("InArrayData","Size of data is too huge.");
+    count+=sdat;
+  }
   else{//-Array de tipos basicos.
     unsigned sizetype=(unsigned)JBinaryDataDef::SizeOfType(ar->GetType());
     InData(count,size,ptr,(byte*)pointer,sizetype*num);
@@ -893,15 +995,18 @@ void JBinaryData::InItem(unsigned &count,unsigned size,byte *ptr,bool all)const{
 /// Extrae datos basicos del Array de ptr.
 /// Extract basic data from ptr Array 
 //==============================================================================
-JBinaryDataArray* JBinaryData::OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata){
+JBinaryDataArray* JBinaryData::OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata,bool &comp){
   const char met[]="OutArrayBase";
   if(OutStr(count,size,ptr)!=CodeArrayDef)RunException(met,"Validation code is invalid.");
   string name=OutStr(count,size,ptr);
   bool hide=OutBool(count,size,ptr);
-  JBinaryDataDef::TpData type=(JBinaryDataDef::TpData)OutInt(count,size,ptr);
+  const int tp=OutInt(count,size,ptr);
+  comp=((tp&JBinaryDataDef::FlagCompressed)!=0);
+  JBinaryDataDef::TpData type=(JBinaryDataDef::TpData)(tp&~JBinaryDataDef::FlagCompressed);
   countdata=OutUint(count,size,ptr);
   sizedata=OutUint(count,size,ptr);
-  if(type!=JBinaryDataDef::DatText&&sizedata!=JBinaryDataDef::SizeOfType(type)*countdata)RunException(met,"Size of data is invalid.");
+  if(comp&&type==JBinaryDataDef::DatText)RunException(met,"Type of compressed array is invalid.");
+  if(!comp&&type!=JBinaryDataDef::DatText&&sizedata!=JBinaryDataDef::SizeOfType(type)*countdata)RunException(met,"Size of data is invalid.");
   //-Crea array.
   JBinaryDataArray *ar=CreateArray(name,type);
   ar->SetHide(hide);
@@ -912,11 +1017,24 @@ JBinaryDataArray* JBinaryData::OutArrayBase(unsigned &count,unsigned size,const
 /// Extrae contenido de Array de ptr.
 /// Extract the contents of the ptr Array
 //==============================================================================
-void JBinaryData::OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata){
+void JBinaryData::OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool comp,bool view){
   if(ar->GetType()==JBinaryDataDef::DatText){//-Array de strings.
     ar->AllocMemory(countdata);
     for(unsigned c=0;c<countdata;c++)ar->AddText(OutStr(count,size,ptr),false);
   }
+  else if(view){//-Datos en fichero proyectado (ptr) sin copia. Data in mapped file (ptr) without copy.
+    unsigned count2=count+sizedata;
+    if(count2>size||count2<count)RunException("OutArrayData","Overflow in reading data.");
+    if(comp)ar->ConfigFileData(count,countdata,sizedata,true);
+    else ar->SetData(countdata,ptr+count,true);
+    count=count2;
+  }
+  else if(comp){//-Datos comprimidos. Compressed data.
+    unsigned count2=count+sizedata;
+    if(count2>size||count2<count)RunException("OutArrayData","Overflow in reading data.");
+    ar->AddDataCompressed(countdata,ptr+count,sizedata,true);
+    count=count2;
+  }
   else{
     //-Comprueba que los datos del array estan disponibles.
     //-Checks that the data array is available.
@@ -933,15 +1051,16 @@ void JBinaryData::OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBi
 /// Extrae Array de ptr.
 /// Extracts the Array of the ptr.
 //==============================================================================
-void JBinaryData::OutArray(unsigned &count,unsigned size,const byte *ptr){
+void JBinaryData::OutArray(unsigned &count,unsigned size,const byte *ptr,bool view){
   //-Crea y configura array a partir de ptr.
   //-Creates and configures array from ptr 
   const unsigned sizearraydef=OutUint(count,size,ptr);
   unsigned countdata,sizedata;
-  JBinaryDataArray *ar=OutArrayBase(count,size,ptr,countdata,sizedata);
+  bool comp;
+  JBinaryDataArray *ar=OutArrayBase(count,size,ptr,countdata,sizedata,comp);
   //-Extrae contenido del array.
   //-Extract contents of the array.
-  OutArrayData(count,size,ptr,ar,countdata,sizedata);
+  OutArrayData(count,size,ptr,ar,countdata,sizedata,comp,view);
 }
 
 //==============================================================================
@@ -967,7 +1086,7 @@ JBinaryData* JBinaryData::OutItemBase(unsigned &count,unsigned size,const byte *
 /// Extrae Item de ptr.
 /// Extracts the Item ptr.
 //==============================================================================
-void JBinaryData::OutItem(unsigned &count,unsigned size,const byte *ptr,bool create){
+void JBinaryData::OutItem(unsigned &count,unsigned size,const byte *ptr,bool create,bool view){
   //-Extrae propiedades del item.
   //-Extract item properties
   const unsigned sizeitemdef=OutUint(count,size,ptr);
@@ -982,10 +1101,10 @@ void JBinaryData::OutItem(unsigned &count,unsigned size,const byte *ptr,bool cre
   }
   //-Extrae arrays del item.
   //-Extract arrays from item.
-  for(unsigned c=0;c<narrays;c++)item->OutArray(count,size,ptr);
+  for(unsigned c=0;c<narrays;c++)item->OutArray(count,size,ptr,view);
   //-Extrae items del item.
   //-Extract items from item.
-  for(unsigned c=0;c<nitems;c++)item->OutItem(count,size,ptr,true);
+  for(unsigned c=0;c<nitems;c++)item->OutItem(count,size,ptr,true,view);
 }
 
 //==============================================================================
@@ -1030,6 +1149,17 @@ void JBinaryData::WriteArrayData(std::fstream *pf,const JBinaryDataArray *ar)con
     pf->write((char*)buf,cbuf);
     delete[] buf;
   }
+  else if(ar->PointerIsStrided()){//-Array con stride, se agrupa por bloques. Strided array, gathered by blocks.
+    const unsigned sizetype=(unsigned)JBinaryDataDef::SizeOfType(ar->GetType());
+    const unsigned nblock=max(1u,(1u<<16)/sizetype);
+    byte *buf=new byte[sizetype*min(nblock,countdata)];
+    for(unsigned c=0;c<countdata;c+=nblock){
+      const unsigned n=min(nblock,countdata-c);
+      ar->GetStridedData(c,n,buf);
+      pf->write((char*)buf,sizetype*n);
+    }
+    delete[] buf;
+  }
   else{//-Array de tipos basicos. Array of basic types.
     unsigned sizetype=(unsigned)JBinaryDataDef::SizeOfType(ar->GetType());
     pf->write((char*)pointer,sizetype*countdata);
@@ -1041,16 +1171,22 @@ void JBinaryData::WriteArrayData(std::fstream *pf,const JBinaryDataArray *ar)con
 /// Saves the Array in the file. 
 //==============================================================================
 void JBinaryData::WriteArray(std::fstream *pf,unsigned sbuf,byte *buf,const JBinaryDataArray *ar)const{
+  //-Comprime datos del array si esta activado y hay ganancia.
+  //-Compresses the array data when it is enabled and there is gain.
+  std::vector<byte> comp;
+  const bool cp=(GetCompressArrays() && JBinaryDataCodec::Compress(ar,comp));
+  const unsigned sizecomp=(cp? unsigned(comp.size()): 0);
   //-Calcula size de la definicion del array.
   unsigned sizearray=0;
-  InArrayBase(sizearray,0,NULL,ar);
+  InArrayBase(sizearray,0,NULL,ar,sizecomp);
   //-Graba propiedades de array. Saves properties of array.
   unsigned cbuf=0;
   InUint(cbuf,sbuf,buf,sizearray);
-  InArrayBase(cbuf,sbuf,buf,ar);
+  InArrayBase(cbuf,sbuf,buf,ar,sizecomp);
   pf->write((char*)buf,cbuf);
   //-Graba contenido del array. Saves contents of array.
-  WriteArrayData(pf,ar);
+  if(cp)pf->write((char*)comp.data(),sizecomp);
+  else WriteArrayData(pf,ar);
 }
 
 //==============================================================================
@@ -1096,11 +1232,11 @@ unsigned JBinaryData::ReadUint(std::ifstream *pf)const{
 /// Carga datos de array de fichero.
 /// Loads data to array from the file.
 //==============================================================================
-void JBinaryData::ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool loadarraysdata){
+void JBinaryData::ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool comp,bool loadarraysdata){
   const JBinaryDataDef::TpData type=ar->GetType();
-  if(loadarraysdata)ar->ReadData(countdata,sizedata,pf,true);
+  if(loadarraysdata)ar->ReadData(countdata,sizedata,pf,true,comp);
   else{
-    ar->ConfigFileData((llong)pf->tellg(),countdata,sizedata);  
+    ar->ConfigFileData((llong)pf->tellg(),countdata,sizedata,comp);  
     pf->seekg(sizedata,ios::cur);
   }
 }
@@ -1115,11 +1251,12 @@ void JBinaryData::ReadArray(std::ifstream *pf,unsigned sbuf,byte *buf,bool loada
   const unsigned sizearraydef=ReadUint(pf);
   pf->read((char*)buf,sizearraydef);
   unsigned countdata,sizedata;
+  bool comp;
   unsigned cbuf=0;
-  JBinaryDataArray *ar=OutArrayBase(cbuf,sizearraydef,buf,countdata,sizedata);
+  JBinaryDataArray *ar=OutArrayBase(cbuf,sizearraydef,buf,countdata,sizedata,comp);
   //-Extrae contenido del array.
   //-Extract contents of the array.
-  ReadArrayData(pf,ar,countdata,sizedata,loadarraysdata);
+  ReadArrayData(pf,ar,countdata,sizedata,comp,loadarraysdata);
 }
 
 //==============================================================================
@@ -1283,7 +1420,12 @@ void JBinaryData::WriteFileXmlArray(const std::string &tabs,std::ofstream* pf,bo
   else{
     res=res+">";
     (*pf) << tabs << res << endl;
-    const void *data=ar->GetDataPointer();
+    byte *datcopy=NULL;
+    if(ar->PointerIsStrided()){//-Copia contigua de array con stride. Contiguous copy of strided array.
+      datcopy=new byte[JBinaryDataDef::SizeOfType(type)*count];
+      ar->GetStridedData(0,count,datcopy);
+    }
+    const void *data=(datcopy? (const void*)datcopy: ar->GetDataPointer());
     JBinaryData::StValue v;
     //ResetValue("",type,v);
     v.type=type;
@@ -1311,6 +1453,7 @@ void JBinaryData::WriteFileXmlArray(const std::string &tabs,std::ofstream* pf,bo
       }
       (*pf) << tabs << "\t" << ValueToXml(v) << endl;
     }
+    delete[] datcopy;
     (*pf) << tabs << string("</array_")+tx+">" << endl;
   }
 }
@@ -1474,6 +1617,7 @@ void JBinaryData::LoadData(unsigned size,const byte* ptr){
 void JBinaryData::SaveFileData(std::fstream *pf,bool head,const std::string &filecode,bool memory,bool all)const{
   if(head){//-Graba cabecera basica.
     StHeadFmtBin head=MakeFileHead(filecode); 
+    head.compress=byte(!memory&&GetCompressArrays()? 1: 0); //-Solo WriteItem() comprime. Only WriteItem() compresses.
     pf->write((char*)&head,sizeof(StHeadFmtBin));
   }
   //-Graba datos. Save data.
@@ -1661,6 +1805,15 @@ void JBinaryData::OpenFileStructure(const std::string &file,const std::string &f
 void JBinaryData::CloseFileStructure(){
   if(FileStructure&&FileStructure->is_open())FileStructure->close();
   delete FileStructure; FileStructure=NULL;
+  if(FileMap){
+  #ifdef _WIN32
+    UnmapViewOfFile(FileMap);
+    CloseHandle((HANDLE)FileMapHandle);
+  #else
+    munmap(FileMap,size_t(FileMapSize));
+  #endif
+  }
+  FileMap=NULL; FileMapSize=0; FileMapHandle=NULL;
 }
 
 //==============================================================================
@@ -1672,6 +1825,78 @@ std::ifstream* JBinaryData::GetFileStructure()const{
   return(FileStructure);
 }
 
+//==============================================================================
+/// Proyecta el fichero en memoria y carga la estructura de datos sin leer el
+/// contenido de los arrays. Los arrays sin comprimir son vistas del fichero
+/// (sin copia) y solo se leen las paginas que se usan. Si el fichero no se
+/// puede proyectar usa OpenFileStructure() y devuelve false.
+/// Maps the file in memory and loads the data structure without reading the
+/// contents of the arrays. Uncompressed arrays are views of the file (no copy)
+/// and only the pages that are used are read. If the file cannot be mapped it
+/// uses OpenFileStructure() and returns false.
+//==============================================================================
+bool JBinaryData::OpenFileMapped(const std::string &file,const std::string &filecode){
+  const char met[]="OpenFileMapped";
+  if(Parent)RunException(met,"Item is not root.");
+  Clear(); //-Limpia contenido de objeto. Clean object content.
+  byte *map=NULL;
+  llong fsize=0;
+#ifdef _WIN32
+  HANDLE hf=CreateFileA(file.c_str(),GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+  if(hf!=INVALID_HANDLE_VALUE){
+    LARGE_INTEGER fs;
+    if(GetFileSizeEx(hf,&fs) && fs.QuadPart>0 && fs.QuadPart<UINT_MAX){
+      HANDLE hm=CreateFileMappingA(hf,NULL,PAGE_WRITECOPY,0,0,NULL);
+      if(hm){
+        map=(byte*)MapViewOfFile(hm,FILE_MAP_COPY,0,0,0);
+        if(map){ fsize=llong(fs.QuadPart); FileMapHandle=(void*)hm; }
+        else CloseHandle(hm);
+      }
+    }
+    CloseHandle(hf);
+  }
+#else
+  const int fd=open(file.c_str(),O_RDONLY);
+  if(fd>=0){
+    struct stat st;
+    if(!fstat(fd,&st) && st.st_size>0 && st.st_size<UINT_MAX){
+      //-Privada y con escritura para que las vistas se puedan modificar sin cambiar el fichero. Private and writable so the views can be modified without changing the file.
+      void *ptr=mmap(NULL,size_t(st.st_size),PROT_READ|PROT_WRITE,MAP_PRIVATE,fd,0);
+      if(ptr!=MAP_FAILED){ map=(byte*)ptr; fsize=llong(st.st_size); }
+    }
+    close(fd);
+  }
+#endif
+  if(!map){
+    OpenFileStructure(file,filecode);
+    return(false);
+  }
+  FileMap=map; FileMapSize=fsize;
+  //-Comprueba cabecera y carga estructura. Checks header and loads structure.
+  try{
+    StHeadFmtBin head;
+    if(fsize>=llong(sizeof(StHeadFmtBin)))memcpy(&head,map,sizeof(StHeadFmtBin));
+    else memset(&head,0,sizeof(StHeadFmtBin));
+    CheckHead(file,head,filecode);
+    unsigned count=sizeof(StHeadFmtBin);
+    OutItem(count,unsigned(fsize),map,false,true);
+  }
+  catch(...){
+    Clear();
+    throw;
+  }
+  return(true);
+}
+
+//==============================================================================
+/// Devuelve puntero al fichero proyectado con OpenFileMapped() o NULL.
+/// Returns pointer to the file mapped with OpenFileMapped() or NULL.
+//==============================================================================
+const byte* JBinaryData::GetFileMap()const{
+  if(Parent)RunException("GetFileMap","Item is not root.");
+  return(FileMap);
+}
+
 //==============================================================================
 /// Graba contenido en fichero XML.
 /// Record XML file content.
@@ -1830,6 +2055,16 @@ JBinaryDataArray* JBinaryData::CreateArray(const std::string &name,JBinaryDataDe
   return(ar);
 }
 
+//==============================================================================
+/// Crea y devuelve array con datos externos con stride bytes entre elementos.
+/// Creates and returns array of external data with stride bytes between elements.
+//==============================================================================
+JBinaryDataArray* JBinaryData::CreateArrayStrided(const std::string &name,JBinaryDataDef::TpData type,unsigned count,const void *data,unsigned stride){
+  JBinaryDataArray *ar=CreateArray(name,type);
+  ar->SetDataStrided(count,data,stride);
+  return(ar);
+}
+
 //==============================================================================
 /// Elimina el array indicado.
 /// Removes the specified array.
@@ -72,6 +72,8 @@ class JBinaryDataDef
 	,DatSymMat = 24
   }TpData; 
 
+  static const int FlagCompressed=0x1000;  ///<Flag en el tipo de los arrays comprimidos. Flag in the type of the arrays stored compressed (see JBinaryDataCodec).
+
   static std::string TypeToStr(TpData type);
   static size_t SizeOfType(TpData type);
   static bool TypeIsTriple(TpData type);
@@ -96,9 +98,11 @@ class JBinaryDataArray : protected JObject
   unsigned Size;          ///<Numero de elementos para los que hay memoria reservada. Number of elements for which there is reserved memory.
   void* Pointer;
   bool ExternalPointer;   ///<Indica que el puntero es externo y no debe liberarse. Indicates that the pointer is external, and should not be released.
+  unsigned Stride;        ///<Bytes entre elementos de un puntero externo (0:contiguos). Bytes between elements of an external pointer (0:contiguous).
   llong FileDataPos;      ///<Valor mayor o igual a cero indica la posicion de lectura en el fichero abierto en el ItemHead. Value greater than or equal to zero indicates the position of reading in the file opened in the ItemHead.
   unsigned FileDataCount; ///<Numero de elemetos del array en fichero. Number of elements in the array in a file.
   unsigned FileDataSize;  ///<Size de datos del array en fichero. Size of array data in file.
+  bool FileDataComp;      ///<Los datos del array en fichero estan comprimidos. The array data in file is compressed.
 
   void FreePointer(void* ptr)const;
   void* AllocPointer(unsigned size)const;
@@ -125,6 +129,8 @@ class JBinaryDataArray : protected JObject
   const void* GetPointer()const{ return(Pointer); };
 
   bool PointerIsExternal()const{ return(ExternalPointer); };
+  bool PointerIsStrided()const{ return(Stride!=0); };
+  unsigned GetStride()const{ return(Stride); };
   bool DataInPointer()const{ return(Pointer&&Count); }
   bool DataInFile()const{ return(FileDataPos>=0); }
 
@@ -132,9 +138,12 @@ class JBinaryDataArray : protected JObject
   void AllocMemory(unsigned size,bool savedata=false);
   void ConfigExternalMemory(unsigned size,void* pointer);
 
-  void ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize);
+  void ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize,bool comp=false);
+  void AddDataCompressed(unsigned count,const byte* data,unsigned sizedata,bool resize);
   void AddData(unsigned count,const void* data,bool resize);
   void SetData(unsigned count,const void* data,bool externalpointer);
+  void SetDataStrided(unsigned count,const void* data,unsigned stride);
+  void GetStridedData(unsigned ini,unsigned count,void* pointer)const;
 
   const void* GetDataPointer()const;
   unsigned GetDataCopy(unsigned size,void* pointer)const;
@@ -142,7 +151,7 @@ class JBinaryDataArray : protected JObject
   void AddText(const std::string &str,bool resize);
   void AddTexts(unsigned count,const std::string *strs,bool resize);
 
-  void ConfigFileData(llong filepos,unsigned datacount,unsigned datasize);
+  void ConfigFileData(llong filepos,unsigned datacount,unsigned datasize,bool datacomp=false);
   void ClearFileData();
   unsigned GetFileDataCount()const{ return(FileDataCount); }
   unsigned GetFileDataSize()const{ return(FileDataSize); }
@@ -162,7 +171,7 @@ class JBinaryData : protected JObject
   typedef struct{
     char titu[60];               ///<Title of the file eg: "#File JBinaryData".
     byte byteorder;              ///<1:BigEndian 0:LittleEndian.
-    byte void1;                  ///<Not used.
+    byte compress;               ///<1:Los arrays pueden estar comprimidos. The arrays may be compressed (see JBinaryDataCodec).
     byte void2;                  ///<Not used.
     byte void3;                  ///<Not used.
   }StHeadFmtBin;//-sizeof(64)
@@ -202,6 +211,7 @@ class JBinaryData : protected JObject
   std::string Name;      ///<Nombre de item. Name of item.
   bool HideAll;          ///<Ignora el item en determinados metodos como SaveData(). It ignores the item in certain functions as SaveData().
   bool HideValues;       ///<Ignora los Values en determinados metodos como SaveData(). It ignores the values in certain functions as SaveData().
+  bool CompressArrays;   ///<Comprime los arrays en SaveFile() sin memory (solo item raiz). Compresses the arrays in SaveFile() without memory (only root item).
   std::string FmtFloat;  ///<Formato para valores float, por defecto "%.7E". Format for float, by default " %.7E". 
   std::string FmtDouble; ///<Formato para valores double, por defecto "%.15E" Format for double, by default " %.15E".
 
@@ -211,6 +221,9 @@ class JBinaryData : protected JObject
   std::vector<StValue> Values;
 
   std::ifstream *FileStructure;
+  byte *FileMap;         ///<Fichero proyectado en memoria con OpenFileMapped() (solo item raiz). File mapped in memory with OpenFileMapped() (only root item).
+  llong FileMapSize;     ///<Size del fichero proyectado. Size of the mapped file.
+  void *FileMapHandle;   ///<Handle de la proyeccion (solo Windows). Handle of the mapping (only Windows).
 
   //-Variables para cache de values. Variables to cache values.
   bool ValuesModif;
@@ -266,17 +279,17 @@ class JBinaryData : protected JObject
   void InValue(unsigned &count,unsigned size,byte *ptr,const StValue &v)const;
   void OutValue(unsigned &count,unsigned size,const byte *ptr);
 
-  void InArrayBase(unsigned &count,unsigned size,byte *ptr,const JBinaryDataArray *ar)const;
+  void InArrayBase(unsigned &count,unsigned size,byte *ptr,const JBinaryDataArray *ar,unsigned sizecomp=0)const;
   void InArrayData(unsigned &count,unsigned size,byte *ptr,const JBinaryDataArray *ar)const;
   void InArray(unsigned &count,unsigned size,byte *ptr,const JBinaryDataArray *ar)const;
   void InItemBase(unsigned &count,unsigned size,byte *ptr,bool all)const;
   void InItem(unsigned &count,unsigned size,byte *ptr,bool all)const;
 
-  JBinaryDataArray* OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata);
-  void OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata);
-  void OutArray(unsigned &count,unsigned size,const byte *ptr);
+  JBinaryDataArray* OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata,bool &comp);
+  void OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool comp,bool view=false);
+  void OutArray(unsigned &count,unsigned size,const byte *ptr,bool view=false);
   JBinaryData* OutItemBase(unsigned &count,unsigned size,const byte *ptr,bool create,unsigned &narrays,unsigned &nitems,unsigned &sizevalues);
-  void OutItem(unsigned &count,unsigned size,const byte *ptr,bool create);
+  void OutItem(unsigned &count,unsigned size,const byte *ptr,bool create,bool view=false);
 
   unsigned GetSizeValues()const;
   void SaveValues(unsigned &count,unsigned size,byte *ptr)const;
@@ -287,7 +300,7 @@ class JBinaryData : protected JObject
   void WriteItem(std::fstream *pf,unsigned sbuf,byte *buf,bool all)const;
 
   unsigned ReadUint(std::ifstream *pf)const;
-  void ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool loadarraysdata);
+  void ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool comp,bool loadarraysdata);
   void ReadArray(std::ifstream *pf,unsigned sbuf,byte *buf,bool loadarraysdata);
   void ReadItem(std::ifstream *pf,unsigned sbuf,byte *buf,bool create,bool loadarraysdata);
 
@@ -317,6 +330,8 @@ class JBinaryData : protected JObject
   bool GetHide()const{ return(HideAll); }
   void SetHideValues(bool hide,bool down);
   bool GetHideValues()const{ return(HideValues); }
+  void SetCompressArrays(bool comp){ CompressArrays=comp; }
+  bool GetCompressArrays()const{ return(Parent? Parent->GetCompressArrays(): CompressArrays); }
   void SetHideArrays(bool hide,bool down);
   void SetHideItems(bool hide,bool down);
 
@@ -341,6 +356,8 @@ class JBinaryData : protected JObject
   void OpenFileStructure(const std::string &file,const std::string &filecode="");
   void CloseFileStructure();
   std::ifstream* GetFileStructure()const;
+  bool OpenFileMapped(const std::string &file,const std::string &filecode="");
+  const byte* GetFileMap()const;
 
   void SaveFileXml(std::string file,bool svarrays=false,const std::string &head=" fmt=\"JBinaryData\"")const;
 
@@ -364,6 +381,7 @@ class JBinaryData : protected JObject
   JBinaryDataArray* GetArray(unsigned index);
   JBinaryDataArray* CreateArray(const std::string &name,JBinaryDataDef::TpData type);
   JBinaryDataArray* CreateArray(const std::string &name,JBinaryDataDef::TpData type,unsigned count,const void *data,bool externalpointer);
+  JBinaryDataArray* CreateArrayStrided(const std::string &name,JBinaryDataDef::TpData type,unsigned count,const void *data,unsigned stride);
   void RemoveArray(const std::string &name);
   void RemoveArrays();
 
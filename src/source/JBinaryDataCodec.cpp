@@ -0,0 +1,285 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JBinaryDataCodec.cpp \brief Implements the class \ref JBinaryDataCodec.
+
+#include "JBinaryDataCodec.h"
+#include "OmpDefs.h"
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+#define LZ_HASHLOG 14        ///<Bits of the hash table of the LZ coder.
+#define LZ_MINMATCH 4        ///<Minimum length of a match.
+#define LZ_LASTLITERALS 5    ///<The last bytes of a block are always literals.
+#define LZ_MFLIMIT 12        ///<Matches can not start in the last bytes of a block.
+#define LZ_MAXOFFSET 65535   ///<Maximum distance of a match.
+
+//==============================================================================
+/// Returns 4 bytes of ptr as unsigned.
+//==============================================================================
+static inline unsigned LzRead32(const byte *ptr){
+  unsigned v; memcpy(&v,ptr,sizeof(unsigned)); return(v);
+}
+
+//==============================================================================
+/// Writes an extended length (bytes of 255 and the remainder).
+//==============================================================================
+static inline void LzLength(unsigned len,byte *dst,unsigned &op){
+  for(;len>=255;len-=255)dst[op++]=255;
+  dst[op++]=byte(len);
+}
+
+//==============================================================================
+/// Writes a sequence with nlit literals and a match of mlen bytes at distance
+/// offset (mlen=0 for the last sequence). Returns false when the sequence
+/// does not fit in cap bytes.
+//==============================================================================
+static bool LzSequence(const byte *lit,unsigned nlit,unsigned offset,unsigned mlen,byte *dst,unsigned &op,unsigned cap){
+  const ullong need=ullong(op)+1+nlit/255+1+nlit+(mlen? 2+(mlen-LZ_MINMATCH)/255+1: 0);
+  if(need>cap)return(false);
+  const unsigned ptoken=op++;
+  dst[ptoken]=byte((nlit>=15? 15: nlit)<<4);
+  if(nlit>=15)LzLength(nlit-15,dst,op);
+  memcpy(dst+op,lit,nlit); op+=nlit;
+  if(mlen){
+    dst[op++]=byte(offset&0xff);
+    dst[op++]=byte(offset>>8);
+    const unsigned ml=mlen-LZ_MINMATCH;
+    dst[ptoken]|=byte(ml>=15? 15: ml);
+    if(ml>=15)LzLength(ml-15,dst,op);
+  }
+  return(true);
+}
+
+//==============================================================================
+/// Compresses n bytes of src in dst (LZ4 block format). Returns the size of
+/// the compressed data or 0 when it does not fit in cap bytes.
+//==============================================================================
+unsigned JBinaryDataCodec::LzCompress(const byte *src,unsigned n,byte *dst,unsigned cap){
+  vector<unsigned> htab(1u<<LZ_HASHLOG,0); //-Position+1 of the last sequence with each hash.
+  unsigned ip=0,anchor=0,op=0;
+  if(n>LZ_MFLIMIT){
+    const unsigned ilimit=n-LZ_MFLIMIT,mlimit=n-LZ_LASTLITERALS;
+    unsigned miss=0;
+    while(ip<=ilimit){
+      const unsigned seq=LzRead32(src+ip);
+      const unsigned h=(seq*2654435761u)>>(32-LZ_HASHLOG);
+      const unsigned ref=htab[h];
+      htab[h]=ip+1;
+      if(ref && ip-(ref-1)<=LZ_MAXOFFSET && LzRead32(src+ref-1)==seq){
+        const unsigned r=ref-1;
+        unsigned len=LZ_MINMATCH;
+        while(ip+len<mlimit && src[r+len]==src[ip+len])len++;
+        if(!LzSequence(src+anchor,ip-anchor,ip-r,len,dst,op,cap))return(0);
+        ip+=len; anchor=ip; miss=0;
+      }
+      else ip+=1+(miss++>>6); //-Skips faster in data without matches.
+    }
+  }
+  if(!LzSequence(src+anchor,n-anchor,0,0,dst,op,cap))return(0);
+  return(op);
+}
+
+//==============================================================================
+/// Decompresses csize bytes of src in the n bytes of dst. Returns false when
+/// the data is corrupted.
+//==============================================================================
+bool JBinaryDataCodec::LzDecompress(const byte *src,unsigned csize,byte *dst,unsigned n){
+  unsigned ip=0,op=0;
+  while(ip<csize){
+    const unsigned token=src[ip++];
+    unsigned nlit=token>>4;
+    if(nlit==15){
+      byte b;
+      do{
+        if(ip>=csize)return(false);
+        b=src[ip++]; nlit+=b;
+      }while(b==255);
+    }
+    if(nlit>csize-ip || nlit>n-op)return(false);
+    memcpy(dst+op,src+ip,nlit); ip+=nlit; op+=nlit;
+    if(ip==csize)break; //-Last sequence.
+    if(csize-ip<2)return(false);
+    const unsigned offset=unsigned(src[ip])|(unsigned(src[ip+1])<<8);
+    ip+=2;
+    if(!offset || offset>op)return(false);
+    unsigned mlen=token&15;
+    if(mlen==15){
+      byte b;
+      do{
+        if(ip>=csize)return(false);
+        b=src[ip++]; mlen+=b;
+      }while(b==255);
+    }
+    mlen+=LZ_MINMATCH;
+    if(mlen>n-op)return(false);
+    const byte *m=dst+op-offset;
+    if(offset>=mlen)memcpy(dst+op,m,mlen);
+    else for(unsigned c=0;c<mlen;c++)dst[op+c]=m[c]; //-Overlapped copy (repeated pattern).
+    op+=mlen;
+  }
+  return(op==n);
+}
+
+//==============================================================================
+/// Returns the size of the scalar components of type used for the shuffle.
+//==============================================================================
+unsigned JBinaryDataCodec::ShuffleUnit(JBinaryDataDef::TpData type){
+  switch(type){
+    case JBinaryDataDef::DatShort:
+    case JBinaryDataDef::DatUshort:   return(2);
+    case JBinaryDataDef::DatLlong:
+    case JBinaryDataDef::DatUllong:
+    case JBinaryDataDef::DatDouble:
+    case JBinaryDataDef::DatDouble3:  return(8);
+    case JBinaryDataDef::DatInt:
+    case JBinaryDataDef::DatUint:
+    case JBinaryDataDef::DatFloat:
+    case JBinaryDataDef::DatInt3:
+    case JBinaryDataDef::DatUint3:
+    case JBinaryDataDef::DatFloat3:
+    case JBinaryDataDef::DatSymMat:   return(4);
+    default:                          return(1);
+  }
+}
+
+//==============================================================================
+/// Groups the byte b of the n/unit values of src in the stream b of dst.
+//==============================================================================
+void JBinaryDataCodec::Shuffle(unsigned n,unsigned unit,const byte *src,byte *dst){
+  if(unit<=1 || n%unit){ memcpy(dst,src,n); return; }
+  const unsigned m=n/unit;
+  for(unsigned b=0;b<unit;b++){
+    byte *d=dst+size_t(b)*m;
+    for(unsigned c=0;c<m;c++)d[c]=src[size_t(c)*unit+b];
+  }
+}
+
+//==============================================================================
+/// Inverse of Shuffle().
+//==============================================================================
+void JBinaryDataCodec::Unshuffle(unsigned n,unsigned unit,const byte *src,byte *dst){
+  if(unit<=1 || n%unit){ memcpy(dst,src,n); return; }
+  const unsigned m=n/unit;
+  for(unsigned b=0;b<unit;b++){
+    const byte *s=src+size_t(b)*m;
+    for(unsigned c=0;c<m;c++)dst[size_t(c)*unit+b]=s[c];
+  }
+}
+
+//==============================================================================
+/// Compresses the data of the array in out. Returns false when the array is
+/// not compressed (type not supported, small array or no gain).
+//==============================================================================
+bool JBinaryDataCodec::Compress(const JBinaryDataArray *ar,std::vector<byte> &out){
+  const JBinaryDataDef::TpData type=ar->GetType();
+  const unsigned stype=unsigned(JBinaryDataDef::SizeOfType(type));
+  const unsigned count=ar->GetCount();
+  if(type==JBinaryDataDef::DatText || !stype || !ar->DataInPointer())return(false);
+  const ullong rawsize=ullong(stype)*count;
+  if(rawsize<CODEC_MINSIZE)return(false);
+  const unsigned unit=ShuffleUnit(type);
+  const unsigned nblock=max(1u,CODEC_BLOCKSIZE/stype); //-Values per block.
+  const unsigned nb=(count+nblock-1)/nblock;
+  vector< vector<byte> > blocks(nb);
+  vector<unsigned> csize(nb);
+  const int nbi=int(nb);
+#ifdef OMP_USE
+  #pragma omp parallel for schedule (dynamic) if(nbi>1)
+#endif
+  for(int cb=0;cb<nbi;cb++){
+    const unsigned ini=unsigned(cb)*nblock;
+    const unsigned sn=min(nblock,count-ini)*stype;
+    vector<byte> raw(sn),shf(sn);
+    ar->GetStridedData(ini,sn/stype,raw.data());
+    Shuffle(sn,unit,raw.data(),shf.data());
+    vector<byte> &bk=blocks[cb];
+    bk.resize(sn);
+    const unsigned cs=LzCompress(shf.data(),sn,bk.data(),sn);
+    if(cs){ bk.resize(cs); csize[cb]=cs; }
+    else{ bk.swap(shf); csize[cb]=sn|CODEC_RAWBLOCK; }
+  }
+  //-Joins the blocks when there is gain.
+  ullong total=sizeof(unsigned)*(2+ullong(nb));
+  for(unsigned cb=0;cb<nb;cb++)total+=blocks[cb].size();
+  if(total>=rawsize)return(false);
+  out.resize(size_t(total));
+  byte *p=out.data();
+  const unsigned head[2]={nblock*stype,nb};
+  memcpy(p,head,sizeof(head)); p+=sizeof(head);
+  memcpy(p,csize.data(),sizeof(unsigned)*nb); p+=sizeof(unsigned)*nb;
+  for(unsigned cb=0;cb<nb;cb++){
+    memcpy(p,blocks[cb].data(),blocks[cb].size()); p+=blocks[cb].size();
+  }
+  return(true);
+}
+
+//==============================================================================
+/// Decompresses csize bytes of src in the count values of type of dst.
+/// Returns false when the data is corrupted.
+//==============================================================================
+bool JBinaryDataCodec::Decompress(JBinaryDataDef::TpData type,unsigned count,const byte *src,unsigned csize,void *dst){
+  const unsigned stype=unsigned(JBinaryDataDef::SizeOfType(type));
+  if(type==JBinaryDataDef::DatText || !stype || csize<sizeof(unsigned)*2)return(false);
+  unsigned head[2];
+  memcpy(head,src,sizeof(head));
+  const unsigned bsize=head[0],nb=head[1];
+  if(!bsize || bsize%stype)return(false);
+  const unsigned nblock=bsize/stype;
+  if(nb!=(count+nblock-1)/nblock)return(false);
+  const ullong sizehead=sizeof(unsigned)*(2+ullong(nb));
+  if(csize<sizehead)return(false);
+  //-Position of the blocks.
+  vector<unsigned> csizes(nb);
+  vector<ullong> pos(nb);
+  memcpy(csizes.data(),src+sizeof(head),sizeof(unsigned)*nb);
+  ullong p=sizehead;
+  for(unsigned cb=0;cb<nb;cb++){
+    pos[cb]=p;
+    p+=(csizes[cb]&~CODEC_RAWBLOCK);
+  }
+  if(p!=csize)return(false);
+  const unsigned unit=ShuffleUnit(type);
+  vector<byte> ok(nb,1);
+  const int nbi=int(nb);
+#ifdef OMP_USE
+  #pragma omp parallel for schedule (dynamic) if(nbi>1)
+#endif
+  for(int cb=0;cb<nbi;cb++){
+    const unsigned ini=unsigned(cb)*nblock;
+    const unsigned sn=min(nblock,count-ini)*stype;
+    const byte *bk=src+pos[cb];
+    const unsigned cs=(csizes[cb]&~CODEC_RAWBLOCK);
+    byte *out=(byte*)dst+size_t(ini)*stype;
+    if(csizes[cb]&CODEC_RAWBLOCK){
+      if(cs==sn)Unshuffle(sn,unit,bk,out);
+      else ok[cb]=0;
+    }
+    else{
+      vector<byte> shf(sn);
+      if(LzDecompress(bk,cs,shf.data(),sn))Unshuffle(sn,unit,shf.data(),out);
+      else ok[cb]=0;
+    }
+  }
+  for(unsigned cb=0;cb<nb;cb++)if(!ok[cb])return(false);
+  return(true);
+}
+
+
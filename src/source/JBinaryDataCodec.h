@@ -0,0 +1,66 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JBinaryDataCodec.h \brief Declares the class \ref JBinaryDataCodec.
+
+#ifndef _JBinaryDataCodec_
+#define _JBinaryDataCodec_
+
+#include "TypesDef.h"
+#include "JBinaryData.h"
+#include <vector>
+
+//##############################################################################
+//# JBinaryDataCodec
+//##############################################################################
+/// \brief Lossless compression of the arrays of basic types of \ref JBinaryData.
+/// The data is split in blocks of CODEC_BLOCKSIZE bytes that are processed
+/// in parallel. Each block is byte-shuffled with the size of the scalar
+/// components of the type (4 for float, tfloat3 and tsymatrix3f, 8 for double...)
+/// so the exponents and high bytes of neighbouring values are contiguous,
+/// and then compressed with a LZ77 coder (LZ4 block format).
+///
+/// Format of the compressed data:
+///  - unsigned blocksize: bytes of uncompressed data per block.
+///  - unsigned nblocks: number of blocks.
+///  - unsigned csize[nblocks]: bytes of each block, CODEC_RAWBLOCK is set
+///    when the block was stored shuffled but without LZ.
+///  - data of the blocks.
+
+#define CODEC_BLOCKSIZE (1u<<18)   ///<Bytes of uncompressed data per block (256 KB).
+#define CODEC_MINSIZE 4096         ///<Arrays smaller than this are not compressed.
+#define CODEC_RAWBLOCK 0x80000000u ///<Flag in csize of blocks stored without LZ.
+
+class JBinaryDataCodec
+{
+ private:
+  static unsigned LzCompress(const byte *src,unsigned n,byte *dst,unsigned cap);
+  static bool LzDecompress(const byte *src,unsigned csize,byte *dst,unsigned n);
+
+ public:
+  static unsigned ShuffleUnit(JBinaryDataDef::TpData type);
+  static void Shuffle(unsigned n,unsigned unit,const byte *src,byte *dst);
+  static void Unshuffle(unsigned n,unsigned unit,const byte *src,byte *dst);
+
+  static bool Compress(const JBinaryDataArray *ar,std::vector<byte> &out);
+  static bool Decompress(JBinaryDataDef::TpData type,unsigned count,const byte *src,unsigned csize,void *dst);
+};
+
+#endif
+
+
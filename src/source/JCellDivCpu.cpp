@@ -42,7 +42,9 @@ JCellDivCpu::JCellDivCpu(bool stable,bool floating,byte periactive,TpCellOrder c
   ClassName="JCellDivCpu";
   CellPart=NULL;    SortPart=NULL;
   PartsInCell=NULL; BeginCell=NULL;
+  SortAux=NULL; SizeSortAux=0;
   VSort=NULL;
+  IncrDivide=0;
   Reset();
 }
 
@@ -76,6 +78,9 @@ void JCellDivCpu::Reset(){
   BoundLimitCellMin=BoundLimitCellMax=TUint3(0);
   BoundDivideCellMin=BoundDivideCellMax=TUint3(0);
   DivideFull=false;
+  IncrOk=false; IncrNp=IncrNpb=0;
+  SortIdentity=false;
+  NdivIncr=0;
 }
 
 //==============================================================================
@@ -85,8 +90,10 @@ void JCellDivCpu::Reset(){
 void JCellDivCpu::FreeMemoryNct(){
   delete[] PartsInCell;   PartsInCell=NULL;
   delete[] BeginCell;     BeginCell=NULL; 
+  delete[] SortAux;       SortAux=NULL; SizeSortAux=0;
   MemAllocNct=0;
   BoundDivideOk=false;
+  IncrOk=false;
 }
 
 //==============================================================================
@@ -99,6 +106,7 @@ void JCellDivCpu::FreeMemoryNp(){
   delete[] VSort;       SetMemoryVSort(NULL);
   MemAllocNp=0;
   BoundDivideOk=false;
+  IncrOk=false;
 }
 
 //==============================================================================
@@ -211,6 +219,27 @@ void JCellDivCpu::CheckMemoryNct(unsigned nctmin){
   else if(!BeginCell)AllocMemoryNct(SizeNct);  
 }
 
+//==============================================================================
+/// Returns auxiliary memory of the parallel and incremental sorts with at least
+/// size values. It is released with the memory of cells.
+//==============================================================================
+unsigned* JCellDivCpu::GetMemorySortAux(ullong size){
+  if(SizeSortAux<size || !SortAux){
+    if(SortAux)MemAllocNct-=sizeof(unsigned)*SizeSortAux;
+    delete[] SortAux; SortAux=NULL;
+    SizeSortAux=0;
+    try{
+      SortAux=new unsigned[size];
+    }
+    catch(const std::bad_alloc){
+      RunException("GetMemorySortAux",fun::PrintStr("Failed CPU memory allocation of %.1f MB for sorting particles.",double(sizeof(unsigned)*size)/(1024*1024)));
+    }
+    SizeSortAux=size;
+    MemAllocNct+=sizeof(unsigned)*size;
+  }
+  return(SortAux);
+}
+
 //==============================================================================
 /// Define simulation domain to use.
 /// Define el dominio de simulacion a usar.
@@ -447,6 +476,77 @@ void JCellDivCpu::SortArray(tsymatrix3f *vec) {
 	memcpy(vec + ini, VSortSymmatrix3f + ini, sizeof(tsymatrix3f)*(n - ini));
 }
 
+//==============================================================================
+/// Reorder values of all particles (for type tsymatrix3fsoa). The 6 streams
+/// are gathered in one pass using VSort as 6 arrays of float.
+/// Reordena datos de todas las particulas (para tipo tsymatrix3fsoa).
+//==============================================================================
+void JCellDivCpu::SortArray(tsymatrix3fsoa &vec){
+  const int n=int(Nptot);
+  const int ini=(DivideFull? 0: int(NpbFinal));
+  float *sxx=VSortFloat,*sxy=sxx+n,*sxz=sxy+n,*syy=sxz+n,*syz=syy+n,*szz=syz+n;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int p=ini;p<n;p++){
+    const unsigned sp=SortPart[p];
+    sxx[p]=vec.xx[sp]; sxy[p]=vec.xy[sp]; sxz[p]=vec.xz[sp];
+    syy[p]=vec.yy[sp]; syz[p]=vec.yz[sp]; szz[p]=vec.zz[sp];
+  }
+  for(unsigned c=0;c<6;c++)memcpy(vec.Stream(c)+ini,VSortFloat+n*c+ini,sizeof(float)*(n-ini));
+}
+
+//==============================================================================
+/// Copies src[sortpart[p]] to dst[p] for p in [pini,pfin).
+//==============================================================================
+template<class T> static void SortBlock(unsigned pini,unsigned pfin,const unsigned *sortpart,const void *src,void *dst){
+  const T *vsrc=(const T*)src;
+  T *vdst=(T*)dst;
+  for(unsigned p=pini;p<pfin;p++)vdst[p]=vsrc[sortpart[p]];
+}
+
+//==============================================================================
+/// Reorders several particle arrays in one pass over SortPart. The particles
+/// are processed in blocks of SORTBLOCK so each block of SortPart is reused
+/// from cache for all the arrays. The data is written in arrays[].dst, so the
+/// caller only swaps pointers instead of copying the data back.
+/// Reordena varios arrays de particulas en una sola pasada sobre SortPart.
+//==============================================================================
+void JCellDivCpu::SortArrays(unsigned narrays,const StSortArrayCpu *arrays)const{
+  const unsigned SORTBLOCK=2048;
+  for(unsigned ca=0;ca<narrays;ca++){
+    const unsigned size=arrays[ca].size;
+    if(size!=1 && size!=2 && size!=4 && size!=8 && size!=12 && size!=16 && size!=24 && size!=36)
+      RunException("SortArrays","The element size of the array is invalid.");
+  }
+  const unsigned n=Nptot;
+  const unsigned ini=(DivideFull? 0: NpbFinal);
+  //-Particles not included in divide keep their position.
+  if(ini)for(unsigned ca=0;ca<narrays;ca++)memcpy(arrays[ca].dst,arrays[ca].src,size_t(arrays[ca].size)*ini);
+  const int nblock=int((n-ini+SORTBLOCK-1)/SORTBLOCK);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int cb=0;cb<nblock;cb++){
+    const unsigned pini=ini+unsigned(cb)*SORTBLOCK;
+    const unsigned pfin=min(n,pini+SORTBLOCK);
+    for(unsigned ca=0;ca<narrays;ca++){
+      const void *src=arrays[ca].src;
+      void *dst=arrays[ca].dst;
+      switch(arrays[ca].size){
+        case 1:  SortBlock<byte>     (pini,pfin,SortPart,src,dst);  break;
+        case 2:  SortBlock<word>     (pini,pfin,SortPart,src,dst);  break;
+        case 4:  SortBlock<unsigned> (pini,pfin,SortPart,src,dst);  break;
+        case 8:  SortBlock<ullong>   (pini,pfin,SortPart,src,dst);  break;
+        case 12: SortBlock<tfloat3>  (pini,pfin,SortPart,src,dst);  break;
+        case 16: SortBlock<tfloat4>  (pini,pfin,SortPart,src,dst);  break;
+        case 24: SortBlock<tdouble3> (pini,pfin,SortPart,src,dst);  break;
+        case 36: SortBlock<tmatrix3f>(pini,pfin,SortPart,src,dst);  break;
+      }
+    }
+  }
+}
+
 //==============================================================================
 /// Reorder values of all particles (for type tmatrix3f)
 /// Matthias
@@ -33,6 +33,13 @@
 
 //#define DBG_JCellDivCpu 1 //:DEL:
 
+///Particle array reordered by JCellDivCpu::SortArrays().
+typedef struct{
+  const void *src;     ///<Current data.
+  void *dst;           ///<Array that receives the reordered data (must be different from src).
+  unsigned size;       ///<Size of one element in bytes (1,2,4,8,12,16,24 or 36).
+}StSortArrayCpu;
+
 //##############################################################################
 //# JCellDivCpu
 //##############################################################################
@@ -78,6 +85,8 @@ protected:
   unsigned *PartsInCell;
   unsigned *BeginCell;   ///<Get first value of each cell. | Contiene el principio de cada celda. 
   // BeginCell=[BoundOk(nct),BoundIgnore(1),Fluid(nct),BoundOut(1),FluidOut(1),BoundOutIgnore(1),FluidOutIgnore(1),END)]
+  unsigned *SortAux;     ///<Auxiliary memory of the parallel and incremental sorts (allocated on demand). [SizeSortAux]
+  ullong SizeSortAux;
 
   //-Variables to reorder particles. | Variables para reordenar particulas.
   byte        *VSort;            ///<Memory to reorder particles. | Memoria para reordenar particulas. [sizeof(tdouble3)*Np]
@@ -123,6 +132,14 @@ protected:
 
   bool DivideFull;      ///<Indicate that divie is applied to fluid & boundary (not only to fluid). | Indica que el divide se aplico a fluido y contorno (no solo al fluido).
 
+  //-Variables of the incremental divide.
+  float IncrDivide;     ///<Maximum fraction of particles that change box to use the incremental divide (0:disabled).
+  bool IncrOk;          ///<CellPart[] of the last divide is valid for the incremental divide.
+  unsigned IncrNp;      ///<NpFinal of the last divide, particles [Npb,IncrNp) are sorted by CellPart[].
+  unsigned IncrNpb;     ///<NpbFinal of the last divide.
+  bool SortIdentity;    ///<SortPart[] of the last divide does not change the order of particles.
+  unsigned NdivIncr;    ///<Number of incremental divides.
+
   void Reset();
 
   //-Management of allocated dynamic memory.
@@ -135,6 +152,7 @@ protected:
   void AllocMemoryNct(ullong nct);
   void CheckMemoryNp(unsigned npmin);
   void CheckMemoryNct(unsigned nctmin);
+  unsigned* GetMemorySortAux(ullong size);
 
   ullong SizeBeginCell(ullong nct)const{ return((nct*2)+5+1); } //-[BoundOk(nct),BoundIgnore(1),Fluid(nct),BoundOut(1),FluidOut(1),BoundOutIgnore(1),FluidOutIgnore(1),END(1)]
 
@@ -163,10 +181,13 @@ public:
   void SortArray(tfloat3 *vec);
   void SortArray(tfloat4 *vec);
   void SortArray(tsymatrix3f *vec);
+  void SortArray(tsymatrix3fsoa &vec);
   // Matthias
   void SortArray(tmatrix3f *vec);
   void SortArray(bool *vec);
 
+  void SortArrays(unsigned narrays,const StSortArrayCpu *arrays)const;
+
   TpCellMode GetCellMode()const{ return(CellMode); }
   unsigned GetHdiv()const{ return(Hdiv); }
   float GetScell()const{ return(Scell); }
@@ -182,6 +203,9 @@ public:
   tuint3 GetCellDomainMax()const{ return(CellDomainMax); }
   tdouble3 GetDomainLimits(bool limitmin,unsigned slicecellmin=0)const;
 
+  void SetIncrementalDivide(float incr){ IncrDivide=incr; }
+  bool GetSortIdentity()const{ return(SortIdentity); }
+
   unsigned GetNpFinal()const{ return(NpFinal); }
   unsigned GetNpbFinal()const{ return(NpbFinal); }
   unsigned GetNpbIgnore()const{ return(NpbIgnore); }
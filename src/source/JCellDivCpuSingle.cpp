@@ -21,6 +21,7 @@
 #include "JCellDivCpuSingle.h"
 #include "Functions.h"
 #include <climits>
+#include <algorithm>
 
 using namespace std;
 
@@ -104,6 +105,45 @@ void JCellDivCpuSingle::PrepareNct(){
   //:Log->Printf("--->PrepareNct> BoxBoundOutIgnore:%u BoxFluidOutIgnore:%u",BoxBoundOutIgnore,BoxFluidOutIgnore);
 }
 
+//==============================================================================
+/// Returns the box of one particle in a full divide. Excluded particles bound
+/// (fixed and moving) and floating are moved to BoxBoundOut.
+//==============================================================================
+inline unsigned JCellDivCpuSingle::BoxFull(unsigned rcell,typecode rcode)const{
+  //-Computes cell according position.
+  const unsigned cx=PC__Cellx(DomCellCode,rcell)-CellDomainMin.x;
+  const unsigned cy=PC__Celly(DomCellCode,rcell)-CellDomainMin.y;
+  const unsigned cz=PC__Cellz(DomCellCode,rcell)-CellDomainMin.z;
+  const unsigned cellsort=cx+cy*Ncx+cz*Nsheet;
+  //-Checks particle code.
+  const typecode codetype=CODE_GetType(rcode);
+  const typecode codeout=CODE_GetSpecialValue(rcode);
+  //-Assigns box.
+  if(codetype<CODE_TYPE_FLOATING){//-Bound particles (except floating) | Particulas bound (excepto floating).
+    return(codeout<CODE_OUTIGNORE?   ((cx<Ncx && cy<Ncy && cz<Ncz)? cellsort: BoxBoundIgnore):   (codeout==CODE_OUTIGNORE? BoxBoundOutIgnore: BoxBoundOut));
+  }
+  else{//-Fluid and floating particles | Particulas fluid y floating.
+    return(codeout<=CODE_OUTIGNORE?   (codeout<CODE_OUTIGNORE? BoxFluid+cellsort: BoxFluidOutIgnore):   (codetype==CODE_TYPE_FLOATING? BoxBoundOut: BoxFluidOut));
+  }
+}
+
+//==============================================================================
+/// Returns the box of one fluid particle in a divide of fluid only. Excluded
+/// particles floating are moved to BoxBoundOut.
+//==============================================================================
+inline unsigned JCellDivCpuSingle::BoxFluidPart(unsigned rcell,typecode rcode)const{
+  //-Computes cell according position.
+  const unsigned cx=PC__Cellx(DomCellCode,rcell)-CellDomainMin.x;
+  const unsigned cy=PC__Celly(DomCellCode,rcell)-CellDomainMin.y;
+  const unsigned cz=PC__Cellz(DomCellCode,rcell)-CellDomainMin.z;
+  const unsigned cellsortfluid=BoxFluid+cx+cy*Ncx+cz*Nsheet;
+  //-Checks particle code.
+  const typecode codetype=CODE_GetType(rcode);
+  const typecode codeout=CODE_GetSpecialValue(rcode);
+  //-Assigns box.
+  return(codeout<=CODE_OUTIGNORE?   (codeout<CODE_OUTIGNORE? cellsortfluid: BoxFluidOutIgnore):   (codetype==CODE_TYPE_FLOATING? BoxBoundOut: BoxFluidOut));
+}
+
 //==============================================================================
 /// Computes cell of each boundary and fluid particle (cellpart[]) starting from its cell in 
 /// the map. all the excluded particles were already marked in code[].
@@ -120,24 +160,7 @@ void JCellDivCpuSingle::PreSortFull(unsigned np,const unsigned *dcellc,const typ
 {
   memset(partsincell,0,sizeof(unsigned)*(Nctt-1));
   for(unsigned p=0;p<np;p++){
-    //-Computes cell according position.
-    const unsigned rcell=dcellc[p];
-    const unsigned cx=PC__Cellx(DomCellCode,rcell)-CellDomainMin.x;
-    const unsigned cy=PC__Celly(DomCellCode,rcell)-CellDomainMin.y;
-    const unsigned cz=PC__Cellz(DomCellCode,rcell)-CellDomainMin.z;
-    const unsigned cellsort=cx+cy*Ncx+cz*Nsheet;
-    //-Checks particle code.
-    const typecode rcode=codec[p];
-    const typecode codetype=CODE_GetType(rcode);
-    const typecode codeout=CODE_GetSpecialValue(rcode);
-    //-Assigns box.
-    unsigned box;
-    if(codetype<CODE_TYPE_FLOATING){//-Bound particles (except floating) | Particulas bound (excepto floating).
-      box=(codeout<CODE_OUTIGNORE?   ((cx<Ncx && cy<Ncy && cz<Ncz)? cellsort: BoxBoundIgnore):   (codeout==CODE_OUTIGNORE? BoxBoundOutIgnore: BoxBoundOut));
-    }
-    else{//-Fluid and floating particles | Particulas fluid y floating.
-      box=(codeout<=CODE_OUTIGNORE?   (codeout<CODE_OUTIGNORE? BoxFluid+cellsort: BoxFluidOutIgnore):   (codetype==CODE_TYPE_FLOATING? BoxBoundOut: BoxFluidOut));
-    }
+    const unsigned box=BoxFull(dcellc[p],codec[p]);
     cellpart[p]=box;
     partsincell[box]++;
   }
@@ -160,19 +183,7 @@ void JCellDivCpuSingle::PreSortFluid(unsigned np,unsigned pini,const unsigned *d
   memset(partsincell+BoxFluid,0,sizeof(unsigned)*(Nctt-1-BoxFluid));
   const unsigned pfin=pini+np;
   for(unsigned p=pini;p<pfin;p++){
-
-    //-Computes cell according position.
-    const unsigned rcell=dcellc[p];
-    const unsigned cx=PC__Cellx(DomCellCode,rcell)-CellDomainMin.x;
-    const unsigned cy=PC__Celly(DomCellCode,rcell)-CellDomainMin.y;
-    const unsigned cz=PC__Cellz(DomCellCode,rcell)-CellDomainMin.z;
-    const unsigned cellsortfluid=BoxFluid+cx+cy*Ncx+cz*Nsheet;
-    //-Checks particle code.
-    const typecode rcode=codec[p];
-    const typecode codetype=CODE_GetType(rcode);
-    const typecode codeout=CODE_GetSpecialValue(rcode);
-    //-Assigns box.
-    const unsigned box=(codeout<=CODE_OUTIGNORE?   (codeout<CODE_OUTIGNORE? cellsortfluid: BoxFluidOutIgnore):   (codetype==CODE_TYPE_FLOATING? BoxBoundOut: BoxFluidOut));
+    const unsigned box=BoxFluidPart(dcellc[p],codec[p]);
     cellpart[p]=box;
     partsincell[box]++;
   }
@@ -222,6 +233,233 @@ void JCellDivCpuSingle::MakeSortFluid(unsigned np,unsigned pini,const unsigned*
 	}
 }
 
+//==============================================================================
+/// Returns the number of threads used to sort np particles in nbox boxes, or 1
+/// when the serial version is used. The counts per thread cost nbox values
+/// each, so the threads are limited to keep them below the particle work.
+//==============================================================================
+unsigned JCellDivCpuSingle::GetSortThreads(unsigned np,unsigned nbox)const{
+  unsigned nth=1;
+#ifdef OMP_USE
+  if(np>OMP_LIMIT_COMPUTELIGHT){
+    nth=unsigned(omp_get_max_threads());
+    if(nth>OMP_MAXTHREADS)nth=OMP_MAXTHREADS;
+    const ullong nthbox=(ullong(np)*4)/(nbox? nbox: 1);
+    if(nthbox<nth)nth=unsigned(nthbox>1? nthbox: 1);
+  }
+#endif
+  return(nth);
+}
+
+//==============================================================================
+/// Computes CellPart[], PartsInCell[], BeginCell[] and SortPart[] of particles
+/// [pini,pini+np) with a counting sort in parallel (same result as PreSortFull()
+/// and MakeSortFull() or PreSortFluid() and MakeSortFluid()).
+/// Each thread counts its own contiguous range of particles, the counts of the
+/// threads are converted into the first position of each thread in each box
+/// and then each thread places its range in order, so the sort is stable.
+/// With full=false only the fluid boxes are computed from begincell[BoxFluid].
+//==============================================================================
+void JCellDivCpuSingle::MakeSortParallel(bool full,unsigned nth,unsigned np,unsigned pini
+  ,const unsigned *dcellc,const typecode *codec
+  ,unsigned* cellpart,unsigned* begincell,unsigned* partsincell,unsigned* sortpart)
+{
+  const unsigned box0=(full? 0: BoxFluid);
+  const unsigned nbox=unsigned(Nctt-1)-box0;
+  unsigned *thcount=GetMemorySortAux(ullong(nbox)*nth);
+  const unsigned beg0=(full? 0: begincell[box0]);
+  if(full)begincell[0]=0;
+  unsigned thsum[OMP_MAXTHREADS];
+#ifdef OMP_USE
+  #pragma omp parallel num_threads(nth)
+#endif
+  {
+#ifdef OMP_USE
+    const unsigned nt=unsigned(omp_get_num_threads());
+#else
+    const unsigned nt=1;
+#endif
+    const unsigned th=unsigned(omp_get_thread_num());
+    unsigned *cnt=thcount+ullong(nbox)*th;
+    //-Computes box of particles and counts them by thread.
+    const unsigned pth=pini+unsigned((ullong(np)*th)/nt);
+    const unsigned pthfin=pini+unsigned((ullong(np)*(th+1))/nt);
+    memset(cnt,0,sizeof(unsigned)*nbox);
+    if(full)for(unsigned p=pth;p<pthfin;p++){
+      const unsigned box=BoxFull(dcellc[p],codec[p]);
+      cellpart[p]=box;
+      cnt[box]++;
+    }
+    else for(unsigned p=pth;p<pthfin;p++){
+      const unsigned box=BoxFluidPart(dcellc[p],codec[p]);
+      cellpart[p]=box;
+      cnt[box-box0]++;
+    }
+#ifdef OMP_USE
+    #pragma omp barrier
+#endif
+    //-Total of each box and position of each thread inside the box.
+    const unsigned bini=unsigned((ullong(nbox)*th)/nt);
+    const unsigned bfin=unsigned((ullong(nbox)*(th+1))/nt);
+    unsigned sum=0;
+    for(unsigned b=bini;b<bfin;b++){
+      unsigned n=0;
+      for(unsigned t=0;t<nt;t++){
+        unsigned &c=thcount[ullong(nbox)*t+b];
+        const unsigned v=c; c=n; n+=v;
+      }
+      partsincell[box0+b]=n;
+      sum+=n;
+    }
+    thsum[th]=sum;
+#ifdef OMP_USE
+    #pragma omp barrier
+#endif
+    //-Adjusts initial position of boxes and of each thread inside them.
+    unsigned beg=beg0;
+    for(unsigned t=0;t<th;t++)beg+=thsum[t];
+    for(unsigned b=bini;b<bfin;b++){
+      for(unsigned t=0;t<nt;t++)thcount[ullong(nbox)*t+b]+=beg;
+      beg+=partsincell[box0+b];
+      begincell[box0+b+1]=beg;
+    }
+#ifdef OMP_USE
+    #pragma omp barrier
+#endif
+    //-Puts particles of the thread in their boxes.
+    for(unsigned p=pth;p<pthfin;p++)sortpart[cnt[cellpart[p]-box0]++]=p;
+  }
+}
+
+//==============================================================================
+/// Compares particles by their box in cellpart[] (for the incremental divide).
+//==============================================================================
+struct StCmpCellPart{
+  const unsigned *cellpart;
+  StCmpCellPart(const unsigned *cp):cellpart(cp){}
+  bool operator()(unsigned p1,unsigned p2)const{ return(cellpart[p1]<cellpart[p2]); }
+  bool operator()(unsigned p1,const unsigned *box)const{ return(cellpart[p1]<*box); }
+};
+
+//==============================================================================
+/// Computes CellPart[], PartsInCell[], BeginCell[] and SortPart[] of the fluid
+/// particles [pini,pini+np) starting from the result of the last divide (same
+/// result as PreSortFluid() and MakeSortFluid()).
+/// Particles [pini,IncrNp) are still sorted by cellpart[] of the last divide, so
+/// only the particles that changed box and the new ones (after IncrNp) are
+/// sorted and then merged box by box with the particles that did not move.
+/// Returns false without changes in cellpart[], begincell[] and partsincell[]
+/// when the moved particles exceed IncrDivide*np, then the full sort is used.
+//==============================================================================
+bool JCellDivCpuSingle::MakeSortIncremental(unsigned np,unsigned pini,const unsigned *dcellc,const typecode *codec
+  ,unsigned* cellpart,unsigned* begincell,unsigned* partsincell,unsigned* sortpart)
+{
+  const unsigned pfin=pini+np;
+  const unsigned pold=IncrNp;
+  const unsigned nbox=unsigned(Nctt-1)-BoxFluid;
+  const unsigned nmax=unsigned(IncrDivide*np);
+  if(pold<pini || pold>pfin || pfin-pold>nmax)return(false);
+  //-Memory for the old BeginCell[] of the fluid and the moved particles.
+  unsigned *oldbegin=GetMemorySortAux(ullong(nbox)+1+nmax);
+  unsigned *moved=oldbegin+nbox+1;
+  //-Computes the new box in sortpart[] and collects the particles that changed
+  //-box in order by threads.
+  unsigned thsum[OMP_MAXTHREADS];
+  unsigned nmoved=0;
+#ifdef OMP_USE
+  #pragma omp parallel if(pold-pini>OMP_LIMIT_COMPUTELIGHT)
+#endif
+  {
+#ifdef OMP_USE
+    const unsigned nt=min(unsigned(omp_get_num_threads()),unsigned(OMP_MAXTHREADS));
+#else
+    const unsigned nt=1;
+#endif
+    const unsigned th=unsigned(omp_get_thread_num());
+    if(th<nt){
+      const unsigned pth=pini+unsigned((ullong(pold-pini)*th)/nt);
+      const unsigned pthfin=pini+unsigned((ullong(pold-pini)*(th+1))/nt);
+      unsigned n=0;
+      for(unsigned p=pth;p<pthfin;p++){
+        const unsigned box=BoxFluidPart(dcellc[p],codec[p]);
+        sortpart[p]=box;
+        if(box!=cellpart[p])n++;
+      }
+      thsum[th]=n;
+    }
+#ifdef OMP_USE
+    #pragma omp barrier
+#endif
+    if(th<nt){
+      unsigned ntot=pfin-pold,nprev=0;
+      for(unsigned t=0;t<nt;t++){
+        if(t<th)nprev+=thsum[t];
+        ntot+=thsum[t];
+      }
+      if(th==0)nmoved=ntot;
+      if(ntot<=nmax){
+        const unsigned pth=pini+unsigned((ullong(pold-pini)*th)/nt);
+        const unsigned pthfin=pini+unsigned((ullong(pold-pini)*(th+1))/nt);
+        unsigned *mv=moved+nprev;
+        for(unsigned p=pth;p<pthfin;p++)if(sortpart[p]!=cellpart[p])*(mv++)=p;
+      }
+    }
+  }
+  if(nmoved>nmax)return(false);
+  //-New particles created after the last divide.
+  const unsigned nmovedold=nmoved-(pfin-pold);
+  for(unsigned p=pold;p<pfin;p++){
+    sortpart[p]=BoxFluidPart(dcellc[p],codec[p]);
+    moved[nmovedold+p-pold]=p;
+  }
+  //-Updates the counts of boxes (the excluded particles of the last divide were removed).
+  memset(partsincell+BoxBoundOut,0,sizeof(unsigned)*(Nctt-1-BoxBoundOut));
+  for(unsigned c=0;c<nmoved;c++){
+    const unsigned p=moved[c];
+    if(p<pold)partsincell[cellpart[p]]--;
+    const unsigned box=sortpart[p];
+    partsincell[box]++;
+    cellpart[p]=box;
+  }
+  //-Sorts the moved particles by box keeping the order of particles.
+  stable_sort(moved,moved+nmoved,StCmpCellPart(cellpart));
+  //-Adjusts initial position of cells keeping the previous ones.
+  memcpy(oldbegin,begincell+BoxFluid,sizeof(unsigned)*(nbox+1));
+  for(unsigned box=BoxFluid;box<Nctt-1;box++)begincell[box+1]=begincell[box]+partsincell[box];
+  //-Merges box by box the particles that did not move with the moved ones.
+  //-Each thread computes the boxes that start in its range of positions.
+#ifdef OMP_USE
+  #pragma omp parallel if(np>OMP_LIMIT_COMPUTELIGHT)
+#endif
+  {
+#ifdef OMP_USE
+    const unsigned nt=unsigned(omp_get_num_threads());
+#else
+    const unsigned nt=1;
+#endif
+    const unsigned th=unsigned(omp_get_thread_num());
+    const unsigned *beg=begincell+BoxFluid;
+    const unsigned bini=unsigned(lower_bound(beg,beg+nbox,pini+unsigned((ullong(np)*th)/nt))-beg);
+    const unsigned bfin=(th+1==nt? nbox: unsigned(lower_bound(beg,beg+nbox,pini+unsigned((ullong(np)*(th+1))/nt))-beg));
+    const unsigned boxini=BoxFluid+bini;
+    unsigned c=unsigned(lower_bound(moved,moved+nmoved,&boxini,StCmpCellPart(cellpart))-moved);
+    for(unsigned b=bini;b<bfin;b++){
+      const unsigned box=BoxFluid+b;
+      unsigned q=min(oldbegin[b],pold);
+      const unsigned qfin=min(oldbegin[b+1],pold);
+      unsigned *sp=sortpart+begincell[box];
+      for(;c<nmoved && cellpart[moved[c]]==box;c++){
+        const unsigned pm=moved[c];
+        for(;q<qfin && q<pm;q++)if(cellpart[q]==box)*(sp++)=q;
+        *(sp++)=pm;
+      }
+      for(;q<qfin;q++)if(cellpart[q]==box)*(sp++)=q;
+    }
+  }
+  SortIdentity=(nmoved==0);
+  return(true);
+}
+
 //==============================================================================
 /// Computes cell of each particle (CellPart[]) from dcell[], all the excluded 
 /// particles have been marked  in code[].
@@ -244,15 +482,25 @@ void JCellDivCpuSingle::PreSort(const unsigned* dcellc,const typecode *codec){
   printf("\n");*/
 
   if(DivideFull){
-    PreSortFull(Nptot,dcellc,codec,CellPart,PartsInCell);
-    MakeSortFull(CellPart,BeginCell,PartsInCell,SortPart);
+    const unsigned nth=GetSortThreads(Nptot,unsigned(Nctt-1));
+    if(nth>1)MakeSortParallel(true,nth,Nptot,0,dcellc,codec,CellPart,BeginCell,PartsInCell,SortPart);
+    else{
+      PreSortFull(Nptot,dcellc,codec,CellPart,PartsInCell);
+      MakeSortFull(CellPart,BeginCell,PartsInCell,SortPart);
+    }
+  }
+  else if(IncrDivide>0 && IncrOk && Npb1==IncrNpb && !Npb2 && !Npf2 && MakeSortIncremental(Npf1,Npb1,dcellc,codec,CellPart,BeginCell,PartsInCell,SortPart)){
+    NdivIncr++;
   }
   else{
-    PreSortFluid(Npf1,Npb1,dcellc,codec,CellPart,PartsInCell);
-    MakeSortFluid(Npf1,Npb1,CellPart,BeginCell,PartsInCell,SortPart);
-
+    const unsigned nth=GetSortThreads(Npf1,unsigned(Nctt-1)-BoxFluid);
+    if(nth>1)MakeSortParallel(false,nth,Npf1,Npb1,dcellc,codec,CellPart,BeginCell,PartsInCell,SortPart);
+    else{
+      PreSortFluid(Npf1,Npb1,dcellc,codec,CellPart,PartsInCell);
+      MakeSortFluid(Npf1,Npb1,CellPart,BeginCell,PartsInCell,SortPart);
+    }
   }
-  SortArray(CellPart); //-Order values of CellPart[] | Ordena valores de CellPart[].
+  if(!SortIdentity)SortArray(CellPart); //-Order values of CellPart[] | Ordena valores de CellPart[].
 }
 
 //==============================================================================
@@ -275,6 +523,7 @@ void JCellDivCpuSingle::Divide(unsigned npb1,unsigned npf1,unsigned npb2,unsigne
 {
   const char met[]="Divide";
   DivideFull=false;
+  SortIdentity=false;
   TmcStart(timers,TMC_NlLimits);
 
  
@@ -338,6 +587,10 @@ void JCellDivCpuSingle::Divide(unsigned npb1,unsigned npf1,unsigned npb2,unsigne
   //printf("NpFinal: %d, NpbFinal: %d\n", NpFinal, NpbFinal);
   if(NpbOut!=0 && DivideFull)NpbFinal=UINT_MAX; //-NpbOut can contain excluded particles fixed, moving and also floating.
 
+  //-The next divide can start from this one when particles are only added at the end.
+  IncrOk=(!PeriActive && NpbFinal!=UINT_MAX);
+  IncrNp=NpFinal; IncrNpb=NpbFinal;
+
   Ndiv++;
   if(DivideFull)NdivFull++;
   TmcStop(timers,TMC_NlMakeSort);
@@ -35,10 +35,18 @@ protected:
   void MergeMapCellBoundFluid(const tuint3 &celbmin,const tuint3 &celbmax,const tuint3 &celfmin,const tuint3 &celfmax,tuint3 &celmin,tuint3 &celmax)const;
   void PrepareNct();
 
+  inline unsigned BoxFull(unsigned rcell,typecode rcode)const;
+  inline unsigned BoxFluidPart(unsigned rcell,typecode rcode)const;
+  unsigned GetSortThreads(unsigned np,unsigned nbox)const;
+
   void PreSortFull(unsigned np,const unsigned *dcellc,const typecode *codec,unsigned* cellpart,unsigned* partsincell)const;
   void PreSortFluid(unsigned np,unsigned pini,const unsigned *dcellc,const typecode *codec,unsigned* cellpart,unsigned* partsincell)const;
   void MakeSortFull(const unsigned* cellpart,unsigned* begincell,unsigned* partsincell,unsigned* sortpart)const;
   void MakeSortFluid(unsigned np,unsigned pini,const unsigned* cellpart,unsigned* begincell,unsigned* partsincell,unsigned* sortpart)const;
+  void MakeSortParallel(bool full,unsigned nth,unsigned np,unsigned pini,const unsigned *dcellc,const typecode *codec
+    ,unsigned* cellpart,unsigned* begincell,unsigned* partsincell,unsigned* sortpart);
+  bool MakeSortIncremental(unsigned np,unsigned pini,const unsigned *dcellc,const typecode *codec
+    ,unsigned* cellpart,unsigned* begincell,unsigned* partsincell,unsigned* sortpart);
   void PreSort(const unsigned* dcellc,const typecode *codec);
 
 public:
@@ -58,9 +58,12 @@ void JCfgRun::Reset(){
   DeltaSph=-1;
   Shifting=-1;
   SvRes=true; SvDomainVtk=false;
+  TraceFile="";
   Sv_Binx=false; Sv_Info=false; Sv_Vtk=false; Sv_Csv=false;
   CaseName=""; RunName=""; DirOut=""; DirDataOut=""; 
   PartBegin=0; PartBeginFirst=0; PartBeginDir="";
+  Restart=false; RestartFile="";
+  WallTime=0;
   TimeMax=-1; TimePart=-1;
   RhopOutModif=false; RhopOutMin=700; RhopOutMax=1300;
   FtPause=-1;
@@ -140,6 +143,8 @@ void JCfgRun::VisuInfo()const{
   printf("    -svres:<0/1>     Generates file that summarises the execution process\n");
   printf("    -svtimers:<0/1>  Obtains timing for each individual process\n");
   printf("    -svdomainvtk:<0/1>  Generates VTK file with domain limits\n");
+  printf("    -trace:<file>    Saves the timeline of the execution in Chrome trace format\n");
+  printf("     (JSON for chrome://tracing or ui.perfetto.dev), by default in dir_out\n");
   printf("    -name <string>      Specifies path and name of the case \n");
   printf("    -runname <string>   Specifies name for case execution\n");
   printf("    -dirout <dir>       Specifies the general output directory \n");
@@ -148,6 +153,13 @@ void JCfgRun::VisuInfo()const{
   printf("     Specifies the beginning of the simulation starting from a given PART\n");
   printf("     (begin) and located in the directory (dir), (first) indicates the\n");
   printf("     number of the first PART to be generated\n\n");
+  printf("    -restart[:file]  Resumes the simulation from a checkpoint file\n");
+  printf("     (Checkpoint.cbi4 in dir_out by default)\n");
+  printf("    -walltime:<time> Wall-clock budget of the run in seconds or [d-]hh:mm:ss.\n");
+  printf("     When it expires (or with SIGTERM/SIGUSR1) the run writes a checkpoint\n");
+  printf("     and stops with exit code 3, so it can be resumed with -restart\n");
+  printf("     (with NeighbourSkin the stop forces a divide and the resumed run is\n");
+  printf("     not bit-for-bit)\n\n");
   printf("    -incz:<float>    Allows increase in Z+ direction \n");
   printf("    -rhopout:min:max Excludes fluid particles out of these density limits\n\n");
   printf("    -ftpause:<float> Time to start floating bodies movement. By default 0\n");
@@ -176,6 +188,9 @@ void JCfgRun::VisuConfig()const{
   PrintVar("  PartBegin",PartBegin,ln);
   PrintVar("  PartBeginFirst",PartBeginFirst,ln);
   PrintVar("  PartBeginDir",PartBeginDir,ln);
+  PrintVar("  Restart",Restart,ln);
+  PrintVar("  RestartFile",RestartFile,ln);
+  PrintVar("  WallTime",WallTime,ln);
   PrintVar("  Cpu",Cpu,ln);
   printf("  %s  %s\n",VarStr("Gpu",Gpu).c_str(),VarStr("GpuId",GpuId).c_str());
   PrintVar("  GpuFree",GpuFree,ln);
@@ -196,6 +211,7 @@ void JCfgRun::VisuConfig()const{
   PrintVar("  SvRes",SvRes,ln);
   PrintVar("  SvTimers",SvTimers,ln);
   PrintVar("  SvDomainVtk",SvDomainVtk,ln);
+  PrintVar("  TraceFile",TraceFile,ln);
   PrintVar("  Sv_Binx",Sv_Binx,ln);
   PrintVar("  Sv_Info",Sv_Info,ln);
   PrintVar("  Sv_Vtk",Sv_Vtk,ln);
@@ -400,6 +416,10 @@ void JCfgRun::LoadOpts(string *optlis,int optn,int lv,string file){
       else if(txword=="SVRES")SvRes=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
       else if(txword=="SVTIMERS")SvTimers=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
       else if(txword=="SVDOMAINVTK")SvDomainVtk=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
+      else if(txword=="TRACE"){
+        TraceFile=txoptfull;
+        if(TraceFile.empty())ErrorParm(opt,c,lv,file);
+      }
       else if(txword=="SV"){
         string txop=StrUpper(txoptfull);
         while(!txop.empty()){
@@ -430,6 +450,11 @@ void JCfgRun::LoadOpts(string *optlis,int optn,int lv,string file){
         }
         PartBeginDir=optlis[c+1]; c++; 
       }
+      else if(txword=="RESTART"){ Restart=true; RestartFile=txoptfull; }
+      else if(txword=="WALLTIME"){
+        WallTime=GetWallTime(txoptfull);
+        if(WallTime<=0)ErrorParm(opt,c,lv,file);
+      }
       else if(txword=="RHOPOUT"){ 
         RhopOutMin=float(atof(txopt1.c_str())); 
         RhopOutMax=float(atof(txopt2.c_str())); 
@@ -528,6 +553,26 @@ void JCfgRun::LoadFloat6(std::string txopt,float def,tfloat3 &v1,tfloat3 &v2){
   v2=ToTFloat3(v2d);
 }
 
+//==============================================================================
+// Returns the seconds of a time given in seconds or as [d-]hh:mm:ss, the
+// format of the time limit in SLURM (squeue -o %L). Returns -1 when invalid.
+//==============================================================================
+double JCfgRun::GetWallTime(std::string txopt){
+  if(txopt.empty())return(-1);
+  double days=0;
+  int pos=int(txopt.find("-"));
+  if(pos>0){ days=atof(txopt.substr(0,pos).c_str()); txopt=txopt.substr(pos+1); }
+  double secs=0;
+  while(!txopt.empty()){
+    pos=int(txopt.find(":"));
+    const string tx=(pos>=0? txopt.substr(0,pos): txopt);
+    if(tx.empty()||tx.find_first_not_of("0123456789.")!=string::npos)return(-1);
+    secs=secs*60+atof(tx.c_str());
+    txopt=(pos>=0? txopt.substr(pos+1): "");
+  }
+  return(days*86400+secs);
+}
+
 //==============================================================================
 // Splits options in txoptfull, txopt, txopt2, txopt3 and txopt4.
 //==============================================================================
@@ -47,6 +47,7 @@ protected:
   static void LoadFloat3(std::string txopt,float def,tfloat3 &v1);
   static void LoadDouble6(std::string txopt,double def,tdouble3 &v1,tdouble3 &v2);
   static void LoadFloat6(std::string txopt,float def,tfloat3 &v1,tfloat3 &v2);
+  static double GetWallTime(std::string txopt);
 
   void SplitsOpts(const std::string &opt,std::string &txword,std::string &txoptfull,std::string &txopt1,std::string &txopt2,std::string &txopt3,std::string &txopt4)const;
   void SplitsOpts(const std::string &opt,std::string &txword,std::string &txoptfull,std::string &txopt1,std::string &txopt2,std::string &txopt3)const{
@@ -87,10 +88,14 @@ public:
   float DeltaSph;
   int Shifting;  ///<Shifting mode -1:no defined, 0:none, 1:nobound, 2:nofixed, 3:full
   bool SvRes,SvTimers,SvDomainVtk;
+  std::string TraceFile;          ///<Chrome trace file with the timeline of the execution (empty: no trace).
   bool Sv_Binx,Sv_Info,Sv_Csv,Sv_Vtk;
   std::string CaseName,RunName,DirOut,DirDataOut;
   std::string PartBeginDir;
   unsigned PartBegin,PartBeginFirst;
+  bool Restart;                   ///<Resumes the simulation from a checkpoint.
+  std::string RestartFile;        ///<Checkpoint file (empty: Checkpoint.cbi4 in DirOut).
+  double WallTime;                ///<Wall-clock budget in seconds, the run stops with a checkpoint when it expires (0: no limit).
   float FtPause;
   bool RhopOutModif;              ///<Indicates whether \ref RhopOutMin or RhopOutMax is changed.
   float RhopOutMin,RhopOutMax;    ///<Limits for \ref RhopOut density correction.
@@ -0,0 +1,245 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JNeighbourListCpu.cpp \brief Implements the class \ref JNeighbourListCpu.
+
+#include "JNeighbourListCpu.h"
+#include <cstring>
+#include <climits>
+
+using namespace std;
+
+//##############################################################################
+//# JNeighbourListCpu
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JNeighbourListCpu::JNeighbourListCpu(float overmemory){
+  ClassName="JNeighbourListCpu";
+  OverMemory=(overmemory<1.f? 1.f: overmemory);
+  NbBegin=NULL; Pairs=NULL;
+  CandBegin=NULL; Cand=NULL; CandPos=NULL;
+  HalfReach=NULL; HalfBlock=NULL;
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JNeighbourListCpu::~JNeighbourListCpu(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JNeighbourListCpu::Reset(){
+  FreeMemory();
+  Np=0;
+  CandNp=0;
+  CandValid=false;
+  HalfNblock=0;
+}
+
+//==============================================================================
+/// Frees allocated memory.
+//==============================================================================
+void JNeighbourListCpu::FreeMemory(){
+  delete[] NbBegin; NbBegin=NULL;
+  delete[] Pairs;   Pairs=NULL;
+  SizeNp=SizePairs=0;
+  delete[] CandBegin; CandBegin=NULL;
+  delete[] Cand;      Cand=NULL;
+  delete[] CandPos;   CandPos=NULL;
+  SizeCandNp=SizeCand=0;
+  delete[] HalfReach; HalfReach=NULL;
+  delete[] HalfBlock; HalfBlock=NULL;
+  SizeHalf=0;
+}
+
+//==============================================================================
+/// Returns the allocated memory.
+//==============================================================================
+llong JNeighbourListCpu::GetAllocMemory()const{
+  llong s=0;
+  if(NbBegin)s+=llong(sizeof(unsigned))*(llong(SizeNp)*2+1);
+  if(Pairs)s+=llong(sizeof(StNeighbourPair))*SizePairs;
+  if(CandBegin)s+=llong(sizeof(unsigned))*(llong(SizeCandNp)*2+1);
+  if(Cand)s+=llong(sizeof(unsigned))*SizeCand;
+  if(CandPos)s+=llong(sizeof(tdouble3))*SizeCandNp;
+  if(HalfReach)s+=llong(sizeof(unsigned))*SizeHalf;
+  if(HalfBlock)s+=llong(sizeof(unsigned))*(llong(SizeHalf)+1);
+  return(s);
+}
+
+//==============================================================================
+/// Converts n counts into begin positions and stores the total in vbegin[n].
+/// Returns the total number.
+//==============================================================================
+ullong JNeighbourListCpu::CountToBegin(unsigned n,unsigned *vbegin)const{
+  ullong total=0;
+  for(unsigned c=0;c<n;c++){
+    const unsigned v=vbegin[c];
+    vbegin[c]=unsigned(total);
+    total+=v;
+  }
+  if(total>=UINT_MAX)RunException("CountToBegin","Number of neighbour pairs exceeds the limit of unsigned.");
+  vbegin[n]=unsigned(total);
+  return(total);
+}
+
+//==============================================================================
+/// Prepares the list to receive the number of neighbours of np particles.
+/// The caller writes in GetCountPtr()[p1*2] and [p1*2+1] the number of pairs
+/// found in boundary and fluid cells respectively and then calls CompleteCount().
+//==============================================================================
+void JNeighbourListCpu::PrepareCount(unsigned np){
+  if(np>SizeNp || !NbBegin){
+    delete[] NbBegin; NbBegin=NULL;
+    SizeNp=0;
+    const unsigned size=unsigned(OverMemory*np);
+    try{
+      NbBegin=new unsigned[size*2+1];
+    }
+    catch(const std::bad_alloc){
+      RunException("PrepareCount","Could not allocate the requested memory.");
+    }
+    SizeNp=size;
+  }
+  Np=np;
+  NbBegin[np*2]=0;
+}
+
+//==============================================================================
+/// Converts the counts into begin positions and allocates memory for the pairs.
+/// Returns the total number of pairs.
+//==============================================================================
+unsigned JNeighbourListCpu::CompleteCount(){
+  const ullong total=CountToBegin(Np*2,NbBegin);
+  if(unsigned(total)>SizePairs){
+    delete[] Pairs; Pairs=NULL;
+    SizePairs=0;
+    ullong size=ullong(OverMemory*total);
+    if(size>=UINT_MAX)size=total;
+    try{
+      Pairs=new StNeighbourPair[size];
+    }
+    catch(const std::bad_alloc){
+      RunException("CompleteCount","Could not allocate the requested memory for neighbour pairs.");
+    }
+    SizePairs=unsigned(size);
+  }
+  return(unsigned(total));
+}
+
+//==============================================================================
+/// Prepares the list of candidates of np particles (same protocol as
+/// PrepareCount()) and invalidates the previous one.
+//==============================================================================
+void JNeighbourListCpu::PrepareCandCount(unsigned np){
+  CandValid=false;
+  if(np>SizeCandNp || !CandBegin){
+    delete[] CandBegin; CandBegin=NULL;
+    delete[] CandPos;   CandPos=NULL;
+    SizeCandNp=0;
+    const unsigned size=unsigned(OverMemory*np);
+    try{
+      CandBegin=new unsigned[size*2+1];
+      CandPos=new tdouble3[size+1];
+    }
+    catch(const std::bad_alloc){
+      RunException("PrepareCandCount","Could not allocate the requested memory.");
+    }
+    SizeCandNp=size;
+  }
+  CandNp=np;
+  CandBegin[np*2]=0;
+}
+
+//==============================================================================
+/// Converts the counts of candidates into begin positions and allocates memory.
+/// Returns the total number of candidates.
+//==============================================================================
+unsigned JNeighbourListCpu::CompleteCandCount(){
+  const ullong total=CountToBegin(CandNp*2,CandBegin);
+  if(unsigned(total)>SizeCand){
+    delete[] Cand; Cand=NULL;
+    SizeCand=0;
+    ullong size=ullong(OverMemory*total);
+    if(size>=UINT_MAX)size=total;
+    try{
+      Cand=new unsigned[size];
+    }
+    catch(const std::bad_alloc){
+      RunException("CompleteCandCount","Could not allocate the requested memory for neighbour candidates.");
+    }
+    SizeCand=unsigned(size);
+  }
+  return(unsigned(total));
+}
+
+//==============================================================================
+/// Returns the array where the caller writes the reach of particles [0,np)
+/// before calling CompleteHalfBlocks().
+//==============================================================================
+unsigned* JNeighbourListCpu::PrepareHalfReach(unsigned np){
+  HalfNblock=0;
+  if(np>SizeHalf || !HalfReach){
+    delete[] HalfReach; HalfReach=NULL;
+    delete[] HalfBlock; HalfBlock=NULL;
+    SizeHalf=0;
+    const unsigned size=unsigned(OverMemory*np)+1;
+    try{
+      HalfReach=new unsigned[size];
+      HalfBlock=new unsigned[size+1];
+    }
+    catch(const std::bad_alloc){
+      RunException("PrepareHalfReach","Could not allocate the requested memory.");
+    }
+    SizeHalf=size;
+  }
+  return(HalfReach);
+}
+
+//==============================================================================
+/// Splits particles [pini,pfin) in blocks of at least blocksize particles so
+/// that the pairs of block b only reach particles of blocks b and b+1.
+/// Returns the number of blocks.
+//==============================================================================
+unsigned JNeighbourListCpu::CompleteHalfBlocks(unsigned pini,unsigned pfin,unsigned blocksize){
+  if(!blocksize)blocksize=1;
+  unsigned nb=0;
+  if(pini<pfin){
+    HalfBlock[nb++]=pini;
+    unsigned bini=pini,bfin=min(pfin,pini+blocksize);
+    while(bini<pfin){
+      //-Next block ends after the reach of the current one.
+      unsigned reach=bfin;
+      for(unsigned p=bini;p<bfin;p++)if(HalfReach[p]>=reach)reach=HalfReach[p]+1;
+      HalfBlock[nb++]=bfin;
+      bini=bfin;
+      bfin=(bini<pfin? min(pfin,max(reach,bini+blocksize)): pfin);
+    }
+    nb--;
+  }
+  HalfNblock=nb;
+  return(nb);
+}
+
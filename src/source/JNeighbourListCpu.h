@@ -0,0 +1,121 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JNeighbourListCpu.h \brief Declares the class \ref JNeighbourListCpu.
+
+#ifndef _JNeighbourListCpu_
+#define _JNeighbourListCpu_
+
+#include "Types.h"
+#include "JObject.h"
+
+///Structure with the geometry of one interacting pair p1-p2 (2h range).
+typedef struct{
+  unsigned p2;         ///<Index of the neighbour particle.
+  float drx,dry,drz;   ///<Distance p1-p2.
+  float rr2;           ///<Squared distance p1-p2.
+  float frx,fry,frz;   ///<Kernel gradient.
+  float fr;            ///<Kernel value (Wendland only, zero otherwise).
+}StNeighbourPair;
+
+//##############################################################################
+//# JNeighbourListCpu
+//##############################################################################
+/// \brief Stores the in-range neighbours of each particle in CSR format.
+/// The neighbours of particle p1 are split in two ranges: those found in the
+/// boundary cells [NbBegin[p1*2],NbBegin[p1*2+1]) and those found in the
+/// fluid cells [NbBegin[p1*2+1],NbBegin[p1*2+2]). Inside each range the pairs
+/// follow the same order as the cell walk so the summations are unchanged.
+/// With a Verlet skin the list of candidates within 2h+skin (same layout) is
+/// kept between divides and the pairs are refreshed from it at each interaction.
+/// For the symmetric evaluation (each pair p1<p2 visited once) the particles
+/// are split in blocks whose pairs only reach the next block, so even and odd
+/// blocks can be processed in parallel without writing the same particle.
+
+class JNeighbourListCpu : protected JObject
+{
+protected:
+  unsigned SizeNp;          ///<Number of particles with reserved memory.
+  unsigned SizePairs;       ///<Number of pairs with reserved memory.
+  float OverMemory;         ///<Factor applied to the memory reserved for pairs (def=1.2).
+
+  unsigned Np;              ///<Number of particles in the current list.
+  unsigned *NbBegin;        ///<First pair of each range [SizeNp*2+1].
+  StNeighbourPair *Pairs;   ///<Geometry of the pairs [SizePairs].
+
+  //-Candidates within 2h+skin (Verlet skin mode).
+  unsigned SizeCandNp;      ///<Number of particles with reserved memory for candidates.
+  unsigned SizeCand;        ///<Number of candidates with reserved memory.
+  unsigned CandNp;          ///<Number of particles in the current list of candidates.
+  bool CandValid;           ///<Candidates can be used (no divide since they were built).
+  unsigned *CandBegin;      ///<First candidate of each range [SizeCandNp*2+1].
+  unsigned *Cand;           ///<Index of the candidates [SizeCand].
+  tdouble3 *CandPos;        ///<Position of particles when the candidates were built [SizeCandNp].
+
+  //-Blocks for the symmetric evaluation of pairs.
+  unsigned SizeHalf;        ///<Number of particles with reserved memory for blocks.
+  unsigned HalfNblock;      ///<Number of blocks in HalfBlock.
+  unsigned *HalfReach;      ///<Last neighbour p2>p1 of each particle, or p1 without them [SizeHalf].
+  unsigned *HalfBlock;      ///<First particle of each block [SizeHalf+1].
+
+  void FreeMemory();
+  ullong CountToBegin(unsigned n,unsigned *vbegin)const;
+
+public:
+  JNeighbourListCpu(float overmemory=1.2f);
+  ~JNeighbourListCpu();
+  void Reset();
+  llong GetAllocMemory()const;
+
+  void PrepareCount(unsigned np);
+  unsigned* GetCountPtr(){ return(NbBegin); }
+  unsigned CompleteCount();
+  StNeighbourPair* GetPairsPtr(){ return(Pairs); }
+
+  unsigned GetNp()const{ return(Np); }
+  unsigned GetNpairs()const{ return(Np? NbBegin[Np*2]: 0); }
+  const unsigned* GetBegin()const{ return(NbBegin); }
+  const StNeighbourPair* GetPairs()const{ return(Pairs); }
+
+  unsigned BoundIni(unsigned p1)const{ return(NbBegin[p1*2]); }
+  unsigned FluidIni(unsigned p1)const{ return(NbBegin[p1*2+1]); }
+  unsigned FluidFin(unsigned p1)const{ return(NbBegin[p1*2+2]); }
+
+  void PrepareCandCount(unsigned np);
+  unsigned* GetCandCountPtr(){ return(CandBegin); }
+  unsigned CompleteCandCount();
+  unsigned* GetCandPtr(){ return(Cand); }
+  tdouble3* GetCandPosPtr(){ return(CandPos); }
+
+  unsigned GetCandNp()const{ return(CandNp); }
+  unsigned GetNcand()const{ return(CandNp? CandBegin[CandNp*2]: 0); }
+  const unsigned* GetCandBegin()const{ return(CandBegin); }
+  const unsigned* GetCand()const{ return(Cand); }
+  const tdouble3* GetCandPos()const{ return(CandPos); }
+  bool GetCandValid()const{ return(CandValid); }
+  void SetCandValid(bool valid){ CandValid=valid; }
+
+  unsigned* PrepareHalfReach(unsigned np);
+  unsigned CompleteHalfBlocks(unsigned pini,unsigned pfin,unsigned blocksize);
+  unsigned GetHalfNblock()const{ return(HalfNblock); }
+  const unsigned* GetHalfBlock()const{ return(HalfBlock); }
+};
+
+#endif
+
+
@@ -313,6 +313,137 @@ void JPartDataBi4::AddPartDataVar(const std::string &name,JBinaryDataDef::TpData
   Part->CreateArray(name,type,npok,v,externalpointer);
 }
 
+//==============================================================================
+/// Aade datos de particulas de un puntero externo con stride bytes entre
+/// elementos. Los datos se leen al grabar el fichero.
+/// Add data of particles from an external pointer with stride bytes between
+/// elements. The data is read when the file is saved.
+//==============================================================================
+void JPartDataBi4::AddPartDataVarStrided(const std::string &name,JBinaryDataDef::TpData type,unsigned npok,const void *v,unsigned stride){
+  const char met[]="AddPartDataVarStrided";
+  if(!v)RunException(met,"The pointer data is invalid.");
+  //-Comprueba valor de npok. Checks value of npok.
+  if(Part->GetvUint("Npok")!=npok)RunException(met,"Part information is invalid.");
+  //-Crea array con particulas validas. Creates valid particles array.
+  Part->CreateArrayStrided(name,type,npok,v,stride);
+}
+
+//==============================================================================
+/// Devuelve v redondeado al menor numero de bits de mantisa que mantiene el
+/// error absoluto por debajo de abserror (debe ser normal y positivo).
+/// Returns v rounded to the fewest mantissa bits that keep the absolute error
+/// below abserror (it must be normal and positive).
+//==============================================================================
+float JPartDataBi4::TruncateFloat(float v,float abserror){
+  if(!(fabs(v)>abserror))return(fabs(v)<=abserror? 0: v); //-NaN se mantiene. NaN is kept.
+  unsigned bits,ebits;
+  memcpy(&bits,&v,sizeof(float));
+  memcpy(&ebits,&abserror,sizeof(float));
+  const int ev=int((bits>>23)&0xff);
+  if(ev==255)return(v);
+  //-Bits descartados d cumplen 2^(d-1)*ulp(v) <= 2^floor(log2(abserror)). Dropped bits d hold 2^(d-1)*ulp(v) <= 2^floor(log2(abserror)).
+  int d=int((ebits>>23)&0xff)-(ev? ev: 1)+24;
+  if(d<=0)return(v);
+  if(d>23)d=23;
+  bits=(bits+(1u<<(d-1)))&~((1u<<d)-1);
+  float r; memcpy(&r,&bits,sizeof(float));
+  return(((bits>>23)&0xff)==255? v: r);
+}
+
+//==============================================================================
+/// Cuantiza n valores de v (con stride bytes entre ellos) a 16 bits en el
+/// rango [vmin,vmax] de los valores finitos. Devuelve vmin y el paso.
+/// Quantises n values of v (with stride bytes between them) to 16 bits over
+/// the range [vmin,vmax] of the finite values. Returns vmin and the step.
+//==============================================================================
+static void QuantiseQ16(unsigned n,const byte *v,unsigned stride,unsigned qstride,word *q,float &offset,float &scale){
+  float vmin=FLT_MAX,vmax=-FLT_MAX;
+  for(unsigned p=0;p<n;p++){
+    const float x=*(const float*)(v+size_t(stride)*p);
+    if(x>=-FLT_MAX && x<=FLT_MAX){
+      if(vmin>x)vmin=x;
+      if(vmax<x)vmax=x;
+    }
+  }
+  if(vmin>vmax)vmin=vmax=0;
+  offset=vmin;
+  scale=float((double(vmax)-double(vmin))/65535.);
+  const double fac=(scale? 1./scale: 0);
+  for(unsigned p=0;p<n;p++){
+    const double x=(double(*(const float*)(v+size_t(stride)*p))-vmin)*fac+0.5;
+    q[size_t(qstride)*p]=word(x>=65535.? 65535: (x>=0? unsigned(x): 0));
+  }
+}
+
+//==============================================================================
+/// Aade array float de diagnostico con la precision indicada. En PREC_Q16 se
+/// graba como DatUshort con los valores name_QOffset y name_QScale (error
+/// maximo QScale/2). En PREC_AbsError se graba como DatFloat redondeado con
+/// error maximo name_QError.
+/// Adds a diagnostic float array with the given precision. With PREC_Q16 it is
+/// stored as DatUshort with the values name_QOffset and name_QScale (maximum
+/// error QScale/2). With PREC_AbsError it is stored as rounded DatFloat with
+/// maximum error name_QError.
+//==============================================================================
+void JPartDataBi4::AddPartDataPrec(const std::string &name,unsigned npok,const float *v,unsigned stride,TpPrecision prec,float abserror){
+  const char met[]="AddPartDataPrec";
+  if(!v)RunException(met,"The pointer data is invalid.");
+  if(!stride)stride=sizeof(float);
+  if(prec==PREC_Exact || !npok){
+    if(stride==sizeof(float))AddPartDataVar(name,JBinaryDataDef::DatFloat,npok,v);
+    else AddPartDataVarStrided(name,JBinaryDataDef::DatFloat,npok,v,stride);
+  }
+  else if(prec==PREC_Q16){
+    std::vector<word> q(npok);
+    float offset,scale;
+    QuantiseQ16(npok,(const byte*)v,stride,1,&q[0],offset,scale);
+    AddPartDataVar(name,JBinaryDataDef::DatUshort,npok,&q[0],false);
+    Part->SetvFloat(name+"_QOffset",offset);
+    Part->SetvFloat(name+"_QScale",scale);
+  }
+  else if(prec==PREC_AbsError){
+    if(!(abserror>=FLT_MIN))RunException(met,"The maximum absolute error is invalid.");
+    std::vector<float> t(npok);
+    for(unsigned p=0;p<npok;p++)t[p]=TruncateFloat(*(const float*)((const byte*)v+size_t(stride)*p),abserror);
+    AddPartDataVar(name,JBinaryDataDef::DatFloat,npok,&t[0],false);
+    Part->SetvFloat(name+"_QError",abserror);
+  }
+  else RunException(met,"Precision mode is invalid.");
+}
+
+//==============================================================================
+/// Aade array tfloat3 de diagnostico con la precision indicada. En PREC_Q16
+/// cada componente se cuantiza por separado y se graba como DatUshort con
+/// 3*npok valores intercalados.
+/// Adds a diagnostic tfloat3 array with the given precision. With PREC_Q16
+/// each component is quantised separately and stored as DatUshort with 3*npok
+/// interleaved values.
+//==============================================================================
+void JPartDataBi4::AddPartDataPrec(const std::string &name,unsigned npok,const tfloat3 *v,TpPrecision prec,float abserror){
+  const char met[]="AddPartDataPrec";
+  if(!v)RunException(met,"The pointer data is invalid.");
+  if(prec==PREC_Exact || !npok)AddPartDataVar(name,JBinaryDataDef::DatFloat3,npok,v);
+  else if(prec==PREC_Q16){
+    std::vector<word> q(size_t(npok)*3);
+    tfloat3 offset,scale;
+    const unsigned sv=sizeof(tfloat3);
+    QuantiseQ16(npok,(const byte*)&v->x,sv,3,&q[0],offset.x,scale.x);
+    QuantiseQ16(npok,(const byte*)&v->y,sv,3,&q[1],offset.y,scale.y);
+    QuantiseQ16(npok,(const byte*)&v->z,sv,3,&q[2],offset.z,scale.z);
+    Part->CreateArray(name,JBinaryDataDef::DatUshort,npok*3,&q[0],false);
+    Part->SetvFloat3(name+"_QOffset",offset);
+    Part->SetvFloat3(name+"_QScale",scale);
+  }
+  else if(prec==PREC_AbsError){
+    if(!(abserror>=FLT_MIN))RunException(met,"The maximum absolute error is invalid.");
+    std::vector<tfloat3> t(npok);
+    for(unsigned p=0;p<npok;p++)t[p]=TFloat3(TruncateFloat(v[p].x,abserror),TruncateFloat(v[p].y,abserror),TruncateFloat(v[p].z,abserror));
+    AddPartDataVar(name,JBinaryDataDef::DatFloat3,npok,&t[0],false);
+    Part->SetvFloat(name+"_QError",abserror);
+  }
+  else RunException(met,"Precision mode is invalid.");
+}
+
 //==============================================================================
 /// Aade datos de particulas de de nuevo part.
 /// Adds data of particles to new part.
@@ -424,7 +555,7 @@ unsigned JPartDataBi4::GetPiecesFile(std::string file)const{
   unsigned npieces=0;
   if(fun::FileExists(file)){
     JBinaryData dat(ClassName);
-    dat.OpenFileStructure(file,ClassName);
+    dat.OpenFileMapped(file,ClassName);
     npieces=dat.GetvUint("Npiece");
   }
   return(npieces);
@@ -460,7 +591,7 @@ void JPartDataBi4::LoadFileData(std::string file,unsigned cpart,unsigned piece,u
   const char met[]="LoadFileData";
   ResetData();
   Cpart=cpart; Piece=piece; Npiece=npiece;
-  Data->OpenFileStructure(file,ClassName);
+  Data->OpenFileMapped(file,ClassName);
   if (Piece != Data->GetvUint("Piece") || Npiece != Data->GetvUint("Npiece")) {
 	  RunException(met, "PART configuration is invalid.");
   }
@@ -557,6 +688,64 @@ JBinaryDataArray* JPartDataBi4::GetArray(std::string name,JBinaryDataDef::TpData
   return(ar);
 }
 
+//==============================================================================
+/// Carga array float descuantizando los datos grabados con PREC_Q16.
+/// Loads a float array, dequantising the data saved with PREC_Q16.
+//==============================================================================
+unsigned JPartDataBi4::Get_Float(const std::string &name,unsigned size,float *data)const{
+  const char met[]="Get_Float";
+  JBinaryDataArray* ar=GetArray(name);
+  if(ar->GetType()==JBinaryDataDef::DatFloat)return(ar->GetDataCopy(size,data));
+  if(ar->GetType()!=JBinaryDataDef::DatUshort || !GetPart()->ExistsValue(name+"_QScale"))RunException(met,fun::PrintStr("Type of array \'%s\' is not float.",name.c_str()));
+  const unsigned n=Get_ArrayCount(name);
+  if(n>size)RunException(met,"Insufficient memory for data.");
+  std::vector<word> q(n);
+  if(n)ar->GetDataCopy(n,&q[0]);
+  const float offset=GetPart()->GetvFloat(name+"_QOffset");
+  const float scale=GetPart()->GetvFloat(name+"_QScale");
+  for(unsigned p=0;p<n;p++)data[p]=offset+scale*q[p];
+  return(n);
+}
+
+//==============================================================================
+/// Carga array tfloat3 descuantizando los datos grabados con PREC_Q16.
+/// Loads a tfloat3 array, dequantising the data saved with PREC_Q16.
+//==============================================================================
+unsigned JPartDataBi4::Get_Float3(const std::string &name,unsigned size,tfloat3 *data)const{
+  const char met[]="Get_Float3";
+  JBinaryDataArray* ar=GetArray(name);
+  if(ar->GetType()==JBinaryDataDef::DatFloat3)return(ar->GetDataCopy(size,data));
+  if(ar->GetType()!=JBinaryDataDef::DatUshort || !GetPart()->ExistsValue(name+"_QScale"))RunException(met,fun::PrintStr("Type of array \'%s\' is not tfloat3.",name.c_str()));
+  const unsigned n=Get_ArrayCount(name)/3;
+  if(n>size)RunException(met,"Insufficient memory for data.");
+  std::vector<word> q(size_t(n)*3);
+  if(n)ar->GetDataCopy(n*3,&q[0]);
+  const tfloat3 offset=GetPart()->GetvFloat3(name+"_QOffset");
+  const tfloat3 scale=GetPart()->GetvFloat3(name+"_QScale");
+  for(unsigned p=0;p<n;p++)data[p]=TFloat3(offset.x+scale.x*q[p*3],offset.y+scale.y*q[p*3+1],offset.z+scale.z*q[p*3+2]);
+  return(n);
+}
+
+//==============================================================================
+/// Carga la forma cuadratica Qf. Los ficheros PART la graban por componentes
+/// (Qfxx,Qfyy,Qfzz,Qfyz,Qfxz,Qfxy), que pueden estar cuantizadas.
+/// Loads the quadratic form Qf. PART files store it by components
+/// (Qfxx,Qfyy,Qfzz,Qfyz,Qfxz,Qfxy), which may be quantised.
+//==============================================================================
+unsigned JPartDataBi4::Get_Qf(unsigned size,tsymatrix3f *data)const{
+  if(ArrayExists("Qf"))return(GetArray("Qf",JBinaryDataDef::DatSymMat)->GetDataCopy(size,data));
+  const unsigned n=Get_ArrayCount("Qfxx");
+  if(n>size)RunException("Get_Qf","Insufficient memory for data.");
+  std::vector<float> c(n? n: 1);
+  Get_Float("Qfxx",n,&c[0]); for(unsigned p=0;p<n;p++)data[p].xx=c[p];
+  Get_Float("Qfyy",n,&c[0]); for(unsigned p=0;p<n;p++)data[p].yy=c[p];
+  Get_Float("Qfzz",n,&c[0]); for(unsigned p=0;p<n;p++)data[p].zz=c[p];
+  Get_Float("Qfyz",n,&c[0]); for(unsigned p=0;p<n;p++)data[p].yz=c[p];
+  Get_Float("Qfxz",n,&c[0]); for(unsigned p=0;p<n;p++)data[p].xz=c[p];
+  Get_Float("Qfxy",n,&c[0]); for(unsigned p=0;p<n;p++)data[p].xy=c[p];
+  return(n);
+}
+
 //==============================================================================
 /// Devuelve el valor de Y de datos 2D.
 /// Returns Y value in 2-D data.
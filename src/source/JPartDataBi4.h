@@ -71,6 +71,8 @@ class JPartDataBi4 : protected JObject
  public:
   typedef enum{ DIV_None=0,DIV_X=1,DIV_Y=2,DIV_Z=3,DIV_Unknown=99 }TpAxisDiv; 
   typedef enum{ PERI_None=0,PERI_X=1,PERI_Y=2,PERI_Z=4,PERI_XY=3,PERI_XZ=5,PERI_YZ=6,PERI_Unknown=96 }TpPeri; 
+  ///Precision de arrays float de diagnostico. Precision of diagnostic float arrays.
+  typedef enum{ PREC_Exact=0,PREC_Q16=1,PREC_AbsError=2 }TpPrecision; 
 
  private:
   JBinaryData *Data;      ///<Almacena la informacion general de los datos (constante para cada PART). Stores general information of data (constant for each PART).
@@ -88,6 +90,7 @@ class JPartDataBi4 : protected JObject
   static std::string GetNamePart(unsigned cpart);
   void AddPartData(unsigned npok,const unsigned *idp,const ullong *idpd,const tfloat3 *pos,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,bool externalpointer=true);
   void AddPartDataVar(const std::string &name,JBinaryDataDef::TpData type,unsigned npok,const void *v,bool externalpointer=true);
+  void AddPartDataVarStrided(const std::string &name,JBinaryDataDef::TpData type,unsigned npok,const void *v,unsigned stride);
 
   void SaveFileData(std::string fname);
   unsigned GetPiecesFile(std::string file)const;
@@ -121,6 +124,7 @@ class JPartDataBi4 : protected JObject
   void ConfigSimPeri(TpPeri periactive,tdouble3 perixinc,tdouble3 periyinc,tdouble3 perizinc);
   void ConfigSimDiv(TpAxisDiv axisdiv);
   void ConfigSplitting(bool splitting);
+  void ConfigCompress(bool comp){ Data->SetCompressArrays(comp); }  ///<Lossless compression of the arrays in the PART files (see JBinaryDataCodec).
 
   //-Configuracion de parts. Configuration of parts.
   JBinaryData* AddPartInfo(unsigned cpart,double timestep,unsigned npok,unsigned nout,unsigned step,double runtime,tdouble3 domainmin,tdouble3 domainmax,ullong nptotal=0,ullong idmax=0);
@@ -149,6 +153,13 @@ class JPartDataBi4 : protected JObject
 
   // Matthias
   void AddPartData(const std::string &name, unsigned npok, const tsymatrix3f *v, bool externalpointer = true) { AddPartDataVar(name, JBinaryDataDef::DatSymMat, npok, (const void *)v, externalpointer); }
+  //-Arrays externos con stride bytes entre elementos (p.ej. componentes de tsymatrix3f). External arrays with stride bytes between elements (e.g. components of tsymatrix3f).
+  void AddPartDataStrided(const std::string &name,unsigned npok,const float    *v,unsigned stride){  AddPartDataVarStrided(name,JBinaryDataDef::DatFloat  ,npok,(const void *)v,stride);  }
+  void AddPartDataStrided(const std::string &name,unsigned npok,const tfloat3  *v,unsigned stride){  AddPartDataVarStrided(name,JBinaryDataDef::DatFloat3 ,npok,(const void *)v,stride);  }
+  //-Arrays de diagnostico con perdida acotada (cuantizados a 16 bits o con error absoluto maximo). Diagnostic arrays with bounded loss (quantised to 16 bits or with maximum absolute error).
+  void AddPartDataPrec(const std::string &name,unsigned npok,const float   *v,unsigned stride,TpPrecision prec,float abserror);
+  void AddPartDataPrec(const std::string &name,unsigned npok,const tfloat3 *v,TpPrecision prec,float abserror);
+  static float TruncateFloat(float v,float abserror);
 
   //-Grabacion de fichero. File recording.
   void SaveFileCase(std::string casename);
@@ -231,7 +242,7 @@ class JPartDataBi4 : protected JObject
   bool ArrayExists(std::string name)const;
   JBinaryDataArray* GetArray(std::string name)const;
   JBinaryDataArray* GetArray(std::string name,JBinaryDataDef::TpData type)const;
-  unsigned Get_ArrayCount(std::string name)const{ return(GetArray(name)->GetCount()); }
+  unsigned Get_ArrayCount(std::string name)const{ const JBinaryDataArray* ar=GetArray(name); return(ar->DataInFile()? ar->GetFileDataCount(): ar->GetCount()); }
   bool Get_IdpSimple()const{ return(ArrayExists("Idp")); }
   bool Get_PosSimple()const{ return(ArrayExists("Pos")); }
   unsigned Get_Idp  (unsigned size,unsigned *data)const{ return(GetArray("Idp" ,JBinaryDataDef::DatUint   )->GetDataCopy(size,data)); }
@@ -241,8 +252,11 @@ class JPartDataBi4 : protected JObject
   unsigned Get_Vel  (unsigned size,tfloat3  *data)const{ return(GetArray("Vel" ,JBinaryDataDef::DatFloat3 )->GetDataCopy(size,data)); }
   unsigned Get_Rhop (unsigned size,float    *data)const{ return(GetArray("Rhop",JBinaryDataDef::DatFloat  )->GetDataCopy(size,data)); }
   unsigned Get_Mass (unsigned size,float    *data)const{ return(GetArray("Mass",JBinaryDataDef::DatFloat  )->GetDataCopy(size,data)); }
-  unsigned Get_Qf (unsigned size,tsymatrix3f*data)const{ return(GetArray("Qf"  ,JBinaryDataDef::DatSymMat )->GetDataCopy(size,data)); }
+  unsigned Get_Qf   (unsigned size,tsymatrix3f *data)const;
   unsigned Get_Hvar (unsigned size,float    *data)const{ return(GetArray("Hvar",JBinaryDataDef::DatFloat  )->GetDataCopy(size,data)); }
+  //-Arrays float que pueden estar cuantizados (ver AddPartDataPrec). Float arrays that may be quantised (see AddPartDataPrec).
+  unsigned Get_Float (const std::string &name,unsigned size,float   *data)const;
+  unsigned Get_Float3(const std::string &name,unsigned size,tfloat3 *data)const;
 
   double Get_Particles2dPosY()const;
 
@@ -195,7 +195,7 @@ void JPartsLoad4::LoadParticles(const std::string &casedir,const std::string &ca
     JPartDataBi4 pd2;
     if(!PartBegin)pd2.LoadFileCase(dir,casename,piece,Npiece);
     else pd2.LoadFilePart(dir,PartBegin,piece,Npiece);
-    sizetot+=pd.Get_Npok();
+    sizetot+=pd2.Get_Npok();
   }
   //-Allocates memory.
   AllocMemory(sizetot);
@@ -315,7 +315,7 @@ void JPartsLoad4::LoadParticles_T(const std::string &casedir, const std::string
 		JPartDataBi4 pd2;
 		if (!PartBegin)pd2.LoadFileCase(dir, casename, piece, Npiece);
 		else pd2.LoadFilePart(dir, PartBegin, piece, Npiece);
-		sizetot += pd.Get_Npok();
+		sizetot += pd2.Get_Npok();
 	}
 
 	//-Allocates memory.
@@ -359,8 +359,8 @@ void JPartsLoad4::LoadParticles_T(const std::string &casedir, const std::string
 				pd.Get_Qf(npok, auxf6);
 				for (unsigned p = 0; p < npok; p++) {
 					VelRhop[ntot + p] = TFloat4(auxf3[p].x, auxf3[p].y, auxf3[p].z, auxf[p]);
-					Mass[p] = auxfbis[p];
-					Qf[p] = auxf6[p];
+					Mass[ntot + p] = auxfbis[p];
+					Qf[ntot + p] = auxf6[p];
 				}
 			}
 			ntot += npok;
@@ -368,6 +368,7 @@ void JPartsLoad4::LoadParticles_T(const std::string &casedir, const std::string
 		delete[] auxf3; auxf3 = NULL;
 		delete[] auxf;  auxf = NULL;
 		delete[] auxfbis;  auxfbis = NULL;
+		delete[] auxf6;  auxf6 = NULL;
 	}
 
 	//-In simulations 2D, if PosY is invalid then calculates starting from position of particles.
@@ -450,7 +451,7 @@ void JPartsLoad4::LoadParticles_Mixed_M(const std::string& casedir, const std::s
 		JPartDataBi4 pd2;
 		if (!PartBegin)pd2.LoadFileCase(dir, casename, piece, Npiece);
 		else pd2.LoadFilePart(dir, PartBegin, piece, Npiece);
-		sizetot += pd.Get_Npok();
+		sizetot += pd2.Get_Npok();
 	}
 
 	//-Allocates memory.
@@ -599,7 +600,7 @@ void JPartsLoad4::LoadParticles_Mixed2_M(const std::string& casedir, const std::
 		JPartDataBi4 pd2;
 		if (!PartBegin)pd2.LoadFileCase(dir, casename, piece, Npiece);
 		else pd2.LoadFilePart(dir, PartBegin, piece, Npiece);
-		sizetot += pd.Get_Npok();
+		sizetot += pd2.Get_Npok();
 	}
 
 	//-Allocates memory.
@@ -762,7 +763,7 @@ void JPartsLoad4::LoadParticles_Mixed3_M(const std::string& casedir, const std::
 		JPartDataBi4 pd2;
 		if (!PartBegin)pd2.LoadFileCase(dir, casename, piece, Npiece);
 		else pd2.LoadFilePart(dir, PartBegin, piece, Npiece);
-		sizetot += pd.Get_Npok();
+		sizetot += pd2.Get_Npok();
 	}
 
 	//-Allocates memory.
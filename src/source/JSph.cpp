@@ -70,6 +70,7 @@ JSph::JSph(bool cpu,bool withmpi):Cpu(cpu),WithMpi(withmpi){
   FtObjs=NULL;
   DemData=NULL;
   AccInput=NULL;
+  ConsTab=NULL;
   InitVars();
 }
 
@@ -92,6 +93,7 @@ JSph::~JSph(){
   AllocMemoryFloating(0);
   delete[] DemData; DemData=NULL;
   delete AccInput;
+  delete[] ConsTab; ConsTab=NULL;
 }
 
 //==============================================================================
@@ -122,6 +124,13 @@ void JSph::InitVars(){
   TDeltaSph=DELTA_None; DeltaSph=0;
   TShifting=SHIFT_None; ShiftCoef=ShiftTFS=0;
   Visco=0; ViscoBoundFactor=1;
+  NlSkin=0; NlSymmetric=false; SimdLevel=3;
+  SvAsync=true;
+  SvCompress=false;
+  memset(SvPrecMode,0,sizeof(byte)*SVPREC_COUNT);
+  memset(SvPrecError,0,sizeof(float)*SVPREC_COUNT);
+  CheckpointInterval=0;
+  IncrDivide=0.05f;
   UseDEM=false;  //(DEM)
   DemDtForce=0;  //(DEM)
   delete[] DemData; DemData=NULL;  //(DEM)
@@ -136,14 +145,18 @@ void JSph::InitVars(){
   SvRes=false;
   SvTimers=false;
   SvDomainVtk=false;
+  TraceFile="";
 
   H=CteB=Gamma=RhopZero=CFLnumber=0;
+  GammaExp_M=0;
   // Matthias
   typeCase = typeCompression = typeGrowth = typeDivision = typeAni
 	  = typeDamping = typeCorrection = 0;
   aM0 = posGr = po2Gr = ctGr = c2Gr = aDv = pDv = posAn = cstAn 
 	  = 0.0f;
   spGr = s2Gr = klGr = bDv = spAn = 1.0f;
+  delete[] ConsTab; ConsTab=NULL;
+  ConsTabSize=0; ConsTabMin=ConsTabStep=ConsTabOvStep=ConsTabLast=0;
   Dp=0;
   Cs0=0;
   Delta2H=0;
@@ -173,6 +186,8 @@ void JSph::InitVars(){
   PartBegin=PartBeginFirst=0;
   PartBeginTimeStep=0;
   PartBeginTotalNp=0;
+  RestartFile="";
+  WallTime=0;
 
   MotionTimeMod=0;
   MotionObjCount=0;
@@ -354,6 +369,8 @@ void JSph::LoadConfig(const JCfgRun *cfg){
   //Log->Printf("DirAddXml_M=\"%s\"", fun::GetPathLevels(fun::GetCanonicalPath(RunPath, DirAddXml_M), 3).c_str());
   //Log->Printf("AddFileXml_M=\"%s\"", fun::GetPathLevels(fun::GetCanonicalPath(RunPath, AddFileXml_M), 3).c_str());
   PartBeginDir=cfg->PartBeginDir; PartBegin=cfg->PartBegin; PartBeginFirst=cfg->PartBeginFirst;
+  if(cfg->Restart)RestartFile=(!cfg->RestartFile.empty()? cfg->RestartFile: DirOut+"Checkpoint.cbi4");
+  WallTime=cfg->WallTime;
 
   //-Output options:
   CsvSepComa=cfg->CsvSepComa;
@@ -366,6 +383,8 @@ void JSph::LoadConfig(const JCfgRun *cfg){
   SvRes=cfg->SvRes;
   SvTimers=cfg->SvTimers;
   SvDomainVtk=cfg->SvDomainVtk;
+  TraceFile=cfg->TraceFile;
+  if(!TraceFile.empty() && TraceFile.find_first_of("/\\")==string::npos)TraceFile=DirOut+TraceFile;
 
   printf("\n");
   RunTimeDate=fun::GetDateTime();
@@ -383,6 +402,9 @@ void JSph::LoadConfig(const JCfgRun *cfg){
     Log->Print(fun::VarStr("PartBeginDir",PartBeginDir));
     Log->Print(fun::VarStr("PartBeginFirst",PartBeginFirst));
   }
+  if(!RestartFile.empty())Log->Print(fun::VarStr("RestartFile",RestartFile));
+  if(WallTime)Log->Print(fun::VarStr("WallTime",WallTime));
+  if(!TraceFile.empty())Log->Print(fun::VarStr("TraceFile",TraceFile));
 
   LoadCaseConfig();
 
@@ -459,6 +481,8 @@ void JSph::LoadConfig_Uni_M(const JCfgRun* cfg) {
 	RunName = (cfg->RunName.length() ? cfg->RunName : CaseName);
 	FileXml = DirCase + CaseName + ".xml";
 	PartBeginDir = cfg->PartBeginDir; PartBegin = cfg->PartBegin; PartBeginFirst = cfg->PartBeginFirst;
+	if (cfg->Restart)RestartFile = (!cfg->RestartFile.empty() ? cfg->RestartFile : DirOut + "Checkpoint.cbi4");
+	WallTime = cfg->WallTime;
 
 	//-Output options:
 	CsvSepComa = cfg->CsvSepComa;
@@ -471,6 +495,8 @@ void JSph::LoadConfig_Uni_M(const JCfgRun* cfg) {
 	SvRes = cfg->SvRes;
 	SvTimers = cfg->SvTimers;
 	SvDomainVtk = cfg->SvDomainVtk;
+	TraceFile = cfg->TraceFile;
+	if (!TraceFile.empty() && TraceFile.find_first_of("/\\") == string::npos)TraceFile = DirOut + TraceFile;
 
 	printf("\n");
 	RunTimeDate = fun::GetDateTime();
@@ -487,6 +513,9 @@ void JSph::LoadConfig_Uni_M(const JCfgRun* cfg) {
 		Log->Print(fun::VarStr("PartBeginDir", PartBeginDir));
 		Log->Print(fun::VarStr("PartBeginFirst", PartBeginFirst));
 	}
+	if (!RestartFile.empty())Log->Print(fun::VarStr("RestartFile", RestartFile));
+	if (WallTime)Log->Print(fun::VarStr("WallTime", WallTime));
+	if (!TraceFile.empty())Log->Print(fun::VarStr("TraceFile", TraceFile));
 
 	// Load and update case
 	// #XMLUpdate
@@ -553,6 +582,52 @@ void JSph::LoadConfig_Uni_M(const JCfgRun* cfg) {
 	if (!RhopOut) { RhopOutMin = -FLT_MAX; RhopOutMax = FLT_MAX; }
 }
 
+///Names of the diagnostic fields with configurable precision (see TpSvPrecField_M).
+static const char* SvPrecName[JSph::SVPREC_COUNT]={"Press","VonMises3D","GradVel","StrainDot","Acec","AceVisc","Qf"};
+
+//==============================================================================
+/// Loads the precision of the diagnostic fields in the PART files from a list
+/// of field:mode separated by commas, where mode is exact, q16 (quantised to
+/// 16 bits) or the maximum absolute error (e.g. "VonMises3D:q16,Acec:1e-4").
+/// Fields needed to restart the simulation (Idp, Pos, Vel, Rhop, Mass) are
+/// always stored exactly.
+//==============================================================================
+void JSph::LoadSavePrecision_M(std::string cfg){
+  const char* met="LoadSavePrecision_M";
+  memset(SvPrecMode,0,sizeof(byte)*SVPREC_COUNT);
+  memset(SvPrecError,0,sizeof(float)*SVPREC_COUNT);
+  while(!cfg.empty()){
+    string item=fun::StrTrim(fun::StrSplit(",",cfg));
+    if(item.empty())continue;
+    const string name=fun::StrTrim(fun::StrSplit(":",item));
+    const string mode=fun::StrLower(fun::StrTrim(item));
+    unsigned cf=0;
+    for(;cf<SVPREC_COUNT && name!=SvPrecName[cf];cf++);
+    if(cf>=SVPREC_COUNT)RunException(met,fun::PrintStr("SavePrecision: Field \'%s\' is not a diagnostic field with configurable precision.",name.c_str()));
+    if(mode=="exact")SvPrecMode[cf]=JPartDataBi4::PREC_Exact;
+    else if(mode=="q16")SvPrecMode[cf]=JPartDataBi4::PREC_Q16;
+    else{
+      char *end=NULL;
+      const float err=float(strtod(mode.c_str(),&end));
+      if(!(err>=FLT_MIN) || *end)RunException(met,fun::PrintStr("SavePrecision: Mode \'%s\' of field \'%s\' is invalid.",mode.c_str(),name.c_str()));
+      SvPrecMode[cf]=JPartDataBi4::PREC_AbsError;
+      SvPrecError[cf]=err;
+    }
+  }
+}
+
+//==============================================================================
+/// Returns the precision of the diagnostic fields that are not stored exactly.
+//==============================================================================
+std::string JSph::GetSavePrecisionStr_M()const{
+  string tx;
+  for(unsigned cf=0;cf<SVPREC_COUNT;cf++)if(SvPrecMode[cf]!=JPartDataBi4::PREC_Exact){
+    if(!tx.empty())tx=tx+",";
+    tx=tx+SvPrecName[cf]+":"+(SvPrecMode[cf]==JPartDataBi4::PREC_Q16? string("q16"): fun::FloatStr(SvPrecError[cf],"%g"));
+  }
+  return(tx.empty()? string("exact"): tx);
+}
+
 //==============================================================================
 /// Loads the case configuration to be executed.
 //==============================================================================
@@ -603,6 +678,18 @@ void JSph::LoadCaseConfig(){
     ViscoTime=new JSphVisco();
     ViscoTime->LoadFile(DirCase+filevisco);
   }
+  NlSkin=eparms.GetValueFloat("NeighbourSkin",true,0);
+  if(NlSkin<0)RunException(met,"NeighbourSkin cannot be negative.");
+  NlSymmetric=(eparms.GetValueInt("SymmetricForces",true,0)!=0);
+  SimdLevel=eparms.GetValueInt("SimdForces",true,3);
+  if(SimdLevel<0 || SimdLevel>3)RunException(met,"SimdForces value is invalid.");
+  IncrDivide=eparms.GetValueFloat("IncrementalDivide",true,0.05f);
+  if(IncrDivide<0 || IncrDivide>1)RunException(met,"IncrementalDivide must be in the range [0,1].");
+  SvAsync=(eparms.GetValueInt("SaveAsync",true,1)!=0);
+  SvCompress=(eparms.GetValueInt("SaveCompress",true,0)!=0);
+  LoadSavePrecision_M(eparms.GetValueStr("SavePrecision",true));
+  CheckpointInterval=eparms.GetValueDouble("CheckpointInterval",true,0);
+  if(CheckpointInterval<0)RunException(met,"CheckpointInterval cannot be negative.");
   DeltaSph=eparms.GetValueFloat("DeltaSPH",true,0);
   TDeltaSph=(DeltaSph? DELTA_Dynamic: DELTA_None);
 
@@ -648,6 +735,10 @@ void JSph::LoadCaseConfig(){
   if(eparms.Exists("XZPeriodic")){ PeriXZ=PeriX=PeriZ=true; PeriXY=PeriYZ=false; PeriXinc=PeriZinc=TDouble3(0); }
   if(eparms.Exists("YZPeriodic")){ PeriYZ=PeriY=PeriZ=true; PeriXY=PeriXZ=false; PeriYinc=PeriZinc=TDouble3(0); }
   PeriActive=(PeriX? 1: 0)+(PeriY? 2: 0)+(PeriZ? 4: 0);
+  if(NlSkin && PeriActive){
+    Log->PrintWarning("NeighbourSkin is not compatible with periodic boundaries and it is disabled.");
+    NlSkin=0;
+  }
 
   //-Configuration of domain size.
   float incz=eparms.GetValueFloat("IncZ",true,0.f);
@@ -683,6 +774,7 @@ void JSph::LoadCaseConfig(){
   H=(float)ctes.GetH();
   //CteB=(float)ctes.GetB();
   Gamma=(float)ctes.GetGamma();
+  GammaExp_M=EosGammaExp_M(Gamma);
   RhopZero=(float)ctes.GetRhop0();
   CFLnumber=(float)ctes.GetCFLnumber();
   Dp=ctes.GetDp();
@@ -827,6 +919,12 @@ void JSph::LoadCaseConfig(){
     }
   }
   else UseDEM=false;
+  //-Only the DFPM correction on the neighbour list keeps the candidates, the
+  //-other corrections and DEM walk the cells of the last divide.
+  if(NlSkin && (typeCorrection!=2 || UseDEM)){
+    Log->PrintWarning("NeighbourSkin is only compatible with typeCorrection=2 without DEM and it is disabled.");
+    NlSkin=0;
+  }
 
   //-Loads DEM data for the objects. (DEM)
   if(UseDEM){
@@ -1115,6 +1213,7 @@ void JSph::ConfigConstants(bool simulate2d){
     SpsSmag=float(pow((0.12*dp_sps),2));
     SpsBlin=float((2./3.)*0.0066*dp_sps*dp_sps);
   }
+  ConfigConstitutive();
   VisuConfig();
 }
 
@@ -1123,44 +1222,116 @@ void JSph::ConfigConstants(bool simulate2d){
 // #CalcK  #KS
 //=======================
 float JSph::CalcK(double x) {
-	float K;
+	return(GetConstitutiveK(float(x)));
+}
+
+//==============================================================================
+/// Computes the constitutive coefficients of the solid at distance x to the
+/// tip: anisotropy balance theta, bulk modulus K and stiffness C1..C6 already
+/// combined as used by computeDeformationSolid01() (2D or 3D).
+//==============================================================================
+JSph::StConstitutive JSph::CalcConstitutive(float x)const {
+	StConstitutive cs;
+	memset(&cs, 0, sizeof(StConstitutive));
 	// #MdYoung #Gradual #young
-	//int typeMdYoung = 0;
-	float theta = interfaceAnisotropyBalance(float(x)); 
+	const float theta = interfaceAnisotropyBalance(x);
 	const float E = theta * Ey + (1.0f - theta) * Ex;
 	const float G = theta * Gf + (1.0f - theta) * Ex * 0.5f * (1 + nuxy);
 	const float nu = theta * nuyz + (1.0f - theta) * nuxy;
-	const float  nf = E / Ex;
+	const float nf = E / Ex;
+	cs.theta = theta;
 
 	if (Simulate2D) {
+		//-Bulk modulus.
 		const float KS1 = 1 / Ex;
-		const float KS12 = 0.0f; 
 		const float KS13 = -nuxy / Ex;
-		const float KS21 = 0.0f;		
-		const float KS2 = 0.0f;	
-		const float KS23 = 0.0f;
-		const float KS31 = -nuxy / Ex; 
-		const float KS32 = 0.0f; 
+		const float KS31 = -nuxy / Ex;
 		const float KS3 = 1 / E;
-
-		K = 1 / (KS1 + KS12 + KS13 + KS21 + KS2 + KS23 + KS31 + KS32 + KS3);
-
+		cs.k = 1 / (KS1 + KS13 + KS31 + KS3);
+
+		//-Stiffness (xz plane).
+		const float Delta = 1.0f / (1.0f - nuxy * nuxy * nf);
+		const float C1 = Delta * Ex;
+		const float C13 = Delta * nuxy * E;
+		const float C3 = Delta * E;
+		cs.m[0] = 1.0f / 2.0f * (C1 - C13);  cs.m[2] = 1.0f / 2.0f * (C13 - C3);
+		cs.m[6] = 1.0f / 2.0f * (-C1 + C13); cs.m[8] = 1.0f / 2.0f * (-C13 + C3);
+		cs.c5 = G;
 	}
 	else {
-		const float KS1 = 1 / Ex; 
-		const float KS12 = -nuxy / Ex; 
+		//-Bulk modulus.
+		const float KS1 = 1 / Ex;
+		const float KS12 = -nuxy / Ex;
 		const float KS13 = -nuxy / Ex;
 		const float KS21 = -nuxy / Ex;
-		const float KS2 = 1 / E; 
+		const float KS2 = 1 / E;
 		const float KS23 = -nu / E;
 		const float KS31 = -nuxy / Ex;
-		const float KS32 = -nu / E; 
+		const float KS32 = -nu / E;
 		const float KS3 = 1 / E;
-
-		K = 1 / (KS1 + KS12 + KS13 + KS21 + KS2 + KS23 + KS31 + KS32 + KS3);
+		cs.k = 1 / (KS1 + KS12 + KS13 + KS21 + KS2 + KS23 + KS31 + KS32 + KS3);
+
+		//-Stiffness.
+		const float Delta = nf * Ex / (1.0f - nu - 2.0f * nf * nuxy * nuxy);
+		const float C1 = Delta * (1.0f - nu) / nf;
+		const float C12 = Delta * nuxy;
+		const float C13 = Delta * nuxy;
+		const float C2 = Delta * (1.0f - nf * nuxy * nuxy) / (1.0f + nu);
+		const float C23 = Delta * (nu + nf * nuxy * nuxy) / (1.0f + nu);
+		const float C3 = Delta * (1.0f - nf * nuxy * nuxy) / (1.0f + nu);
+		cs.m[0] = 2.0f / 3.0f * C1 - 1.0f / 3.0f * C12 - 1.0f / 3.0f * C13;
+		cs.m[1] = 2.0f / 3.0f * C12 - 1.0f / 3.0f * C2 - 1.0f / 3.0f * C23;
+		cs.m[2] = 2.0f / 3.0f * C13 - 1.0f / 3.0f * C23 - 1.0f / 3.0f * C3;
+		cs.m[3] = -1.0f / 3.0f * C1 + 2.0f / 3.0f * C12 - 1.0f / 3.0f * C13;
+		cs.m[4] = -1.0f / 3.0f * C12 + 2.0f / 3.0f * C2 - 1.0f / 3.0f * C23;
+		cs.m[5] = -1.0f / 3.0f * C13 + 2.0f / 3.0f * C23 - 1.0f / 3.0f * C3;
+		cs.m[6] = -1.0f / 3.0f * C1 - 1.0f / 3.0f * C12 + 2.0f / 3.0f * C13;
+		cs.m[7] = -1.0f / 3.0f * C12 - 1.0f / 3.0f * C2 + 2.0f / 3.0f * C23;
+		cs.m[8] = -1.0f / 3.0f * C13 - 1.0f / 3.0f * C23 + 2.0f / 3.0f * C3;
+		cs.c4 = E / (2.0f + 2.0f * nuxy);
+		cs.c5 = G;
+		cs.c6 = G;
 	}
-
-	return K;
+	return(cs);
+}
+
+//==============================================================================
+/// Builds the table of constitutive coefficients for distances to the tip in
+/// [-L,L] (L is the largest size of the domain). The step is Dp/8, reduced to
+/// resolve the transition of theta, and only two points are used when theta
+/// is constant. Out of the table the coefficients are computed directly.
+/// Must be called again when Simulate2D, Dp or the solid/anisotropy
+/// parameters change.
+//==============================================================================
+void JSph::ConfigConstitutive() {
+	const char met[] = "ConfigConstitutive";
+	const unsigned maxsize = 65536;
+	delete[] ConsTab; ConsTab = NULL;
+	ConsTabSize = 0; ConsTabMin = ConsTabStep = ConsTabOvStep = ConsTabLast = 0;
+	const double len = max(Map_Size.x, max(Map_Size.y, Map_Size.z));
+	if (len <= 0 || Dp <= 0)return;
+	//-Step of the table.
+	double step = Dp / 8;
+	if (typeAni == 2 && spAn)step = std::min(step, 1. / (16. * fabs(spAn)));
+	else if (typeAni == 3 && spAn)step = std::min(step, fabs(spAn) / 16.);
+	else if (typeAni != 2 && typeAni != 3)step = len * 2;
+	unsigned size = unsigned(ceil(len * 2 / step)) + 1;
+	if (size > maxsize) {
+		size = maxsize;
+		step = len * 2 / (size - 1);
+	}
+	try {
+		ConsTab = new StConstitutive[size];
+	}
+	catch (const std::bad_alloc) {
+		RunException(met, "Could not allocate the requested memory.");
+	}
+	ConsTabSize = size;
+	ConsTabMin = float(-len);
+	ConsTabStep = float(step);
+	ConsTabOvStep = float(1. / step);
+	ConsTabLast = float(size - 1);
+	for (unsigned c = 0; c < size; c++)ConsTab[c] = CalcConstitutive(float(-len + step * c));
 }
 
 float JSph::CalcMaxK() {
@@ -1237,6 +1408,13 @@ void JSph::VisuConfig()const{
   Log->Print(fun::VarStr("Visco",Visco));
   Log->Print(fun::VarStr("ViscoBoundFactor",ViscoBoundFactor));
   if(ViscoTime)Log->Print(fun::VarStr("ViscoTime",ViscoTime->GetFile()));
+  if(NlSkin)Log->Print(fun::VarStr("NeighbourSkin",NlSkin));
+  Log->Print(fun::VarStr("SymmetricForces",NlSymmetric));
+  Log->Print(fun::VarStr("SaveAsync",SvAsync));
+  Log->Print(fun::VarStr("SaveCompress",SvCompress));
+  Log->Print(fun::VarStr("SavePrecision",GetSavePrecisionStr_M()));
+  if(CheckpointInterval)Log->Print(fun::VarStr("CheckpointInterval",CheckpointInterval));
+  Log->Print(fun::VarStr("IncrementalDivide",IncrDivide));
   Log->Print(fun::VarStr("DeltaSph",GetDeltaSphName(TDeltaSph)));
   if(TDeltaSph!=DELTA_None)Log->Print(fun::VarStr("DeltaSphValue",DeltaSph));
   Log->Print(fun::VarStr("Shifting",GetShiftingName(TShifting)));
@@ -1266,6 +1444,7 @@ void JSph::VisuConfig()const{
   //Log->Print(fun::VarStr("CteB", CteB));
   // Matthias
   Log->Print(fun::VarStr("Gamma",Gamma));
+  Log->Print(fun::VarStr("GammaExp",GammaExp_M));
   Log->Print(fun::VarStr("RhopZero",RhopZero));
   Log->Print(fun::VarStr("Cs0",Cs0));
   Log->Print(fun::VarStr("CFLnumber", CFLnumber));
@@ -1285,6 +1464,7 @@ void JSph::VisuConfig()const{
   Log->Print(fun::VarStr("Shear modulus", Gf));
   Log->Print(fun::VarStr("Poisson modulus xy", nuxy));
   Log->Print(fun::VarStr("Poisson modulus yz", nuyz));
+  if(ConsTabSize)Log->Print(fun::PrintStr("ConstitutiveTable=%u points (step=%g)",ConsTabSize,ConsTabStep));
 
 
   if(TKernel==KERNEL_Wendland){
@@ -1691,6 +1871,7 @@ void JSph::ConfigSaveData(unsigned piece,unsigned pieces,std::string div){
   if(SvData&SDAT_Info || SvData&SDAT_Binx){
     DataBi4=new JPartDataBi4();
     DataBi4->ConfigBasic(piece,pieces,RunCode,AppName,CaseName,Simulate2D,Simulate2DPosY,DirDataOut);
+    DataBi4->ConfigCompress(SvCompress);
     DataBi4->ConfigParticles(CaseNp,CaseNfixed,CaseNmoving,CaseNfloat,CaseNfluid,CasePosMin,CasePosMax,NpDynamic,ReuseIds);
     //DataBi4->ConfigCtes(Dp,H,CteB,RhopZero,Gamma,MassBound,MassFluid); #Gradual #Young
     DataBi4->ConfigCtes(Dp,H, max(CalcK(0.0),CalcK(1.5))/Gamma,RhopZero,Gamma,MassBound,MassFluid);
@@ -1748,6 +1929,13 @@ void JSph::AddParticlesOut(unsigned nout,const unsigned *idp,const tdouble3 *pos
   PartsOut->AddParticles(nout,idp,pos,vel,rhop,code);
 }
 
+//==============================================================================
+/// Returns the number of excluded particles waiting for the next PART.
+//==============================================================================
+unsigned JSph::GetParticlesOutCount()const{
+  return(PartsOut? PartsOut->GetCount(): 0);
+}
+
 //==============================================================================
 /// Manages excluded particles fixed, moving and floating before aborting the execution.
 /// Gestiona particulas excluidas fixed, moving y floating antes de abortar la ejecucion.
@@ -1854,7 +2042,7 @@ void JSph::SavePartData(unsigned npok, unsigned nout, const unsigned *idp, const
 			float *press = NULL;
 			if (0) {//-Example saving a new array (Pressure) in files BI4.
 				press = new float[npok];
-				for (unsigned p = 0; p<npok; p++)press[p] = (idp[p] >= CaseNbound ? CalcK((2.0-pos[p].x))/Gamma * (pow(rhop[p] / RhopZero, Gamma) - 1.0f) : 0.f);
+				for (unsigned p = 0; p<npok; p++)press[p] = (idp[p] >= CaseNbound ? TaitEosPress_M(GammaExp_M, Gamma, RhopZero, CalcK((2.0-pos[p].x)), rhop[p]) : 0.f);
 				DataBi4->AddPartData("Pressure", npok, press);
 			}
 			DataBi4->SaveFilePart();
@@ -2487,18 +2675,58 @@ void JSph::SavePartData35_M(unsigned npok, unsigned nout, const unsigned* idp, c
 	, const float* rhop, const float* pore, const float* press, const float* massp, const tsymatrix3f* qfp
 	, const float* vonMises, const float* grVelSave, const unsigned* cellOSpr, const tfloat3* gradvel, const tfloat3* ace, const tfloat3* fvi
 	, unsigned ndom, const tdouble3* vdom, const StInfoPartPlus* infoplus) {
+	const StPartHead_M hd = GetPartHead_M(npok, nout, vdom, infoplus);
+	SavePartFiles35_M(hd, idp, pos, vel, rhop, pore, press, massp, qfp, vonMises, grVelSave, cellOSpr, gradvel, ace, fvi);
+	SavePartOut_M();
+}
+
+//==============================================================================
+/// Returns the values of the current PART stored with the particle data.
+//==============================================================================
+JSph::StPartHead_M JSph::GetPartHead_M(unsigned npok, unsigned nout, const tdouble3* vdom, const StInfoPartPlus* infoplus) {
+	StPartHead_M hd;
+	memset(&hd, 0, sizeof(StPartHead_M));
+	TimerPart.Stop();
+	hd.part = Part;
+	hd.timestep = TimeStep;
+	hd.nstep = Nstep;
+	hd.runtime = TimerPart.GetElapsedTimeD() / 1000.;
+	hd.npok = npok;
+	hd.nout = nout;
+	hd.vdom[0] = vdom[0]; hd.vdom[1] = vdom[1];
+	hd.totalnp = TotalNp;
+	hd.info = (infoplus && SvData & SDAT_Info);
+	if (hd.info) {
+		hd.dtmean = (!Nstep ? 0 : (TimeStep - TimeStepM1) / (Nstep - PartNstep));
+		hd.dtmin = (!Nstep ? 0 : PartDtMin);
+		hd.dtmax = (!Nstep ? 0 : PartDtMax);
+		hd.dtfixed = (DtFixed != NULL);
+		if (DtFixed)hd.dterror = DtFixed->GetDtError(true);
+		hd.infoplus = *infoplus;
+	}
+	return(hd);
+}
+
+//==============================================================================
+/// Stores the particle data of one PART in bi4 and VTK files. Only reads
+/// the configuration of the output, so it can be called by the writer
+/// thread of JSphSaveAsync while the simulation continues.
+//==============================================================================
+void JSph::SavePartFiles35_M(const StPartHead_M& hd, const unsigned* idp, const tdouble3* pos, const tfloat3* vel
+	, const float* rhop, const float* pore, const float* press, const float* massp, const tsymatrix3f* qfp
+	, const float* vonMises, const float* grVelSave, const unsigned* cellOSpr, const tfloat3* gradvel, const tfloat3* ace, const tfloat3* fvi)const {
+	const unsigned npok = hd.npok;
 	//-Stores particle data and/or information in bi4 format.
 	//-Graba datos de particulas y/o informacion en formato bi4.
-
 	if (DataBi4) {
 		tfloat3* posf3 = NULL;
-		TimerPart.Stop();
-		JBinaryData* bdpart = DataBi4->AddPartInfo(Part, TimeStep, npok, nout, Nstep, TimerPart.GetElapsedTimeD() / 1000., vdom[0], vdom[1], TotalNp);
-		if (infoplus && SvData & SDAT_Info) {
-			bdpart->SetvDouble("dtmean", (!Nstep ? 0 : (TimeStep - TimeStepM1) / (Nstep - PartNstep)));
-			bdpart->SetvDouble("dtmin", (!Nstep ? 0 : PartDtMin));
-			bdpart->SetvDouble("dtmax", (!Nstep ? 0 : PartDtMax));
-			if (DtFixed)bdpart->SetvDouble("dterror", DtFixed->GetDtError(true));
+		JBinaryData* bdpart = DataBi4->AddPartInfo(hd.part, hd.timestep, npok, hd.nout, hd.nstep, hd.runtime, hd.vdom[0], hd.vdom[1], hd.totalnp);
+		if (hd.info) {
+			const StInfoPartPlus* infoplus = &hd.infoplus;
+			bdpart->SetvDouble("dtmean", hd.dtmean);
+			bdpart->SetvDouble("dtmin", hd.dtmin);
+			bdpart->SetvDouble("dtmax", hd.dtmax);
+			if (hd.dtfixed)bdpart->SetvDouble("dterror", hd.dterror);
 			bdpart->SetvDouble("timesim", infoplus->timesim);
 			bdpart->SetvUint("nct", infoplus->nct);
 			bdpart->SetvUint("npbin", infoplus->npbin);
@@ -2520,101 +2748,32 @@ void JSph::SavePartData35_M(unsigned npok, unsigned nout, const unsigned* idp, c
 				posf3 = GetPointerDataFloat3(npok, pos);
 				DataBi4->AddPartData(npok, idp, posf3, vel, rhop);
 			}
-			// Press
-			float* pressp = NULL;
-			pressp = new float[npok];
-			for (unsigned p = 0; p < npok; p++) pressp[p] = press[p];
-			DataBi4->AddPartData("Press", npok, pressp);
-
-			// Mass
-			float* mass = NULL;
-			mass = new float[npok];
-			for (unsigned p = 0; p < npok; p++) mass[p] = massp[p];
-			DataBi4->AddPartData("Mass", npok, mass);
-
-			// Von Mises
-			float* vM3D = NULL;
-			vM3D = new float[npok];
-			for (unsigned p = 0; p < npok; p++) vM3D[p] = vonMises[p];
-			DataBi4->AddPartData("VonMises3D", npok, vM3D);
-
-			// GradVelSave
-			float* grVS = NULL;
-			grVS = new float[npok];
-			for (unsigned p = 0; p < npok; p++) grVS[p] = grVelSave[p];
-			DataBi4->AddPartData("GradVel", npok, grVS);
-
-			// CellOffSpring
-			unsigned* cOS = NULL;
-			cOS = new unsigned[npok];
-			for (unsigned p = 0; p < npok; p++) cOS[p] = cellOSpr[p];
-			DataBi4->AddPartData("CellOffSpring", npok, cOS);
-
-			tfloat3* gr = NULL;
-			gr = new tfloat3[npok];
-			for (unsigned p = 0; p < npok; p++) gr[p] = gradvel[p];
-			DataBi4->AddPartData("StrainDot", npok, gr);
-
-			tfloat3* ac = NULL;
-			ac = new tfloat3[npok];
-			for (unsigned p = 0; p < npok; p++) ac[p] = ace[p];
-			DataBi4->AddPartData("Acec", npok, ac);
-
-			tfloat3* fv = NULL;
-			fv = new tfloat3[npok];
-			for (unsigned p = 0; p < npok; p++) fv[p] = fvi[p];
-			DataBi4->AddPartData("AceVisc", npok, fv);
+			//-The arrays are added as external pointers, they are only read in SaveFilePart().
+			//-Diagnostic fields use the precision of SavePrecision, the lossy ones are copied when they are added.
+			DataBi4->AddPartDataPrec("Press", npok, press, 0, JPartDataBi4::TpPrecision(SvPrecMode[SVPREC_Press]), SvPrecError[SVPREC_Press]);
+			DataBi4->AddPartData("Mass", npok, massp);
+			DataBi4->AddPartDataPrec("VonMises3D", npok, vonMises, 0, JPartDataBi4::TpPrecision(SvPrecMode[SVPREC_VonMises3D]), SvPrecError[SVPREC_VonMises3D]);
+			DataBi4->AddPartDataPrec("GradVel", npok, grVelSave, 0, JPartDataBi4::TpPrecision(SvPrecMode[SVPREC_GradVel]), SvPrecError[SVPREC_GradVel]);
+			DataBi4->AddPartData("CellOffSpring", npok, cellOSpr);
+			DataBi4->AddPartDataPrec("StrainDot", npok, gradvel, JPartDataBi4::TpPrecision(SvPrecMode[SVPREC_StrainDot]), SvPrecError[SVPREC_StrainDot]);
+			DataBi4->AddPartDataPrec("Acec", npok, ace, JPartDataBi4::TpPrecision(SvPrecMode[SVPREC_Acec]), SvPrecError[SVPREC_Acec]);
+			DataBi4->AddPartDataPrec("AceVisc", npok, fvi, JPartDataBi4::TpPrecision(SvPrecMode[SVPREC_AceVisc]), SvPrecError[SVPREC_AceVisc]);
 
 			/*// Quadratic form -- Blocked formulation since PartVtk does not seem to read tsymatrix
-			tsymatrix3f *qf = NULL;
-			qf = new tsymatrix3f[npok];
-			for (unsigned p = 0; p < npok; p++) qf[p] = qfp[p];
-			DataBi4->AddPartData("Qf", npok, qf);*/
+			DataBi4->AddPartData("Qf", npok, qfp);*/
 			// Quadratic form -- term to term formulation (Voigt notation)
-			float* qfxx = NULL;
-			float* qfyy = NULL;
-			float* qfzz = NULL;
-			float* qfyz = NULL;
-			float* qfxz = NULL;
-			float* qfxy = NULL;
-			qfxx = new float[npok];
-			qfyy = new float[npok];
-			qfzz = new float[npok];
-			qfyz = new float[npok];
-			qfxz = new float[npok];
-			qfxy = new float[npok];
-			for (unsigned p = 0; p < npok; p++) {
-				qfxx[p] = qfp[p].xx;
-				qfyy[p] = qfp[p].yy;
-				qfzz[p] = qfp[p].zz;
-				qfyz[p] = qfp[p].yz;
-				qfxz[p] = qfp[p].xz;
-				qfxy[p] = qfp[p].xy;
-			}
-			DataBi4->AddPartData("Qfxx", npok, qfxx);
-			DataBi4->AddPartData("Qfyy", npok, qfyy);
-			DataBi4->AddPartData("Qfzz", npok, qfzz);
-			DataBi4->AddPartData("Qfyz", npok, qfyz);
-			DataBi4->AddPartData("Qfxz", npok, qfxz);
-			DataBi4->AddPartData("Qfxy", npok, qfxy);
+			//-The components are read from qfp with the stride of tsymatrix3f when the file is saved.
+			const unsigned sqf = unsigned(sizeof(tsymatrix3f));
+			const JPartDataBi4::TpPrecision precqf = JPartDataBi4::TpPrecision(SvPrecMode[SVPREC_Qf]);
+			const float errqf = SvPrecError[SVPREC_Qf];
+			DataBi4->AddPartDataPrec("Qfxx", npok, &qfp->xx, sqf, precqf, errqf);
+			DataBi4->AddPartDataPrec("Qfyy", npok, &qfp->yy, sqf, precqf, errqf);
+			DataBi4->AddPartDataPrec("Qfzz", npok, &qfp->zz, sqf, precqf, errqf);
+			DataBi4->AddPartDataPrec("Qfyz", npok, &qfp->yz, sqf, precqf, errqf);
+			DataBi4->AddPartDataPrec("Qfxz", npok, &qfp->xz, sqf, precqf, errqf);
+			DataBi4->AddPartDataPrec("Qfxy", npok, &qfp->xy, sqf, precqf, errqf);
 
 			DataBi4->SaveFilePart();
-			//delete[] tensor; tensor = NULL;
-			delete[] qfxx; qfxx = NULL;
-			delete[] qfyy; qfyy = NULL;
-			delete[] qfzz; qfzz = NULL;
-			delete[] qfyz; qfyz = NULL;
-			delete[] qfxz; qfxz = NULL;
-			delete[] qfxy; qfxy = NULL;
-			delete[] vM3D; vM3D = NULL;
-			delete[] mass; mass = NULL;
-			delete[] grVS; grVS = NULL;
-			delete[] cOS; cOS = NULL;
-			delete[] gr; gr = NULL;
-			delete[] ac; ac = NULL;
-			delete[] fv; fv = NULL;
-			delete[] pressp; pressp = NULL;//-Memory must to be deallocated after saving file because DataBi4 uses this memory space.
-										   //delete[] gradvelSave; gradvelSave = NULL;	
 		}
 		if (SvData & SDAT_Info)DataBi4->SaveFileInfo();
 		delete[] posf3;
@@ -2669,7 +2828,7 @@ void JSph::SavePartData35_M(unsigned npok, unsigned nout, const unsigned* idp, c
 		if (cellOSpr) { fields[nfields] = JFormatFiles2::DefineField("CellOffSpring", JFormatFiles2::UInt32, 1, cellOSpr);  nfields++; }
 		if (gradvel) { fields[nfields] = JFormatFiles2::DefineField("StrainDot", JFormatFiles2::Float32, 3, gradvel);   nfields++; }
 		if (type) { fields[nfields] = JFormatFiles2::DefineField("Type", JFormatFiles2::UChar8, 1, type);  nfields++; }
-		if (SvData & SDAT_Vtk)JFormatFiles2::SaveVtk(DirDataOut + fun::FileNameSec("PartVtk.vtk", Part), npok, posf3, nfields, fields);
+		if (SvData & SDAT_Vtk)JFormatFiles2::SaveVtk(DirDataOut + fun::FileNameSec("PartVtk.vtk", hd.part), npok, posf3, nfields, fields);
 		//if (SvData&SDAT_Csv)JFormatFiles2::SaveCsv(DirDataOut + fun::FileNameSec("PartCsv.csv", Part), CsvSepComa, npok, posf3, nfields, fields);
 		//-libera memoria.
 		//-release of memory.
@@ -2681,6 +2840,12 @@ void JSph::SavePartData35_M(unsigned npok, unsigned nout, const unsigned* idp, c
 		}
 	}
 
+}
+
+//==============================================================================
+/// Stores the data of excluded particles and floatings of the current PART.
+//==============================================================================
+void JSph::SavePartOut_M() {
 	//-Graba datos de particulas excluidas.
 	//-Stores data of excluded particles.
 	if (DataOutBi4 && PartsOut->GetCount()) {
@@ -2710,17 +2875,32 @@ void JSph::SaveData35_M(unsigned npok, const unsigned* idp, const tdouble3* pos,
 	, const float* gradVelSav, unsigned* cellOSpr, const tfloat3* gradvel, const tfloat3* ace, const tfloat3* fvi, unsigned ndom
 	, const tdouble3* vdom, const StInfoPartPlus* infoplus)
 {
-	string suffixpartx = fun::PrintStr("_%04d", Part);
+	const unsigned nout = SaveDataCountOut_M();
 
+	//-Graba ficheros con datos de particulas.
+	//-Stores data files of particles.
+	SavePartData35_M(npok, nout, idp, pos, vel, rhop, pore, press, mass, qf, vonMises, gradVelSav, cellOSpr, gradvel, ace, fvi, ndom, vdom, infoplus);
+
+	SaveDataEnd_M(npok, nout, ndom, vdom);
+}
+
+//==============================================================================
+/// Counts the new excluded particles of the PART and returns their number.
+//==============================================================================
+unsigned JSph::SaveDataCountOut_M() {
 	//-Contabiliza nuevas particulas excluidas.
 	//-Counts new excluded particles.
 	const unsigned noutpos = PartsOut->GetOutPosCount(), noutrhop = PartsOut->GetOutRhopCount(), noutmove = PartsOut->GetOutMoveCount();
-	const unsigned nout = noutpos + noutrhop + noutmove;
 	AddOutCount(noutpos, noutrhop, noutmove);
+	return(noutpos + noutrhop + noutmove);
+}
 
-	//-Graba ficheros con datos de particulas.
-	//-Stores data files of particles.
-	SavePartData35_M(npok, nout, idp, pos, vel, rhop, pore, press, mass, qf, vonMises, gradVelSav, cellOSpr, gradvel, ace, fvi, ndom, vdom, infoplus);
+//==============================================================================
+/// Shows the information of the PART once its data was stored (or queued)
+/// and reinitialises the limits of dt.
+//==============================================================================
+void JSph::SaveDataEnd_M(unsigned npok, unsigned nout, unsigned ndom, const tdouble3* vdom) {
+	string suffixpartx = fun::PrintStr("_%04d", Part);
 
 	//-Reinicia limites de dt.
 	//-Reinitialises limits of dt.
@@ -33,6 +33,7 @@
 #include "JCfgRun.h"
 #include "JLog2.h"
 #include "JTimer.h"
+#include "JSphEos_M.h"
 #include <float.h>
 #include <string>
 #include <cmath>
@@ -77,6 +78,14 @@ public:
     float od_wdeltap;        ///<Parameter for tensile instability correction.  
   }StCubicCte;
 
+/// Structure with the constitutive coefficients of the solid for one distance to the tip.
+  typedef struct{
+    float theta;         ///<Anisotropy balance (interfaceAnisotropyBalance()).
+    float k;             ///<Bulk modulus (CalcK()).
+    float m[9];          ///<Normal stress rate per normal strain rate, rows xx,yy,zz (computeDeformationSolid01()).
+    float c4,c5,c6;      ///<Shear stiffness in xy, xz and yz.
+  }StConstitutive;
+
 /// Structure that saves extra information about the execution.
   typedef struct {
     double timesim;      ///<Seconds from the start of the simulation (after loading the initial data).                    | Segundos desde el inicio de la simulacion (despues de cargar los datos iniciales).
@@ -95,6 +104,27 @@ public:
     llong memorynctused;
   }StInfoPartPlus;
 
+/// Structure with the values of one PART stored with the particle data (see SavePartFiles35_M()).
+  typedef struct{
+    unsigned part;       ///<Number of PART.
+    double timestep;     ///<Simulation time of the PART.
+    unsigned nstep;      ///<Number of steps.
+    double runtime;      ///<Seconds of computation of the PART.
+    unsigned npok;       ///<Number of stored particles.
+    unsigned nout;       ///<Number of new excluded particles.
+    tdouble3 vdom[2];    ///<Limits of the domain.
+    ullong totalnp;      ///<Total number of simulated particles.
+    bool info;           ///<Stores the values below and infoplus.
+    double dtmean,dtmin,dtmax;
+    bool dtfixed;        ///<Stores dterror.
+    double dterror;
+    StInfoPartPlus infoplus;
+  }StPartHead_M;
+
+/// Diagnostic fields of the PART files with configurable precision (see SavePrecision).
+  typedef enum{ SVPREC_Press=0,SVPREC_VonMises3D=1,SVPREC_GradVel=2,SVPREC_StrainDot=3,SVPREC_Acec=4,SVPREC_AceVisc=5,SVPREC_Qf=6 }TpSvPrecField_M;
+  static const unsigned SVPREC_COUNT=7;
+
 /// Structure with Periodic information.
   typedef struct{
     byte PeriActive;
@@ -185,6 +215,16 @@ protected:
   float ViscoBoundFactor;     ///<For boundary interaction use Visco*ViscoBoundFactor.                  | Para interaccion con contorno usa Visco*ViscoBoundFactor.
   JSphVisco* ViscoTime;       ///<Provides a viscosity value as a function of simulation time.          | Proporciona un valor de viscosidad en funcion del instante de la simulacion.
 
+  float NlSkin;               ///<Skin added to 2h so the neighbour list survives several steps (def=0, disabled).
+  bool NlSymmetric;           ///<Fluid-fluid forces visit each pair of the neighbour list once (def=false).
+  int SimdLevel;              ///<Maximum instruction set for the vectorised pair kernel, limited by the CPU (0:None, 1:SSE4, 2:AVX2, 3:AVX-512, def=3).
+  float IncrDivide;           ///<Maximum fraction of particles that change cell to use the incremental divide (def=0.05, 0:disabled).
+  bool SvAsync;               ///<PART files are written by a background thread (see JSphSaveAsync, def=true).
+  bool SvCompress;            ///<Arrays of the PART files are compressed (see JBinaryDataCodec, def=false).
+  byte SvPrecMode[SVPREC_COUNT];   ///<Precision of the diagnostic fields in the PART files (JPartDataBi4::TpPrecision, def=PREC_Exact).
+  float SvPrecError[SVPREC_COUNT]; ///<Maximum absolute error of the fields with PREC_AbsError.
+  double CheckpointInterval;  ///<Wall-clock seconds between checkpoints of the complete state (def=0, disabled).
+
   bool RhopOut;               ///<Indicates whether the RhopOut density correction is active or not.    | Indica si activa la correccion de densidad RhopOut o no.                       
   float RhopOutMin;           ///<Minimum limit for Rhopout correction.                                 | Limite minimo para la correccion de RhopOut.
   float RhopOutMax;           ///<Maximum limit for Rhopout correction.                                 | Limite maximo para la correccion de RhopOut.
@@ -211,9 +251,11 @@ protected:
   bool SvRes;                ///<Creates file with execution summary.                            | Graba fichero con resumen de ejecucion.
   bool SvTimers;             ///<Computes the time for each process.                             | Obtiene tiempo para cada proceso.
   bool SvDomainVtk;          ///<Stores VTK file with the domain of particles of each PART file. | Graba fichero vtk con el dominio de las particulas en cada Part. 
+  std::string TraceFile;     ///<Chrome trace file with the timeline of the execution (empty: no trace).
 
   //-Constants for computation.
   float H,CteB,Gamma,CFLnumber,RhopZero;
+  unsigned GammaExp_M;       ///<Exponent of JTaitEos_M for Gamma (0 when Gamma is not integral, see EosGammaExp_M()).
   double Dp;
   double Cs0;
   float Delta2H;             ///<Constant for DeltaSPH. Delta2H=DeltaSph*H*2
@@ -237,6 +279,13 @@ protected:
   float C1, C2, C3, C12, C13, C23, C4, C5, C6;
   float S1, S12, S13, S21, S2, S23, S31, S32, S3;
   float K, Kani;
+  //-Constitutive coefficients along the distance to the tip (see ConfigConstitutive()).
+  StConstitutive *ConsTab;   ///<Coefficients at distance ConsTabMin+i*ConsTabStep [ConsTabSize].
+  unsigned ConsTabSize;      ///<Number of points of ConsTab (0: not built).
+  float ConsTabMin;          ///<Distance of the first point.
+  float ConsTabStep;         ///<Distance between points.
+  float ConsTabOvStep;       ///<1/ConsTabStep.
+  float ConsTabLast;         ///<float(ConsTabSize-1) (0: not built).
   tfloat3 K_M, CteB_M;
 
   //tfloat3 CteB3D;
@@ -284,6 +333,8 @@ protected:
   unsigned PartBeginFirst;    ///<Indicates the number of the first PART to be generated. | Indica el numero del primer PART a generar.                                    
   double PartBeginTimeStep;   ///<initial instant of the simulation                       | Instante de inicio de la simulación.                                          
   ullong PartBeginTotalNp;    ///<Total number of simulated particles.
+  std::string RestartFile;    ///<Checkpoint file to resume the simulation (empty: no restart).
+  double WallTime;            ///<Wall-clock budget in seconds, then the run stops with a checkpoint (0: no limit).
 
   //-Variables for predefined movement.
   JSphMotion *Motion;
@@ -379,6 +430,8 @@ protected:
   void LoadConfig(const JCfgRun *cfg);
   void LoadConfig_Uni_M(const JCfgRun* cfg);
   void LoadCaseConfig();
+  void LoadSavePrecision_M(std::string cfg);
+  std::string GetSavePrecisionStr_M()const;
   void UpdateCaseConfig_Mixed_M();
 
   void VisuDemCoefficients()const;
@@ -391,6 +444,40 @@ protected:
   // Matthias
   float CalcK(double x); 
   float CalcMaxK();
+  StConstitutive CalcConstitutive(float x)const;
+  void ConfigConstitutive();
+
+  //==============================================================================
+  /// Returns the constitutive coefficients at distance x to the tip interpolated
+  /// from ConsTab (computed directly out of the table).
+  //==============================================================================
+  inline StConstitutive GetConstitutive(float x)const{
+    const float fx=(x-ConsTabMin)*ConsTabOvStep;
+    if(!(fx>=0 && fx<ConsTabLast))return(CalcConstitutive(x));
+    const unsigned i=unsigned(fx);
+    const float f=fx-float(i);
+    const StConstitutive &a=ConsTab[i],&b=ConsTab[i+1];
+    StConstitutive r;
+    r.theta=a.theta+(b.theta-a.theta)*f;
+    r.k=a.k+(b.k-a.k)*f;
+    for(unsigned c=0;c<9;c++)r.m[c]=a.m[c]+(b.m[c]-a.m[c])*f;
+    r.c4=a.c4+(b.c4-a.c4)*f;
+    r.c5=a.c5+(b.c5-a.c5)*f;
+    r.c6=a.c6+(b.c6-a.c6)*f;
+    return(r);
+  }
+
+  //==============================================================================
+  /// Returns the bulk modulus at distance x to the tip (see GetConstitutive()).
+  //==============================================================================
+  inline float GetConstitutiveK(float x)const{
+    const float fx=(x-ConsTabMin)*ConsTabOvStep;
+    if(!(fx>=0 && fx<ConsTabLast))return(CalcConstitutive(x).k);
+    const unsigned i=unsigned(fx);
+    const float f=fx-float(i);
+    return(ConsTab[i].k+(ConsTab[i+1].k-ConsTab[i].k)*f);
+  }
+
   float CircleYoung(float x)const;
   float thetaTransition(float p) const;
 
@@ -431,6 +518,7 @@ protected:
 
   void ConfigSaveData(unsigned piece,unsigned pieces,std::string div);
   void AddParticlesOut(unsigned nout,const unsigned *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,const typecode *code);
+  unsigned GetParticlesOutCount()const;
   void AbortBoundOut(unsigned nout,const unsigned *idp,const tdouble3 *pos,const tfloat3 *vel,const float *rhop,const typecode *code);
 
   tfloat3* GetPointerDataFloat3(unsigned n,const tdouble3* v)const;
@@ -453,6 +541,13 @@ protected:
   void SavePartData35_M(unsigned npok, unsigned nout, const unsigned* idp, const tdouble3* pos, const tfloat3* vel, const float* rhop, const float* pore
 	  , const float* press, const float* massp, const tsymatrix3f* qfp, const float* vonMises, const float* grVelSave, const unsigned* cellOSpr
 	  , const tfloat3* gradvel, const tfloat3* ace, const tfloat3* fvi, unsigned ndom, const tdouble3* vdom, const StInfoPartPlus* infoplus);
+  StPartHead_M GetPartHead_M(unsigned npok, unsigned nout, const tdouble3* vdom, const StInfoPartPlus* infoplus);
+  void SavePartFiles35_M(const StPartHead_M& hd, const unsigned* idp, const tdouble3* pos, const tfloat3* vel, const float* rhop, const float* pore
+	  , const float* press, const float* massp, const tsymatrix3f* qfp, const float* vonMises, const float* grVelSave, const unsigned* cellOSpr
+	  , const tfloat3* gradvel, const tfloat3* ace, const tfloat3* fvi)const;
+  void SavePartOut_M();
+  unsigned SaveDataCountOut_M();
+  void SaveDataEnd_M(unsigned npok, unsigned nout, unsigned ndom, const tdouble3* vdom);
 
   void SaveDomainVtk(unsigned ndom,const tdouble3 *vdom)const;
   void SaveInitialDomainVtk()const;
@@ -466,6 +561,7 @@ protected:
   unsigned GetOutPosCount()const{ return(OutPosCount); }
   unsigned GetOutRhopCount()const{ return(OutRhopCount); }
   unsigned GetOutMoveCount()const{ return(OutMoveCount); }
+  void SetOutCount_M(unsigned outpos,unsigned outrhop,unsigned outmove){ OutPosCount=outpos; OutRhopCount=outrhop; OutMoveCount=outmove; }
 
 public:
   JSph(bool cpu,bool withmpi);
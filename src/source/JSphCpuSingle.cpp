@@ -21,6 +21,7 @@
 #include "JSphCpuSingle.h"
 #include "JCellDivCpuSingle.h"
 #include "JArraysCpu.h"
+#include "JNeighbourListCpu.h"
 #include "JSphMk.h"
 #include "Functions.h"
 #include "FunctionsMath.h"
@@ -30,25 +31,19 @@
 #include "JSphVisco.h"
 #include "JTimeOut.h"
 #include "JTimeControl.h"
+#include "JSphSaveAsync.h"
+#include "JBinaryData.h"
+#include "JTimerRegistry.h"
 //#include "JGaugeSystem.h"
 #include <climits>
+#include <cstdio>
+#include <csignal>
 #include "JSphSolidCpu_M.h"
-#include <Eigen/Dense>
-#include <Eigen/Eigenvalues>
 #include <random>
 #include <chrono>
 #include <vector>
 
 using namespace std;
-using Eigen::MatrixXd;
-using Eigen::MatrixXcd;
-using Eigen::MatrixXf;
-using Eigen::Matrix3f;
-using Eigen::Matrix2d;
-using Eigen::Vector2d;
-using Eigen::EigenSolver;
-using Eigen::VectorXcd;
-using Eigen::Vector3f;
 
 //==============================================================================
 /// Constructor.
@@ -57,6 +52,8 @@ JSphCpuSingle::JSphCpuSingle():JSphSolidCpu(false){
   ClassName="JSphCpuSingle";
   CellDivSingle=NULL;
   PartsLoaded=NULL;
+  SaveAsync=NULL;
+  StopRequested=Preempted=false;
 }
 
 //==============================================================================
@@ -64,6 +61,7 @@ JSphCpuSingle::JSphCpuSingle():JSphSolidCpu(false){
 //==============================================================================
 JSphCpuSingle::~JSphCpuSingle(){
   DestructorActive=true;
+  delete SaveAsync;     SaveAsync=NULL; //-Waits for the PART files in the queue.
   delete CellDivSingle; CellDivSingle=NULL;
   delete PartsLoaded;   PartsLoaded=NULL;
 }
@@ -77,6 +75,7 @@ llong JSphCpuSingle::GetAllocMemoryCpu()const{
   //-Allocated in other objects.
   if(CellDivSingle)s+=CellDivSingle->GetAllocMemory();
   if(PartsLoaded)s+=PartsLoaded->GetAllocMemory();
+  if(SaveAsync)s+=SaveAsync->GetAllocMemory();
   return(s);
 }
 
@@ -266,6 +265,7 @@ void JSphCpuSingle::ConfigDomain(){
   //-Create object for divide in CPU & select a valid cellmode. | Crea objeto para divide en Gpu y selecciona un cellmode valido.
   CellDivSingle=new JCellDivCpuSingle(Stable,FtCount!=0,PeriActive,CellOrder,CellMode,Scell,Map_PosMin,Map_PosMax,Map_Cells,CaseNbound,CaseNfixed,CaseNpb,Log,DirOut);
   CellDivSingle->DefineDomain(DomCellCode,DomCelIni,DomCelFin,DomPosMin,DomPosMax);
+  CellDivSingle->SetIncrementalDivide(IncrDivide);
   ConfigCellDiv((JCellDivCpu*)CellDivSingle);
 
   ConfigSaveData(0,1,"");
@@ -296,7 +296,10 @@ void JSphCpuSingle::ConfigDomain_Uni_M() {
 	memcpy(Idpc, PartsLoaded->GetIdp(), sizeof(unsigned) * Np);
 	memcpy(Velrhopc, PartsLoaded->GetVelRhop(), sizeof(tfloat4) * Np);
 	memcpy(Massc_M, PartsLoaded->GetMass(), sizeof(float) * Np);
-	memcpy(QuadFormc_M, PartsLoaded->GetQf(), sizeof(tsymatrix3f) * Np);
+	{
+		const tsymatrix3f *qf = PartsLoaded->GetQf();
+		for (unsigned p = 0; p < Np; p++)QuadFormc_M[p] = qf[p];
+	}
 	
 	//-Calculate floating radius. | Calcula radio de floatings.
 	if (CaseNfloat && PeriActive != 0 && !PartBegin)CalcFloatingRadius(Np, Posc, Idpc);
@@ -325,6 +328,7 @@ void JSphCpuSingle::ConfigDomain_Uni_M() {
 	//-Create object for divide in CPU & select a valid cellmode. | Crea objeto para divide en Gpu y selecciona un cellmode valido.
 	CellDivSingle = new JCellDivCpuSingle(Stable, FtCount != 0, PeriActive, CellOrder, CellMode, Scell, Map_PosMin, Map_PosMax, Map_Cells, CaseNbound, CaseNfixed, CaseNpb, Log, DirOut);
 	CellDivSingle->DefineDomain(DomCellCode, DomCelIni, DomCelFin, DomPosMin, DomPosMax);
+	CellDivSingle->SetIncrementalDivide(IncrDivide);
 	ConfigCellDiv((JCellDivCpu*)CellDivSingle);
 
 	ConfigSaveData(0, 1, "");
@@ -500,6 +504,7 @@ void JSphCpuSingle::PeriodicDuplicateSymplectic(unsigned np,unsigned pini,tuint3
 void JSphCpuSingle::RunPeriodic(){
   const char met[]="RunPeriodic";
   TmcStart(Timers,TMC_SuPeriodic);
+  TraceBegin_M("Periodic");
   //-Keep number of present periodic. | Guarda numero de periodicas actuales.
   NpfPerM1=NpfPer;
   NpbPerM1=NpbPer;
@@ -566,6 +571,7 @@ void JSphCpuSingle::RunPeriodic(){
       }
     }
   }
+  TraceEnd_M("Periodic");
   TmcStop(Timers,TMC_SuPeriodic);
 }
 
@@ -575,6 +581,7 @@ void JSphCpuSingle::RunPeriodic(){
 //==============================================================================
 void JSphCpuSingle::RunCellDivide(bool updateperiodic){
   const char met[]="RunCellDivide";
+  TraceBegin_M("CellDivide");
   //-Creates new periodic particles and marks the old ones to be ignored.
   //-Crea nuevas particulas periodicas y marca las viejas para ignorarlas.
   if (updateperiodic && PeriActive) {
@@ -582,45 +589,15 @@ void JSphCpuSingle::RunCellDivide(bool updateperiodic){
   }
 
   //-Initiates Divide.
+  TraceBegin_M("Divide");
   CellDivSingle->Divide(Npb,Np-Npb-NpbPer-NpfPer,NpbPer,NpfPer,BoundChanged,Dcellc,Codec,Idpc,Posc,Timers);
+  TraceEnd_M("Divide");
 
   //-Sorts particle data. | Ordena datos de particulas.
   TmcStart(Timers,TMC_NlSortData);
-  CellDivSingle->SortArray(Idpc);
-  CellDivSingle->SortArray(Codec);
-  CellDivSingle->SortArray(Dcellc);
-  CellDivSingle->SortArray(Posc);
-  CellDivSingle->SortArray(Velrhopc);
-  if(TStep==STEP_Verlet){
-    CellDivSingle->SortArray(VelrhopM1c);
-	// Matthias
-	CellDivSingle->SortArray(TauM1c_M);
-	CellDivSingle->SortArray(MassM1c_M);
-	CellDivSingle->SortArray(QuadFormM1c_M);
-  }
-  else if(TStep==STEP_Symplectic && (PosPrec || VelrhopPrec)){//-In reality, this is only necessary in divide for corrector, not in predictor??? | En realidad solo es necesario en el divide del corrector, no en el predictor???
-    if(!PosPrec || !VelrhopPrec)RunException(met,"Symplectic data is invalid.") ;
-    CellDivSingle->SortArray(PosPrec);
-	CellDivSingle->SortArray(VelrhopPrec);
-	CellDivSingle->SortArray(MassPrec_M);
-	CellDivSingle->SortArray(TauPrec_M);
-	CellDivSingle->SortArray(QuadFormPrec_M);
-  }
-  if(TVisco==VISCO_LaminarSPS)CellDivSingle->SortArray(SpsTauc);
-
-  // Matthias
-  CellDivSingle->SortArray(Tauc_M);
-  CellDivSingle->SortArray(Massc_M);
-  CellDivSingle->SortArray(Divisionc_M);
-  CellDivSingle->SortArray(Porec_M);
-  CellDivSingle->SortArray(QuadFormc_M);
-  // Augustin
-  CellDivSingle->SortArray(VonMises);
-  CellDivSingle->SortArray(GradVelSave);
-  CellDivSingle->SortArray(StrainDotSave);
-  CellDivSingle->SortArray(AceSave);
-  CellDivSingle->SortArray(ForceVisc);
-  CellDivSingle->SortArray(CellOffSpring);
+  TraceBegin_M("SortData");
+  if(TStep==STEP_Symplectic && (PosPrec || VelrhopPrec) && (!PosPrec || !VelrhopPrec))RunException(met,"Symplectic data is invalid.");
+  SortParticleArrays_M(CellDivSingle);
 
   //-Collect divide data. | Recupera datos del divide.
   Np=CellDivSingle->GetNpFinal();
@@ -632,6 +609,7 @@ void JSphCpuSingle::RunCellDivide(bool updateperiodic){
 
   //-Collect position of floating particles. | Recupera posiciones de floatings.
   if(CaseNfloat)CalcRidp(PeriActive!=0,Np-Npb,Npb,CaseNpb,CaseNpb+CaseNfloat,Codec,Idpc,FtRidp);
+  TraceEnd_M("SortData");
   TmcStop(Timers,TMC_NlSortData);
 
   //-Control of excluded particles (only fluid because excluded boundary are checked before).
@@ -653,7 +631,27 @@ void JSphCpuSingle::RunCellDivide(bool updateperiodic){
     ArraysCpu->Free(code);
   }
   TmcStop(Timers,TMC_NlOutCheck);
+  //-Excluded and new periodic particles change the tip.
+  if(npfout || PeriActive)InvalidateTip_M();
   BoundChanged=false;
+  //-Candidates of the neighbour list must be rebuilt after each divide.
+  NbList->SetCandValid(false);
+  TraceEnd_M("CellDivide");
+}
+
+//==============================================================================
+/// Executes divide of particles in cells only when the neighbour list with
+/// NeighbourSkin is no longer valid. Without skin it always executes divide.
+/// Ejecuta divide solo cuando la lista de vecinos con skin deja de ser valida.
+//==============================================================================
+void JSphCpuSingle::RunCellDivideSkin(bool updateperiodic){
+  bool divide=true;
+  if(NlSkin){
+    TmcStart(Timers,TMC_NlLimits);
+    divide=CheckNeighbourSkin_M(Np,Posc,Codec);
+    TmcStop(Timers,TMC_NlLimits);
+  }
+  if(divide)RunCellDivide(updateperiodic);
 }
 
 
@@ -707,6 +705,7 @@ void JSphCpuSingle::RunRandomDivision_M() {
 				Posc, Velrhopc, Tauc_M, Porec_M, Massc_M, VelrhopM1c, StrainDotc_M,
 				LocDiv_M, RateBirth_M, Spread_M);*/
 			Np += count;
+			InvalidateTip_M();
 		}
 	}
 	TmcStop(Timers, TMC_SuPeriodic);
@@ -734,69 +733,120 @@ uint64_t nanos()
 	return ns;
 }
 
-// #V37-2 - #parallel fix and lean marking
-void JSphCpuSingle::RunSizeDivision37_M(double stepdt) {
-	const char met[] = "RunSizeDivision37";
-	TmcStart(Timers, TMC_SuPeriodic); // Use of Periodic timer for creation of particles
-	std::vector<int> mark_for_div;
-
-	// 1. Test division cellulaire
-	switch (typeDivision) {
-		// #division #parallel possible
-	default: { // No division
-		break;
-	}
-	case 1: { // Size double
-		for (int p = Npb; p < Np; p++) {
-			if (Massc_M[p] > SizeDivision_M * MassFluid) {
-				//Divisionc_M[p] = true;
-				// Original line mark_for_div.push_back(Idpc[p]);
-				mark_for_div.push_back(p);
-			}
+//==============================================================================
+/// Creates the list of particles [pini,pini+n) whose mass is over masslimit.
+/// Each thread counts its own range, the counts are converted into offsets and
+/// then each thread writes its particles, so the list keeps the order of the
+/// particles without locks. Returns the number of particles in the list.
+//==============================================================================
+unsigned JSphCpuSingle::MarkDivisionList37_M(unsigned n, unsigned pini, const float* massp, float masslimit, unsigned* listp)const {
+	unsigned countth[OMP_MAXTHREADS * OMP_STRIDE];
+	unsigned count = 0;
+#ifdef OMP_USE
+#pragma omp parallel if (n > OMP_LIMIT_COMPUTELIGHT)
+#endif
+	{
+		const JTimerRegistry::ThreadScope ths(TimersReg, TmsDivMark);
+#ifdef OMP_USE
+		const unsigned nt = min(unsigned(omp_get_num_threads()), unsigned(OMP_MAXTHREADS));
+#else
+		const unsigned nt = 1;
+#endif
+		const unsigned th = unsigned(omp_get_thread_num());
+		const unsigned pth = pini + unsigned((ullong(n) * th) / nt);
+		const unsigned pthfin = pini + unsigned((ullong(n) * (th + 1)) / nt);
+		if (th < nt) {
+			unsigned c = 0;
+			for (unsigned p = pth; p < pthfin; p++)if (massp[p] > masslimit)c++;
+			countth[th * OMP_STRIDE] = c;
+		}
+#ifdef OMP_USE
+#pragma omp barrier
+#endif
+		if (th < nt) {
+			unsigned cp = 0;
+			for (unsigned t = 0; t < th; t++)cp += countth[t * OMP_STRIDE];
+			for (unsigned p = pth; p < pthfin; p++)if (massp[p] > masslimit)listp[cp++] = p;
+			if (th + 1 == nt)count = cp;
 		}
-		break;
-	}
 	}
+	return(count);
+}
 
-	if (!mark_for_div.empty()) {
-		// 2. Prepare memory for count particles
+// #V37-2 - #parallel fix and lean marking
+void JSphCpuSingle::RunSizeDivision37_M(double stepdt) {
+	const char met[] = "RunSizeDivision37";
+	TmcStart(Timers, TMC_SuDivision);
+	TraceBegin_M("Division");
+	bool run = true;
+	while (run) {
 		//-Maximum number of particles that fit in the list / Numero maximo de particulas que caben en la lista.
-		unsigned nmax = CpuParticlesSize - 1;
-
+		const unsigned nmax = CpuParticlesSize - 1;
 		if (Np >= 0x80000000)RunException(met, "The number of particles is too big.");//-Because the last bit is used to mark the direction in which a new periodic particle is created / Pq el ultimo bit se usa para marcar el sentido en que se crea la nueva periodica.
-																					  // Maximal number of division per turn
-																					  //-Redimension memory for particles if there is insufficient space and repeat the search process.
-		if (mark_for_div.size() > nmax || mark_for_div.size() + Np > CpuParticlesSize) {
-			TmcStop(Timers, TMC_SuPeriodic);
-			// Peut etre qu'ici on a la source de certains bug (trop particles, need extend)
-			ResizeParticlesSize(Np + mark_for_div.size(), PERIODIC_OVERMEMORYNP, false); // No particle sorting
-			TmcStart(Timers, TMC_SuPeriodic);
+
+		// 1. Test division cellulaire
+		unsigned* listp = ArraysCpu->ReserveUint();
+		unsigned ndiv = 0;
+		switch (typeDivision) {
+		default: { // No division
+			break;
+		}
+		case 1: { // Size double
+			TimersReg->Start(TmsDivMark);
+			ndiv = MarkDivisionList37_M(Np - Npb, Npb, Massc_M, SizeDivision_M * MassFluid, listp);
+			TimersReg->Stop(TmsDivMark);
+			break;
+		}
 		}
 
-		// 3 Cell division
-		if (TStep == STEP_Verlet) {
-			MarkedDivision_M(mark_for_div.size(), Np, Npb, DomCells, Idpc, Codec, Dcellc
-				, Posc, Velrhopc, Tauc_M, Divisionc_M, Porec_M, Massc_M, QuadFormc_M, VelrhopM1c, TauM1c_M, MassM1c_M, QuadFormM1c_M);
+		//-Redimension memory for particles if there is insufficient space and repeat the search process.
+		if (ndiv > nmax || ndiv + Np > CpuParticlesSize) {
+			ArraysCpu->Free(listp);
+			TmcStop(Timers, TMC_SuDivision);
+			TraceBegin_M("ResizeNp");
+			ResizeParticlesSize(Np + ndiv, PERIODIC_OVERMEMORYNP, false); // No particle sorting
+			TraceEnd_M("ResizeNp");
+			TmcStart(Timers, TMC_SuDivision);
 		}
 		else {
-			if (true) MarkedDivision37_M(mark_for_div, Np, Npb, DomCells, Idpc, Codec, Dcellc
-				, Posc, Velrhopc, Tauc_M, Divisionc_M, Porec_M, Massc_M, QuadFormc_M
-				, PosPrec, VelrhopPrec, TauPrec_M, MassPrec_M, QuadFormPrec_M, CellOffSpring, GradVelSave, VonMises,
-				StrainDotSave, AceSave);
-			else MarkedDivision34_M(mark_for_div.size(), Np, Npb, DomCells, Idpc, Codec, Dcellc
-				, Posc, Velrhopc, Tauc_M, Divisionc_M, Porec_M, Massc_M, QuadFormc_M
-				, PosPrec, VelrhopPrec, TauPrec_M, MassPrec_M, QuadFormPrec_M, CellOffSpring, GradVelSave, VonMises,
-				StrainDotSave, AceSave);
+			run = false;
+			TraceCounter_M("Divisions", ndiv);
+			if (ndiv) {
+				// 2. Cell division, daughters are created after Np and the next
+				// divide inserts them in their cells (see IncrementalDivide).
+				if (TStep == STEP_Verlet) {
+					MarkedDivision_M(ndiv, Np, Npb, DomCells, Idpc, Codec, Dcellc
+						, Posc, Velrhopc, Tauc_M, Divisionc_M, Porec_M, Massc_M, QuadFormc_M, VelrhopM1c, TauM1c_M, MassM1c_M, QuadFormM1c_M);
+					InvalidateTip_M();
+				}
+				else {
+					if (true) {
+						TimersReg->Start(TmsDivCreate);
+						MarkedDivision37_M(ndiv, listp, Np, Npb, DomCells, Idpc, Codec, Dcellc
+							, Posc, Velrhopc, Tauc_M, Divisionc_M, Porec_M, Massc_M, QuadFormc_M
+							, PosPrec, VelrhopPrec, TauPrec_M, MassPrec_M, QuadFormPrec_M, CellOffSpring,
+							StrainDotSave, AceSave, ForceVisc);
+						TimersReg->Stop(TmsDivCreate);
+						UpdateTipDivision_M(ndiv, listp, Np);
+					}
+					else {
+						MarkedDivision34_M(ndiv, Np, Npb, DomCells, Idpc, Codec, Dcellc
+							, Posc, Velrhopc, Tauc_M, Divisionc_M, Porec_M, Massc_M, QuadFormc_M
+							, PosPrec, VelrhopPrec, TauPrec_M, MassPrec_M, QuadFormPrec_M, CellOffSpring,
+							StrainDotSave, AceSave);
+						InvalidateTip_M();
+					}
+				}
+
+				// 3. Update Minimal number of ptcs
+				Np += ndiv;
+				NpMinimum = Np - unsigned(PartsOutMax * (Np - Npb));
+			}
+			ArraysCpu->Free(listp);
 		}
-
-		// 4, Update Minimal number of ptcs
-		Np += mark_for_div.size();
-		NpMinimum = Np - unsigned(PartsOutMax * (Np - Npb));
-		//mark_for_div.clear();
 	}
-
-	TmcStop(Timers, TMC_SuPeriodic);
-
+	TraceEnd_M("Division");
+	TmcStop(Timers, TMC_SuDivision);
 }
 
 // #V37 - #parallel fix
@@ -924,12 +974,13 @@ void JSphCpuSingle::RunSizeDivision12_M(double stepdt) {
 			else {
 				if (true) MarkedDivision34_M(count, Np, Npb, DomCells, Idpc, Codec, Dcellc
 					, Posc, Velrhopc, Tauc_M, Divisionc_M, Porec_M, Massc_M, QuadFormc_M
-					, PosPrec, VelrhopPrec, TauPrec_M, MassPrec_M, QuadFormPrec_M, CellOffSpring, GradVelSave, VonMises,
+					, PosPrec, VelrhopPrec, TauPrec_M, MassPrec_M, QuadFormPrec_M, CellOffSpring,
 					StrainDotSave, AceSave);
 
 
 			}
 			Np += count;
+			InvalidateTip_M();
 
 		}
 		// 4, Update Minimal number of ptcs
@@ -1038,11 +1089,12 @@ void JSphCpuSingle::RunSizeDivision_M2(double stepdt) {
 			else {
 				MarkedDivisionSymp11_M(count, Np, Npb, DomCells, Idpc, Codec, Dcellc
 					, Posc, Velrhopc, Tauc_M, Divisionc_M, Porec_M, Massc_M, QuadFormc_M
-					, PosPrec, VelrhopPrec, TauPrec_M, MassPrec_M, QuadFormPrec_M, CellOffSpring, GradVelSave, VonMises,
+					, PosPrec, VelrhopPrec, TauPrec_M, MassPrec_M, QuadFormPrec_M, CellOffSpring,
 					StrainDotSave);
 
 			}
 			Np += count;
+			InvalidateTip_M();
 
 		}
 	}
@@ -1071,8 +1123,8 @@ void JSphCpuSingle::RunDivisionDisplacement_M() {
 /// Random selection of particles
 //==============================================================================
 void JSphCpuSingle::SourceSelectedParticles_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
-	, unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3f *taup, float *porep, float *massp
-	, tfloat4 *velrhopm1, tsymatrix3f *taupm1)const
+	, unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3fsoa taup, float *porep, float *massp
+	, tfloat4 *velrhopm1, tsymatrix3fsoa taupm1)const
 {
 	const char met[] = "SourceSelectedParticles_M";
 	unsigned count = 0;
@@ -1144,8 +1196,8 @@ void JSphCpuSingle::SourceSelectedParticles_M(unsigned countMax, unsigned np, un
 /// Random selection of particles
 //==============================================================================
 void JSphCpuSingle::RandomDivDistance_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
-	, unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3f *taup, float *porep, float *massp
-	, tfloat4 *velrhopm1, tsymatrix3f *taupm1, tdouble3 location, float rateBirth, float sigma)const
+	, unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3fsoa taup, float *porep, float *massp
+	, tfloat4 *velrhopm1, tsymatrix3fsoa taupm1, tdouble3 location, float rateBirth, float sigma)const
 {
 	const char met[] = "RandomDivDistance_M";
 	unsigned count = 0;
@@ -1226,8 +1278,8 @@ void JSphCpuSingle::RandomDivDistance_M(unsigned countMax, unsigned np, unsigned
 /// Division of marked particles
 //==============================================================================
 void JSphCpuSingle::MarkedDivision_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
-	, unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3f *taup
-	, bool *divisionp, float *porep, float *massp, tfloat4 *velrhopm1, tsymatrix3f *taupm1, float *masspm1)const
+	, unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3fsoa taup
+	, bool *divisionp, float *porep, float *massp, tfloat4 *velrhopm1, tsymatrix3fsoa taupm1, float *masspm1)const
 {
 	const char met[] = "MarkedDivision_M";
 	unsigned count = 0;
@@ -1293,12 +1345,29 @@ void JSphCpuSingle::MarkedDivision_M(unsigned countMax, unsigned np, unsigned pi
 	}
 }
 
+//==============================================================================
+/// Returns the displacement of the two daughters of a particle with quadratic
+/// form qf and the quadratic form of the daughters in qfdiv. The smallest
+/// eigenvalue (longest axis of the ellipsoid) is multiplied by 4, so qfdiv is
+/// qf+3*lmin*v*v^T and the daughters are moved +/-v/sqrt(4*lmin).
+//==============================================================================
+inline tdouble3 JSphCpuSingle::DivisionAxis_M(const tsymatrix3f &qf, tsymatrix3f &qfdiv)const {
+	const tdouble3 eig = fmath::EigenValuesSym3x3(qf);
+	const tfloat3 v = fmath::EigenVectorSym3x3(qf, eig.x);
+	const float lmin = float(eig.x);
+	const float l3 = 3.f * lmin;
+	qfdiv = TSymatrix3f(qf.xx + l3 * v.x * v.x, qf.xy + l3 * v.x * v.y, qf.xz + l3 * v.x * v.z
+		, qf.yy + l3 * v.y * v.y, qf.yz + l3 * v.y * v.z, qf.zz + l3 * v.z * v.z);
+	const float ov = 1.f / sqrt(4.f * lmin);
+	return(TDouble3(v.x * ov, v.y * ov, v.z * ov));
+}
+
 //==============================================================================
 /// Division of marked particles with Quad form - Matthias
 //==============================================================================
 void JSphCpuSingle::MarkedDivision_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
-	, unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3f *taup
-	, bool *divisionp, float *porep, float *massp, tsymatrix3f *qfp, tfloat4 *velrhopm1, tsymatrix3f *taupm1, float *masspm1, tsymatrix3f *qfpm1)const
+	, unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3fsoa taup
+	, bool *divisionp, float *porep, float *massp, tsymatrix3fsoa qfp, tfloat4 *velrhopm1, tsymatrix3fsoa taupm1, float *masspm1, tsymatrix3fsoa qfpm1)const
 {
 	const char met[] = "MarkedDivision_M";
 	unsigned count = 0;
@@ -1309,37 +1378,10 @@ void JSphCpuSingle::MarkedDivision_M(unsigned countMax, unsigned np, unsigned pi
 		if (divisionp[p]) {
 			const unsigned pnew = np + count;
 
-			// Eigen resolution of qf[p], defintion of V, D
-			Matrix3f Qg;
-			Qg << qfpm1[p].xx, qfpm1[p].xy, qfpm1[p].xz, qfpm1[p].xy, qfpm1[p].yy, qfpm1[p].yz, qfpm1[p].xz, qfpm1[p].yz, qfpm1[p].zz;
-			EigenSolver<Matrix3f> es(Qg);
-
-			//printf("Max index\n");
-			// Index of maximal eigenvalue
-			float l0 = es.eigenvalues()[0].real();
-			float l1 = es.eigenvalues()[1].real();
-			float l2 = es.eigenvalues()[2].real();
-			unsigned i;
-			if (l0 < l1) {
-				if (l0 > l2) i = 2;
-				else i = 0;
-			}
-			else {
-				if (l1 > l2) i = 2;
-				else i = 1;
-			}
-
-
-			//printf("UpdateQ\n");
-			Matrix3f D = es.eigenvalues().real().asDiagonal();
-			Matrix3f V = es.eigenvectors().real();
-			D(i, i) *= 4.0;
-			Matrix3f Qt = V * D * V.transpose();
-
-			qfpm1[p] = TSymatrix3f(Qt(0, 0), Qt(0, 1), Qt(0, 2), Qt(1, 1), Qt(1, 2), Qt(2, 2));
-
-			// Update Pos
-			orientation = TDouble3(V(0, i) / sqrt(D(i, i)), V(1, i) / sqrt(D(i, i)), V(2, i) / sqrt(D(i, i)));
+			// Closed-form eigen decomposition of qfpm1[p], its longest axis is halved
+			tsymatrix3f qfdiv;
+			orientation = DivisionAxis_M(qfpm1[p], qfdiv);
+			qfpm1[p] = qfdiv;
 			tdouble3 ps = { pos[p].x + orientation.x, pos[p].y + orientation.y, pos[p].z + orientation.z };
 
 			//-Calculate coordinates of cell inside of domain / Calcula coordendas de celda dentro de dominio.
@@ -1394,9 +1436,9 @@ void JSphCpuSingle::MarkedDivision_M(unsigned countMax, unsigned np, unsigned pi
 // Division update 1: with float3 straindot save
 void JSphCpuSingle::MarkedDivisionSymp11_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
 	, unsigned* idp, typecode* code, unsigned* dcell
-	, tdouble3* pos, tfloat4* velrhop, tsymatrix3f* taup, bool* divisionp, float* porep, float* massp, tsymatrix3f* qfp
-	, tdouble3* pospre, tfloat4* velrhopre, tsymatrix3f* taupre, float* masspre, tsymatrix3f* qfpre
-	, unsigned* cellOSpr, float* straindot, float* vonMises, tfloat3* sds)const {
+	, tdouble3* pos, tfloat4* velrhop, tsymatrix3fsoa taup, bool* divisionp, float* porep, float* massp, tsymatrix3fsoa qfp
+	, tdouble3* pospre, tfloat4* velrhopre, tsymatrix3fsoa taupre, float* masspre, tsymatrix3fsoa qfpre
+	, unsigned* cellOSpr, tfloat3* sds)const {
 
 	const char met[] = "MarkedDivision_M";
 	unsigned count = 0;
@@ -1409,36 +1451,10 @@ void JSphCpuSingle::MarkedDivisionSymp11_M(unsigned countMax, unsigned np, unsig
 
 			const unsigned pnew = np + count;
 
-			// Eigen resolution of qf[p], defintion of V, D
-			Matrix3f Qg;
-			Qg << qfp[p].xx, qfp[p].xy, qfp[p].xz, qfp[p].xy, qfp[p].yy, qfp[p].yz, qfp[p].xz, qfp[p].yz, qfp[p].zz;
-			EigenSolver<Matrix3f> es(Qg);
-
-			//printf("Max index\n");
-			// Index of maximal eigenvalue
-			float l0 = es.eigenvalues()[0].real();
-			float l1 = es.eigenvalues()[1].real();
-			float l2 = es.eigenvalues()[2].real();
-			unsigned i;
-			if (l0 < l1) {
-				if (l0 > l2) i = 2;
-				else i = 0;
-			}
-			else {
-				if (l1 > l2) i = 2;
-				else i = 1;
-			}
-
-			//printf("UpdateQ\n");
-			Matrix3f D = es.eigenvalues().real().asDiagonal();
-			Matrix3f V = es.eigenvectors().real();
-			D(i, i) *= 4.0;
-			Matrix3f Qt = V * D * V.transpose();
-
-			qfp[p] = TSymatrix3f(Qt(0, 0), Qt(0, 1), Qt(0, 2), Qt(1, 1), Qt(1, 2), Qt(2, 2));
-
-			// Update Pos
-			orientation = TDouble3(V(0, i) / sqrt(D(i, i)), V(1, i) / sqrt(D(i, i)), V(2, i) / sqrt(D(i, i)));
+			// Closed-form eigen decomposition of qfp[p], its longest axis is halved
+			tsymatrix3f qfdiv;
+			orientation = DivisionAxis_M(qfp[p], qfdiv);
+			qfp[p] = qfdiv;
 			tdouble3 ps = { pos[p].x + orientation.x, pos[p].y + orientation.y, pos[p].z + orientation.z };
 
 			//-Calculate coordinates of cell inside of domain / Calcula coordendas de celda dentro de dominio.
@@ -1465,9 +1481,7 @@ void JSphCpuSingle::MarkedDivisionSymp11_M(unsigned countMax, unsigned np, unsig
 			qfp[pnew] = qfp[p];
 			divisionp[pnew] = false;
 			cellOSpr[pnew] = cellOSpr[p];
-			vonMises[pnew] = vonMises[p];
-			straindot[pnew] = straindot[p];
-			sds[pnew] = sds[p];
+			if (sds) sds[pnew] = sds[p];
 
 
 			// MOVE
@@ -1496,9 +1510,9 @@ void JSphCpuSingle::MarkedDivisionSymp11_M(unsigned countMax, unsigned np, unsig
 // Division v34d: with float3 ace save
 void JSphCpuSingle::MarkedDivision34_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
 	, unsigned* idp, typecode* code, unsigned* dcell
-	, tdouble3* pos, tfloat4* velrhop, tsymatrix3f* taup, bool* divisionp, float* porep, float* massp, tsymatrix3f* qfp
-	, tdouble3* pospre, tfloat4* velrhopre, tsymatrix3f* taupre, float* masspre, tsymatrix3f* qfpre
-	, unsigned* cellOSpr, float* straindot, float* vonMises, tfloat3* sds, tfloat3* ace)const {
+	, tdouble3* pos, tfloat4* velrhop, tsymatrix3fsoa taup, bool* divisionp, float* porep, float* massp, tsymatrix3fsoa qfp
+	, tdouble3* pospre, tfloat4* velrhopre, tsymatrix3fsoa taupre, float* masspre, tsymatrix3fsoa qfpre
+	, unsigned* cellOSpr, tfloat3* sds, tfloat3* ace)const {
 
 	const char met[] = "MarkedDivision_M";
 	unsigned count = 0;
@@ -1511,36 +1525,10 @@ void JSphCpuSingle::MarkedDivision34_M(unsigned countMax, unsigned np, unsigned
 
 			const unsigned pnew = np + count;
 
-			// Eigen resolution of qf[p], defintion of V, D
-			Matrix3f Qg;
-			Qg << qfp[p].xx, qfp[p].xy, qfp[p].xz, qfp[p].xy, qfp[p].yy, qfp[p].yz, qfp[p].xz, qfp[p].yz, qfp[p].zz;
-			EigenSolver<Matrix3f> es(Qg);
-
-			//printf("Max index\n");
-			// Index of maximal eigenvalue
-			float l0 = es.eigenvalues()[0].real();
-			float l1 = es.eigenvalues()[1].real();
-			float l2 = es.eigenvalues()[2].real();
-			unsigned i;
-			if (l0 < l1) {
-				if (l0 > l2) i = 2;
-				else i = 0;
-			}
-			else {
-				if (l1 > l2) i = 2;
-				else i = 1;
-			}
-
-			//printf("UpdateQ\n");
-			Matrix3f D = es.eigenvalues().real().asDiagonal();
-			Matrix3f V = es.eigenvectors().real();
-			D(i, i) *= 4.0;
-			Matrix3f Qt = V * D * V.transpose();
-
-			qfp[p] = TSymatrix3f(Qt(0, 0), Qt(0, 1), Qt(0, 2), Qt(1, 1), Qt(1, 2), Qt(2, 2));
-
-			// Update Pos
-			orientation = TDouble3(V(0, i) / sqrt(D(i, i)), V(1, i) / sqrt(D(i, i)), V(2, i) / sqrt(D(i, i)));
+			// Closed-form eigen decomposition of qfp[p], its longest axis is halved
+			tsymatrix3f qfdiv;
+			orientation = DivisionAxis_M(qfp[p], qfdiv);
+			qfp[p] = qfdiv;
 			tdouble3 ps = { pos[p].x + orientation.x, pos[p].y + orientation.y, pos[p].z + orientation.z };
 
 			//-Calculate coordinates of cell inside of domain / Calcula coordendas de celda dentro de dominio.
@@ -1567,9 +1555,8 @@ void JSphCpuSingle::MarkedDivision34_M(unsigned countMax, unsigned np, unsigned
 			qfp[pnew] = qfp[p];
 			divisionp[pnew] = false;
 			cellOSpr[pnew] = cellOSpr[p];
-			vonMises[pnew] = vonMises[p];
-			straindot[pnew] = straindot[p];
-			sds[pnew] = sds[p];
+			if (sds) sds[pnew] = sds[p];
+			if (ace) ace[pnew] = ace[p];
 
 
 			// MOVE
@@ -1597,9 +1584,9 @@ void JSphCpuSingle::MarkedDivision34_M(unsigned countMax, unsigned np, unsigned
 // Division v35c: with float3 #ForceVisc
 void JSphCpuSingle::MarkedDivision35_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
 	, unsigned* idp, typecode* code, unsigned* dcell
-	, tdouble3* pos, tfloat4* velrhop, tsymatrix3f* taup, bool* divisionp, float* porep, float* massp, tsymatrix3f* qfp
-	, tdouble3* pospre, tfloat4* velrhopre, tsymatrix3f* taupre, float* masspre, tsymatrix3f* qfpre
-	, unsigned* cellOSpr, float* straindot, float* vonMises, tfloat3* sds, tfloat3* ace, tfloat3* fvi)const {
+	, tdouble3* pos, tfloat4* velrhop, tsymatrix3fsoa taup, bool* divisionp, float* porep, float* massp, tsymatrix3fsoa qfp
+	, tdouble3* pospre, tfloat4* velrhopre, tsymatrix3fsoa taupre, float* masspre, tsymatrix3fsoa qfpre
+	, unsigned* cellOSpr, tfloat3* sds, tfloat3* ace, tfloat3* fvi)const {
 
 	const char met[] = "MarkedDivision_M";
 	unsigned count = 0;
@@ -1612,36 +1599,10 @@ void JSphCpuSingle::MarkedDivision35_M(unsigned countMax, unsigned np, unsigned
 
 			const unsigned pnew = np + count;
 
-			// Eigen resolution of qf[p], defintion of V, D
-			Matrix3f Qg;
-			Qg << qfp[p].xx, qfp[p].xy, qfp[p].xz, qfp[p].xy, qfp[p].yy, qfp[p].yz, qfp[p].xz, qfp[p].yz, qfp[p].zz;
-			EigenSolver<Matrix3f> es(Qg);
-
-			//printf("Max index\n");
-			// Index of maximal eigenvalue
-			float l0 = es.eigenvalues()[0].real();
-			float l1 = es.eigenvalues()[1].real();
-			float l2 = es.eigenvalues()[2].real();
-			unsigned i;
-			if (l0 < l1) {
-				if (l0 > l2) i = 2;
-				else i = 0;
-			}
-			else {
-				if (l1 > l2) i = 2;
-				else i = 1;
-			}
-
-			//printf("UpdateQ\n");
-			Matrix3f D = es.eigenvalues().real().asDiagonal();
-			Matrix3f V = es.eigenvectors().real();
-			D(i, i) *= 4.0;
-			Matrix3f Qt = V * D * V.transpose();
-
-			qfp[p] = TSymatrix3f(Qt(0, 0), Qt(0, 1), Qt(0, 2), Qt(1, 1), Qt(1, 2), Qt(2, 2));
-
-			// Update Pos
-			orientation = TDouble3(V(0, i) / sqrt(D(i, i)), V(1, i) / sqrt(D(i, i)), V(2, i) / sqrt(D(i, i)));
+			// Closed-form eigen decomposition of qfp[p], its longest axis is halved
+			tsymatrix3f qfdiv;
+			orientation = DivisionAxis_M(qfp[p], qfdiv);
+			qfp[p] = qfdiv;
 			tdouble3 ps = { pos[p].x + orientation.x, pos[p].y + orientation.y, pos[p].z + orientation.z };
 
 			//-Calculate coordinates of cell inside of domain / Calcula coordendas de celda dentro de dominio.
@@ -1668,11 +1629,9 @@ void JSphCpuSingle::MarkedDivision35_M(unsigned countMax, unsigned np, unsigned
 			qfp[pnew] = qfp[p];
 			divisionp[pnew] = false;
 			cellOSpr[pnew] = cellOSpr[p];
-			vonMises[pnew] = vonMises[p];
-			straindot[pnew] = straindot[p];
-			sds[pnew] = sds[p];
-			ace[pnew] = ace[p];
-			fvi[pnew] = fvi[p];
+			if (sds) sds[pnew] = sds[p];
+			if (ace) ace[pnew] = ace[p];
+			if (fvi) fvi[pnew] = fvi[p];
 
 
 			// MOVE
@@ -1700,99 +1659,80 @@ void JSphCpuSingle::MarkedDivision35_M(unsigned countMax, unsigned np, unsigned
 
 // Division v34d: with parallel acceleration
 // #parallel
-void JSphCpuSingle::MarkedDivision37_M(std::vector<int> mark, unsigned np, unsigned pini, tuint3 cellmax
+void JSphCpuSingle::MarkedDivision37_M(unsigned ndiv, const unsigned* mark, unsigned np, unsigned pini, tuint3 cellmax
 	, unsigned* idp, typecode* code, unsigned* dcell
-	, tdouble3* pos, tfloat4* velrhop, tsymatrix3f* taup, bool* divisionp, float* porep, float* massp, tsymatrix3f* qfp
-	, tdouble3* pospre, tfloat4* velrhopre, tsymatrix3f* taupre, float* masspre, tsymatrix3f* qfpre
-	, unsigned* cellOSpr, float* straindot, float* vonMises, tfloat3* sds, tfloat3* ace)const {
+	, tdouble3* pos, tfloat4* velrhop, tsymatrix3fsoa taup, bool* divisionp, float* porep, float* massp, tsymatrix3fsoa qfp
+	, tdouble3* pospre, tfloat4* velrhopre, tsymatrix3fsoa taupre, float* masspre, tsymatrix3fsoa qfpre
+	, unsigned* cellOSpr, tfloat3* sds, tfloat3* ace, tfloat3* fvi)const {
 
 	const char met[] = "MarkedDivision_M";
 
 
 #ifdef OMP_USE
-#pragma omp parallel for schedule (static)
+#pragma omp parallel
 #endif
-	for (int n = 0; n < mark.size(); n++) {
-		int p = mark.at(n);
-
-		// Eigen resolution of qf[p], defintion of V, D
-		Matrix3f Qg;
-		tdouble3 orientation;
-		Qg << qfp[p].xx, qfp[p].xy, qfp[p].xz, qfp[p].xy, qfp[p].yy, qfp[p].yz, qfp[p].xz, qfp[p].yz, qfp[p].zz;
-		EigenSolver<Matrix3f> es(Qg);
-
-		//printf("Max index\n");
-		// Index of maximal eigenvalue
-		float l0 = es.eigenvalues()[0].real();
-		float l1 = es.eigenvalues()[1].real();
-		float l2 = es.eigenvalues()[2].real();
-		unsigned i;
-		if (l0 < l1) {
-			if (l0 > l2) i = 2;
-			else i = 0;
-		}
-		else {
-			if (l1 > l2) i = 2;
-			else i = 1;
-		}
+	{
+		const JTimerRegistry::ThreadScope ths(TimersReg, TmsDivCreate);
+#ifdef OMP_USE
+#pragma omp for schedule (static) nowait
+#endif
+		for (int n = 0; n < int(ndiv); n++) {
+			const unsigned p = mark[n];
+
+			tdouble3 orientation;
+			// Closed-form eigen decomposition of qfp[p], its longest axis is halved
+			tsymatrix3f qfdiv;
+			orientation = DivisionAxis_M(qfp[p], qfdiv);
+			qfp[p] = qfdiv;
+			tdouble3 ps = { pos[p].x + orientation.x, pos[p].y + orientation.y, pos[p].z + orientation.z };
 
-		//printf("UpdateQ\n");
-		Matrix3f D = es.eigenvalues().real().asDiagonal();
-		Matrix3f V = es.eigenvectors().real();
-		D(i, i) *= 4.0;
-		Matrix3f Qt = V * D * V.transpose();
-
-		qfp[p] = TSymatrix3f(Qt(0, 0), Qt(0, 1), Qt(0, 2), Qt(1, 1), Qt(1, 2), Qt(2, 2));
-
-		// Update Pos
-		orientation = TDouble3(V(0, i) / sqrt(D(i, i)), V(1, i) / sqrt(D(i, i)), V(2, i) / sqrt(D(i, i)));
-		tdouble3 ps = { pos[p].x + orientation.x, pos[p].y + orientation.y, pos[p].z + orientation.z };
-
-		//-Calculate coordinates of cell inside of domain / Calcula coordendas de celda dentro de dominio.
-		unsigned cx = unsigned((ps.x - DomPosMin.x) / Scell);
-		unsigned cy = unsigned((ps.y - DomPosMin.y) / Scell);
-		unsigned cz = unsigned((ps.z - DomPosMin.z) / Scell);
-		//-Adjust coordinates of cell is they exceed maximum / Ajusta las coordendas de celda si sobrepasan el maximo.
-		cx = (cx <= cellmax.x ? cx : cellmax.x);
-		cy = (cy <= cellmax.y ? cy : cellmax.y);
-		cz = (cz <= cellmax.z ? cz : cellmax.z);
-
-		// Augustin -- CellOffSpring
-		cellOSpr[p]++;
-
-		//-Record position and cell of new particles /  Graba posicion y celda de nuevas particulas.
-		pos[np+n] = ps;
-		dcell[np + n] = PC__Cell(DomCellCode, cx, cy, cz);
-		idp[np + n] = Np + n;
-		code[np + n] = code[p];
-		velrhop[np + n] = velrhop[p];
-		taup[np + n] = taup[p];
-		porep[np + n] = porep[p];
-		massp[np + n] = massp[p] / 2;
-		qfp[np + n] = qfp[p];
-		divisionp[np + n] = false;
-		cellOSpr[np + n] = cellOSpr[p];
-		vonMises[np + n] = vonMises[p];
-		straindot[np + n] = straindot[p];
-		sds[np + n] = sds[p];
-
-
-		// MOVE
-		//-Get pos of particle to be duplicated / Obtiene pos de particula a duplicar.
-		ps = { pos[p].x - orientation.x, pos[p].y - orientation.y, pos[p].z - orientation.z };
-
-		//-Calculate coordinates of cell inside of domain / Calcula coordendas de celda dentro de dominio.
-		cx = unsigned((ps.x - DomPosMin.x) / Scell);
-		cy = unsigned((ps.y - DomPosMin.y) / Scell);
-		cz = unsigned((ps.z - DomPosMin.z) / Scell);
-		//-Adjust coordinates of cell is they exceed maximum / Ajusta las coordendas de celda si sobrepasan el maximo.
-		cx = (cx <= cellmax.x ? cx : cellmax.x);
-		cy = (cy <= cellmax.y ? cy : cellmax.y);
-		cz = (cz <= cellmax.z ? cz : cellmax.z);
-		pos[p] = ps;
-		dcell[p] = PC__Cell(DomCellCode, cx, cy, cz);
-		massp[p] = massp[np + n];
-		divisionp[p] = false;
+			//-Calculate coordinates of cell inside of domain / Calcula coordendas de celda dentro de dominio.
+			unsigned cx = unsigned((ps.x - DomPosMin.x) / Scell);
+			unsigned cy = unsigned((ps.y - DomPosMin.y) / Scell);
+			unsigned cz = unsigned((ps.z - DomPosMin.z) / Scell);
+			//-Adjust coordinates of cell is they exceed maximum / Ajusta las coordendas de celda si sobrepasan el maximo.
+			cx = (cx <= cellmax.x ? cx : cellmax.x);
+			cy = (cy <= cellmax.y ? cy : cellmax.y);
+			cz = (cz <= cellmax.z ? cz : cellmax.z);
+
+			// Augustin -- CellOffSpring
+			cellOSpr[p]++;
+
+			//-Record position and cell of new particles /  Graba posicion y celda de nuevas particulas.
+			pos[np+n] = ps;
+			dcell[np + n] = PC__Cell(DomCellCode, cx, cy, cz);
+			idp[np + n] = Np + n;
+			code[np + n] = code[p];
+			velrhop[np + n] = velrhop[p];
+			taup[np + n] = taup[p];
+			porep[np + n] = porep[p];
+			massp[np + n] = massp[p] / 2;
+			qfp[np + n] = qfp[p];
+			divisionp[np + n] = false;
+			cellOSpr[np + n] = cellOSpr[p];
+			//-Diagnostic fields (only in output steps).
+			if (sds) sds[np + n] = sds[p];
+			if (ace) ace[np + n] = ace[p];
+			if (fvi) fvi[np + n] = fvi[p];
+
+
+			// MOVE
+			//-Get pos of particle to be duplicated / Obtiene pos de particula a duplicar.
+			ps = { pos[p].x - orientation.x, pos[p].y - orientation.y, pos[p].z - orientation.z };
+
+			//-Calculate coordinates of cell inside of domain / Calcula coordendas de celda dentro de dominio.
+			cx = unsigned((ps.x - DomPosMin.x) / Scell);
+			cy = unsigned((ps.y - DomPosMin.y) / Scell);
+			cz = unsigned((ps.z - DomPosMin.z) / Scell);
+			//-Adjust coordinates of cell is they exceed maximum / Ajusta las coordendas de celda si sobrepasan el maximo.
+			cx = (cx <= cellmax.x ? cx : cellmax.x);
+			cy = (cy <= cellmax.y ? cy : cellmax.y);
+			cz = (cz <= cellmax.z ? cz : cellmax.z);
+			pos[p] = ps;
+			dcell[p] = PC__Cell(DomCellCode, cx, cy, cz);
+			massp[p] = massp[np + n];
+			divisionp[p] = false;
+		}
 	}
 }
 
@@ -1841,9 +1781,19 @@ void JSphCpuSingle::GetInteractionCells(unsigned rcell
 void JSphCpuSingle::Interaction_Forces(TpInter tinter){
 
   const char met[]="Interaction_Forces";
+  TraceBegin_M("PreForces");
   PreInteraction_Forces(tinter);
+  TraceEnd_M("PreForces");
+
+  //-Neighbour list shared by all the interaction passes (one per divide). #V38
+  TmcStart(Timers,TMC_NlNeighbours);
+  TraceBegin_M("Neighbours");
+  BuildNeighbourList_M(Np, CellDivSingle->GetNcells(), CellDivSingle->GetBeginCell(), CellDivSingle->GetCellDomainMin(), Dcellc, Posc, PsPosc);
+  TraceEnd_M("Neighbours");
+  TmcStop(Timers,TMC_NlNeighbours);
 
   TmcStart(Timers,TMC_CfForces);
+  TraceBegin_M("Forces");
 
   //-Interaction of Fluid-Fluid/Bound & Bound-Fluid (forces and DEM). | Interaccion Fluid-Fluid/Bound & Bound-Fluid (forces and DEM).
   float viscdt=0;
@@ -1855,6 +1805,9 @@ void JSphCpuSingle::Interaction_Forces(TpInter tinter){
   if (Psingle)JSphSolidCpu::Interaction_ForcesSimpSmall_M(Np, Npb, NpbOk, CellDivSingle->GetNcells(), CellDivSingle->GetBeginCell(), CellDivSingle->GetCellDomainMin(), Dcellc, PsPosc, Velrhopc, Idpc, Codec, Pressc, Porec_M, Massc_M, L_M, Co_M, viscdt, Arc, Acec, AceSave, Deltac, Tauc_M, StrainDotc_M, TauDotc_M, Spinc_M, ShiftPosc, ShiftDetectc);
   else JSphSolidCpu::Interaction_ForcesSmall_M(Np, Npb, NpbOk, CellDivSingle->GetNcells(), CellDivSingle->GetBeginCell(), CellDivSingle->GetCellDomainMin(), Dcellc, Posc, Velrhopc, Idpc, Codec, Pressc, Porec_M, Massc_M, L_M, Co_M, viscdt, Arc, Acec, AceSave, Deltac, Tauc_M, StrainDotc_M, TauDotc_M, Spinc_M, ShiftPosc, ShiftDetectc);
 
+  //-Add variable acceleration to Acec[] written by the interaction. | Añade la aceleracion variable a Acec[] calculado en la interaccion.
+  if(AccInput)AddAccInput();
+
 //-For 2-D simulations zero the 2nd component. | Para simulaciones 2D anula siempre la 2º componente.
   if(Simulate2D){
     const int ini=int(Npb),fin=int(Np),npf=int(Np-Npb);
@@ -1879,6 +1832,7 @@ void JSphCpuSingle::Interaction_Forces(TpInter tinter){
   //-Calculates maximum value of Ace.
   if(PeriActive!=0)AceMax=ComputeAceMaxOmp<true> (Np-Npb,Acec+Npb,Codec+Npb);
   else             AceMax=ComputeAceMaxOmp<false>(Np-Npb,Acec+Npb,Codec+Npb);
+  TraceEnd_M("Forces");
   TmcStop(Timers,TMC_CfForces);
 }
 
@@ -1965,6 +1919,7 @@ double JSphCpuSingle::ComputeStep_Ver() {
 
 	Interaction_Forces(INTER_Forces);    //-Interaction.
 	const double dt = DtVariable(true);    //-Calculate new dt.
+	if (DgReserve_M(dt))DgCapture_M(true); //-Diagnostic fields of output steps.
 	DemDtForce = dt;                       //(DEM)
 	if (TShifting)RunShifting(dt);        //-Shifting.
 	ComputeVerlet(dt);                   //-Update particles using Verlet.
@@ -1980,6 +1935,7 @@ double JSphCpuSingle::ComputeStep_Ver() {
 double JSphCpuSingle::ComputeStep_Eul_M() {
 	Interaction_Forces(INTER_Forces);    //-Interaction.
 	const double dt = DtVariable(true);    //-Calculate new dt.
+	if (DgReserve_M(dt))DgCapture_M(true); //-Diagnostic fields of output steps.
 	DemDtForce = dt;                       //(DEM)
 	if (TShifting)RunShifting(dt);        //-Shifting.
 	ComputeEuler_M(dt);                   //-Update particles using Verlet.
@@ -2004,32 +1960,43 @@ double JSphCpuSingle::ComputeStep_Sym(){
   
   //-Predictor
   //-----------
+  TraceBegin_M("Predictor");
   DemDtForce=dt*0.5f;                     //(DEM)
   Interaction_Forces(INTER_Forces);       //-Interaction.
   const double ddt_p=DtVariable(false);   //-Calculate dt of predictor step.
   if(TShifting)RunShifting(dt*.5);        //-Shifting. 
 
   //-Apply Symplectic-Predictor to particles - case compression or no
+  TraceBegin_M("SymplecticPre");
   ComputeSymplecticPre_M(ddt_p);
+  TraceEnd_M("SymplecticPre");
 
   if(CaseNfloat)RunFloating(dt*.5,true);  //-Control of floating bodies.
   PosInteraction_Forces();                //-Free memory used for interaction.
+  TraceEnd_M("Predictor");
 
   //-Corrector
   //-----------
+  TraceBegin_M("Corrector");
   DemDtForce=dt;                          //(DEM)
-  RunCellDivide(true);
+  RunCellDivideSkin(true);
+  const bool dgout=DgReserve_M(dt);       //-Diagnostic fields of output steps.
   Interaction_Forces(INTER_ForcesCorr);   //Interaction.
+  if(dgout)DgCapture_M(false);
   const double ddt_c=DtVariable(true);    //-Calculate dt of corrector step.
   if(TShifting)RunShifting(dt);           //-Shifting.
 
   //-Apply Symplectic-Corrector to particles - case compression or no
+  TraceBegin_M("SymplecticCorr");
   ComputeSymplecticCorr_M(ddt_p);            
+  TraceEnd_M("SymplecticCorr");
 
   if(CaseNfloat)RunFloating(dt,false);    //-Control of floating bodies.
   PosInteraction_Forces();                //-Free memory used for interaction.
+  TraceEnd_M("Corrector");
   
   DtPre=min(ddt_p,ddt_c);
+  TraceCounter_M("dt",dt);
 
   return(dt);
 }
@@ -2218,10 +2185,120 @@ void JSphCpuSingle::RunFloating(double dt,bool predictor){
         FtObjs[cf].fomega=fomega;
       }
     }
+    InvalidateTip_M();  //-Floating particles were moved after the tip was updated.
     TmcStop(Timers,TMC_SuFloating);
   }
 }
 
+//==============================================================================
+/// Returns true when the state at the end of the current step resumes
+/// bit-for-bit from a checkpoint: the particles were just sorted by a divide
+/// (the restart divide keeps that order, see LoadCheckpoint_M()) and there are
+/// no excluded particles waiting for the next PART.
+//==============================================================================
+bool JSphCpuSingle::CheckpointReady_M()const{
+  return(!NbList->GetCandValid() && !GetParticlesOutCount());
+}
+
+//==============================================================================
+/// Brings the state at the end of the step to one that CheckpointReady_M()
+/// accepts, so a stop request does not wait for it: divides when the skin kept
+/// the previous divide and stores the excluded particles waiting for the next
+/// PART with the current part number.
+/// The extra divide changes the order of the particles, so with NeighbourSkin
+/// the run resumed from this checkpoint is equivalent to the uninterrupted one
+/// but not bit-for-bit.
+//==============================================================================
+void JSphCpuSingle::PrepareCheckpoint_M(){
+  if(NbList->GetCandValid()){
+    Log->Print("  Divide forced by NeighbourSkin, the restart is not bit-for-bit.");
+    RunCellDivide(true);
+  }
+  if(GetParticlesOutCount()){
+    const unsigned nout=SaveDataCountOut_M();
+    PartOut+=nout;
+    Log->Printf("  Particles out: %u  (total: %u)",nout,PartOut);
+    SavePartOut_M();
+  }
+}
+
+//==============================================================================
+/// Writes the complete state of the simulation in Checkpoint.cbi4. The data is
+/// written to a temporary file that replaces the previous checkpoint at the
+/// end, so an interrupted write never leaves an invalid checkpoint.
+//==============================================================================
+void JSphCpuSingle::SaveCheckpoint_M(){
+  const char met[]="SaveCheckpoint_M";
+  TmcStart(Timers,TMC_SuSavePart);
+  const string file=DirOut+"Checkpoint.cbi4";
+  const string filetmp=file+".tmp";
+  JBinaryData bdat("RootSPH_Checkpoint");
+  bdat.SetvText("RunCode",RunCode);
+  bdat.SetvText("CaseName",CaseName);
+  SaveCheckpointData_M(&bdat);
+  bdat.SaveFile(filetmp,false,true);
+  //-The PARTs before the checkpoint must be complete. | Los PARTs previos deben estar completos.
+  if(SaveAsync)SaveAsync->Wait();
+#ifdef _WIN32
+  remove(file.c_str());
+#endif
+  if(rename(filetmp.c_str(),file.c_str()))RunException(met,"Cannot replace the checkpoint file.",file);
+  TmcStop(Timers,TMC_SuSavePart);
+  Log->Printf("  Checkpoint saved at t=%g (step %d, next part %d)",TimeStep,Nstep,Part);
+}
+
+//==============================================================================
+/// Replaces the particles and counters of the case with the ones stored in a
+/// checkpoint. The particles are in the order of the last divide, so the new
+/// divide does not change it and the simulation continues bit-for-bit (except
+/// after the divide forced by a stop with NeighbourSkin, see PrepareCheckpoint_M()).
+//==============================================================================
+void JSphCpuSingle::LoadCheckpoint_M(const std::string &file){
+  const char met[]="LoadCheckpoint_M";
+  if(!fun::FileExists(file))RunException(met,"The checkpoint file was not found.",file);
+  JBinaryData bdat;
+  bdat.OpenFileMapped(file,"RootSPH_Checkpoint");
+  const unsigned np=bdat.GetvUint("Np");
+  if(!CheckCpuParticlesSize(np))ResizeParticlesSize(np,PERIODIC_OVERMEMORYNP,false);
+  LoadCheckpointData_M(&bdat);
+  bdat.CloseFileStructure();
+  //-The divide can invalidate the tip, which is still valid for the stored positions.
+  const bool tipvalid=TipValid_M;
+  BoundChanged=true;
+  RunCellDivide(false);
+  TipValid_M=tipvalid;
+  Log->Printf("Restart from checkpoint \"%s\" at t=%g (step %d, next part %d)",file.c_str(),TimeStep,Nstep,Part);
+}
+
+//==============================================================================
+/// Signal received to stop the run with a checkpoint (0: none).
+/// The handler only records it, the main loop does the rest. It is installed
+/// again because signal() can reset it to the default action, and SLURM sends
+/// SIGTERM to the solver and to the batch script, which forwards it.
+//==============================================================================
+static volatile sig_atomic_t StopSignal_M=0;
+static void StopSignalHandler_M(int sig){ signal(sig,StopSignalHandler_M); StopSignal_M=sig; }
+
+//==============================================================================
+/// Returns true once SIGTERM or SIGUSR1 was received or the WallTime expired.
+/// The run then stops at the end of the same step with a checkpoint.
+//==============================================================================
+bool JSphCpuSingle::CheckStopRequest_M(){
+  if(!StopRequested){
+    string reason;
+    if(StopSignal_M)reason=(StopSignal_M==SIGTERM? "SIGTERM": "SIGUSR1");
+    else if(WallTime){
+      TimerTot.Stop();
+      if(TimerTot.GetElapsedTimeD()/1000.>=WallTime)reason="WallTime";
+    }
+    if(!reason.empty()){
+      StopRequested=true;
+      Log->Printf("  Stop requested by %s at t=%g (step %d), saving a checkpoint...",reason.c_str(),TimeStep,Nstep);
+    }
+  }
+  return(StopRequested);
+}
+
 //==============================================================================
 /// Initialises execution of simulation.
 /// Inicia ejecucion de simulacion.
@@ -2235,6 +2312,7 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
   //-Configure timers.
   //-------------------
   TmcCreation(Timers,cfg->SvTimers);
+  ConfigTimers_M(cfg->SvTimers);
   TmcStart(Timers,TMC_Init);
   
   // #Case
@@ -2245,6 +2323,10 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
   ConfigRunMode(cfg);
   VisuParticleSummary();
   InitRun_Uni_M();
+  const bool restart=!RestartFile.empty();
+  if((restart || CheckpointInterval || WallTime) && CaseNfloat)RunException(met,"Checkpoints are not supported with floating bodies.");
+  if(restart)LoadCheckpoint_M(RestartFile);
+  ConfigTrace_M();
 
 
   //-Free memory of PartsLoaded. | Libera memoria de PartsLoaded.
@@ -2253,8 +2335,13 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
 
   // Save step #Save
   int typeSave = 1;
+  if (SvAsync && typeSave == 1)SaveAsync = new JSphSaveAsync([this](JSphSnapshot& sn) {
+	  if (Trace)Trace->BeginTh(JTraceEvents::THWRITER, "WritePart");
+	  WriteSnapshot35_M(sn);
+	  if (Trace)Trace->EndTh(JTraceEvents::THWRITER, "WritePart");
+  });
   
-  switch (typeSave) {
+  if (!restart) switch (typeSave) { //-The PARTs up to the checkpoint were saved by the previous run.
   case 1: {
 	  SaveData35_M(); // 
 	  break;
@@ -2267,8 +2354,9 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
   
   PrintAllocMemory(GetAllocMemoryCpu());
   TmcResetValues(Timers);
+  TimersReg->ResetValues();
   TmcStop(Timers,TMC_Init);
-  PartNstep=-1; Part++;
+  if(!restart){ PartNstep=-1; Part++; }
 
 
   //-Main Loop.
@@ -2278,10 +2366,19 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
   bool partoutstop=false;
   TimerSim.Start();
   TimerPart.Start();
+  TimerCheckpoint.Start();
+  //-SIGTERM (SLURM time limit or preemption) and SIGUSR1 (sbatch --signal) stop the run with a checkpoint.
+  if(!CaseNfloat){
+    signal(SIGTERM,StopSignalHandler_M);
+  #ifndef _WIN32
+    signal(SIGUSR1,StopSignalHandler_M);
+  #endif
+  }
   Log->Print(string("\n[Initialising simulation (")+RunCode+")  "+fun::GetDateTime()+"]");
   PrintHeadPart();
 
   while(TimeStep<TimeMax){
+    TraceBegin_M("Step");
     if(ViscoTime)Visco=ViscoTime->GetVisco(float(TimeStep));
 
 	// Control of step - Matthias
@@ -2293,7 +2390,7 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
 	// Matthias - Cell division
 	if (true) RunSizeDivision37_M(stepdt);
 	else RunSizeDivision12_M(stepdt);
-	RunCellDivide(true);
+	RunCellDivideSkin(true);
 
     TimeStep+=stepdt;
 	partoutstop=(Np<NpMinimum || !Np);
@@ -2321,15 +2418,34 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
       TimerPart.Start();
     }
     UpdateMaxValues();
+    TraceEnd_M("Step");
+    TraceCounter_M("Np",Np);
     Nstep++;
+    const bool stop=(TimeStep<TimeMax && CheckStopRequest_M());
+    if(stop)PrepareCheckpoint_M();
+    if((CheckpointInterval || stop) && TimeStep<TimeMax && CheckpointReady_M()){
+      TimerCheckpoint.Stop();
+      if(stop || TimerCheckpoint.GetElapsedTimeD()/1000.>=CheckpointInterval){
+        SaveCheckpoint_M();
+        TimerCheckpoint.Start();
+      }
+      if(stop){ Preempted=true; break; }
+    }
     if(Part<=PartIni+1 && tc.CheckTime())Log->Print(string("  ")+tc.GetInfoFinish((TimeStep-TimeStepIni)/(TimeMax-TimeStepIni)));
 	//printf("End of step\n");
   }
   TimerSim.Stop(); TimerTot.Stop();
+  if(!CaseNfloat){
+    signal(SIGTERM,SIG_DFL);
+  #ifndef _WIN32
+    signal(SIGUSR1,SIG_DFL);
+  #endif
+  }
+  if(Preempted)Log->Printf("\nSimulation stopped at t=%g, it continues with -restart.",TimeStep);
 
   //-End of Simulation.
   //--------------------
-  FinishRun(partoutstop);
+  FinishRun(partoutstop || Preempted);
 }
 
 //==============================================================================
@@ -2427,6 +2543,7 @@ void JSphCpuSingle::SaveData12_M() {
 			, pore, press, mass, qf, vonMises, grVelSav, cellOSpr, gradvel, ace, NULL);
 		if (npnormal != npsave)RunException("SaveData", "The number of particles is invalid.");
 	}
+	DgFree_M(); //-Diagnostic fields are computed again for the next output.
 	//-Gather additional information. | Reune informacion adicional..
 	StInfoPartPlus infoplus;
 	memset(&infoplus, 0, sizeof(StInfoPartPlus));
@@ -2472,9 +2589,11 @@ void JSphCpuSingle::SaveData12_M() {
 // #35 - 07/07/20: Addition ForceVisc
 //==============================================================================
 void JSphCpuSingle::SaveData35_M() {
+	if (SaveAsync) { SaveDataAsync35_M(); return; }
 	const bool save = (SvData != SDAT_None && SvData != SDAT_Info);
 	const unsigned npsave = Np - NpbPer - NpfPer; //-Subtracts the periodic particles if they exist. | Resta las periodicas si las hubiera.
 	TmcStart(Timers, TMC_SuSavePart);
+	TraceBegin_M("SavePart");
 	//-Collect particle values in original order. | Recupera datos de particulas en orden original.
 	unsigned* idp = NULL;
 	tdouble3* pos = NULL;
@@ -2511,10 +2630,13 @@ void JSphCpuSingle::SaveData35_M() {
 		ace = ArraysCpu->ReserveFloat3();
 		fvi = ArraysCpu->ReserveFloat3();
 
+		TimersReg->Start(TmsSaveData);
 		unsigned npnormal = GetParticlesData35_M(Np, 0, true, PeriActive != 0, idp, pos, vel, rhop
 			, pore, press, mass, qf, vonMises, grVelSav, cellOSpr, gradvel, ace, fvi, NULL);
+		TimersReg->Stop(TmsSaveData);
 		if (npnormal != npsave)RunException("SaveData", "The number of particles is invalid.");
 	}
+	DgFree_M(); //-Diagnostic fields are computed again for the next output.
 	//-Gather additional information. | Reune informacion adicional..
 	StInfoPartPlus infoplus;
 	memset(&infoplus, 0, sizeof(StInfoPartPlus));
@@ -2552,15 +2674,143 @@ void JSphCpuSingle::SaveData35_M() {
 	ArraysCpu->Free(gradvel);
 	ArraysCpu->Free(ace);
 	ArraysCpu->Free(fvi);
+	TraceEnd_M("SavePart");
 	TmcStop(Timers, TMC_SuSavePart);
 }
 
 
+//==============================================================================
+/// Generates the output of SaveData35_M() with the writer thread of
+/// JSphSaveAsync. Only the copy of the particle data stops the simulation,
+/// the output fields are computed and stored by WriteSnapshot35_M().
+//==============================================================================
+void JSphCpuSingle::SaveDataAsync35_M() {
+	const bool save = (SvData != SDAT_None && SvData != SDAT_Info);
+	const unsigned npsave = Np - NpbPer - NpfPer; //-Subtracts the periodic particles if they exist. | Resta las periodicas si las hubiera.
+	TmcStart(Timers, TMC_SuSavePart);
+	TraceBegin_M("SavePart");
+	TimersReg->Start(TmsSaveWait);
+	JSphSnapshot* sn = SaveAsync->Reserve(); //-Waits when the writer is still storing the previous PARTs.
+	TimersReg->Stop(TmsSaveWait);
+	TimersReg->Start(TmsSaveData);
+	if (save)CopySnapshot_M(*sn);
+	else sn->Resize(0);
+	TimersReg->Stop(TmsSaveData);
+	DgFree_M(); //-Diagnostic fields are computed again for the next output.
+	//-Gather additional information. | Reune informacion adicional..
+	StInfoPartPlus infoplus;
+	memset(&infoplus, 0, sizeof(StInfoPartPlus));
+	if (SvData & SDAT_Info) {
+		infoplus.nct = CellDivSingle->GetNct();
+		infoplus.npbin = NpbOk;
+		infoplus.npbout = Npb - NpbOk;
+		infoplus.npf = Np - Npb;
+		infoplus.npbper = NpbPer;
+		infoplus.npfper = NpfPer;
+		infoplus.memorycpualloc = this->GetAllocMemoryCpu();
+		infoplus.gpudata = false;
+		TimerSim.Stop();
+		infoplus.timesim = TimerSim.GetElapsedTimeD() / 1000.;
+	}
+	const tdouble3 vdom[2] = { OrderDecode(CellDivSingle->GetDomainLimits(true)),OrderDecode(CellDivSingle->GetDomainLimits(false)) };
+	const unsigned nout = SaveDataCountOut_M();
+	sn->Head = GetPartHead_M(npsave, nout, vdom, &infoplus);
+	sn->OnlyNormal = (PeriActive != 0);
+	sn->TipX = MaxPosition().x;
+	SaveAsync->Push(sn);
+	//-Excluded particles and floatings are stored by the main thread.
+	SavePartOut_M();
+	SaveDataEnd_M(npsave, nout, 1, vdom);
+	TraceEnd_M("SavePart");
+	TmcStop(Timers, TMC_SuSavePart);
+}
+
+//==============================================================================
+/// Copies the particle data in cell order to the snapshot.
+//==============================================================================
+void JSphCpuSingle::CopySnapshot_M(JSphSnapshot& sn)const {
+	const int n = int(Np);
+	sn.Resize(Np);
+#ifdef OMP_USE
+#pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+#endif
+	for (int p = 0; p < n; p++) {
+		sn.Idp[p] = Idpc[p];
+		sn.Code[p] = Codec[p];
+		sn.Pos[p] = Posc[p];
+		sn.Velrhop[p] = Velrhopc[p];
+		sn.Pore[p] = Porec_M[p];
+		sn.Mass[p] = Massc_M[p];
+		sn.Qf[p] = QuadFormc_M[p];
+		sn.Tau[p] = Tauc_M[p];
+		sn.CellOSpr[p] = CellOffSpring[p];
+		//-Diagnostic fields are zero when they were not computed in the last step.
+		sn.StrainDot[p] = (StrainDotSave ? StrainDotSave[p] : TFloat3(0));
+		sn.Ace[p] = (AceSave ? AceSave[p] : TFloat3(0));
+		sn.Fvi[p] = (ForceVisc ? ForceVisc[p] : TFloat3(0));
+	}
+}
+
+//==============================================================================
+/// Computes the output fields of the snapshot and stores its PART files.
+/// Called by the writer thread of JSphSaveAsync, so it only uses the
+/// snapshot and the configuration of the case.
+//==============================================================================
+void JSphCpuSingle::WriteSnapshot35_M(JSphSnapshot& sn)const {
+	const unsigned n = sn.Np;
+	if (!n) { //-Only information of the PART (see SaveDataAsync35_M()).
+		SavePartFiles35_M(sn.Head, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+		return;
+	}
+	ComputePress_M(n, sn.Pos, sn.Velrhop, sn.TipX, sn.Press);
+	for (unsigned p = 0; p < n; p++) {
+		const tfloat4 vr = sn.Velrhop[p];
+		sn.Vel[p] = TFloat3(vr.x, vr.y, vr.z);
+		sn.Rhop[p] = vr.w;
+		sn.VonMises[p] = VonMises_M(sn.Tau[p]);
+		const tfloat3 sd = sn.StrainDot[p];
+		sn.GradVel[p] = sd.x + sd.y + sd.z;
+	}
+	//-Eliminate non-normal particles (periodic & others). | Elimina particulas no normales (periodicas y otras).
+	unsigned npok = n;
+	if (sn.OnlyNormal) {
+		npok = 0;
+		for (unsigned p = 0; p < n; p++)if (CODE_IsNormal(sn.Code[p])) {
+			if (npok != p) {
+				sn.Idp[npok] = sn.Idp[p];
+				sn.Pos[npok] = sn.Pos[p];
+				sn.Vel[npok] = sn.Vel[p];
+				sn.Rhop[npok] = sn.Rhop[p];
+				sn.Pore[npok] = sn.Pore[p];
+				sn.Press[npok] = sn.Press[p];
+				sn.Mass[npok] = sn.Mass[p];
+				sn.Qf[npok] = sn.Qf[p];
+				sn.VonMises[npok] = sn.VonMises[p];
+				sn.GradVel[npok] = sn.GradVel[p];
+				sn.CellOSpr[npok] = sn.CellOSpr[p];
+				sn.StrainDot[npok] = sn.StrainDot[p];
+				sn.Ace[npok] = sn.Ace[p];
+				sn.Fvi[npok] = sn.Fvi[p];
+			}
+			npok++;
+		}
+	}
+	if (npok != sn.Head.npok)RunException("WriteSnapshot35_M", "The number of particles is invalid.");
+	//-Reorder components in their original order. | Reordena componentes en su orden original.
+	DecodeCellOrder(npok, sn.Pos, sn.Vel);
+	SavePartFiles35_M(sn.Head, sn.Idp, sn.Pos, sn.Vel, sn.Rhop, sn.Pore, sn.Press, sn.Mass, sn.Qf
+		, sn.VonMises, sn.GradVel, sn.CellOSpr, sn.StrainDot, sn.Ace, sn.Fvi);
+}
+
 //==============================================================================
 /// Displays and stores final summary of the execution.
 /// Muestra y graba resumen final de ejecucion.
 //==============================================================================
 void JSphCpuSingle::FinishRun(bool stop){
+  if(SaveAsync){
+    SaveAsync->Wait();
+    Log->Printf("Time waiting for the writer of PART files: %.3f s",SaveAsync->GetWaitTime());
+  }
   float tsim=TimerSim.GetElapsedTimeF()/1000.f,ttot=TimerTot.GetElapsedTimeF()/1000.f;
   JSph::ShowResume(stop,tsim,ttot,true,"");
   Log->Print(" ");
@@ -2571,6 +2821,7 @@ void JSphCpuSingle::FinishRun(bool stop){
     Log->Print(" ");
   }
   if(SvRes)SaveRes(tsim,ttot,hinfo,dinfo);
+  SaveTrace_M();
   Log->PrintFilesList();
   Log->PrintWarningList();
 }
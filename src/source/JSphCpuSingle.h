@@ -29,6 +29,8 @@
 
 class JCellDivCpuSingle;
 class JPartsLoad4;
+class JSphSaveAsync;
+class JSphSnapshot;
 
 //##############################################################################
 //# JSphCpuSingle
@@ -40,6 +42,10 @@ class JSphCpuSingle : public JSphSolidCpu
 protected:
   JCellDivCpuSingle* CellDivSingle;
   JPartsLoad4* PartsLoaded;
+  JSphSaveAsync* SaveAsync;  ///<Writer thread of PART files (only with SvAsync and SaveData35_M).
+  JTimer TimerCheckpoint;    ///<Measures the wall-clock time since the last checkpoint.
+  bool StopRequested;        ///<A signal or the WallTime asked to stop at the next checkpoint.
+  bool Preempted;            ///<The run stopped before TimeMax after saving a checkpoint.
 
   llong GetAllocMemoryCpu()const;
   void UpdateMaxValues();
@@ -62,6 +68,7 @@ protected:
   void RunPeriodic();
 
   void RunCellDivide(bool updateperiodic);
+  void RunCellDivideSkin(bool updateperiodic);
   // Matthias - Cell division
   void RunRandomDivision_M();
   //Mathis - Cell Divison stepdt
@@ -71,38 +78,40 @@ protected:
   void RunDivisionDisplacement_M();
 
   void SourceSelectedParticles_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
-	  , unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3f *taup, float *porep, float *massp
-	  , tfloat4 *velrhopm1, tsymatrix3f *taupm1)const;
+	  , unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3fsoa taup, float *porep, float *massp
+	  , tfloat4 *velrhopm1, tsymatrix3fsoa taupm1)const;
   void RandomDivDistance_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
-	  , unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3f *taup, float *porep, float *massp
-	  , tfloat4 *velrhopm1, tsymatrix3f *taupm1, tdouble3 location, float rateBirth, float sigma)const;
+	  , unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3fsoa taup, float *porep, float *massp
+	  , tfloat4 *velrhopm1, tsymatrix3fsoa taupm1, tdouble3 location, float rateBirth, float sigma)const;
+  inline tdouble3 DivisionAxis_M(const tsymatrix3f &qf, tsymatrix3f &qfdiv)const;
   void MarkedDivision_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
-	  , unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3f *taup
-	  , bool *divisionp, float *porep, float *massp, tfloat4 *velrhopm1, tsymatrix3f *taupm1, float *masspm1)const;
+	  , unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3fsoa taup
+	  , bool *divisionp, float *porep, float *massp, tfloat4 *velrhopm1, tsymatrix3fsoa taupm1, float *masspm1)const;
 
   void MarkedDivision_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
-	  , unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3f *taup
-	  , bool *divisionp, float *porep, float *massp, tsymatrix3f *qfp, tfloat4 *velrhopm1, tsymatrix3f *taupm1, float *masspm1, tsymatrix3f *qfpm1)const;
+	  , unsigned *idp, typecode *code, unsigned *dcell, tdouble3 *pos, tfloat4 *velrhop, tsymatrix3fsoa taup
+	  , bool *divisionp, float *porep, float *massp, tsymatrix3fsoa qfp, tfloat4 *velrhopm1, tsymatrix3fsoa taupm1, float *masspm1, tsymatrix3fsoa qfpm1)const;
 
   void MarkedDivisionSymp11_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
 	  , unsigned* idp, typecode* code, unsigned* dcell
-	  , tdouble3* pos, tfloat4* velrhop, tsymatrix3f* taup, bool* divisionp, float* porep, float* massp, tsymatrix3f* qfp
-	  , tdouble3* pospre, tfloat4* velrhopre, tsymatrix3f* taupre, float* masspre, tsymatrix3f* qfpre
-	  , unsigned* cellOSpr, float* straindot, float* vonMises, tfloat3* sds)const;
+	  , tdouble3* pos, tfloat4* velrhop, tsymatrix3fsoa taup, bool* divisionp, float* porep, float* massp, tsymatrix3fsoa qfp
+	  , tdouble3* pospre, tfloat4* velrhopre, tsymatrix3fsoa taupre, float* masspre, tsymatrix3fsoa qfpre
+	  , unsigned* cellOSpr, tfloat3* sds)const;
 
   void MarkedDivision34_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
 	  , unsigned* idp, typecode* code, unsigned* dcell
-	  , tdouble3* pos, tfloat4* velrhop, tsymatrix3f* taup, bool* divisionp, float* porep, float* massp, tsymatrix3f* qfp
-	  , tdouble3* pospre, tfloat4* velrhopre, tsymatrix3f* taupre, float* masspre, tsymatrix3f* qfpre
-	  , unsigned* cellOSpr, float* straindot, float* vonMises, tfloat3* sds, tfloat3* ace)const;
+	  , tdouble3* pos, tfloat4* velrhop, tsymatrix3fsoa taup, bool* divisionp, float* porep, float* massp, tsymatrix3fsoa qfp
+	  , tdouble3* pospre, tfloat4* velrhopre, tsymatrix3fsoa taupre, float* masspre, tsymatrix3fsoa qfpre
+	  , unsigned* cellOSpr, tfloat3* sds, tfloat3* ace)const;
 
   void MarkedDivision35_M(unsigned countMax, unsigned np, unsigned pini, tuint3 cellmax
 	  , unsigned* idp, typecode* code, unsigned* dcell
-	  , tdouble3* pos, tfloat4* velrhop, tsymatrix3f* taup, bool* divisionp, float* porep, float* massp, tsymatrix3f* qfp
-	  , tdouble3* pospre, tfloat4* velrhopre, tsymatrix3f* taupre, float* masspre, tsymatrix3f* qfpre
-	  , unsigned* cellOSpr, float* straindot, float* vonMises, tfloat3* sds, tfloat3* ace, tfloat3* fvi)const;
+	  , tdouble3* pos, tfloat4* velrhop, tsymatrix3fsoa taup, bool* divisionp, float* porep, float* massp, tsymatrix3fsoa qfp
+	  , tdouble3* pospre, tfloat4* velrhopre, tsymatrix3fsoa taupre, float* masspre, tsymatrix3fsoa qfpre
+	  , unsigned* cellOSpr, tfloat3* sds, tfloat3* ace, tfloat3* fvi)const;
 
-  void MarkedDivision37_M(std::vector<int> mark, unsigned np, unsigned pini, tuint3 cellmax, unsigned* idp, typecode* code, unsigned* dcell, tdouble3* pos, tfloat4* velrhop, tsymatrix3f* taup, bool* divisionp, float* porep, float* massp, tsymatrix3f* qfp, tdouble3* pospre, tfloat4* velrhopre, tsymatrix3f* taupre, float* masspre, tsymatrix3f* qfpre, unsigned* cellOSpr, float* straindot, float* vonMises, tfloat3* sds, tfloat3* ace) const;
+  unsigned MarkDivisionList37_M(unsigned n, unsigned pini, const float* massp, float masslimit, unsigned* listp)const;
+  void MarkedDivision37_M(unsigned ndiv, const unsigned* mark, unsigned np, unsigned pini, tuint3 cellmax, unsigned* idp, typecode* code, unsigned* dcell, tdouble3* pos, tfloat4* velrhop, tsymatrix3fsoa taup, bool* divisionp, float* porep, float* massp, tsymatrix3fsoa qfp, tdouble3* pospre, tfloat4* velrhopre, tsymatrix3fsoa taupre, float* masspre, tsymatrix3fsoa qfpre, unsigned* cellOSpr, tfloat3* sds, tfloat3* ace, tfloat3* fvi) const;
 
   void AbortBoundOut();
 
@@ -131,12 +140,21 @@ protected:
   void SaveData();
   void SaveData12_M();
   void SaveData35_M();
+  void SaveDataAsync35_M();
+  void CopySnapshot_M(JSphSnapshot& sn)const;
+  void WriteSnapshot35_M(JSphSnapshot& sn)const;
+  bool CheckpointReady_M()const;
+  void PrepareCheckpoint_M();
+  void SaveCheckpoint_M();
+  void LoadCheckpoint_M(const std::string &file);
+  bool CheckStopRequest_M();
   void FinishRun(bool stop);
 
 public:
   JSphCpuSingle();
   ~JSphCpuSingle();
   void Run(std::string appname,JCfgRun *cfg,JLog2 *log);
+  bool GetPreempted()const{ return(Preempted); }
 
 };
 
@@ -0,0 +1,89 @@
+//HEAD_DSPH
+/*
+<DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+This file is part of DualSPHysics.
+
+DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphEos_M.h \brief Tait equation of state with the exponent fixed at compile time.
+/// When gamma is an integer in [1,EOS_MAXGAMMA] the power (rhop/rhopzero)^gamma
+/// is computed by repeated squaring (gexp=gamma), otherwise pow() is used
+/// (gexp=0). The exponent of the case is selected once with EosGammaExp_M().
+
+#ifndef _JSphEos_M_
+#define _JSphEos_M_
+
+#include <cmath>
+
+#define EOS_MAXGAMMA 7   ///<Maximum integer gamma with specialised power.
+
+//==============================================================================
+/// Returns x^n by repeated squaring.
+//==============================================================================
+template<unsigned n> inline float EosPowInt_M(float x){
+  const float h=EosPowInt_M<n/2>(x);
+  return(n&1? h*h*x: h*h);
+}
+template<> inline float EosPowInt_M<0>(float){ return(1.f); }
+
+//==============================================================================
+/// Returns the exponent gexp used for gamma (0 when it is not integral).
+//==============================================================================
+inline unsigned EosGammaExp_M(float gamma){
+  const int g=int(gamma);
+  return(float(g)==gamma && g>=1 && g<=EOS_MAXGAMMA? unsigned(g): 0);
+}
+
+//##############################################################################
+//# JTaitEos_M
+//##############################################################################
+/// \brief Pressure of the solid press=k/gamma*((rhop/rhopzero)^gamma-1) where
+/// k is the bulk modulus at the position of the particle (JSph::CalcK()).
+template<unsigned gexp> class JTaitEos_M
+{
+protected:
+  const float Gamma;      ///<Polytropic constant (gexp when gexp!=0).
+  const float RhopZero;   ///<Reference density.
+
+public:
+  JTaitEos_M(float gamma,float rhopzero):Gamma(gexp? float(gexp): gamma),RhopZero(rhopzero){}
+
+  inline float Pow(float rhop_r0)const{ return(gexp? EosPowInt_M<gexp>(rhop_r0): pow(rhop_r0,Gamma)); }
+
+  //==============================================================================
+  /// Returns the pressure of density rhop for the bulk modulus k.
+  //==============================================================================
+  inline float Press(float k,float rhop)const{ return(k/Gamma*(Pow(rhop/RhopZero)-1.0f)); }
+};
+
+//==============================================================================
+/// Returns the pressure selecting the exponent at runtime (for use out of
+/// the particle loops).
+//==============================================================================
+inline float TaitEosPress_M(unsigned gexp,float gamma,float rhopzero,float k,float rhop){
+  switch(gexp){
+    case 1: return(JTaitEos_M<1>(gamma,rhopzero).Press(k,rhop));
+    case 2: return(JTaitEos_M<2>(gamma,rhopzero).Press(k,rhop));
+    case 3: return(JTaitEos_M<3>(gamma,rhopzero).Press(k,rhop));
+    case 4: return(JTaitEos_M<4>(gamma,rhopzero).Press(k,rhop));
+    case 5: return(JTaitEos_M<5>(gamma,rhopzero).Press(k,rhop));
+    case 6: return(JTaitEos_M<6>(gamma,rhopzero).Press(k,rhop));
+    case 7: return(JTaitEos_M<7>(gamma,rhopzero).Press(k,rhop));
+  }
+  return(JTaitEos_M<0>(gamma,rhopzero).Press(k,rhop));
+}
+
+#endif
+
+
@@ -0,0 +1,246 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphSaveAsync.cpp \brief Implements the classes \ref JSphSnapshot and \ref JSphSaveAsync.
+
+#include "JSphSaveAsync.h"
+#include "OmpDefs.h"
+#include <cstring>
+#include <chrono>
+
+using namespace std;
+
+//##############################################################################
+//# JSphSnapshot
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphSnapshot::JSphSnapshot(){
+  ClassName="JSphSnapshot";
+  Idp=NULL; Code=NULL; Pos=NULL; Velrhop=NULL;
+  Pore=NULL; Mass=NULL; Qf=NULL; Tau=NULL; CellOSpr=NULL;
+  StrainDot=NULL; Ace=NULL; Fvi=NULL;
+  Vel=NULL; Rhop=NULL; Press=NULL; VonMises=NULL; GradVel=NULL;
+  Size=Np=0;
+  memset(&Head,0,sizeof(JSph::StPartHead_M));
+  TipX=0;
+  OnlyNormal=false;
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSphSnapshot::~JSphSnapshot(){
+  DestructorActive=true;
+  FreeMemory();
+}
+
+//==============================================================================
+/// Frees allocated memory.
+//==============================================================================
+void JSphSnapshot::FreeMemory(){
+  delete[] Idp;       Idp=NULL;
+  delete[] Code;      Code=NULL;
+  delete[] Pos;       Pos=NULL;
+  delete[] Velrhop;   Velrhop=NULL;
+  delete[] Pore;      Pore=NULL;
+  delete[] Mass;      Mass=NULL;
+  delete[] Qf;        Qf=NULL;
+  delete[] Tau;       Tau=NULL;
+  delete[] CellOSpr;  CellOSpr=NULL;
+  delete[] StrainDot; StrainDot=NULL;
+  delete[] Ace;       Ace=NULL;
+  delete[] Fvi;       Fvi=NULL;
+  delete[] Vel;       Vel=NULL;
+  delete[] Rhop;      Rhop=NULL;
+  delete[] Press;     Press=NULL;
+  delete[] VonMises;  VonMises=NULL;
+  delete[] GradVel;   GradVel=NULL;
+  Size=Np=0;
+}
+
+//==============================================================================
+/// Prepares the snapshot for np particles, memory is only allocated when
+/// np exceeds the current size.
+//==============================================================================
+void JSphSnapshot::Resize(unsigned np){
+  if(np>Size){
+    FreeMemory();
+    const unsigned size=np+np/10+1;
+    try{
+      Idp=new unsigned[size];
+      Code=new typecode[size];
+      Pos=new tdouble3[size];
+      Velrhop=new tfloat4[size];
+      Pore=new float[size];
+      Mass=new float[size];
+      Qf=new tsymatrix3f[size];
+      Tau=new tsymatrix3f[size];
+      CellOSpr=new unsigned[size];
+      StrainDot=new tfloat3[size];
+      Ace=new tfloat3[size];
+      Fvi=new tfloat3[size];
+      Vel=new tfloat3[size];
+      Rhop=new float[size];
+      Press=new float[size];
+      VonMises=new float[size];
+      GradVel=new float[size];
+    }
+    catch(const std::bad_alloc){
+      FreeMemory();
+      RunException("Resize","Could not allocate the requested memory.");
+    }
+    Size=size;
+  }
+  Np=np;
+}
+
+//==============================================================================
+/// Returns the allocated memory.
+//==============================================================================
+llong JSphSnapshot::GetAllocMemory()const{
+  const llong s=sizeof(unsigned)*2+sizeof(typecode)+sizeof(tdouble3)+sizeof(tfloat4)
+    +sizeof(float)*6+sizeof(tsymatrix3f)*2+sizeof(tfloat3)*4;
+  return(s*Size);
+}
+
+//##############################################################################
+//# JSphSaveAsync
+//##############################################################################
+//==============================================================================
+/// Constructor. Starts the writer thread with nsnaps snapshots (min=2).
+//==============================================================================
+JSphSaveAsync::JSphSaveAsync(TpFnSave fnsave,unsigned nsnaps):FnSave(fnsave){
+  ClassName="JSphSaveAsync";
+  Writing=false;
+  Stop=false;
+  WaitTime=0;
+  const unsigned n=(nsnaps<2? 2: nsnaps);
+  for(unsigned c=0;c<n;c++){
+    Snaps.push_back(new JSphSnapshot);
+    SnapsFree.push_back(Snaps[c]);
+  }
+  Writer=std::thread(&JSphSaveAsync::RunWriter,this);
+}
+
+//==============================================================================
+/// Destructor. Writes the queued snapshots and finishes the writer thread.
+//==============================================================================
+JSphSaveAsync::~JSphSaveAsync(){
+  DestructorActive=true;
+  {
+    std::lock_guard<std::mutex> lock(Mtx);
+    Stop=true;
+  }
+  CvQueue.notify_one();
+  if(Writer.joinable())Writer.join();
+  for(unsigned c=0;c<unsigned(Snaps.size());c++)delete Snaps[c];
+  Snaps.clear();
+}
+
+//==============================================================================
+/// Loop of the writer thread. The files are stored without OpenMP so the
+/// threads of the simulation are not disturbed.
+//==============================================================================
+void JSphSaveAsync::RunWriter(){
+#ifdef OMP_USE
+  omp_set_num_threads(1);
+#endif
+  std::unique_lock<std::mutex> lock(Mtx);
+  while(true){
+    CvQueue.wait(lock,[this]{ return(Stop || !Queue.empty()); });
+    if(Queue.empty())break;
+    JSphSnapshot *snap=Queue.front();
+    Queue.pop_front();
+    Writing=true;
+    lock.unlock();
+    string err;
+    try{
+      FnSave(*snap);
+    }
+    catch(const std::exception &e){ err=e.what(); }
+    catch(...){ err="Unknown error storing the PART files."; }
+    lock.lock();
+    if(!err.empty() && Error.empty())Error=err;
+    Writing=false;
+    SnapsFree.push_back(snap);
+    CvFree.notify_all();
+  }
+}
+
+//==============================================================================
+/// Throws the error of the writer thread (call with Mtx locked).
+//==============================================================================
+void JSphSaveAsync::CheckError(const char *met){
+  if(!Error.empty()){
+    const string err=Error;
+    Error="";
+    RunException(met,string("Error in the writer thread: ")+err);
+  }
+}
+
+//==============================================================================
+/// Returns a free snapshot, waits for the writer when all of them are in use.
+//==============================================================================
+JSphSnapshot* JSphSaveAsync::Reserve(){
+  std::unique_lock<std::mutex> lock(Mtx);
+  if(SnapsFree.empty()){
+    const std::chrono::steady_clock::time_point t0=std::chrono::steady_clock::now();
+    CvFree.wait(lock,[this]{ return(!SnapsFree.empty()); });
+    WaitTime+=std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+  }
+  CheckError("Reserve");
+  JSphSnapshot *snap=SnapsFree.back();
+  SnapsFree.pop_back();
+  return(snap);
+}
+
+//==============================================================================
+/// Queues a snapshot obtained with Reserve() to be written.
+//==============================================================================
+void JSphSaveAsync::Push(JSphSnapshot *snap){
+  {
+    std::lock_guard<std::mutex> lock(Mtx);
+    Queue.push_back(snap);
+  }
+  CvQueue.notify_one();
+}
+
+//==============================================================================
+/// Waits until all the queued snapshots are written.
+//==============================================================================
+void JSphSaveAsync::Wait(){
+  std::unique_lock<std::mutex> lock(Mtx);
+  if(!Queue.empty() || Writing){
+    const std::chrono::steady_clock::time_point t0=std::chrono::steady_clock::now();
+    CvFree.wait(lock,[this]{ return(Queue.empty() && !Writing); });
+    WaitTime+=std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+  }
+  CheckError("Wait");
+}
+
+//==============================================================================
+/// Returns the allocated memory.
+//==============================================================================
+llong JSphSaveAsync::GetAllocMemory()const{
+  llong s=0;
+  for(unsigned c=0;c<unsigned(Snaps.size());c++)s+=Snaps[c]->GetAllocMemory();
+  return(s);
+}
+
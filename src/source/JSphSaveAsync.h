@@ -0,0 +1,125 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphSaveAsync.h \brief Declares the classes \ref JSphSnapshot and \ref JSphSaveAsync.
+
+#ifndef _JSphSaveAsync_
+#define _JSphSaveAsync_
+
+#include "JSph.h"
+#include <string>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//##############################################################################
+//# JSphSnapshot
+//##############################################################################
+/// \brief Copy of the particle data of one PART in cell order (periodic
+/// particles included). The arrays keep their size between PARTs so the
+/// copy does not allocate memory once the number of particles is stable.
+
+class JSphSnapshot : protected JObject
+{
+protected:
+  unsigned Size;            ///<Number of particles with reserved memory.
+  void FreeMemory();
+
+public:
+  unsigned Np;              ///<Number of particles in the snapshot.
+  JSph::StPartHead_M Head;  ///<Values of the PART, set by the main thread. The writer checks npok against the particles it keeps.
+  float TipX;               ///<Position of the tip used for the pressure.
+  bool OnlyNormal;          ///<Removes the non-normal particles (periodic).
+
+  //-Copy of the particle arrays [Np].
+  unsigned *Idp;
+  typecode *Code;
+  tdouble3 *Pos;
+  tfloat4 *Velrhop;
+  float *Pore;
+  float *Mass;
+  tsymatrix3f *Qf;
+  tsymatrix3f *Tau;
+  unsigned *CellOSpr;
+  tfloat3 *StrainDot;       ///<Diagnostic fields, zero when they were not computed (see JSphSolidCpu::DgReserve_M()).
+  tfloat3 *Ace;
+  tfloat3 *Fvi;
+
+  //-Fields computed by the writer from the copy [Np].
+  tfloat3 *Vel;
+  float *Rhop;
+  float *Press;
+  float *VonMises;
+  float *GradVel;
+
+  JSphSnapshot();
+  ~JSphSnapshot();
+  void Resize(unsigned np);
+  llong GetAllocMemory()const;
+};
+
+//##############################################################################
+//# JSphSaveAsync
+//##############################################################################
+/// \brief Writes the PART files in a background thread.
+/// The main thread takes a free snapshot with Reserve(), copies the particle
+/// data and queues it with Push(). The writer thread calls the save function
+/// for each queued snapshot and returns it to the pool. When all snapshots
+/// are in use Reserve() waits until the oldest one is written (backpressure).
+/// Errors of the writer are thrown again in the main thread by the next call
+/// to Reserve() or Wait().
+
+class JSphSaveAsync : protected JObject
+{
+public:
+  typedef std::function<void(JSphSnapshot&)> TpFnSave;
+
+protected:
+  const TpFnSave FnSave;       ///<Function that stores the files of one snapshot.
+  std::vector<JSphSnapshot*> Snaps;      ///<Pool of snapshots.
+  std::vector<JSphSnapshot*> SnapsFree;  ///<Snapshots available for Reserve().
+  std::deque<JSphSnapshot*> Queue;       ///<Snapshots waiting to be written.
+  bool Writing;                ///<The writer is storing a snapshot.
+  bool Stop;                   ///<The writer thread must finish.
+  std::string Error;           ///<Error of the writer thread.
+  double WaitTime;             ///<Seconds waited by the main thread for the writer.
+
+  std::mutex Mtx;
+  std::condition_variable CvQueue;  ///<Notifies the writer of new snapshots.
+  std::condition_variable CvFree;   ///<Notifies the main thread of written snapshots.
+  std::thread Writer;
+
+  void RunWriter();
+  void CheckError(const char *met);
+
+public:
+  JSphSaveAsync(TpFnSave fnsave,unsigned nsnaps=2);
+  ~JSphSaveAsync();
+  JSphSnapshot* Reserve();
+  void Push(JSphSnapshot *snap);
+  void Wait();
+  llong GetAllocMemory()const;
+  double GetWaitTime()const{ return(WaitTime); }
+};
+
+#endif
+
+
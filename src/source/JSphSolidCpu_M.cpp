@@ -20,6 +20,7 @@ You should have received a copy of the GNU Lesser General Public License along w
 
 #include "JSphSolidCpu_M.h"
 #include "JCellDivCpu.h"
+#include "JNeighbourListCpu.h"
 #include "JPartFloatBi4.h"
 #include "Functions.h"
 #include "JSphMotion.h"
@@ -29,6 +30,8 @@ You should have received a copy of the GNU Lesser General Public License along w
 #include "JSaveDt.h"
 #include "JTimeOut.h"
 #include "JSphAccInput.h"
+#include "JBinaryData.h"
+#include "JTimerRegistry.h"
 #include "TypesDef.h"
 
 #include <climits>
@@ -42,8 +45,12 @@ JSphSolidCpu::JSphSolidCpu(bool withmpi) :JSph(true, withmpi) {
 	ClassName = "JSphSolidCpu";
 	CellDiv = NULL;
 	ArraysCpu = new JArraysCpu;
+	NbList = new JNeighbourListCpu;
+	TimersReg = new JTimerRegistry;
+	Trace = NULL;
 	InitVars();
 	TmcCreation(Timers, false);
+	ConfigTimers_M(false);
 }
 
 //==============================================================================
@@ -54,7 +61,10 @@ JSphSolidCpu::~JSphSolidCpu() {
 	FreeCpuMemoryParticles();
 	FreeCpuMemoryFixed();
 	delete ArraysCpu;
+	delete NbList;
 	TmcDestruction(Timers);
+	delete TimersReg;
+	delete Trace; Trace = NULL;
 }
 
 //=============================================================================
@@ -63,6 +73,7 @@ JSphSolidCpu::~JSphSolidCpu() {
 void JSphSolidCpu::InitVars() {
 	RunMode = "";
 	OmpThreads = 1;
+	SimdMode = SIMD_None; SimdForcesFnc = NULL;
 
 	Np = Npb = NpbOk = 0;
 	NpbPer = NpfPer = 0;
@@ -75,10 +86,11 @@ void JSphSolidCpu::InitVars() {
 	SpsTauc = NULL; SpsGradvelc = NULL; //-Laminar+SPS. 
 										// Matthias
 
-	Tauc_M = NULL; StrainDotc_M = NULL; // Jaumann Solid
-	TauM1c_M = NULL;
+	Tauc_M = TSymatrix3fSoa(); StrainDotc_M = TSymatrix3fSoa(); // Jaumann Solid
+	TauM1c_M = TSymatrix3fSoa();
 	MassM1c_M = NULL;
-	TauDotc_M = NULL; Spinc_M = NULL; // Jaumann Solid
+	TauPrec_M = TSymatrix3fSoa(); MassPrec_M = NULL; QuadFormPrec_M = TSymatrix3fSoa(); //-Symplectic
+	TauDotc_M = TSymatrix3fSoa(); Spinc_M = TSymatrix3fSoa(); // Jaumann Solid
 
 	Arc = NULL; Acec = NULL; Deltac = NULL;
 	ShiftPosc = NULL; ShiftDetectc = NULL; //-Shifting.
@@ -88,14 +100,15 @@ void JSphSolidCpu::InitVars() {
 	Porec_M = NULL;
 	Massc_M = NULL;
 	Divisionc_M = NULL;
-	QuadFormc_M = NULL;	QuadFormM1c_M = NULL;
+	QuadFormc_M = TSymatrix3fSoa();	QuadFormM1c_M = TSymatrix3fSoa();
 	L_M = NULL; Co_M = NULL;
-	VonMises = NULL;
-	GradVelSave = NULL;
+	SymAce_M = NULL; SymGrad_M = NULL; SymAr_M = NULL;
 	CellOffSpring = NULL;
 	StrainDotSave = NULL;
 	AceSave = NULL;
 	ForceVisc = NULL;
+	maxPosX = 0;
+	TipPos_M = TFloat3(0); TipIdp_M = TUint3(UINT_MAX); TipValid_M = false;
 
 	RidpMove = NULL;
 	FtRidp = NULL;
@@ -147,6 +160,7 @@ void JSphSolidCpu::FreeCpuMemoryParticles() {
 	CpuParticlesSize = 0;
 	MemCpuParticles = 0;
 	ArraysCpu->Reset();
+	NbList->Reset();
 }
 
 //==============================================================================
@@ -161,6 +175,11 @@ void JSphSolidCpu::AllocCpuMemoryParticles(unsigned np, float over) {
 	CpuParticlesSize = np2 + PARTICLES_OVERMEMORY_MIN;
 	//-Define number or arrays to use. | Establece numero de arrays a usar.
 	ArraysCpu->SetArraySize(CpuParticlesSize);
+	//-Destination of the arrays reordered after divide. | Destino de los arrays reordenados tras el divide.
+	ConfigSortArrays_M();
+	for (unsigned c = 0; c < unsigned(SortRegister.size()); c++) {
+		ArraysCpu->AddArrayCount(JArraysCpu::TpArraySize(SortRegister[c].ptr ? SortRegister[c].size : sizeof(tsymatrix3f)), 1);
+	}
 #ifdef CODE_SIZE4
 	ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B, 2);  //-code,code2
 #else
@@ -200,11 +219,13 @@ void JSphSolidCpu::AllocCpuMemoryParticles(unsigned np, float over) {
 	ArraysCpu->AddArrayCount(JArraysCpu::SIZE_24B, 4); //-JauGradvel, JauTau2, Omega and Taudot, QuadForm
 	ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B, 7); // SaveFields
 	ArraysCpu->AddArrayCount(JArraysCpu::SIZE_36B, 1); // Matrix3f L_M
+	if (NlSymmetric) {
+		ArraysCpu->AddArrayCount(JArraysCpu::SIZE_36B, 2); // SymAce_M, SymGrad_M
+		ArraysCpu->AddArrayCount(JArraysCpu::SIZE_12B, 1); // SymAr_M
+	}
 	// Augustin
-	ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B, 1); // VonMises3D
-	ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B, 1); // GradVelSave
 	ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B, 1); // CellOffSpring
-	ArraysCpu->AddArrayCount(JArraysCpu::SIZE_12B, 6); // Grad vel save, ace save, ForceVisc, ForceVisc(Save)
+	ArraysCpu->AddArrayCount(JArraysCpu::SIZE_12B, 6); // Diagnostic fields StrainDotSave, AceSave, ForceVisc and their copies in SaveData
 
 	//-Shows the allocated memory.
 	MemCpuParticles = ArraysCpu->GetAllocMemoryCpu();
@@ -235,8 +256,6 @@ void JSphSolidCpu::ResizeCpuMemoryParticles(unsigned npnew) {
 	tsymatrix3f *jautaum12 = SaveArrayCpu(Np, TauM1c_M);
 	tsymatrix3f *quadform = SaveArrayCpu(Np, QuadFormc_M);
 	tsymatrix3f *quadformm1 = SaveArrayCpu(Np, QuadFormM1c_M);
-	float         *vonMises = SaveArrayCpu(Np, VonMises);
-	float  	      *gradVelSav = SaveArrayCpu(Np, GradVelSave);
 	unsigned      *cellOSpr = SaveArrayCpu(Np, CellOffSpring);
 	tfloat3      *sds= SaveArrayCpu(Np, StrainDotSave);
 	tfloat3		*aces = SaveArrayCpu(Np, AceSave);
@@ -261,8 +280,6 @@ void JSphSolidCpu::ResizeCpuMemoryParticles(unsigned npnew) {
 	ArraysCpu->Free(TauM1c_M);
 	ArraysCpu->Free(QuadFormc_M);
 	ArraysCpu->Free(QuadFormM1c_M);
-	ArraysCpu->Free(VonMises);
-	ArraysCpu->Free(GradVelSave);
 	ArraysCpu->Free(CellOffSpring);
 	ArraysCpu->Free(StrainDotSave);
 	ArraysCpu->Free(AceSave);
@@ -288,13 +305,11 @@ void JSphSolidCpu::ResizeCpuMemoryParticles(unsigned npnew) {
 	Porec_M = ArraysCpu->ReserveFloat();
 	Massc_M = ArraysCpu->ReserveFloat();
 	if (massm1) MassM1c_M = ArraysCpu->ReserveFloat();
-	Tauc_M = ArraysCpu->ReserveSymatrix3f();
-	if (jautaum12) TauM1c_M = ArraysCpu->ReserveSymatrix3f();
-	QuadFormc_M = ArraysCpu->ReserveSymatrix3f();
-	if (quadformm1) QuadFormM1c_M = ArraysCpu->ReserveSymatrix3f();
+	Tauc_M = ArraysCpu->ReserveSymatrix3fSoa();
+	if (jautaum12) TauM1c_M = ArraysCpu->ReserveSymatrix3fSoa();
+	QuadFormc_M = ArraysCpu->ReserveSymatrix3fSoa();
+	if (quadformm1) QuadFormM1c_M = ArraysCpu->ReserveSymatrix3fSoa();
 	// Augustin
-	if (vonMises) VonMises = ArraysCpu->ReserveFloat();
-	if (gradVelSav) GradVelSave = ArraysCpu->ReserveFloat();
 	if (cellOSpr) CellOffSpring = ArraysCpu->ReserveUint();
 	if (sds) StrainDotSave = ArraysCpu->ReserveFloat3();
 	if (aces) AceSave = ArraysCpu->ReserveFloat3();
@@ -319,8 +334,6 @@ void JSphSolidCpu::ResizeCpuMemoryParticles(unsigned npnew) {
 	RestoreArrayCpu(Np, jautaum12, TauM1c_M);
 	RestoreArrayCpu(Np, quadform, QuadFormc_M);
 	RestoreArrayCpu(Np, quadformm1, QuadFormM1c_M);
-	RestoreArrayCpu(Np, vonMises, VonMises);
-	RestoreArrayCpu(Np, gradVelSav, GradVelSave);
 	RestoreArrayCpu(Np, cellOSpr, CellOffSpring);
 	RestoreArrayCpu(Np, sds, StrainDotSave);
 	RestoreArrayCpu(Np, aces, AceSave);
@@ -331,6 +344,227 @@ void JSphSolidCpu::ResizeCpuMemoryParticles(unsigned npnew) {
 	MemCpuParticles = ArraysCpu->GetAllocMemoryCpu();
 }
 
+//==============================================================================
+/// Adds an array to the list of particle arrays reordered after each divide.
+/// The address of the pointer is stored so arrays can be reserved, swapped or
+/// freed later (NULL arrays are ignored in SortParticleArrays_M()).
+//==============================================================================
+void JSphSolidCpu::RegisterSortArray_M(const char *name, void **ptr, unsigned size) {
+	StSortRegister r = { name, ptr, NULL, size };
+	SortRegister.push_back(r);
+}
+
+//==============================================================================
+/// Adds a SoA array to the list of particle arrays reordered after each divide.
+//==============================================================================
+void JSphSolidCpu::RegisterSortArray_M(const char *name, tsymatrix3fsoa *soa) {
+	StSortRegister r = { name, NULL, soa, unsigned(sizeof(float)) };
+	SortRegister.push_back(r);
+}
+
+//==============================================================================
+/// Defines the particle arrays reordered after each divide. New particle data
+/// only needs to be added here to keep its order and to be stored in the
+/// checkpoints (see SaveCheckpointData_M()).
+/// Define los arrays de particulas que se reordenan tras cada divide.
+//==============================================================================
+void JSphSolidCpu::ConfigSortArrays_M() {
+	SortRegister.clear();
+	RegisterSortArray_M("Idp", &Idpc);
+	RegisterSortArray_M("Code", &Codec);
+	RegisterSortArray_M("Dcell", &Dcellc);
+	RegisterSortArray_M("Pos", &Posc);
+	RegisterSortArray_M("Velrhop", &Velrhopc);
+	if (TStep == STEP_Verlet) {
+		RegisterSortArray_M("VelrhopM1", &VelrhopM1c);
+		RegisterSortArray_M("TauM1", &TauM1c_M);
+		RegisterSortArray_M("MassM1", &MassM1c_M);
+		RegisterSortArray_M("QuadFormM1", &QuadFormM1c_M);
+	}
+	else if (TStep == STEP_Symplectic) {
+		RegisterSortArray_M("PosPre", &PosPrec);
+		RegisterSortArray_M("VelrhopPre", &VelrhopPrec);
+		RegisterSortArray_M("MassPre", &MassPrec_M);
+		RegisterSortArray_M("TauPre", &TauPrec_M);
+		RegisterSortArray_M("QuadFormPre", &QuadFormPrec_M);
+	}
+	if (TVisco == VISCO_LaminarSPS)RegisterSortArray_M("SpsTau", &SpsTauc);
+	// Matthias
+	RegisterSortArray_M("Tau", &Tauc_M);
+	RegisterSortArray_M("Mass", &Massc_M);
+	RegisterSortArray_M("Division", &Divisionc_M);
+	RegisterSortArray_M("Pore", &Porec_M);
+	RegisterSortArray_M("QuadForm", &QuadFormc_M);
+	// Augustin
+	RegisterSortArray_M("CellOffSpring", &CellOffSpring);
+	//-Diagnostic fields are NULL (and not sorted) out of the output steps.
+	RegisterSortArray_M("StrainDotSave", &StrainDotSave);
+	RegisterSortArray_M("AceSave", &AceSave);
+	RegisterSortArray_M("ForceVisc", &ForceVisc);
+}
+
+//==============================================================================
+/// Reorders all the registered particle arrays with the SortPart of the last
+/// divide. Each array is gathered in a new array of ArraysCpu in one fused
+/// pass and then the pointers are swapped and the old arrays are freed.
+/// Reordena todos los arrays de particulas registrados.
+//==============================================================================
+void JSphSolidCpu::SortParticleArrays_M(JCellDivCpu *celldiv) {
+	if (celldiv->GetSortIdentity())return; //-No particle changed its position.
+	const unsigned nreg = unsigned(SortRegister.size());
+	std::vector<StSortArrayCpu> arrays;
+	std::vector<void*> newptr(nreg, NULL);
+	std::vector<tsymatrix3fsoa> newsoa(nreg, TSymatrix3fSoa());
+	arrays.reserve(nreg * 6);
+	for (unsigned c = 0; c < nreg; c++) {
+		const StSortRegister &r = SortRegister[c];
+		if (r.ptr && *r.ptr) {
+			newptr[c] = ArraysCpu->Reserve(JArraysCpu::TpArraySize(r.size));
+			const StSortArrayCpu a = { *r.ptr, newptr[c], r.size };
+			arrays.push_back(a);
+		}
+		else if (!r.ptr && !r.soa->IsNull()) {
+			newsoa[c] = ArraysCpu->ReserveSymatrix3fSoa();
+			for (unsigned cs = 0; cs < 6; cs++) {
+				const StSortArrayCpu a = { r.soa->Stream(cs), newsoa[c].Stream(cs), r.size };
+				arrays.push_back(a);
+			}
+		}
+	}
+	if (!arrays.empty())celldiv->SortArrays(unsigned(arrays.size()), &arrays[0]);
+	for (unsigned c = 0; c < nreg; c++) {
+		const StSortRegister &r = SortRegister[c];
+		if (newptr[c]) {
+			ArraysCpu->Free(JArraysCpu::TpArraySize(r.size), *r.ptr);
+			*r.ptr = newptr[c];
+		}
+		else if (!newsoa[c].IsNull()) {
+			ArraysCpu->Free(*r.soa);
+			*r.soa = newsoa[c];
+		}
+	}
+}
+
+//==============================================================================
+/// Stores in bdat the state needed to resume the simulation: the registered
+/// particle arrays of [0,Np) in their current order (SoA tensors by stream)
+/// and the counters of particles and time control.
+//==============================================================================
+void JSphSolidCpu::SaveCheckpointData_M(JBinaryData *bdat)const {
+	const char met[] = "SaveCheckpointData_M";
+	static const char* soastream[6] = { "xx","xy","xz","yy","yz","zz" };
+	bdat->SetvUint("CaseNp", CaseNp);
+	bdat->SetvInt("TStep", int(TStep));
+	bdat->SetvInt("TVisco", int(TVisco));
+	bdat->SetvUint("Np", Np);
+	bdat->SetvUint("Npb", Npb);
+	bdat->SetvUint("NpbOk", NpbOk);
+	bdat->SetvUint("NpbPer", NpbPer);
+	bdat->SetvUint("NpfPer", NpfPer);
+	bdat->SetvUint("NpMinimum", NpMinimum);
+	bdat->SetvUllong("TotalNp", TotalNp);
+	bdat->SetvUint("IdMax", IdMax);
+	bdat->SetvInt("PartIni", PartIni);
+	bdat->SetvInt("Part", Part);
+	bdat->SetvInt("Nstep", Nstep);
+	bdat->SetvInt("PartNstep", PartNstep);
+	bdat->SetvUint("PartOut", PartOut);
+	bdat->SetvUint("OutPosCount", GetOutPosCount());
+	bdat->SetvUint("OutRhopCount", GetOutRhopCount());
+	bdat->SetvUint("OutMoveCount", GetOutMoveCount());
+	bdat->SetvInt("VerletStep", VerletStep);
+	bdat->SetvUint("DtModif", DtModif);
+	bdat->SetvDouble("TimeStepIni", TimeStepIni);
+	bdat->SetvDouble("TimeStep", TimeStep);
+	bdat->SetvDouble("TimeStepM1", TimeStepM1);
+	bdat->SetvDouble("TimePartNext", TimePartNext);
+	bdat->SetvDouble("DtIni", DtIni);
+	bdat->SetvDouble("DtPre", DtPre);
+	bdat->SetvDouble("PartDtMin", PartDtMin);
+	bdat->SetvDouble("PartDtMax", PartDtMax);
+	bdat->SetvFloat("MaxPosX", maxPosX);
+	bdat->SetvBool("TipValid", TipValid_M);
+	bdat->SetvFloat3("TipPos", TipPos_M);
+	bdat->SetvUint3("TipIdp", TipIdp_M);
+	for (unsigned c = 0; c < unsigned(SortRegister.size()); c++) {
+		const StSortRegister &r = SortRegister[c];
+		if (r.ptr && *r.ptr) {
+			if (ullong(Np) * r.size >= UINT_MAX)RunException(met, "The array is too big for a checkpoint.");
+			bdat->CreateArray(r.name, JBinaryDataDef::DatUchar, Np * r.size, *r.ptr, true);
+		}
+		else if (!r.ptr && !r.soa->IsNull()) {
+			for (unsigned cs = 0; cs < 6; cs++)bdat->CreateArray(string(r.name) + "_" + soastream[cs], JBinaryDataDef::DatFloat, Np, r.soa->Stream(cs), true);
+		}
+	}
+}
+
+//==============================================================================
+/// Restores the state stored by SaveCheckpointData_M(). The registered arrays
+/// missing in bdat are freed (e.g. diagnostic fields) and the stored ones are
+/// reserved when they are NULL. CpuParticlesSize must be enough for Np.
+//==============================================================================
+void JSphSolidCpu::LoadCheckpointData_M(JBinaryData *bdat) {
+	const char met[] = "LoadCheckpointData_M";
+	static const char* soastream[6] = { "xx","xy","xz","yy","yz","zz" };
+	if (bdat->GetvUint("CaseNp") != CaseNp)RunException(met, "The checkpoint belongs to a different case.");
+	if (bdat->GetvInt("TStep") != int(TStep) || bdat->GetvInt("TVisco") != int(TVisco))RunException(met, "The time stepping or viscosity of the checkpoint do not match the configuration of the case.");
+	const unsigned np = bdat->GetvUint("Np");
+	if (!CheckCpuParticlesSize(np))RunException(met, "The memory for particles is not enough.");
+	for (unsigned c = 0; c < unsigned(SortRegister.size()); c++) {
+		const StSortRegister &r = SortRegister[c];
+		if (r.ptr) {
+			JBinaryDataArray *ar = bdat->GetArray(r.name);
+			if (!ar) {
+				ArraysCpu->Free(JArraysCpu::TpArraySize(r.size), *r.ptr);
+				*r.ptr = NULL;
+				continue;
+			}
+			if (!*r.ptr)*r.ptr = ArraysCpu->Reserve(JArraysCpu::TpArraySize(r.size));
+			if (ar->GetDataCopy(np * r.size, *r.ptr) != np * r.size)RunException(met, string("The size of array ") + r.name + " is invalid.");
+		}
+		else {
+			const bool stored = (bdat->GetArray(string(r.name) + "_" + soastream[0]) != NULL);
+			if (!stored) {
+				if (!r.soa->IsNull()) { ArraysCpu->Free(*r.soa); *r.soa = TSymatrix3fSoa(); }
+				continue;
+			}
+			if (r.soa->IsNull())*r.soa = ArraysCpu->ReserveSymatrix3fSoa();
+			for (unsigned cs = 0; cs < 6; cs++) {
+				JBinaryDataArray *ar = bdat->GetArray(string(r.name) + "_" + soastream[cs]);
+				if (!ar || ar->GetDataCopy(np, r.soa->Stream(cs)) != np)RunException(met, string("The size of array ") + r.name + " is invalid.");
+			}
+		}
+	}
+	Np = np;
+	Npb = bdat->GetvUint("Npb");
+	NpbOk = bdat->GetvUint("NpbOk");
+	NpbPer = bdat->GetvUint("NpbPer");
+	NpfPer = bdat->GetvUint("NpfPer");
+	NpMinimum = bdat->GetvUint("NpMinimum");
+	TotalNp = bdat->GetvUllong("TotalNp");
+	IdMax = bdat->GetvUint("IdMax");
+	PartIni = bdat->GetvInt("PartIni");
+	Part = bdat->GetvInt("Part");
+	Nstep = bdat->GetvInt("Nstep");
+	PartNstep = bdat->GetvInt("PartNstep");
+	PartOut = bdat->GetvUint("PartOut");
+	SetOutCount_M(bdat->GetvUint("OutPosCount"), bdat->GetvUint("OutRhopCount"), bdat->GetvUint("OutMoveCount"));
+	VerletStep = bdat->GetvInt("VerletStep");
+	DtModif = bdat->GetvUint("DtModif");
+	TimeStepIni = bdat->GetvDouble("TimeStepIni");
+	TimeStep = bdat->GetvDouble("TimeStep");
+	TimeStepM1 = bdat->GetvDouble("TimeStepM1");
+	TimePartNext = bdat->GetvDouble("TimePartNext");
+	DtIni = bdat->GetvDouble("DtIni");
+	DtPre = bdat->GetvDouble("DtPre");
+	PartDtMin = bdat->GetvDouble("PartDtMin");
+	PartDtMax = bdat->GetvDouble("PartDtMax");
+	maxPosX = bdat->GetvFloat("MaxPosX");
+	TipValid_M = bdat->GetvBool("TipValid");
+	TipPos_M = bdat->GetvFloat3("TipPos");
+	TipIdp_M = bdat->GetvUint3("TipIdp");
+}
+
 //==============================================================================
 /// Saves a CPU array in CPU memory. 
 //==============================================================================
@@ -356,6 +590,31 @@ template<class T> void JSphSolidCpu::TRestoreArrayCpu(unsigned np, T *data, T *d
 	delete[] data;
 }
 
+//==============================================================================
+/// Saves the streams of a tsymatrix3fsoa array in CPU memory (as tsymatrix3f).
+//==============================================================================
+tsymatrix3f* JSphSolidCpu::SaveArrayCpu(unsigned np, const tsymatrix3fsoa &datasrc)const {
+	tsymatrix3f *data = NULL;
+	if (!datasrc.IsNull()) {
+		try {
+			data = new tsymatrix3f[np];
+		}
+		catch (const std::bad_alloc) {
+			RunException("SaveArrayCpu", "Could not allocate the requested memory.");
+		}
+		for (unsigned p = 0; p < np; p++)data[p] = datasrc[p];
+	}
+	return(data);
+}
+
+//==============================================================================
+/// Restores the streams of a tsymatrix3fsoa array from CPU memory.
+//==============================================================================
+void JSphSolidCpu::RestoreArrayCpu(unsigned np, tsymatrix3f *data, tsymatrix3fsoa &datanew)const {
+	if (data && !datanew.IsNull())for (unsigned p = 0; p < np; p++)datanew[p] = data[p];
+	delete[] data;
+}
+
 //==============================================================================
 /// Arrays for basic particle data. 
 /// Arrays para datos basicos de las particulas. 
@@ -369,8 +628,8 @@ void JSphSolidCpu::ReserveBasicArraysCpu() {
 	if (TStep == STEP_Verlet) {
 		VelrhopM1c = ArraysCpu->ReserveFloat4();
 		MassM1c_M = ArraysCpu->ReserveFloat();
-		TauM1c_M = ArraysCpu->ReserveSymatrix3f();
-		QuadFormM1c_M = ArraysCpu->ReserveSymatrix3f();
+		TauM1c_M = ArraysCpu->ReserveSymatrix3fSoa();
+		QuadFormM1c_M = ArraysCpu->ReserveSymatrix3fSoa();
 	}
 	if (TVisco == VISCO_LaminarSPS)SpsTauc = ArraysCpu->ReserveSymatrix3f();
 
@@ -378,14 +637,9 @@ void JSphSolidCpu::ReserveBasicArraysCpu() {
 	Divisionc_M = ArraysCpu->ReserveBool();
 	Porec_M = ArraysCpu->ReserveFloat();
 	Massc_M = ArraysCpu->ReserveFloat();
-	Tauc_M = ArraysCpu->ReserveSymatrix3f();
-	QuadFormc_M = ArraysCpu->ReserveSymatrix3f();
-	VonMises = ArraysCpu->ReserveFloat();
-	GradVelSave = ArraysCpu->ReserveFloat();
+	Tauc_M = ArraysCpu->ReserveSymatrix3fSoa();
+	QuadFormc_M = ArraysCpu->ReserveSymatrix3fSoa();
 	CellOffSpring = ArraysCpu->ReserveUint();
-	StrainDotSave = ArraysCpu->ReserveFloat3();
-	AceSave = ArraysCpu->ReserveFloat3();
-	ForceVisc = ArraysCpu->ReserveFloat3();
 }
 
 //==============================================================================
@@ -399,6 +653,7 @@ llong JSphSolidCpu::GetAllocMemoryCpu()const {
 	//-Reserved in AllocCpuMemoryFixed().
 	s += MemCpuFixed;
 	//-Reserved in other objects.
+	s += NbList->GetAllocMemory();
 	return(s);
 }
 
@@ -470,6 +725,37 @@ unsigned JSphSolidCpu::GetParticlesData(unsigned n, unsigned pini, bool cellorde
 	return(num);
 }
 
+//==============================================================================
+/// Computes the pressure of n particles in press[] with the same equation of
+/// state as PreInteractionVars_Forces(), tipx is the position of the tip.
+//==============================================================================
+void JSphSolidCpu::ComputePress_M(unsigned n, const tdouble3* pos, const tfloat4* velrhop, float tipx, float* press)const {
+	switch (GammaExp_M) {
+	case 1: ComputePressT_M<1>(n, pos, velrhop, tipx, press); break;
+	case 2: ComputePressT_M<2>(n, pos, velrhop, tipx, press); break;
+	case 3: ComputePressT_M<3>(n, pos, velrhop, tipx, press); break;
+	case 4: ComputePressT_M<4>(n, pos, velrhop, tipx, press); break;
+	case 5: ComputePressT_M<5>(n, pos, velrhop, tipx, press); break;
+	case 6: ComputePressT_M<6>(n, pos, velrhop, tipx, press); break;
+	case 7: ComputePressT_M<7>(n, pos, velrhop, tipx, press); break;
+	default: ComputePressT_M<0>(n, pos, velrhop, tipx, press); break;
+	}
+}
+
+//==============================================================================
+/// Computes the pressure with JTaitEos_M<gexp> (see ComputePress_M()).
+//==============================================================================
+template<unsigned gexp> void JSphSolidCpu::ComputePressT_M(unsigned n, const tdouble3* pos, const tfloat4* velrhop, float tipx, float* press)const {
+	const JTaitEos_M<gexp> eos(Gamma, RhopZero);
+	const int np = int(n);
+#ifdef OMP_USE
+#pragma omp parallel for schedule (static) if(np>OMP_LIMIT_COMPUTELIGHT)
+#endif
+	for (int p = 0; p < np; p++) {
+		press[p] = eos.Press(GetConstitutiveK(float(abs(tipx - pos[p].x))), velrhop[p].w);
+	}
+}
+
 //////////////////////////////////////
 // Collect data from a range of particles, update 1: add float3 deformation, remove NabVx
 // V34c
@@ -498,19 +784,24 @@ unsigned JSphSolidCpu::GetParticlesData12_M(unsigned n, unsigned pini, bool cell
 
 	// Matthias
 	if (pore)memcpy(pore, Porec_M + pini, sizeof(float) * n);
-	if (press) {
-		for (unsigned p = 0; p < n; p++) {
-			press[p] = CalcK(abs(MaxPosition().x - Posc[p].x)) / Gamma * (pow(Velrhopc[p + pini].w / RhopZero, Gamma) - 1.0f);
-			//press[p] = -0.5f*RhopZero*float(Posc[p].x*Posc[p].x);
-		}
-	}
+	if (press)ComputePress_M(n, Posc + pini, Velrhopc + pini, MaxPosition().x, press);
 	if (mass)memcpy(mass, Massc_M + pini, sizeof(float) * n);
-	if (qf)memcpy(qf, QuadFormc_M + pini, sizeof(tsymatrix3f) * n);
-	if (vonMises) memcpy(vonMises, VonMises + pini, sizeof(float) * n);
-	if (grVelSav) memcpy(grVelSav, GradVelSave + pini, sizeof(float) * n);
+	if (qf)for (unsigned p = 0; p < n; p++)qf[p] = QuadFormc_M[p + pini];
+	if (vonMises) DgVonMises_M(n, pini, vonMises);
 	if (cellOSpr) memcpy(cellOSpr, CellOffSpring + pini, sizeof(unsigned) * n);
-	if (gradvel) memcpy(gradvel, StrainDotSave + pini, sizeof(tfloat3) * n);
-	if (ace) memcpy(ace, AceSave + pini, sizeof(tfloat3) * n);
+	//-Diagnostic fields are zero when they were not computed in the last step.
+	if (gradvel) {
+		if (StrainDotSave) memcpy(gradvel, StrainDotSave + pini, sizeof(tfloat3) * n);
+		else memset(gradvel, 0, sizeof(tfloat3) * n);
+	}
+	if (grVelSav) {
+		if (StrainDotSave) for (unsigned p = 0; p < n; p++) { const tfloat3 sd = StrainDotSave[p + pini]; grVelSav[p] = sd.x + sd.y + sd.z; }
+		else memset(grVelSav, 0, sizeof(float) * n);
+	}
+	if (ace) {
+		if (AceSave) memcpy(ace, AceSave + pini, sizeof(tfloat3) * n);
+		else memset(ace, 0, sizeof(tfloat3) * n);
+	}
 
 
 	//-Eliminate non-normal particles (periodic & others). | Elimina particulas no normales (periodicas y otras).
@@ -572,33 +863,28 @@ unsigned JSphSolidCpu::GetParticlesData35_M(unsigned n, unsigned pini, bool cell
 
 	// Matthias
 	if (pore)memcpy(pore, Porec_M + pini, sizeof(float) * n);
-	if (press) {
-		if (true) {
-			const float tip_position = MaxPosition().x;
-#ifdef OMP_USE
-#pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
-#endif
-			for (int p = 0; p < n; p++) {
-				press[p] = CalcK(abs(tip_position - Posc[p].x)) / Gamma * (pow(Velrhopc[p + pini].w / RhopZero, Gamma) - 1.0f);
-				//press[p] = -0.5f*RhopZero*float(Posc[p].x*Posc[p].x);
-			}
-
-		}
-		else {
-			for (int p = 0; p < n; p++) {
-				press[p] = CalcK(abs(MaxPosition().x - Posc[p].x)) / Gamma * (pow(Velrhopc[p + pini].w / RhopZero, Gamma) - 1.0f);
-				//press[p] = -0.5f*RhopZero*float(Posc[p].x*Posc[p].x);
-			}
-		}
-	}
+	if (press)ComputePress_M(n, Posc + pini, Velrhopc + pini, MaxPosition().x, press);
 	if (mass)memcpy(mass, Massc_M + pini, sizeof(float) * n);
-	if (qf)memcpy(qf, QuadFormc_M + pini, sizeof(tsymatrix3f) * n);
-	if (vonMises) memcpy(vonMises, VonMises + pini, sizeof(float) * n);
-	if (grVelSav) memcpy(grVelSav, GradVelSave + pini, sizeof(float) * n);
+	if (qf)for (unsigned p = 0; p < n; p++)qf[p] = QuadFormc_M[p + pini];
+	if (vonMises) DgVonMises_M(n, pini, vonMises);
 	if (cellOSpr) memcpy(cellOSpr, CellOffSpring + pini, sizeof(unsigned) * n);
-	if (gradvel) memcpy(gradvel, StrainDotSave + pini, sizeof(tfloat3) * n);
-	if (ace) memcpy(ace, AceSave + pini, sizeof(tfloat3) * n);
-	if (fvi) memcpy(fvi, ForceVisc + pini, sizeof(tfloat3) * n);
+	//-Diagnostic fields are zero when they were not computed in the last step.
+	if (gradvel) {
+		if (StrainDotSave) memcpy(gradvel, StrainDotSave + pini, sizeof(tfloat3) * n);
+		else memset(gradvel, 0, sizeof(tfloat3) * n);
+	}
+	if (grVelSav) {
+		if (StrainDotSave) for (unsigned p = 0; p < n; p++) { const tfloat3 sd = StrainDotSave[p + pini]; grVelSav[p] = sd.x + sd.y + sd.z; }
+		else memset(grVelSav, 0, sizeof(float) * n);
+	}
+	if (ace) {
+		if (AceSave) memcpy(ace, AceSave + pini, sizeof(tfloat3) * n);
+		else memset(ace, 0, sizeof(tfloat3) * n);
+	}
+	if (fvi) {
+		if (ForceVisc) memcpy(fvi, ForceVisc + pini, sizeof(tfloat3) * n);
+		else memset(fvi, 0, sizeof(tfloat3) * n);
+	}
 
 
 	//-Eliminate non-normal particles (periodic & others). | Elimina particulas no normales (periodicas y otras).
@@ -668,6 +954,11 @@ void JSphSolidCpu::ConfigRunMode(const JCfgRun *cfg, std::string preinfo) {
 	Hardware = "Cpu";
 	if (OmpThreads == 1)RunMode = "Single core";
 	else RunMode = string("OpenMP(Threads:") + fun::IntStr(OmpThreads) + ")";
+	//-Vectorised pair kernel limited by SimdLevel. #simd
+	SimdMode = SimdDetectCpu();
+	if (int(SimdMode) > SimdLevel)SimdMode = TpSimdMode(SimdLevel);
+	SimdForcesFnc = SimdForcesFn(SimdMode);
+	RunMode = RunMode + " - Simd:" + SimdModeName(SimdMode);
 	if (!preinfo.empty())RunMode = preinfo + " - " + RunMode;
 	if (Stable)RunMode = string("Stable - ") + RunMode;
 	if (Psingle)RunMode = string("Pos-Single - ") + RunMode;
@@ -686,7 +977,7 @@ void JSphSolidCpu::InitRun() {
 	WithFloating = (CaseNfloat>0);
 	if (TStep == STEP_Verlet) {
 		memcpy(VelrhopM1c, Velrhopc, sizeof(tfloat4)*Np);
-		memset(TauM1c_M, 0, sizeof(tsymatrix3f)*Np);
+		TauM1c_M.Zero(0, Np);
 		VerletStep = 0;
 		for (unsigned p = 0; p < Np; p++) {
 			MassM1c_M[p] = MassFluid;
@@ -697,17 +988,13 @@ void JSphSolidCpu::InitRun() {
 	if (TVisco == VISCO_LaminarSPS)memset(SpsTauc, 0, sizeof(tsymatrix3f)*Np);
 
 	// Matthias
-	memset(Tauc_M, 0, sizeof(tsymatrix3f)*Np);
+	Tauc_M.Zero(0, Np);
 	memset(Divisionc_M, 0, sizeof(bool)*Np);
 	for (unsigned p = 0; p < Np; p++) {
 		Massc_M[p] = MassFluid;
 		QuadFormc_M[p] = TSymatrix3f(4 / float(pow(Dp, 2)), 0, 0, 4 / float(pow(Dp, 2)), 0, 4 / float(pow(Dp, 2)));
 	}
-	memset(VonMises, 0, sizeof(float)* Np);
-	memset(GradVelSave, 0, sizeof(float) * Np);
 	memset(CellOffSpring, 0, sizeof(unsigned) * Np);
-	memset(StrainDotSave, 0, sizeof(tfloat3) * Np);
-	memset(AceSave, 0, sizeof(tfloat3) * Np);
 	  
 	if (UseDEM)DemDtForce = DtIni; //(DEM)
 	if (CaseNfloat)InitFloating();
@@ -771,7 +1058,7 @@ void JSphSolidCpu::InitRun_Uni_M() {
 
 	if (TStep == STEP_Verlet) {
 		memcpy(VelrhopM1c, Velrhopc, sizeof(tfloat4) * Np);
-		memset(TauM1c_M, 0, sizeof(tsymatrix3f) * Np);
+		TauM1c_M.Zero(0, Np);
 		memcpy(MassM1c_M, Massc_M, sizeof(float) * Np);
 		VerletStep = 0;
 		for (unsigned p = 0; p < Np; p++) {
@@ -783,14 +1070,9 @@ void JSphSolidCpu::InitRun_Uni_M() {
 	if (TVisco == VISCO_LaminarSPS)memset(SpsTauc, 0, sizeof(tsymatrix3f) * Np);
 
 	// Matthias
-	memset(Tauc_M, 0, sizeof(tsymatrix3f) * Np);
+	Tauc_M.Zero(0, Np);
 	memset(Divisionc_M, 0, sizeof(bool) * Np);
-	memset(VonMises, 0, sizeof(float) * Np);
-	memset(GradVelSave, 0, sizeof(float) * Np);
 	memset(CellOffSpring, 0, sizeof(unsigned) * Np);
-	memset(StrainDotSave, 0, sizeof(tfloat3) * Np);
-	memset(AceSave, 0, sizeof(tfloat3) * Np);
-	memset(ForceVisc, 0, sizeof(tfloat3) * Np);
 
 	if (UseDEM)DemDtForce = DtIni; //(DEM)
 	if (CaseNfloat)InitFloating();
@@ -901,56 +1183,68 @@ void JSphSolidCpu::AddAccInput() {
 /// Prepara variables para interaccion "INTER_Forces" o "INTER_ForcesCorr".
 //==============================================================================
 void JSphSolidCpu::PreInteractionVars_Forces(TpInter tinter, unsigned np, unsigned npb) {
-	//-Initialize Arrays.
-	const unsigned npf = np - npb;
-	memset(Arc, 0, sizeof(float)*np);                                    //Arc[]=0
-	if (Deltac)memset(Deltac, 0, sizeof(float)*np);                       //Deltac[]=0
-	if (ShiftPosc)memset(ShiftPosc, 0, sizeof(tfloat3)*np);               //ShiftPosc[]=0
-	if (ShiftDetectc)memset(ShiftDetectc, 0, sizeof(float)*np);           //ShiftDetectc[]=0
-	memset(Acec, 0, sizeof(tfloat3)*npb);                                //Acec[]=(0,0,0) for bound / para bound
-	for (unsigned p = npb; p<np; p++)Acec[p] = Gravity;                       //Acec[]=Gravity for fluid / para fluid
-	if (SpsGradvelc)memset(SpsGradvelc + npb, 0, sizeof(tsymatrix3f)*npf);  //SpsGradvelc[]=(0,0,0,0,0,0).
-		
-	// Matthias													
-	//memset(JauGradvelc_M + npb, 0, sizeof(tmatrix3f)*npf);  //JauGradvelc[]=(0,0,0,0,0,0).													
-	/*memset(StrainDotc_M + npb, 0, sizeof(tsymatrix3f)*npf);  													
-	memset(TauDotc_M + npb, 0, sizeof(tsymatrix3f)*npf);  												
-	memset(Spinc_M + npb, 0, sizeof(tsymatrix3f)*npf); 
-	memset(L_M + npb, 0, sizeof(tmatrix3f)*npf); */
-
-	// Taking into account boundaries												
-	memset(StrainDotc_M, 0, sizeof(tsymatrix3f)*np);
-	memset(TauDotc_M, 0, sizeof(tsymatrix3f)*np);
-	memset(Spinc_M, 0, sizeof(tsymatrix3f)*np);
-	memset(L_M, 0, sizeof(tmatrix3f)*np);
-	memset(Co_M, 0, sizeof(float)*np);
-																			  //-Apply the extra forces to the correct particle sets.
-	if (AccInput)AddAccInput();
-
-	//-Prepare values of rhop for interaction. | Prepara datos derivados de rhop para interaccion.
-	const int n = int(np);
+	switch (GammaExp_M) {
+	case 1: PreInteractionVars_ForcesT<1>(np, npb); break;
+	case 2: PreInteractionVars_ForcesT<2>(np, npb); break;
+	case 3: PreInteractionVars_ForcesT<3>(np, npb); break;
+	case 4: PreInteractionVars_ForcesT<4>(np, npb); break;
+	case 5: PreInteractionVars_ForcesT<5>(np, npb); break;
+	case 6: PreInteractionVars_ForcesT<6>(np, npb); break;
+	case 7: PreInteractionVars_ForcesT<7>(np, npb); break;
+	default: PreInteractionVars_ForcesT<0>(np, npb); break;
+	}
+}
+
+//==============================================================================
+/// Computes Press and Pore with the Tait equation of state JTaitEos_M<gexp>
+/// and prepares the variables for interaction (see PreInteractionVars_Forces()).
+//==============================================================================
+template<unsigned gexp> void JSphSolidCpu::PreInteractionVars_ForcesT(unsigned np, unsigned npb) {
+	//-The interaction kernels write the final values of the fluid particles
+	// (Ar, Ace with gravity, Delta, ShiftPos, StrainDot and Spin) and L, Co of
+	// all particles, TauDot is written by computeDeformationSolid01(). So only
+	// the boundary particles are initialised here, in the same pass that
+	// computes Press, Pore, PsPos and the maximum velocity.
+	const int n = int(np), nb = int(npb);
+	const int pvel = (DtAllParticles ? 0 : nb);
 	const float tip_position = MaxPosition().x;
+	const JTaitEos_M<gexp> eos(Gamma, RhopZero);
+	float velth[OMP_MAXTHREADS * OMP_STRIDE];
+	for (int th = 0; th < OmpThreads; th++)velth[th * OMP_STRIDE] = 0;
 #ifdef OMP_USE
 #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
 #endif
 	// #Pore #Pressure Matthias
 	for (int p = 0; p<n; p++) {
-		const float rhop = Velrhopc[p].w, rhop_r0 = rhop / RhopZero;
-		Pressc[p] = CalcK(abs(tip_position - Posc[p].x)) / Gamma * (pow(rhop_r0, Gamma) - 1.0f);
+		const int th = omp_get_thread_num();
+		const tfloat4 vr = Velrhopc[p];
+		Pressc[p] = eos.Press(CalcK(abs(tip_position - Posc[p].x)), vr.w);
+		if (PsPosc)PsPosc[p] = ToTFloat3(Posc[p]);
+		if (p >= pvel) {
+			const float v2 = vr.x * vr.x + vr.y * vr.y + vr.z * vr.z;
+			if (v2 > velth[th * OMP_STRIDE])velth[th * OMP_STRIDE] = v2;
+		}
+		if (p < nb) {//-Boundary particles (only Bound-Fluid terms are added).
+			Arc[p] = 0;
+			Acec[p] = TFloat3(0);
+			if (Deltac)Deltac[p] = 0;
+			if (ShiftPosc)ShiftPosc[p] = TFloat3(0);
+			if (ShiftDetectc)ShiftDetectc[p] = 0;
+			StrainDotc_M[p] = TSymatrix3f(0);
+			Spinc_M[p] = TSymatrix3f(0);
+		}
+		else if (SpsGradvelc)SpsGradvelc[p] = TSymatrix3f(0);
 
 		// Time growing Pore pressure
 		/*switch (typeGrowth) {
 		case 6:
-			if (TimeStep<0.2) Porec_M[p] = CalcK(abs(MaxPosition().x - float(Posc[p].x))) * float(TimeStep);
-			else Porec_M[p] = CalcK(abs(MaxPosition().x - float(Posc[p].x))) * 0.2f;
+			if (TimeStep<0.2) Porec_M[p] = CalcK(abs(tip_position - float(Posc[p].x))) * float(TimeStep);
+			else Porec_M[p] = CalcK(abs(tip_position - float(Posc[p].x))) * 0.2f;
 		default:
 			Porec_M[p] = PoreZero;
 		}*/
 
-		if (Posc[p].x > 0.3) 
-			Porec_M[p] = PoreZero;
-		else
-			Porec_M[p] = 0.0f;
+		Porec_M[p] = (Posc[p].x > 0.3 ? PoreZero : 0.0f);
 
 
 
@@ -979,15 +1273,10 @@ void JSphSolidCpu::PreInteractionVars_Forces(TpInter tinter, unsigned np, unsign
 
 		//Pore pressure constant
 		//Porec_M[p] = PoreZero;
-
-		// Augustin
-		/*if (Simulate2D)
-			//VonMises[p] = sqrt(((Tauc_M[p].xx - Tauc_M[p].yy) * (Tauc_M[p].xx - Tauc_M[p].yy) + (Tauc_M[p].yy - Tauc_M[p].zz) * (Tauc_M[p].yy - Tauc_M[p].zz) + (Tauc_M[p].xx - Tauc_M[p].zz) * (Tauc_M[p].xx - Tauc_M[p].zz) + 6 * (Tauc_M[p].xy * Tauc_M[p].xy + Tauc_M[p].xz * Tauc_M[p].xz + Tauc_M[p].yz * Tauc_M[p].yz)) / 2.0f);
-			VonMises[p] = sqrt((pow(Tauc_M[p].xx - Tauc_M[p].yy, 2.0f) + pow(Tauc_M[p].yy - Tauc_M[p].zz, 2.0f) + pow(Tauc_M[p].xx - Tauc_M[p].zz, 2.0f)
-				+ 6.0f * (pow(Tauc_M[p].xy, 2.0f) + pow(Tauc_M[p].xz, 2.0f) + pow(Tauc_M[p].yz, 2.0f))) / 2.0f);
-		else VonMises[p] = sqrt(pow(Tauc_M[p].xx, 2.0f) + pow(Tauc_M[p].zz, 2.0f) - Tauc_M[p].xx * Tauc_M[p].zz + 3.0f * pow(Tauc_M[p].xz, 2.0f));
-	*/
 	}
+	float velmax = 0;
+	for (int th = 0; th < OmpThreads; th++)velmax = max(velmax, velth[th * OMP_STRIDE]);
+	VelMax = sqrt(velmax);
 }
 
 //==============================================================================
@@ -1014,29 +1303,22 @@ void JSphSolidCpu::PreInteraction_Forces(TpInter tinter) {
 
 	// Matthias
 	//JauGradvelc_M = ArraysCpu->ReserveMatrix3f_M();
-	StrainDotc_M = ArraysCpu->ReserveSymatrix3f();
-	TauDotc_M = ArraysCpu->ReserveSymatrix3f();
-	Spinc_M = ArraysCpu->ReserveSymatrix3f();
+	StrainDotc_M = ArraysCpu->ReserveSymatrix3fSoa();
+	TauDotc_M = ArraysCpu->ReserveSymatrix3fSoa();
+	Spinc_M = ArraysCpu->ReserveSymatrix3fSoa();
 	L_M = ArraysCpu->ReserveMatrix3f_M(); 
 	Co_M = ArraysCpu->ReserveFloat(); 
-	
-	//-Prepare values for interaction Pos-Simpe.
-	if (Psingle) {
-		PsPosc = ArraysCpu->ReserveFloat3();
-		const int np = int(Np);
-#ifdef OMP_USE
-#pragma omp parallel for schedule (static) if(np>OMP_LIMIT_COMPUTELIGHT)
-#endif
-		for (int p = 0; p<np; p++) { PsPosc[p] = ToTFloat3(Posc[p]); }
+	if (NlSymmetric) {
+		SymAce_M = ArraysCpu->ReserveMatrix3f_M();
+		SymGrad_M = ArraysCpu->ReserveMatrix3f_M();
+		SymAr_M = ArraysCpu->ReserveFloat3();
 	}
-	//-Initialize Arrays
-	PreInteractionVars_Forces(tinter, Np, Npb);
-
-	//-Calculate VelMax: Floating object particles are included and do not affect use of periodic condition.
+	
+	//-Prepare values for interaction Pos-Simpe (computed in PreInteractionVars_Forces()).
+	if (Psingle)PsPosc = ArraysCpu->ReserveFloat3();
+	//-Initialize Arrays and calculate VelMax: Floating object particles are included and do not affect use of periodic condition.
 	//-Calcula VelMax: Se incluyen las particulas floatings y no afecta el uso de condiciones periodicas.
-	const unsigned pini = (DtAllParticles ? 0 : Npb);
-	VelMax = CalcVelMaxOmp(Np - pini, Velrhopc + pini);
-	//printf("Velmax: %.3f\n", VelMax);
+	PreInteractionVars_Forces(tinter, Np, Npb);
 	ViscDtMax = 0;
 	TmcStop(Timers, TMC_CfPreForces);
 }
@@ -1106,11 +1388,14 @@ void JSphSolidCpu::PosInteraction_Forces() {
 	ArraysCpu->Free(PsPosc);       PsPosc = NULL;
 	ArraysCpu->Free(SpsGradvelc);  SpsGradvelc = NULL;
 	// Matthias
-	ArraysCpu->Free(StrainDotc_M); StrainDotc_M = NULL;
-	ArraysCpu->Free(TauDotc_M);    TauDotc_M = NULL;
-	ArraysCpu->Free(Spinc_M);	   Spinc_M = NULL;
+	ArraysCpu->Free(StrainDotc_M); StrainDotc_M = TSymatrix3fSoa();
+	ArraysCpu->Free(TauDotc_M);    TauDotc_M = TSymatrix3fSoa();
+	ArraysCpu->Free(Spinc_M);	   Spinc_M = TSymatrix3fSoa();
 	ArraysCpu->Free(L_M);		   L_M = NULL;
 	ArraysCpu->Free(Co_M);		   Co_M = NULL;
+	ArraysCpu->Free(SymAce_M);	   SymAce_M = NULL;
+	ArraysCpu->Free(SymGrad_M);	   SymGrad_M = NULL;
+	ArraysCpu->Free(SymAr_M);	   SymAr_M = NULL;
 }
 
 //==============================================================================
@@ -1318,7 +1603,7 @@ template<bool psingle, TpKernel tker, TpFtMode ftmode> void JSphSolidCpu::Intera
 (unsigned n, unsigned pinit, tint4 nc, int hdiv, unsigned cellinitial
 	, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
 	, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
-	, float& viscdt, float* ar, tsymatrix3f* gradvel, tsymatrix3f* omega, tmatrix3f* L)const
+	, float& viscdt, float* ar, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega, tmatrix3f* L)const
 {
 	//-Initialize viscth to calculate max viscdt with OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
 	float viscth[OMP_MAXTHREADS * OMP_STRIDE];
@@ -1448,7 +1733,7 @@ template<bool psingle, TpKernel tker, TpFtMode ftmode> void JSphSolidCpu::Intera
 (unsigned n, unsigned pinit, tint4 nc, int hdiv, unsigned cellinitial
 	, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
 	, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
-	, float& viscdt, float* ar, const float* mass, tsymatrix3f* gradvel, tsymatrix3f* omega, tmatrix3f* L)const
+	, float& viscdt, float* ar, const float* mass, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega, tmatrix3f* L)const
 {
 	//-Initialize viscth to calculate max viscdt with OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
 	float viscth[OMP_MAXTHREADS * OMP_STRIDE];
@@ -1922,9 +2207,8 @@ template<bool psingle, TpKernel tker> void JSphSolidCpu::InterfaceGradientCorrec
 		break;
 	}
 	case 2: {
-		// DFPM 
-		ComputeDFPM37<psingle, tker>(np, pinit, nc, hdiv, cellinitial,
-			beginendcell, cellzero, dcell, pos, pspos, velrhop, mass, L, co);
+		// DFPM on the neighbour list (same result as ComputeDFPM37) #V38
+		ComputeDFPM38(np, pinit, velrhop, mass, L, co);
 		break;
 	}
 	case 3: {
@@ -1958,118 +2242,123 @@ template<bool psingle, TpKernel tker> void JSphSolidCpu::ComputeNsphCorrection31
 	const int pfin = int(pinit + n);
 
 #ifdef OMP_USE
-#pragma omp parallel for schedule (guided)
+#pragma omp parallel
 #endif
+	{
+		const JTimerRegistry::ThreadScope ths(TimersReg, TmsCorrection);
+#ifdef OMP_USE
+#pragma omp for schedule (guided) nowait
+#endif
+		for (int p1 = int(pinit); p1 < pfin; p1++) {
 
-	for (int p1 = int(pinit); p1 < pfin; p1++) {
-
-		//-Obtain data of particle p1 in case of floating objects. | Obtiene datos de particula p1 en caso de existir floatings.
-		bool ftp1 = false;     //-Indicate if it is floating. | Indica si es floating.
-
-		//-Obtain data of particle p1.
-		const tfloat3 psposp1 = (psingle ? pspos[p1] : TFloat3(0));
-		const tdouble3 posp1 = (psingle ? TDouble3(0) : pos[p1]);
-
-		// Matthias
-		tmatrix3f Mp1 = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-		float Mo1 = 0.0f;
-
-		//-Obtain interaction limits.
-		int cxini, cxfin, yini, yfin, zini, zfin;
-		GetInteractionCells(dcell[p1], hdiv, nc, cellzero, cxini, cxfin, yini, yfin, zini, zfin);
+			//-Obtain data of particle p1 in case of floating objects. | Obtiene datos de particula p1 en caso de existir floatings.
+			bool ftp1 = false;     //-Indicate if it is floating. | Indica si es floating.
 
-		//-Search for neighbours in adjacent cells. Bound
-		for (int z = zini; z < zfin; z++) {
-			const int zmod = (nc.w) * z + 0
-				; //-Sum from start of fluid or boundary cells. | Le suma donde empiezan las celdas de fluido o bound.
-			for (int y = yini; y < yfin; y++) {
-				int ymod = zmod + nc.x * y;
-				const unsigned pini = beginendcell[cxini + ymod];
-				const unsigned pfin = beginendcell[cxfin + ymod];
+			//-Obtain data of particle p1.
+			const tfloat3 psposp1 = (psingle ? pspos[p1] : TFloat3(0));
+			const tdouble3 posp1 = (psingle ? TDouble3(0) : pos[p1]);
 
-				// Computation of Lp1
-				for (unsigned p2 = pini; p2 < pfin; p2++) {
-					const float drx = (psingle ? psposp1.x - pspos[p2].x : float(posp1.x - pos[p2].x));
-					const float dry = (psingle ? psposp1.y - pspos[p2].y : float(posp1.y - pos[p2].y));
-					const float drz = (psingle ? psposp1.z - pspos[p2].z : float(posp1.z - pos[p2].z));
-					const float rr2 = drx * drx + dry * dry + drz * drz;
-					float massp2 = mass[p2]; //-Contiene masa de particula segun sea bound o fluid.
+			// Matthias
+			tmatrix3f Mp1 = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+			float Mo1 = 0.0f;
 
-					if (rr2 <= Fourh2 && rr2 >= ALMOSTZERO) {
-						float frx, fry, frz, fr;
-						if (tker == KERNEL_Wendland)GetKernelWendland(rr2, drx, dry, drz, frx, fry, frz);
-						else if (tker == KERNEL_Gaussian)GetKernelGaussian(rr2, drx, dry, drz, frx, fry, frz);
-						else if (tker == KERNEL_Cubic)GetKernelCubic(rr2, drx, dry, drz, frx, fry, frz);
-						GetKernelDirectWend_M(rr2, fr);
+			//-Obtain interaction limits.
+			int cxini, cxfin, yini, yfin, zini, zfin;
+			GetInteractionCells(dcell[p1], hdiv, nc, cellzero, cxini, cxfin, yini, yfin, zini, zfin);
 
-						if (true) {
-							if (!ftp1) {//-When p1 is a fluid particle / Cuando p1 es fluido. 
-								const float volp2 = -massp2 / velrhop[p2].w;
-								Mp1.a11 += volp2 * drx * frx;
-								Mp1.a12 += volp2 * drx * fry;
-								Mp1.a13 += volp2 * drx * frz;
-								Mp1.a21 += volp2 * dry * frx;
-								Mp1.a22 += volp2 * dry * fry;
-								Mp1.a23 += volp2 * dry * frz;
-								Mp1.a31 += volp2 * drz * frx;
-								Mp1.a32 += volp2 * drz * fry;
-								Mp1.a33 += volp2 * drz * frz;
-								//Mo1 += -volp2 * fr;
+			//-Search for neighbours in adjacent cells. Bound
+			for (int z = zini; z < zfin; z++) {
+				const int zmod = (nc.w) * z + 0
+					; //-Sum from start of fluid or boundary cells. | Le suma donde empiezan las celdas de fluido o bound.
+				for (int y = yini; y < yfin; y++) {
+					int ymod = zmod + nc.x * y;
+					const unsigned pini = beginendcell[cxini + ymod];
+					const unsigned pfin = beginendcell[cxfin + ymod];
+
+					// Computation of Lp1
+					for (unsigned p2 = pini; p2 < pfin; p2++) {
+						const float drx = (psingle ? psposp1.x - pspos[p2].x : float(posp1.x - pos[p2].x));
+						const float dry = (psingle ? psposp1.y - pspos[p2].y : float(posp1.y - pos[p2].y));
+						const float drz = (psingle ? psposp1.z - pspos[p2].z : float(posp1.z - pos[p2].z));
+						const float rr2 = drx * drx + dry * dry + drz * drz;
+						float massp2 = mass[p2]; //-Contiene masa de particula segun sea bound o fluid.
+
+						if (rr2 <= Fourh2 && rr2 >= ALMOSTZERO) {
+							float frx, fry, frz, fr;
+							if (tker == KERNEL_Wendland)GetKernelWendland(rr2, drx, dry, drz, frx, fry, frz);
+							else if (tker == KERNEL_Gaussian)GetKernelGaussian(rr2, drx, dry, drz, frx, fry, frz);
+							else if (tker == KERNEL_Cubic)GetKernelCubic(rr2, drx, dry, drz, frx, fry, frz);
+							GetKernelDirectWend_M(rr2, fr);
+
+							if (true) {
+								if (!ftp1) {//-When p1 is a fluid particle / Cuando p1 es fluido. 
+									const float volp2 = -massp2 / velrhop[p2].w;
+									Mp1.a11 += volp2 * drx * frx;
+									Mp1.a12 += volp2 * drx * fry;
+									Mp1.a13 += volp2 * drx * frz;
+									Mp1.a21 += volp2 * dry * frx;
+									Mp1.a22 += volp2 * dry * fry;
+									Mp1.a23 += volp2 * dry * frz;
+									Mp1.a31 += volp2 * drz * frx;
+									Mp1.a32 += volp2 * drz * fry;
+									Mp1.a33 += volp2 * drz * frz;
+									//Mo1 += -volp2 * fr;
+								}
 							}
 						}
 					}
 				}
 			}
-		}
-
-		//-Search for neighbours in adjacent cells. Fluid
-		for (int z = zini; z < zfin; z++) {
-			const int zmod = (nc.w) * z + cellinitial; //-Sum from start of fluid or boundary cells. | Le suma donde empiezan las celdas de fluido o bound.
-			for (int y = yini; y < yfin; y++) {
-				int ymod = zmod + nc.x * y;
-				const unsigned pini = beginendcell[cxini + ymod];
-				const unsigned pfin = beginendcell[cxfin + ymod];
-
-				// Computation of Lp1
-				for (unsigned p2 = pini; p2 < pfin; p2++) {
-					const float drx = (psingle ? psposp1.x - pspos[p2].x : float(posp1.x - pos[p2].x));
-					const float dry = (psingle ? psposp1.y - pspos[p2].y : float(posp1.y - pos[p2].y));
-					const float drz = (psingle ? psposp1.z - pspos[p2].z : float(posp1.z - pos[p2].z));
-					const float rr2 = drx * drx + dry * dry + drz * drz;
-					float massp2 = mass[p2]; //-Contiene masa de particula segun sea bound o fluid.
 
-					if (rr2 <= Fourh2 && rr2 >= ALMOSTZERO) {
-						float frx, fry, frz, fr;
-						if (tker == KERNEL_Wendland)GetKernelWendland(rr2, drx, dry, drz, frx, fry, frz);
-						else if (tker == KERNEL_Gaussian)GetKernelGaussian(rr2, drx, dry, drz, frx, fry, frz);
-						else if (tker == KERNEL_Cubic)GetKernelCubic(rr2, drx, dry, drz, frx, fry, frz);
-						GetKernelDirectWend_M(rr2, fr);
-
-						if (true) {
-							if (!ftp1) {//-When p1 is a fluid particle / Cuando p1 es fluido. 
-								const float volp2 = -massp2 / velrhop[p2].w;
-								Mp1.a11 += volp2 * drx * frx;
-								Mp1.a12 += volp2 * drx * fry;
-								Mp1.a13 += volp2 * drx * frz;
-								Mp1.a21 += volp2 * dry * frx;
-								Mp1.a22 += volp2 * dry * fry;
-								Mp1.a23 += volp2 * dry * frz;
-								Mp1.a31 += volp2 * drz * frx;
-								Mp1.a32 += volp2 * drz * fry;
-								Mp1.a33 += volp2 * drz * frz;
-								Mo1 += -volp2 * fr;
+			//-Search for neighbours in adjacent cells. Fluid
+			for (int z = zini; z < zfin; z++) {
+				const int zmod = (nc.w) * z + cellinitial; //-Sum from start of fluid or boundary cells. | Le suma donde empiezan las celdas de fluido o bound.
+				for (int y = yini; y < yfin; y++) {
+					int ymod = zmod + nc.x * y;
+					const unsigned pini = beginendcell[cxini + ymod];
+					const unsigned pfin = beginendcell[cxfin + ymod];
+
+					// Computation of Lp1
+					for (unsigned p2 = pini; p2 < pfin; p2++) {
+						const float drx = (psingle ? psposp1.x - pspos[p2].x : float(posp1.x - pos[p2].x));
+						const float dry = (psingle ? psposp1.y - pspos[p2].y : float(posp1.y - pos[p2].y));
+						const float drz = (psingle ? psposp1.z - pspos[p2].z : float(posp1.z - pos[p2].z));
+						const float rr2 = drx * drx + dry * dry + drz * drz;
+						float massp2 = mass[p2]; //-Contiene masa de particula segun sea bound o fluid.
+
+						if (rr2 <= Fourh2 && rr2 >= ALMOSTZERO) {
+							float frx, fry, frz, fr;
+							if (tker == KERNEL_Wendland)GetKernelWendland(rr2, drx, dry, drz, frx, fry, frz);
+							else if (tker == KERNEL_Gaussian)GetKernelGaussian(rr2, drx, dry, drz, frx, fry, frz);
+							else if (tker == KERNEL_Cubic)GetKernelCubic(rr2, drx, dry, drz, frx, fry, frz);
+							GetKernelDirectWend_M(rr2, fr);
+
+							if (true) {
+								if (!ftp1) {//-When p1 is a fluid particle / Cuando p1 es fluido. 
+									const float volp2 = -massp2 / velrhop[p2].w;
+									Mp1.a11 += volp2 * drx * frx;
+									Mp1.a12 += volp2 * drx * fry;
+									Mp1.a13 += volp2 * drx * frz;
+									Mp1.a21 += volp2 * dry * frx;
+									Mp1.a22 += volp2 * dry * fry;
+									Mp1.a23 += volp2 * dry * frz;
+									Mp1.a31 += volp2 * drz * frx;
+									Mp1.a32 += volp2 * drz * fry;
+									Mp1.a33 += volp2 * drz * frz;
+									Mo1 += -volp2 * fr;
+								}
 							}
 						}
 					}
 				}
 			}
-		}
-		if (Simulate2D) Mp1.a22 = 1.0f;
+			if (Simulate2D) Mp1.a22 = 1.0f;
 
-		// Original L
-		L[p1] = Inv3f(Mp1);
-		co[p1] = 1.0f - Mo1;
-		//L[p1] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+			// Original L
+			L[p1] = Inv3f(Mp1);
+			co[p1] = 1.0f - Mo1;
+			//L[p1] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+		}
 	}
 }
 
@@ -2321,6 +2610,7 @@ template<bool psingle, TpKernel tker> void JSphSolidCpu::ComputeDFPM37
 
 		// Inversion of diagonal elements
 		L[p1] = {1.0f/M.x, 0, 0, 0, 1.0f / M.y, 0,0,0, 1.0f / M.z};
+		co[p1] = 0.0f;
 	}
 }
 
@@ -2351,7 +2641,7 @@ template<bool psingle, TpKernel tker> void JSphSolidCpu::ComputeNoCorrection37
 template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph tdelta, bool shift> void JSphSolidCpu::InteractionForces_V11b_M
 (unsigned n, unsigned pinit, tint4 nc, int hdiv, unsigned cellinitial, float visco
 	, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
-	, const tsymatrix3f* tau, tsymatrix3f* gradvel, tsymatrix3f* omega
+	, const tsymatrix3fsoa tau, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega
 	, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
 	, const float* press, const float* pore, const float* mass
 	, tmatrix3f* L
@@ -2591,7 +2881,7 @@ template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph t
 template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph tdelta, bool shift> void JSphSolidCpu::InteractionForces_V31_M
 (unsigned n, unsigned pinit, tint4 nc, int hdiv, unsigned cellinitial, float visco
 	, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
-	, const tsymatrix3f* tau, tsymatrix3f* gradvel, tsymatrix3f* omega
+	, const tsymatrix3fsoa tau, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega
 	, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
 	, const float* press, const float* pore, const float* mass
 	, tmatrix3f* L
@@ -2823,35 +3113,984 @@ template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph t
 }
 
 //==============================================================================
-/// Interaction particles 32 - Matthias
-/// With AceSave output (#34)
+/// Selection of template parameters for BuildNeighbourListT_M. #V38 #neighbour
+/// Uses the same kernel as Interaction_Forces[Simp]Small_M. With NlSkin the
+/// pairs are obtained from the candidates kept between divides.
 //==============================================================================
-template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph tdelta, bool shift> void JSphSolidCpu::InteractionForces_V32_M
-(unsigned n, unsigned pinit, tint4 nc, int hdiv, unsigned cellinitial, float visco
-	, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
-	, const tsymatrix3f* tau, tsymatrix3f* gradvel, tsymatrix3f* omega
-	, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
-	, const float* press, const float* pore, const float* mass
-	, tmatrix3f* L
-	, float& viscdt, float* ar, tfloat3* ace, tfloat3* acesave, float* delta
-	, TpShifting tshifting, tfloat3* shiftpos, float* shiftdetect)const
+void JSphSolidCpu::BuildNeighbourList_M(unsigned np, tuint3 ncells, const unsigned* begincell, tuint3 cellmin
+	, const unsigned* dcell, const tdouble3* pos, const tfloat3* pspos)
 {
-	const bool boundp2 = (!cellinitial); //-Interaction with type boundary (Bound). | Interaccion con Bound.
-										 //-Initialize viscth to calculate viscdt maximo con OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
-	float viscth[OMP_MAXTHREADS * OMP_STRIDE];
-	for (int th = 0; th < OmpThreads; th++)viscth[th * OMP_STRIDE] = 0;
-	//-Initialise execution with OpenMP. | Inicia ejecucion con OpenMP..
-	const int pfin = int(pinit + n);
-
+	const tint4 nc = TInt4(int(ncells.x), int(ncells.y), int(ncells.z), int(ncells.x * ncells.y));
+	const tint3 cellzero = TInt3(cellmin.x, cellmin.y, cellmin.z);
+	const unsigned cellfluid = nc.w * nc.z + 1;
+	const int hdiv = (CellMode == CELLMODE_H ? 2 : 1);
+	if (!NlSkin) {
+		if (Psingle)BuildNeighbourListT_M<true, KERNEL_Wendland>(np, nc, hdiv, cellfluid, begincell, cellzero, dcell, pos, pspos);
+		else        BuildNeighbourListT_M<false, KERNEL_Wendland>(np, nc, hdiv, cellfluid, begincell, cellzero, dcell, pos, pspos);
+	}
+	else {
+		//-Verlet skin: candidates are only built after a divide. #skin
+		if (!NbList->GetCandValid() || NbList->GetCandNp() != np) {
+			const int hdivskin = int(ceil((Dosh + NlSkin) / Scell));
+			if (Psingle)BuildNeighbourCandT_M<true>(np, nc, hdivskin, cellfluid, begincell, cellzero, dcell, pos, pspos);
+			else        BuildNeighbourCandT_M<false>(np, nc, hdivskin, cellfluid, begincell, cellzero, dcell, pos, pspos);
+		}
+		if (Psingle)RefreshNeighbourListT_M<true, KERNEL_Wendland>(np, pos, pspos);
+		else        RefreshNeighbourListT_M<false, KERNEL_Wendland>(np, pos, pspos);
+	}
+}
 
+//==============================================================================
+/// Builds the neighbour list of particles [0,np) starting from the cell division.
+/// First pass counts the neighbours of each particle in boundary and fluid cells,
+/// second pass stores the pairs (distance, kernel gradient and kernel value)
+/// in the same order as the cell walk of the interaction functions.
+//==============================================================================
+template<bool psingle, TpKernel tker> void JSphSolidCpu::BuildNeighbourListT_M
+(unsigned np, tint4 nc, int hdiv, unsigned cellfluid
+	, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
+	, const tdouble3* pos, const tfloat3* pspos)
+{
+	NbList->PrepareCount(np);
+	unsigned* nbcount = NbList->GetCountPtr();
+	const int pfin = int(np);
 
+	//-Counts neighbours in boundary (cel=0) and fluid (cel=1) cells.
 #ifdef OMP_USE
 #pragma omp parallel for schedule (guided)
 #endif
-
-	for (int p1 = int(pinit); p1 < pfin; p1++) {
-		float visc = 0, arp1 = 0, deltap1 = 0;
-		tfloat3 acep1 = TFloat3(0);
+	for (int p1 = 0; p1 < pfin; p1++) {
+		const tfloat3 psposp1 = (psingle ? pspos[p1] : TFloat3(0));
+		const tdouble3 posp1 = (psingle ? TDouble3(0) : pos[p1]);
+		int cxini, cxfin, yini, yfin, zini, zfin;
+		GetInteractionCells(dcell[p1], hdiv, nc, cellzero, cxini, cxfin, yini, yfin, zini, zfin);
+		for (unsigned cel = 0; cel < 2; cel++) {
+			unsigned count = 0;
+			for (int z = zini; z < zfin; z++) {
+				const int zmod = (nc.w) * z + (cel ? cellfluid : 0);
+				for (int y = yini; y < yfin; y++) {
+					int ymod = zmod + nc.x * y;
+					const unsigned pini = beginendcell[cxini + ymod];
+					const unsigned pfin = beginendcell[cxfin + ymod];
+					for (unsigned p2 = pini; p2 < pfin; p2++) {
+						const float drx = (psingle ? psposp1.x - pspos[p2].x : float(posp1.x - pos[p2].x));
+						const float dry = (psingle ? psposp1.y - pspos[p2].y : float(posp1.y - pos[p2].y));
+						const float drz = (psingle ? psposp1.z - pspos[p2].z : float(posp1.z - pos[p2].z));
+						const float rr2 = drx * drx + dry * dry + drz * drz;
+						if (rr2 <= Fourh2 && rr2 >= ALMOSTZERO)count++;
+					}
+				}
+			}
+			nbcount[p1 * 2 + cel] = count;
+		}
+	}
+	NbList->CompleteCount();
+	const unsigned* nbbegin = NbList->GetBegin();
+	StNeighbourPair* pairs = NbList->GetPairsPtr();
+
+	//-Stores geometry of the pairs.
+#ifdef OMP_USE
+#pragma omp parallel for schedule (guided)
+#endif
+	for (int p1 = 0; p1 < pfin; p1++) {
+		const tfloat3 psposp1 = (psingle ? pspos[p1] : TFloat3(0));
+		const tdouble3 posp1 = (psingle ? TDouble3(0) : pos[p1]);
+		int cxini, cxfin, yini, yfin, zini, zfin;
+		GetInteractionCells(dcell[p1], hdiv, nc, cellzero, cxini, cxfin, yini, yfin, zini, zfin);
+		for (unsigned cel = 0; cel < 2; cel++) {
+			unsigned cp = nbbegin[p1 * 2 + cel];
+			for (int z = zini; z < zfin; z++) {
+				const int zmod = (nc.w) * z + (cel ? cellfluid : 0);
+				for (int y = yini; y < yfin; y++) {
+					int ymod = zmod + nc.x * y;
+					const unsigned pini = beginendcell[cxini + ymod];
+					const unsigned pfin = beginendcell[cxfin + ymod];
+					for (unsigned p2 = pini; p2 < pfin; p2++) {
+						const float drx = (psingle ? psposp1.x - pspos[p2].x : float(posp1.x - pos[p2].x));
+						const float dry = (psingle ? psposp1.y - pspos[p2].y : float(posp1.y - pos[p2].y));
+						const float drz = (psingle ? psposp1.z - pspos[p2].z : float(posp1.z - pos[p2].z));
+						const float rr2 = drx * drx + dry * dry + drz * drz;
+						if (rr2 <= Fourh2 && rr2 >= ALMOSTZERO) {
+							StNeighbourPair& pr = pairs[cp++];
+							pr.p2 = p2;
+							pr.drx = drx; pr.dry = dry; pr.drz = drz;
+							pr.rr2 = rr2;
+							if (tker == KERNEL_Wendland)GetKernelWendland(rr2, drx, dry, drz, pr.frx, pr.fry, pr.frz);
+							else if (tker == KERNEL_Gaussian)GetKernelGaussian(rr2, drx, dry, drz, pr.frx, pr.fry, pr.frz);
+							else if (tker == KERNEL_Cubic)GetKernelCubic(rr2, drx, dry, drz, pr.frx, pr.fry, pr.frz);
+							if (tker == KERNEL_Wendland)GetKernelDirectWend_M(rr2, pr.fr);
+							else pr.fr = 0.0f;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+//==============================================================================
+/// Builds the list of candidates within 2h+NlSkin of particles [0,np) starting
+/// from the cell division (Verlet skin mode). The cell range is increased so
+/// all the candidates are found. Stores positions to check the displacement.
+//==============================================================================
+template<bool psingle> void JSphSolidCpu::BuildNeighbourCandT_M
+(unsigned np, tint4 nc, int hdiv, unsigned cellfluid
+	, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
+	, const tdouble3* pos, const tfloat3* pspos)
+{
+	const float rcand2 = (Dosh + NlSkin) * (Dosh + NlSkin);
+	NbList->PrepareCandCount(np);
+	unsigned* nbcount = NbList->GetCandCountPtr();
+	const int pfin = int(np);
+
+	//-Counts candidates in boundary (cel=0) and fluid (cel=1) cells.
+#ifdef OMP_USE
+#pragma omp parallel for schedule (guided)
+#endif
+	for (int p1 = 0; p1 < pfin; p1++) {
+		const tfloat3 psposp1 = (psingle ? pspos[p1] : TFloat3(0));
+		const tdouble3 posp1 = (psingle ? TDouble3(0) : pos[p1]);
+		int cxini, cxfin, yini, yfin, zini, zfin;
+		GetInteractionCells(dcell[p1], hdiv, nc, cellzero, cxini, cxfin, yini, yfin, zini, zfin);
+		for (unsigned cel = 0; cel < 2; cel++) {
+			unsigned count = 0;
+			for (int z = zini; z < zfin; z++) {
+				const int zmod = (nc.w) * z + (cel ? cellfluid : 0);
+				for (int y = yini; y < yfin; y++) {
+					int ymod = zmod + nc.x * y;
+					const unsigned pini = beginendcell[cxini + ymod];
+					const unsigned pfin = beginendcell[cxfin + ymod];
+					for (unsigned p2 = pini; p2 < pfin; p2++) {
+						const float drx = (psingle ? psposp1.x - pspos[p2].x : float(posp1.x - pos[p2].x));
+						const float dry = (psingle ? psposp1.y - pspos[p2].y : float(posp1.y - pos[p2].y));
+						const float drz = (psingle ? psposp1.z - pspos[p2].z : float(posp1.z - pos[p2].z));
+						const float rr2 = drx * drx + dry * dry + drz * drz;
+						if (rr2 <= rcand2 && p2 != unsigned(p1))count++;
+					}
+				}
+			}
+			nbcount[p1 * 2 + cel] = count;
+		}
+	}
+	NbList->CompleteCandCount();
+	const unsigned* nbbegin = NbList->GetCandBegin();
+	unsigned* cand = NbList->GetCandPtr();
+	tdouble3* candpos = NbList->GetCandPosPtr();
+
+	//-Stores candidates and reference positions.
+#ifdef OMP_USE
+#pragma omp parallel for schedule (guided)
+#endif
+	for (int p1 = 0; p1 < pfin; p1++) {
+		candpos[p1] = pos[p1];
+		const tfloat3 psposp1 = (psingle ? pspos[p1] : TFloat3(0));
+		const tdouble3 posp1 = (psingle ? TDouble3(0) : pos[p1]);
+		int cxini, cxfin, yini, yfin, zini, zfin;
+		GetInteractionCells(dcell[p1], hdiv, nc, cellzero, cxini, cxfin, yini, yfin, zini, zfin);
+		for (unsigned cel = 0; cel < 2; cel++) {
+			unsigned cp = nbbegin[p1 * 2 + cel];
+			for (int z = zini; z < zfin; z++) {
+				const int zmod = (nc.w) * z + (cel ? cellfluid : 0);
+				for (int y = yini; y < yfin; y++) {
+					int ymod = zmod + nc.x * y;
+					const unsigned pini = beginendcell[cxini + ymod];
+					const unsigned pfin = beginendcell[cxfin + ymod];
+					for (unsigned p2 = pini; p2 < pfin; p2++) {
+						const float drx = (psingle ? psposp1.x - pspos[p2].x : float(posp1.x - pos[p2].x));
+						const float dry = (psingle ? psposp1.y - pspos[p2].y : float(posp1.y - pos[p2].y));
+						const float drz = (psingle ? psposp1.z - pspos[p2].z : float(posp1.z - pos[p2].z));
+						const float rr2 = drx * drx + dry * dry + drz * drz;
+						if (rr2 <= rcand2 && p2 != unsigned(p1))cand[cp++] = p2;
+					}
+				}
+			}
+		}
+	}
+	NbList->SetCandValid(true);
+}
+
+//==============================================================================
+/// Computes the pairs within 2h of particles [0,np) from the list of candidates
+/// (Verlet skin mode). Pairs keep the order of the candidates.
+//==============================================================================
+template<bool psingle, TpKernel tker> void JSphSolidCpu::RefreshNeighbourListT_M
+(unsigned np, const tdouble3* pos, const tfloat3* pspos)
+{
+	const unsigned* cbegin = NbList->GetCandBegin();
+	const unsigned* cand = NbList->GetCand();
+	NbList->PrepareCount(np);
+	unsigned* nbcount = NbList->GetCountPtr();
+	const int pfin = int(np);
+
+	//-Counts candidates within 2h.
+#ifdef OMP_USE
+#pragma omp parallel for schedule (guided)
+#endif
+	for (int p1 = 0; p1 < pfin; p1++) {
+		const tfloat3 psposp1 = (psingle ? pspos[p1] : TFloat3(0));
+		const tdouble3 posp1 = (psingle ? TDouble3(0) : pos[p1]);
+		for (unsigned cel = 0; cel < 2; cel++) {
+			unsigned count = 0;
+			const unsigned cfin = cbegin[p1 * 2 + cel + 1];
+			for (unsigned c = cbegin[p1 * 2 + cel]; c < cfin; c++) {
+				const unsigned p2 = cand[c];
+				const float drx = (psingle ? psposp1.x - pspos[p2].x : float(posp1.x - pos[p2].x));
+				const float dry = (psingle ? psposp1.y - pspos[p2].y : float(posp1.y - pos[p2].y));
+				const float drz = (psingle ? psposp1.z - pspos[p2].z : float(posp1.z - pos[p2].z));
+				const float rr2 = drx * drx + dry * dry + drz * drz;
+				if (rr2 <= Fourh2 && rr2 >= ALMOSTZERO)count++;
+			}
+			nbcount[p1 * 2 + cel] = count;
+		}
+	}
+	NbList->CompleteCount();
+	const unsigned* nbbegin = NbList->GetBegin();
+	StNeighbourPair* pairs = NbList->GetPairsPtr();
+
+	//-Stores geometry of the pairs.
+#ifdef OMP_USE
+#pragma omp parallel for schedule (guided)
+#endif
+	for (int p1 = 0; p1 < pfin; p1++) {
+		const tfloat3 psposp1 = (psingle ? pspos[p1] : TFloat3(0));
+		const tdouble3 posp1 = (psingle ? TDouble3(0) : pos[p1]);
+		unsigned cp = nbbegin[p1 * 2];
+		const unsigned cfin = cbegin[p1 * 2 + 2];
+		for (unsigned c = cbegin[p1 * 2]; c < cfin; c++) {
+			const unsigned p2 = cand[c];
+			const float drx = (psingle ? psposp1.x - pspos[p2].x : float(posp1.x - pos[p2].x));
+			const float dry = (psingle ? psposp1.y - pspos[p2].y : float(posp1.y - pos[p2].y));
+			const float drz = (psingle ? psposp1.z - pspos[p2].z : float(posp1.z - pos[p2].z));
+			const float rr2 = drx * drx + dry * dry + drz * drz;
+			if (rr2 <= Fourh2 && rr2 >= ALMOSTZERO) {
+				StNeighbourPair& pr = pairs[cp++];
+				pr.p2 = p2;
+				pr.drx = drx; pr.dry = dry; pr.drz = drz;
+				pr.rr2 = rr2;
+				if (tker == KERNEL_Wendland)GetKernelWendland(rr2, drx, dry, drz, pr.frx, pr.fry, pr.frz);
+				else if (tker == KERNEL_Gaussian)GetKernelGaussian(rr2, drx, dry, drz, pr.frx, pr.fry, pr.frz);
+				else if (tker == KERNEL_Cubic)GetKernelCubic(rr2, drx, dry, drz, pr.frx, pr.fry, pr.frz);
+				if (tker == KERNEL_Wendland)GetKernelDirectWend_M(rr2, pr.fr);
+				else pr.fr = 0.0f;
+			}
+		}
+	}
+}
+
+//==============================================================================
+/// Returns true when the list of candidates is no longer valid and a new divide
+/// is required: candidates were not built, the number of particles changed
+/// (division), some particle was marked as excluded or the maximum displacement
+/// since the candidates were built is over NlSkin/2.
+//==============================================================================
+bool JSphSolidCpu::CheckNeighbourSkin_M(unsigned np, const tdouble3* pos, const typecode* code)const {
+	if (!NbList->GetCandValid() || NbList->GetCandNp() != np)return(true);
+	const tdouble3* candpos = NbList->GetCandPos();
+	const double lim2 = double(NlSkin) * double(NlSkin) * 0.25;
+	double dmaxth[OMP_MAXTHREADS * OMP_STRIDE];
+	bool outth[OMP_MAXTHREADS * OMP_STRIDE];
+	for (int th = 0; th < OmpThreads; th++) { dmaxth[th * OMP_STRIDE] = 0; outth[th * OMP_STRIDE] = false; }
+	const int n = int(np);
+#ifdef OMP_USE
+#pragma omp parallel for schedule (static)
+#endif
+	for (int p = 0; p < n; p++) {
+		const int th = omp_get_thread_num();
+		const double dx = pos[p].x - candpos[p].x, dy = pos[p].y - candpos[p].y, dz = pos[p].z - candpos[p].z;
+		const double d2 = dx * dx + dy * dy + dz * dz;
+		if (d2 > dmaxth[th * OMP_STRIDE])dmaxth[th * OMP_STRIDE] = d2;
+		if (!CODE_IsNormal(code[p]))outth[th * OMP_STRIDE] = true;
+	}
+	bool expired = false;
+	for (int th = 0; th < OmpThreads; th++)if (outth[th * OMP_STRIDE] || dmaxth[th * OMP_STRIDE] > lim2)expired = true;
+	return(expired);
+}
+
+//==============================================================================
+/// DFPM correction on the neighbour list - Matthias #V38
+/// Same result as ComputeDFPM37 without walking the cells.
+//==============================================================================
+void JSphSolidCpu::ComputeDFPM38(unsigned n, unsigned pinit
+	, const tfloat4* velrhop, const float* mass, tmatrix3f* L, float* co)const
+{
+	const unsigned* nbbegin = NbList->GetBegin();
+	const StNeighbourPair* pairs = NbList->GetPairs();
+	const int pfin = int(pinit + n);
+
+#ifdef OMP_USE
+#pragma omp parallel
+#endif
+	{
+		const JTimerRegistry::ThreadScope ths(TimersReg, TmsCorrection);
+#ifdef OMP_USE
+#pragma omp for schedule (guided) nowait
+#endif
+		for (int p1 = int(pinit); p1 < pfin; p1++) {
+			tfloat3 M = { 0,0,0 };
+			//-Boundary neighbours then fluid neighbours.
+			const unsigned cpfin = nbbegin[p1 * 2 + 2];
+			for (unsigned cp = nbbegin[p1 * 2]; cp < cpfin; cp++) {
+				const StNeighbourPair& pr = pairs[cp];
+				const unsigned p2 = pr.p2;
+				const float volp2 = -mass[p2] / velrhop[p2].w;
+				M = M + TFloat3(pr.drx * pr.frx, pr.dry * pr.fry, pr.drz * pr.frz) * volp2;
+			}
+			if (Simulate2D) M.y = 1.0f;
+
+			// Inversion of diagonal elements
+			L[p1] = { 1.0f / M.x, 0, 0, 0, 1.0f / M.y, 0,0,0, 1.0f / M.z };
+			co[p1] = 0.0f;
+		}
+	}
+}
+
+//==============================================================================
+/// Interaction particles 38 - Matthias
+/// Same as InteractionForces_V31_M but iterates the neighbour list, boundp2
+/// selects the boundary or fluid neighbours of each particle.
+//==============================================================================
+template<TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph tdelta, bool shift> void JSphSolidCpu::InteractionForces_V38_M
+(unsigned n, unsigned pinit, bool boundp2, float visco
+	, const tsymatrix3fsoa tau, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega
+	, const tfloat4* velrhop, const typecode* code, const unsigned* idp
+	, const float* press, const float* pore, const float* mass
+	, tmatrix3f* L
+	, float& viscdt, float* ar, tfloat3* ace, float* delta
+	, TpShifting tshifting, tfloat3* shiftpos, float* shiftdetect)const
+{
+	const unsigned* nbbegin = NbList->GetBegin();
+	const StNeighbourPair* pairs = NbList->GetPairs();
+	const unsigned nbini = (boundp2 ? 0 : 1);
+	float viscth[OMP_MAXTHREADS * OMP_STRIDE];
+	for (int th = 0; th < OmpThreads; th++)viscth[th * OMP_STRIDE] = 0;
+	//-Initialise execution with OpenMP. | Inicia ejecucion con OpenMP..
+	const int pfin = int(pinit + n);
+
+#ifdef OMP_USE
+#pragma omp parallel for schedule (guided)
+#endif
+	for (int p1 = int(pinit); p1 < pfin; p1++) {
+		float visc = 0, arp1 = 0, deltap1 = 0;
+		tfloat3 acep1 = TFloat3(0);
+
+		// Matthias
+		tsymatrix3f gradvelp1 = { 0, 0, 0, 0, 0, 0 };
+		tsymatrix3f omegap1 = { 0, 0, 0, 0, 0, 0 };
+		tfloat3 shiftposp1 = TFloat3(0);
+		float shiftdetectp1 = 0.0f;
+		float drhop1 = 0.0f;
+
+		//-Obtain data of particle p1 in case of floating objects. | Obtiene datos de particula p1 en caso de existir floatings.
+		bool ftp1 = false;     //-Indicate if it is floating. | Indica si es floating.
+		float ftmassp1 = 1.f;  //-Contains floating particle mass or 1.0f if it is fluid. | Contiene masa de particula floating o 1.0f si es fluid..
+		if (USE_FLOATING) {
+			ftp1 = CODE_IsFloating(code[p1]);
+			if (ftp1)ftmassp1 = FtObjs[CODE_GetTypeValue(code[p1])].massp;
+			if (ftp1 && (tdelta == DELTA_Dynamic || tdelta == DELTA_DynamicExt))deltap1 = FLT_MAX;
+			if (ftp1 && shift)shiftposp1.x = FLT_MAX;  //-For floating objects do not calculate shifting. | Para floatings no se calcula shifting.
+		}
+
+		//-Obtain data of particle p1.
+		const tfloat3 velp1 = TFloat3(velrhop[p1].x, velrhop[p1].y, velrhop[p1].z);
+		const float rhopp1 = velrhop[p1].w;
+		const float pressp1 = press[p1];
+		const tsymatrix3f taup1 = tau[p1];
+		const float porep1 = pore[p1];
+
+		//-Interaction of Fluid with type Fluid or Bound. | Interaccion de Fluid con varias Fluid o Bound.
+		//------------------------------------------------------------------------------------------------
+		const unsigned cpfin = nbbegin[p1 * 2 + nbini + 1];
+		for (unsigned cp = nbbegin[p1 * 2 + nbini]; cp < cpfin; cp++) {
+			const StNeighbourPair& pr = pairs[cp];
+			const unsigned p2 = pr.p2;
+			const float drx = pr.drx, dry = pr.dry, drz = pr.drz, rr2 = pr.rr2;
+			const float frx = pr.frx, fry = pr.fry, frz = pr.frz;
+
+			//===== Get mass of particle p2 ===== 
+			float massp2 = (boundp2 ? MassBound : mass[p2]); //-Contiene masa de particula segun sea bound o fluid.
+			bool ftp2 = false;    //-Indicate if it is floating | Indica si es floating.
+			bool compute = true;  //-Deactivate when using DEM and if it is of type float-float or float-bound | Se desactiva cuando se usa DEM y es float-float o float-bound.
+			if (USE_FLOATING) {
+				ftp2 = CODE_IsFloating(code[p2]);
+				if (ftp2)massp2 = FtObjs[CODE_GetTypeValue(code[p2])].massp;
+#ifdef DELTA_HEAVYFLOATING
+				if (ftp2 && massp2 <= (MassFluid * 1.2f) && (tdelta == DELTA_Dynamic || tdelta == DELTA_DynamicExt))deltap1 = FLT_MAX;
+#else
+				if (ftp2 && (tdelta == DELTA_Dynamic || tdelta == DELTA_DynamicExt))deltap1 = FLT_MAX;
+#endif
+				if (ftp2 && shift && tshifting == SHIFT_NoBound)shiftposp1.x = FLT_MAX; //-With floating objects do not use shifting. | Con floatings anula shifting.
+				compute = !(USE_DEM && ftp1 && (boundp2 || ftp2)); //-Deactivate when using DEM and if it is of type float-float or float-bound. | Se desactiva cuando se usa DEM y es float-float o float-bound.
+			}
+
+			//===== Acceleration ===== 
+			if (compute) {
+				const tsymatrix3f prs = {
+					(pressp1 + porep1 - taup1.xx + press[p2] + pore[p2] - tau[p2].xx) / (rhopp1 * velrhop[p2].w) + (tker == KERNEL_Cubic ? GetKernelCubicTensil(rr2, rhopp1, pressp1, velrhop[p2].w, press[p2]) : 0),
+					-(taup1.xy + tau[p2].xy) / (rhopp1 * velrhop[p2].w),
+					-(taup1.xz + tau[p2].xz) / (rhopp1 * velrhop[p2].w),
+					(pressp1 + porep1 - taup1.yy + press[p2] + pore[p2] - tau[p2].yy) / (rhopp1 * velrhop[p2].w) + (tker == KERNEL_Cubic ? GetKernelCubicTensil(rr2, rhopp1, pressp1, velrhop[p2].w, press[p2]) : 0),
+					-(taup1.yz + tau[p2].yz) / (rhopp1 * velrhop[p2].w),
+					(pressp1 + porep1 - taup1.zz + press[p2] + pore[p2] - tau[p2].zz) / (rhopp1 * velrhop[p2].w) + (tker == KERNEL_Cubic ? GetKernelCubicTensil(rr2, rhopp1, pressp1, velrhop[p2].w, press[p2]) : 0)
+				};
+				const tsymatrix3f p_vpm3 = {
+					-prs.xx * massp2 * ftmassp1, -prs.xy * massp2 * ftmassp1, -prs.xz * massp2 * ftmassp1,
+					-prs.yy * massp2 * ftmassp1, -prs.yz * massp2 * ftmassp1, -prs.zz * massp2 * ftmassp1
+				};
+
+				acep1.x += p_vpm3.xx * frx * L[p1].a11 + p_vpm3.xy * fry * L[p1].a12 + p_vpm3.xz * frz * L[p1].a13;
+				acep1.y += p_vpm3.xy * frx * L[p1].a21 + p_vpm3.yy * fry * L[p1].a22 + p_vpm3.yz * frz * L[p1].a23;
+				acep1.z += p_vpm3.xz * frx * L[p1].a31 + p_vpm3.yz * fry * L[p1].a32 + p_vpm3.zz * frz * L[p1].a33;
+			}
+
+			//-Density derivative. #density
+			const float dvx = velp1.x - velrhop[p2].x, dvy = velp1.y - velrhop[p2].y, dvz = velp1.z - velrhop[p2].z;
+			if (compute)arp1 += massp2 * (dvx * frx * L[p1].a11 + dvy * fry * L[p1].a22 + dvz * frz * L[p1].a33);
+
+			const float cbar = (float)Cs0;
+
+			//-Density derivative (DeltaSPH Molteni).
+			if ((tdelta == DELTA_Dynamic || tdelta == DELTA_DynamicExt) && deltap1 != FLT_MAX) {
+				const float rhop1over2 = rhopp1 / velrhop[p2].w;
+				const float visc_densi = Delta2H * cbar * (rhop1over2 - 1.f) / (rr2 + Eta2);
+				const float dot3 = (drx * frx + dry * fry + drz * frz);
+				const float delta = visc_densi * dot3 * massp2;
+				deltap1 = (boundp2 ? FLT_MAX : deltap1 + delta);
+			}
+
+			//-Shifting correction.
+			if (shift && shiftposp1.x != FLT_MAX) {
+				const float massrhop = massp2 / velrhop[p2].w;
+				const bool noshift = (boundp2 && (tshifting == SHIFT_NoBound || (tshifting == SHIFT_NoFixed && CODE_IsFixed(code[p2]))));
+				shiftposp1.x = (noshift ? FLT_MAX : shiftposp1.x + massrhop * frx); //-For boundary do not use shifting. | Con boundary anula shifting.
+				shiftposp1.y += massrhop * fry;
+				shiftposp1.z += massrhop * frz;
+				shiftdetectp1 -= massrhop * (drx * frx + dry * fry + drz * frz);
+			}
+
+			//===== Viscosity ======
+			if (compute) {
+				const float dot = drx * dvx + dry * dvy + drz * dvz;
+				const float dot_rr2 = dot / (rr2 + Eta2);
+				visc = max(dot_rr2, visc);
+				if (!lamsps) {//-Artificial viscosity.
+					if (dot < 0) {
+						const float amubar = H * dot_rr2;  //amubar=CTE.h*dot/(rr2+CTE.eta2);
+						const float robar = (rhopp1 + velrhop[p2].w) * 0.5f;
+						const float pi_visc = (-visco * cbar * amubar / robar) * massp2 * ftmassp1;
+						acep1.x -= pi_visc * frx; acep1.y -= pi_visc * fry; acep1.z -= pi_visc * frz;
+					}
+				}
+			}
+
+			//===== Velocity gradients ===== 
+			if (compute) {
+				if (!ftp1) {//-When p1 is a fluid particle / Cuando p1 es fluido. 
+					const float volp2 = -massp2 / velrhop[p2].w;
+
+					// Velocity gradient NSPH
+					float dv = dvx * volp2;
+					gradvelp1.xx += dv * frx * L[p1].a11; gradvelp1.xy += 0.5f * dv * fry * L[p1].a12; gradvelp1.xz += 0.5f * dv * frz * L[p1].a13;
+					omegap1.xy += 0.5f * dv * fry * L[p1].a12; omegap1.xz += 0.5f * dv * frz * L[p1].a13;
+
+					dv = dvy * volp2;
+					gradvelp1.xy += 0.5f * dv * frx * L[p1].a21; gradvelp1.yy += dv * fry * L[p1].a22; gradvelp1.yz += 0.5f * dv * frz * L[p1].a23;
+					omegap1.xy -= 0.5f * dv * frx * L[p1].a21; omegap1.yz += 0.5f * dv * frz * L[p1].a23;
+
+					dv = dvz * volp2;
+					gradvelp1.xz += 0.5f * dv * frx * L[p1].a31; gradvelp1.yz += 0.5f * dv * fry * L[p1].a32; gradvelp1.zz += dv * frz * L[p1].a33;
+					omegap1.xz -= 0.5f * dv * frx * L[p1].a31; omegap1.yz -= 0.5f * dv * fry * L[p1].a32;
+				}
+			}
+		}
+
+		//-Stores results, the Fluid-Fluid pass writes the final values (nothing is
+		// initialised before the interaction) and the Fluid-Bound pass adds its terms.
+		if (!boundp2) {
+			if (tdelta == DELTA_Dynamic && deltap1 != FLT_MAX)arp1 += deltap1;
+			if (tdelta == DELTA_DynamicExt)delta[p1] = deltap1;
+			ar[p1] = arp1;
+			ace[p1] = Gravity + acep1;
+			const int th = omp_get_thread_num();
+			if (visc > viscth[th * OMP_STRIDE])viscth[th * OMP_STRIDE] = visc;
+			if (shift) {
+				shiftpos[p1] = (shiftposp1.x == FLT_MAX ? TFloat3(FLT_MAX, 0, 0) : shiftposp1);
+				if (shiftdetect)shiftdetect[p1] = shiftdetectp1;
+			}
+			gradvel[p1] = gradvelp1;
+			omega[p1] = omegap1;
+		}
+		else if (shift || arp1 || acep1.x || acep1.y || acep1.z || visc || gradvelp1.xx || gradvelp1.xy
+			|| gradvelp1.xz || gradvelp1.yy || gradvelp1.yz || gradvelp1.zz || omegap1.xx || omegap1.xy
+			|| omegap1.xz || omegap1.yy || omegap1.yz || omegap1.zz || drhop1) {
+			if (tdelta == DELTA_Dynamic && deltap1 != FLT_MAX)arp1 += deltap1;
+			if (tdelta == DELTA_DynamicExt)delta[p1] = (delta[p1] == FLT_MAX || deltap1 == FLT_MAX ? FLT_MAX : delta[p1] + deltap1);
+			ar[p1] += arp1;
+			ace[p1] = ace[p1] + acep1;
+			const int th = omp_get_thread_num();
+			if (visc > viscth[th * OMP_STRIDE])viscth[th * OMP_STRIDE] = visc;
+
+			if (shift && shiftpos[p1].x != FLT_MAX) {
+				shiftpos[p1] = (shiftposp1.x == FLT_MAX ? TFloat3(FLT_MAX, 0, 0) : shiftpos[p1] + shiftposp1);
+				if (shiftdetect)shiftdetect[p1] += shiftdetectp1;
+			}
+
+			// Gradvel and rotation tensor .
+			gradvel[p1].xx += gradvelp1.xx;
+			gradvel[p1].xy += gradvelp1.xy;
+			gradvel[p1].xz += gradvelp1.xz;
+			gradvel[p1].yy += gradvelp1.yy;
+			gradvel[p1].yz += gradvelp1.yz;
+			gradvel[p1].zz += gradvelp1.zz;
+
+			omega[p1].xx += omegap1.xx;
+			omega[p1].xy += omegap1.xy;
+			omega[p1].xz += omegap1.xz;
+			omega[p1].yy += omegap1.yy;
+			omega[p1].yz += omegap1.yz;
+			omega[p1].zz += omegap1.zz;
+		}
+	}
+
+	//-Keep max value in viscdt. | Guarda en viscdt el valor maximo.
+	for (int th = 0; th < OmpThreads; th++)if (viscdt < viscth[th * OMP_STRIDE])viscdt = viscth[th * OMP_STRIDE];
+}
+
+//==============================================================================
+/// Interaction Bound-Fluid on the neighbour list - Matthias #V38
+/// Same as InteractionForcesBound31_M without walking the cells.
+//==============================================================================
+template<TpFtMode ftmode> void JSphSolidCpu::InteractionForcesBound38_M
+(unsigned n, unsigned pinit, const tfloat4* velrhop, const typecode* code, const unsigned* idp
+	, float& viscdt, float* ar, const float* mass, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega, tmatrix3f* L)const
+{
+	const unsigned* nbbegin = NbList->GetBegin();
+	const StNeighbourPair* pairs = NbList->GetPairs();
+	//-Initialize viscth to calculate max viscdt with OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
+	float viscth[OMP_MAXTHREADS * OMP_STRIDE];
+	for (int th = 0; th < OmpThreads; th++)viscth[th * OMP_STRIDE] = 0;
+
+	//-Starts execution using OpenMP.
+	const int pfin = int(pinit + n);
+#ifdef OMP_USE
+#pragma omp parallel for schedule (guided)
+#endif
+	for (int p1 = int(pinit); p1 < pfin; p1++) {
+		float visc = 0, arp1 = 0;
+		tsymatrix3f gradvelp1 = { 0, 0, 0, 0, 0, 0 };
+		tsymatrix3f omegap1 = { 0, 0, 0, 0, 0, 0 };
+
+		//-Load data of particle p1. | Carga datos de particula p1.
+		const tfloat3 velp1 = TFloat3(velrhop[p1].x, velrhop[p1].y, velrhop[p1].z);
+
+		//-Interaction of boundary with type Fluid/Float | Interaccion de Bound con varias Fluid/Float.
+		//---------------------------------------------------------------------------------------------
+		const unsigned cpfin = nbbegin[p1 * 2 + 2];
+		for (unsigned cp = nbbegin[p1 * 2 + 1]; cp < cpfin; cp++) {
+			const StNeighbourPair& pr = pairs[cp];
+			const unsigned p2 = pr.p2;
+			const float drx = pr.drx, dry = pr.dry, drz = pr.drz, rr2 = pr.rr2;
+			const float frx = pr.frx, fry = pr.fry, frz = pr.frz;
+
+			//===== Get mass of particle p2 ===== 
+			float massp2 = mass[p2]; //-Contains particle mass of incorrect fluid. | Contiene masa de particula por defecto fluid.
+			bool compute = true;      //-Deactivate when using DEM and/or bound-float. | Se desactiva cuando se usa DEM y es bound-float.
+			if (USE_FLOATING) {
+				bool ftp2 = CODE_IsFloating(code[p2]);
+				if (ftp2)massp2 = FtObjs[CODE_GetTypeValue(code[p2])].massp;
+				compute = !(USE_DEM && ftp2); //-Deactivate when using DEM and/or bound-float. | Se desactiva cuando se usa DEM y es bound-float.
+			}
+
+			//-Density derivative.
+			const float dvx = velp1.x - velrhop[p2].x, dvy = velp1.y - velrhop[p2].y, dvz = velp1.z - velrhop[p2].z;
+			if (compute) arp1 += massp2 * (dvx * frx * L[p1].a11 + dvy * fry * L[p1].a22 + dvz * frz * L[p1].a33);
+
+			//-Viscosity.
+			if (compute) {
+				const float dot = drx * dvx + dry * dvy + drz * dvz;
+				const float dot_rr2 = dot / (rr2 + Eta2);
+				visc = max(dot_rr2, visc);
+			}
+
+			//===== Velocity gradients ===== 
+			if (compute) {
+				const float volp2 = -massp2 / velrhop[p2].w;
+
+				// Velocity gradient NSPH
+				float dv = dvx * volp2;
+				gradvelp1.xx += dv * frx * L[p1].a11; gradvelp1.xy += 0.5f * dv * fry * L[p1].a12; gradvelp1.xz += 0.5f * dv * frz * L[p1].a13;
+				omegap1.xy += 0.5f * dv * fry * L[p1].a12; omegap1.xz += 0.5f * dv * frz * L[p1].a13;
+
+				dv = dvy * volp2;
+				gradvelp1.xy += 0.5f * dv * frx * L[p1].a21; gradvelp1.yy += dv * fry * L[p1].a22; gradvelp1.yz += 0.5f * dv * frz * L[p1].a23;
+				omegap1.xy -= 0.5f * dv * frx * L[p1].a21; omegap1.yz += 0.5f * dv * frz * L[p1].a23;
+
+				dv = dvz * volp2;
+				gradvelp1.xz += 0.5f * dv * frx * L[p1].a31; gradvelp1.yz += 0.5f * dv * fry * L[p1].a32; gradvelp1.zz += dv * frz * L[p1].a33;
+				omegap1.xz -= 0.5f * dv * frx * L[p1].a31; omegap1.yz -= 0.5f * dv * fry * L[p1].a32;
+			}
+		}
+		//-Sum results together. | Almacena resultados.
+		if (arp1 || visc || gradvelp1.xx || gradvelp1.xy || gradvelp1.xz || gradvelp1.yy || gradvelp1.yz || gradvelp1.zz
+			|| omegap1.xx || omegap1.xy || omegap1.xz || omegap1.yy || omegap1.yz || omegap1.zz) {
+			ar[p1] += arp1;
+			const int th = omp_get_thread_num();
+			if (visc > viscth[th * OMP_STRIDE])viscth[th * OMP_STRIDE] = visc;
+
+			// Gradvel and rotation tensor .
+			gradvel[p1].xx += gradvelp1.xx;
+			gradvel[p1].xy += gradvelp1.xy;
+			gradvel[p1].xz += gradvelp1.xz;
+			gradvel[p1].yy += gradvelp1.yy;
+			gradvel[p1].yz += gradvelp1.yz;
+			gradvel[p1].zz += gradvelp1.zz;
+
+			omega[p1].xx += omegap1.xx;
+			omega[p1].xy += omegap1.xy;
+			omega[p1].xz += omegap1.xz;
+			omega[p1].yy += omegap1.yy;
+			omega[p1].yz += omegap1.yz;
+			omega[p1].zz += omegap1.zz;
+		}
+	}
+	//-Keep max value in viscdt. | Guarda en viscdt el valor maximo.
+	for (int th = 0; th < OmpThreads; th++)if (viscdt < viscth[th * OMP_STRIDE])viscdt = viscth[th * OMP_STRIDE];
+}
+
+//==============================================================================
+/// Splits the fluid particles [pinit,pinit+n) in blocks for the symmetric
+/// evaluation of pairs. Returns false when there are not enough blocks to
+/// keep all threads busy, in that case the full pair list is used. #V38 #symmetric
+//==============================================================================
+bool JSphSolidCpu::PrepareHalfBlocks38_M(unsigned n, unsigned pinit)const {
+	const unsigned* nbbegin = NbList->GetBegin();
+	const StNeighbourPair* pairs = NbList->GetPairs();
+	unsigned* reach = NbList->PrepareHalfReach(pinit + n);
+	const int pfin = int(pinit + n);
+
+#ifdef OMP_USE
+#pragma omp parallel for schedule (static)
+#endif
+	for (int p1 = int(pinit); p1 < pfin; p1++) {
+		unsigned r = unsigned(p1);
+		const unsigned cpfin = nbbegin[p1 * 2 + 2];
+		for (unsigned cp = nbbegin[p1 * 2 + 1]; cp < cpfin; cp++)if (pairs[cp].p2 > r)r = pairs[cp].p2;
+		reach[p1] = r;
+	}
+	const unsigned blocksize = max(64u, n / unsigned(OmpThreads * 16));
+	const unsigned nb = NbList->CompleteHalfBlocks(pinit, pinit + n, blocksize);
+	return(nb >= unsigned(OmpThreads > 1 ? OmpThreads * 2 : 1));
+}
+
+//==============================================================================
+/// Interaction Fluid-Fluid on the neighbour list visiting each pair once - Matthias #V38 #symmetric
+/// Same result as InteractionForces_V38_M (boundp2=false) without floating
+/// bodies. The terms of p1 and p2 are accumulated without the correction
+/// matrix L in SymAce_M, SymGrad_M and SymAr_M, and L is applied later in
+/// ApplySymmetricL38_M(). Even blocks are computed first and odd blocks
+/// after, so two threads never write the same particle.
+//==============================================================================
+template<TpKernel tker, bool lamsps, TpDeltaSph tdelta, bool shift> void JSphSolidCpu::InteractionForcesSym38_M
+(unsigned n, unsigned pinit, float visco
+	, const tsymatrix3fsoa tau, const tfloat4* velrhop
+	, const float* press, const float* pore, const float* mass
+	, float& viscdt, float* ar, tfloat3* ace, float* delta
+	, tfloat3* shiftpos, float* shiftdetect)const
+{
+	const unsigned* nbbegin = NbList->GetBegin();
+	const StNeighbourPair* pairs = NbList->GetPairs();
+	const unsigned* block = NbList->GetHalfBlock();
+	const int nblock = int(NbList->GetHalfNblock());
+	const float cbar = (float)Cs0;
+	float viscth[OMP_MAXTHREADS * OMP_STRIDE];
+	for (int th = 0; th < OmpThreads; th++)viscth[th * OMP_STRIDE] = 0;
+
+	//-Clear accumulators and outputs (the terms of p2 are added before p1 is visited).
+	const int pfin = int(pinit + n);
+#ifdef OMP_USE
+#pragma omp parallel for schedule (static)
+#endif
+	for (int p = int(pinit); p < pfin; p++) {
+		SymAce_M[p] = TMatrix3f(0);
+		SymGrad_M[p] = TMatrix3f(0);
+		SymAr_M[p] = TFloat3(0);
+		ar[p] = 0;
+		ace[p] = Gravity;
+		if (tdelta == DELTA_DynamicExt)delta[p] = 0;
+		if (shift) {
+			shiftpos[p] = TFloat3(0);
+			if (shiftdetect)shiftdetect[p] = 0;
+		}
+	}
+
+	//-Even blocks then odd blocks.
+	for (int phase = 0; phase < 2; phase++) {
+		const int nbphase = (nblock - phase + 1) / 2;
+#ifdef OMP_USE
+#pragma omp parallel for schedule (dynamic)
+#endif
+		for (int cb = 0; cb < nbphase; cb++) {
+			const int b = phase + cb * 2;
+			const int th = omp_get_thread_num();
+			const int bfin = int(block[b + 1]);
+			for (int p1 = int(block[b]); p1 < bfin; p1++) {
+				float visc = 0, deltap1 = 0, shiftdetectp1 = 0;
+				tmatrix3f acep1 = TMatrix3f(0), gradp1 = TMatrix3f(0);
+				tfloat3 arp1 = TFloat3(0), viscp1 = TFloat3(0), shiftposp1 = TFloat3(0);
+
+				//-Obtain data of particle p1.
+				const tfloat3 velp1 = TFloat3(velrhop[p1].x, velrhop[p1].y, velrhop[p1].z);
+				const float rhopp1 = velrhop[p1].w;
+				const float pressp1 = press[p1];
+				const tsymatrix3f taup1 = tau[p1];
+				const float porep1 = pore[p1];
+				const float massp1 = mass[p1];
+				const float volp1 = -massp1 / rhopp1;
+
+				//-Only pairs with p2>p1, the terms of p2 are stored directly.
+				const unsigned cpfin = nbbegin[p1 * 2 + 2];
+				for (unsigned cp = nbbegin[p1 * 2 + 1]; cp < cpfin; cp++) {
+					const StNeighbourPair& pr = pairs[cp];
+					const unsigned p2 = pr.p2;
+					if (p2 <= unsigned(p1))continue;
+					const float drx = pr.drx, dry = pr.dry, drz = pr.drz, rr2 = pr.rr2;
+					const float frx = pr.frx, fry = pr.fry, frz = pr.frz;
+					const float massp2 = mass[p2];
+					const float rhopp2 = velrhop[p2].w;
+					const float volp2 = -massp2 / rhopp2;
+
+					//===== Acceleration ===== 
+					const float rhop12 = rhopp1 * rhopp2;
+					const float prs1 = pressp1 + porep1 + press[p2] + pore[p2];
+					const tsymatrix3f prs = {
+						(prs1 - taup1.xx - tau[p2].xx) / rhop12, -(taup1.xy + tau[p2].xy) / rhop12, -(taup1.xz + tau[p2].xz) / rhop12,
+						(prs1 - taup1.yy - tau[p2].yy) / rhop12, -(taup1.yz + tau[p2].yz) / rhop12,
+						(prs1 - taup1.zz - tau[p2].zz) / rhop12
+					};
+					const tmatrix3f prsfr = TMatrix3f(
+						prs.xx * frx, prs.xy * fry, prs.xz * frz,
+						prs.xy * frx, prs.yy * fry, prs.yz * frz,
+						prs.xz * frx, prs.yz * fry, prs.zz * frz);
+					acep1 = acep1 + (-massp2) * prsfr;
+					SymAce_M[p2] = SymAce_M[p2] + massp1 * prsfr;
+					if (tker == KERNEL_Cubic) {
+						const float tensil1 = GetKernelCubicTensil(rr2, rhopp1, pressp1, rhopp2, press[p2]) * massp2;
+						const float tensil2 = GetKernelCubicTensil(rr2, rhopp2, press[p2], rhopp1, pressp1) * massp1;
+						acep1.a11 -= tensil1 * frx; acep1.a22 -= tensil1 * fry; acep1.a33 -= tensil1 * frz;
+						SymAce_M[p2].a11 += tensil2 * frx; SymAce_M[p2].a22 += tensil2 * fry; SymAce_M[p2].a33 += tensil2 * frz;
+					}
+
+					//===== Density derivative and velocity gradients ===== 
+					const float dvx = velp1.x - velrhop[p2].x, dvy = velp1.y - velrhop[p2].y, dvz = velp1.z - velrhop[p2].z;
+					const tmatrix3f dvfr = TMatrix3f(
+						dvx * frx, dvx * fry, dvx * frz,
+						dvy * frx, dvy * fry, dvy * frz,
+						dvz * frx, dvz * fry, dvz * frz);
+					const tfloat3 dvfrd = TFloat3(dvfr.a11, dvfr.a22, dvfr.a33);
+					arp1 = arp1 + dvfrd * massp2;
+					SymAr_M[p2] = SymAr_M[p2] + dvfrd * massp1;
+					gradp1 = gradp1 + volp2 * dvfr;
+					SymGrad_M[p2] = SymGrad_M[p2] + volp1 * dvfr;
+
+					//-Density derivative (DeltaSPH Molteni).
+					if (tdelta == DELTA_Dynamic || tdelta == DELTA_DynamicExt) {
+						const float visc_densi = Delta2H * cbar / (rr2 + Eta2) * (drx * frx + dry * fry + drz * frz);
+						deltap1 += visc_densi * (rhopp1 / rhopp2 - 1.f) * massp2;
+						const float deltap2 = visc_densi * (rhopp2 / rhopp1 - 1.f) * massp1;
+						if (tdelta == DELTA_Dynamic)ar[p2] += deltap2;
+						if (tdelta == DELTA_DynamicExt && delta[p2] != FLT_MAX)delta[p2] += deltap2;
+					}
+
+					//-Shifting correction.
+					if (shift) {
+						const float massrhop2 = massp2 / rhopp2, massrhop1 = massp1 / rhopp1;
+						const float dot3 = drx * frx + dry * fry + drz * frz;
+						shiftposp1.x += massrhop2 * frx; shiftposp1.y += massrhop2 * fry; shiftposp1.z += massrhop2 * frz;
+						shiftdetectp1 -= massrhop2 * dot3;
+						if (shiftpos[p2].x != FLT_MAX) {
+							shiftpos[p2].x -= massrhop1 * frx; shiftpos[p2].y -= massrhop1 * fry; shiftpos[p2].z -= massrhop1 * frz;
+							if (shiftdetect)shiftdetect[p2] -= massrhop1 * dot3;
+						}
+					}
+
+					//===== Viscosity ======
+					const float dot = drx * dvx + dry * dvy + drz * dvz;
+					const float dot_rr2 = dot / (rr2 + Eta2);
+					visc = max(dot_rr2, visc);
+					if (!lamsps) {//-Artificial viscosity.
+						if (dot < 0) {
+							const float amubar = H * dot_rr2;
+							const float robar = (rhopp1 + rhopp2) * 0.5f;
+							const float pi_visc = -visco * cbar * amubar / robar;
+							viscp1.x -= pi_visc * massp2 * frx; viscp1.y -= pi_visc * massp2 * fry; viscp1.z -= pi_visc * massp2 * frz;
+							ace[p2].x += pi_visc * massp1 * frx; ace[p2].y += pi_visc * massp1 * fry; ace[p2].z += pi_visc * massp1 * frz;
+						}
+					}
+				}
+
+				//-Sum results of p1 (p1 may already have terms as p2 of other particles).
+				SymAce_M[p1] = SymAce_M[p1] + acep1;
+				SymGrad_M[p1] = SymGrad_M[p1] + gradp1;
+				SymAr_M[p1] = SymAr_M[p1] + arp1;
+				ace[p1] = ace[p1] + viscp1;
+				if (tdelta == DELTA_Dynamic)ar[p1] += deltap1;
+				if (tdelta == DELTA_DynamicExt && delta[p1] != FLT_MAX)delta[p1] += deltap1;
+				if (shift && shiftpos[p1].x != FLT_MAX) {
+					shiftpos[p1] = shiftpos[p1] + shiftposp1;
+					if (shiftdetect)shiftdetect[p1] += shiftdetectp1;
+				}
+				if (visc > viscth[th * OMP_STRIDE])viscth[th * OMP_STRIDE] = visc;
+			}
+		}
+	}
+
+	//-Keep max value in viscdt. | Guarda en viscdt el valor maximo.
+	for (int th = 0; th < OmpThreads; th++)if (viscdt < viscth[th * OMP_STRIDE])viscdt = viscth[th * OMP_STRIDE];
+}
+
+//==============================================================================
+/// Interaction Fluid-Fluid on the neighbour list with the vectorised pair
+/// kernel selected in ConfigRunMode() - Matthias #V38 #simd
+/// Same result as InteractionForces_V38_M (boundp2=false) with Wendland and
+/// without floating bodies. The kernel returns the sums of each particle
+/// before the correction matrix L, which is applied here.
+//==============================================================================
+template<bool lamsps, TpDeltaSph tdelta, bool shift> void JSphSolidCpu::InteractionForcesSimd38_M
+(unsigned n, unsigned pinit, float visco
+	, const tsymatrix3fsoa tau, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega
+	, const tfloat4* velrhop, const float* press, const float* pore, const float* mass
+	, const tmatrix3f* L
+	, float& viscdt, float* ar, tfloat3* ace, float* delta
+	, tfloat3* shiftpos, float* shiftdetect)const
+{
+	const unsigned* nbbegin = NbList->GetBegin();
+	StSimdForcesCtx ctx;
+	ctx.pairs = (const float*)NbList->GetPairs();
+	ctx.velrhop = (const float*)velrhop;
+	ctx.tauxx = tau.xx; ctx.tauxy = tau.xy; ctx.tauxz = tau.xz;
+	ctx.tauyy = tau.yy; ctx.tauyz = tau.yz; ctx.tauzz = tau.zz;
+	ctx.press = press; ctx.pore = pore; ctx.mass = mass;
+	ctx.h = H; ctx.eta2 = Eta2; ctx.cbar = (float)Cs0;
+	ctx.visco = visco; ctx.delta2h = Delta2H;
+	ctx.artvisc = !lamsps;
+	ctx.delta = (tdelta == DELTA_Dynamic || tdelta == DELTA_DynamicExt);
+	ctx.shift = shift;
+	float viscth[OMP_MAXTHREADS * OMP_STRIDE];
+	for (int th = 0; th < OmpThreads; th++)viscth[th * OMP_STRIDE] = 0;
+	const int pfin = int(pinit + n);
+
+#ifdef OMP_USE
+#pragma omp parallel for schedule (guided)
+#endif
+	for (int p1 = int(pinit); p1 < pfin; p1++) {
+		const unsigned cpini = nbbegin[p1 * 2 + 1], cpfin = nbbegin[p1 * 2 + 2];
+		StSimdForcesAcc acc;
+		if (cpini == cpfin)memset(&acc, 0, sizeof(StSimdForcesAcc));
+		else {
+			StSimdForcesP1 dp1;
+			dp1.velx = velrhop[p1].x; dp1.vely = velrhop[p1].y; dp1.velz = velrhop[p1].z; dp1.rhop = velrhop[p1].w;
+			dp1.pressp = press[p1] + pore[p1];
+			dp1.tauxx = tau[p1].xx; dp1.tauxy = tau[p1].xy; dp1.tauxz = tau[p1].xz;
+			dp1.tauyy = tau[p1].yy; dp1.tauyz = tau[p1].yz; dp1.tauzz = tau[p1].zz;
+			SimdForcesFnc(ctx, dp1, cpini, cpfin, acc);
+		}
+
+		//-Applies L and stores the final results (nothing is initialised before the interaction).
+		const tmatrix3f l = L[p1];
+		const float* a = acc.ace;
+		const float* g = acc.grad;
+		ace[p1].x = Gravity.x + a[0] * l.a11 + a[1] * l.a12 + a[2] * l.a13 + acc.acevisc[0];
+		ace[p1].y = Gravity.y + a[3] * l.a21 + a[4] * l.a22 + a[5] * l.a23 + acc.acevisc[1];
+		ace[p1].z = Gravity.z + a[6] * l.a31 + a[7] * l.a32 + a[8] * l.a33 + acc.acevisc[2];
+		float arp1 = acc.ar[0] * l.a11 + acc.ar[1] * l.a22 + acc.ar[2] * l.a33;
+		if (tdelta == DELTA_Dynamic)arp1 += acc.delta;
+		if (tdelta == DELTA_DynamicExt)delta[p1] = acc.delta;
+		ar[p1] = arp1;
+		const int th = omp_get_thread_num();
+		if (acc.viscmax > viscth[th * OMP_STRIDE])viscth[th * OMP_STRIDE] = acc.viscmax;
+
+		if (shift) {
+			shiftpos[p1] = TFloat3(acc.shift[0], acc.shift[1], acc.shift[2]);
+			if (shiftdetect)shiftdetect[p1] = acc.shiftdetect;
+		}
+
+		// Gradvel and rotation tensor.
+		gradvel[p1].xx = g[0] * l.a11;
+		gradvel[p1].xy = 0.5f * (g[1] * l.a12 + g[3] * l.a21);
+		gradvel[p1].xz = 0.5f * (g[2] * l.a13 + g[6] * l.a31);
+		gradvel[p1].yy = g[4] * l.a22;
+		gradvel[p1].yz = 0.5f * (g[5] * l.a23 + g[7] * l.a32);
+		gradvel[p1].zz = g[8] * l.a33;
+		omega[p1] = TSymatrix3f(0, 0.5f * (g[1] * l.a12 - g[3] * l.a21), 0.5f * (g[2] * l.a13 - g[6] * l.a31)
+			, 0, 0.5f * (g[5] * l.a23 - g[7] * l.a32), 0);
+	}
+
+	//-Keep max value in viscdt. | Guarda en viscdt el valor maximo.
+	for (int th = 0; th < OmpThreads; th++)if (viscdt < viscth[th * OMP_STRIDE])viscdt = viscth[th * OMP_STRIDE];
+}
+
+//==============================================================================
+/// Applies the correction matrix L to the terms accumulated by
+/// InteractionForcesSym38_M() - Matthias #V38 #symmetric
+//==============================================================================
+void JSphSolidCpu::ApplySymmetricL38_M(unsigned n, unsigned pinit, const tmatrix3f* L
+	, float* ar, tfloat3* ace, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega)const
+{
+	const int pfin = int(pinit + n);
+#ifdef OMP_USE
+#pragma omp parallel for schedule (static)
+#endif
+	for (int p = int(pinit); p < pfin; p++) {
+		const tmatrix3f l = L[p];
+		const tmatrix3f a = SymAce_M[p];
+		const tmatrix3f g = SymGrad_M[p];
+		const tfloat3 d = SymAr_M[p];
+		ace[p].x += a.a11 * l.a11 + a.a12 * l.a12 + a.a13 * l.a13;
+		ace[p].y += a.a21 * l.a21 + a.a22 * l.a22 + a.a23 * l.a23;
+		ace[p].z += a.a31 * l.a31 + a.a32 * l.a32 + a.a33 * l.a33;
+		ar[p] += d.x * l.a11 + d.y * l.a22 + d.z * l.a33;
+
+		// Gradvel and rotation tensor (final values, only ace and ar have other terms).
+		gradvel[p].xx = g.a11 * l.a11;
+		gradvel[p].xy = 0.5f * (g.a12 * l.a12 + g.a21 * l.a21);
+		gradvel[p].xz = 0.5f * (g.a13 * l.a13 + g.a31 * l.a31);
+		gradvel[p].yy = g.a22 * l.a22;
+		gradvel[p].yz = 0.5f * (g.a23 * l.a23 + g.a32 * l.a32);
+		gradvel[p].zz = g.a33 * l.a33;
+		omega[p] = TSymatrix3f(0, 0.5f * (g.a12 * l.a12 - g.a21 * l.a21), 0.5f * (g.a13 * l.a13 - g.a31 * l.a31)
+			, 0, 0.5f * (g.a23 * l.a23 - g.a32 * l.a32), 0);
+	}
+}
+
+//==============================================================================
+/// Interaction particles 32 - Matthias
+/// With AceSave output (#34)
+//==============================================================================
+template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph tdelta, bool shift> void JSphSolidCpu::InteractionForces_V32_M
+(unsigned n, unsigned pinit, tint4 nc, int hdiv, unsigned cellinitial, float visco
+	, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
+	, const tsymatrix3fsoa tau, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega
+	, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
+	, const float* press, const float* pore, const float* mass
+	, tmatrix3f* L
+	, float& viscdt, float* ar, tfloat3* ace, tfloat3* acesave, float* delta
+	, TpShifting tshifting, tfloat3* shiftpos, float* shiftdetect)const
+{
+	const bool boundp2 = (!cellinitial); //-Interaction with type boundary (Bound). | Interaccion con Bound.
+										 //-Initialize viscth to calculate viscdt maximo con OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
+	float viscth[OMP_MAXTHREADS * OMP_STRIDE];
+	for (int th = 0; th < OmpThreads; th++)viscth[th * OMP_STRIDE] = 0;
+	//-Initialise execution with OpenMP. | Inicia ejecucion con OpenMP..
+	const int pfin = int(pinit + n);
+
+
+
+#ifdef OMP_USE
+#pragma omp parallel for schedule (guided)
+#endif
+
+	for (int p1 = int(pinit); p1 < pfin; p1++) {
+		float visc = 0, arp1 = 0, deltap1 = 0;
+		tfloat3 acep1 = TFloat3(0);
 		tfloat3 acesavep1 = TFloat3(0);
 
 		// Matthias
@@ -3205,7 +4444,7 @@ void JSphSolidCpu::ComputeSpsTau(unsigned n, unsigned pini, const tfloat4 *velrh
 //==============================================================================
 /// Computes stress tensor rate for solid - Matthias 
 //==============================================================================
-void JSphSolidCpu::ComputeJauTauDot_M(unsigned n, unsigned pini, const tsymatrix3f *gradvel, tsymatrix3f *tau, tsymatrix3f *taudot, tsymatrix3f *omega)const {
+void JSphSolidCpu::ComputeJauTauDot_M(unsigned n, unsigned pini, const tsymatrix3fsoa gradvel, tsymatrix3fsoa tau, tsymatrix3fsoa taudot, tsymatrix3fsoa omega)const {
 	const int pfin = int(pini + n);
 #ifdef OMP_USE
 #pragma omp parallel for schedule (static)
@@ -3242,9 +4481,6 @@ void JSphSolidCpu::ComputeJauTauDot_M(unsigned n, unsigned pini, const tsymatrix
 		taudot[p].yy = E.yy - 2.0f*tau.xy*omega.xy + 2.0f*tau.yz*omega.yz;
 		taudot[p].yz = E.yz + (tau.zz - tau.yy)*omega.yz - tau.xz*omega.xy - tau.xy*omega.xz;
 		taudot[p].zz = E.zz - 2.0f*tau.xz*omega.xz - 2.0f*tau.yz*omega.yz;
-
-		GradVelSave[p] = gradvel.xx + gradvel.yy + gradvel.zz;
-		StrainDotSave[p] = TFloat3(gradvel.xx, gradvel.yy, gradvel.zz);
 	}
 }
 
@@ -3255,75 +4491,38 @@ void JSphSolidCpu::ComputeJauTauDot_M(unsigned n, unsigned pini, const tsymatrix
 /// V37#02 - Matthias
 /// #Tau #Anisotropy #Young
 //============================================================================== 
-void JSphSolidCpu::computeDeformationSolid01(unsigned n, unsigned pini, tsymatrix3f* taudot)const {
+void JSphSolidCpu::computeDeformationSolid01(unsigned n, unsigned pini, tsymatrix3fsoa taudot)const {
 	const int pfin = int(pini + n);
 #ifdef OMP_USE
-#pragma omp parallel for schedule (static)
+#pragma omp parallel
 #endif
-	for (int p = int(pini); p < pfin; p++) {
-		const tsymatrix3f tau = Tauc_M[p];
-		const tsymatrix3f gradvel = StrainDotc_M[p];
-		const tsymatrix3f omega = Spinc_M[p];
+	{
+		const JTimerRegistry::ThreadScope ths(TimersReg, TmsDeformation);
+#ifdef OMP_USE
+#pragma omp for schedule (static) nowait
+#endif
+		for (int p = int(pini); p < pfin; p++) {
+			const tsymatrix3f tau = Tauc_M[p];
+			const tsymatrix3f gradvel = StrainDotc_M[p];
+			const tsymatrix3f omega = Spinc_M[p];
 		
-		tsymatrix3f EM;
-		float theta = interfaceAnisotropyBalance(maxPosX - float(Posc[p].x));
-		const float E = theta * Ey + (1.0f - theta) * Ex;
-		const float G = theta * Gf + (1.0f - theta) * Ex * 0.5f * (1 + nuxy);
-		const float nf = E / Ex;
-
-		if (Simulate2D) {
-			const float Delta = 1.0f / (1.0f - nuxy * nuxy * nf);
-			const float C1 = Delta * Ex;
-			const float C12 = 0.0f;
-			const float C13 = Delta * nuxy * E;
-			const float C2 = 0.0f;
-			const float C23 = 0.0f;
-			const float C3 = Delta * E;
-
-			const float C4 = 0.0f;
-			const float C5 = G;
-			const float C6 = 0.0f;
-
-			EM = {
-				1.0f / 2.0f * (C1 - C13) * gradvel.xx + 1.0f / 2.0f * (C13 - C3) * gradvel.zz,
-				0.0f,
-				C5 * gradvel.xz,
-				0.0f,
-				0.0f,
-				1.0f / 2.0f * (-C1 + C13) * gradvel.xx + 1.0f / 2.0f * (-C13 + C3) * gradvel.zz };
-		}
-		else {
-			const float nu = theta * nuyz + (1.0f - theta) * nuxy;
-			const float Delta = nf * Ex / (1.0f - nu - 2.0f * nf * nuxy * nuxy);
-			const float C1 = Delta * (1.0f - nu) / nf;
-			const float C12 = Delta * nuxy;
-			const float C13 = Delta * nuxy;
-			const float C2 = Delta * (1.0f - nf * nuxy * nuxy) / (1.0f + nu);
-			const float C23 = Delta * (nu + nf * nuxy * nuxy) / (1.0f + nu);
-			const float C3 = Delta * (1.0f - nf * nuxy * nuxy) / (1.0f + nu);
-
-			const float C4 = E / (2.0f + 2.0f * nuxy);
-			const float C5 = G;
-			const float C6 = G;
-
-			EM = {
-				(2.0f / 3.0f * C1 - 1.0f / 3.0f * C12 - 1.0f / 3.0f * C13) * gradvel.xx + (2.0f / 3.0f * C12 - 1.0f / 3.0f * C2 - 1.0f / 3.0f * C23) * gradvel.yy + (2.0f / 3.0f * C13 - 1.0f / 3.0f * C23 - 1.0f / 3.0f * C3) * gradvel.zz,
-				C4 * gradvel.xy,
-				C5 * gradvel.xz,
-				(-1.0f / 3.0f * C1 + 2.0f / 3.0f * C12 - 1.0f / 3.0f * C13) * gradvel.xx + (-1.0f / 3.0f * C12 + 2.0f / 3.0f * C2 - 1.0f / 3.0f * C23) * gradvel.yy + (-1.0f / 3.0f * C13 + 2.0f / 3.0f * C23 - 1.0f / 3.0f * C3) * gradvel.zz,
-				C6 * gradvel.yz,
-				(-1.0f / 3.0f * C1 - 1.0f / 3.0f * C12 + 2.0f / 3.0f * C13) * gradvel.xx + (-1.0f / 3.0f * C12 - 1.0f / 3.0f * C2 + 2.0f / 3.0f * C23) * gradvel.yy + (-1.0f / 3.0f * C13 - 1.0f / 3.0f * C23 + 2.0f / 3.0f * C3) * gradvel.zz };
+			//-Stiffness from the table along the distance to the tip (2D or 3D).
+			const StConstitutive cs = GetConstitutive(maxPosX - float(Posc[p].x));
+			const tsymatrix3f EM = {
+				cs.m[0] * gradvel.xx + cs.m[1] * gradvel.yy + cs.m[2] * gradvel.zz,
+				cs.c4 * gradvel.xy,
+				cs.c5 * gradvel.xz,
+				cs.m[3] * gradvel.xx + cs.m[4] * gradvel.yy + cs.m[5] * gradvel.zz,
+				cs.c6 * gradvel.yz,
+				cs.m[6] * gradvel.xx + cs.m[7] * gradvel.yy + cs.m[8] * gradvel.zz };
+
+			taudot[p].xx = EM.xx + 2.0f * tau.xy * omega.xy + 2.0f * tau.xz * omega.xz;
+			taudot[p].xy = EM.xy + (tau.yy - tau.xx) * omega.xy + tau.xz * omega.yz + tau.yz * omega.xz;
+			taudot[p].xz = EM.xz + (tau.zz - tau.xx) * omega.xz - tau.xy * omega.yz + tau.yz * omega.xy;
+			taudot[p].yy = EM.yy - 2.0f * tau.xy * omega.xy + 2.0f * tau.yz * omega.yz;
+			taudot[p].yz = EM.yz + (tau.zz - tau.yy) * omega.yz - tau.xz * omega.xy - tau.xy * omega.xz;
+			taudot[p].zz = EM.zz - 2.0f * tau.xz * omega.xz - 2.0f * tau.yz * omega.yz;
 		}
-
-		taudot[p].xx = EM.xx + 2.0f * tau.xy * omega.xy + 2.0f * tau.xz * omega.xz;
-		taudot[p].xy = EM.xy + (tau.yy - tau.xx) * omega.xy + tau.xz * omega.yz + tau.yz * omega.xz;
-		taudot[p].xz = EM.xz + (tau.zz - tau.xx) * omega.xz - tau.xy * omega.yz + tau.yz * omega.xy;
-		taudot[p].yy = EM.yy - 2.0f * tau.xy * omega.xy + 2.0f * tau.yz * omega.yz;
-		taudot[p].yz = EM.yz + (tau.zz - tau.yy) * omega.yz - tau.xz * omega.xy - tau.xy * omega.xz;
-		taudot[p].zz = EM.zz - 2.0f * tau.xz * omega.xz - 2.0f * tau.yz * omega.yz;
-
-		StrainDotSave[p] = TFloat3(gradvel.xx, gradvel.yy, gradvel.zz);
-		GradVelSave[p] = gradvel.xx + gradvel.yy + gradvel.zz;
 	}
 }
 
@@ -3331,7 +4530,7 @@ void JSphSolidCpu::computeDeformationSolid01(unsigned n, unsigned pini, tsymatri
 //==============================================================================
 /// Computes stress tensor rate for solid - #Gradual Young
 //==============================================================================
-void JSphSolidCpu::ComputeTauDot_Gradual_M(unsigned n, unsigned pini, tsymatrix3f* taudot)const {
+void JSphSolidCpu::ComputeTauDot_Gradual_M(unsigned n, unsigned pini, tsymatrix3fsoa taudot)const {
 	const int pfin = int(pini + n);
 #ifdef OMP_USE
 #pragma omp parallel for schedule (static)
@@ -3421,9 +4620,6 @@ void JSphSolidCpu::ComputeTauDot_Gradual_M(unsigned n, unsigned pini, tsymatrix3
 		taudot[p].yy = EM.yy - 2.0f * tau.xy * omega.xy + 2.0f * tau.yz * omega.yz;
 		taudot[p].yz = EM.yz + (tau.zz - tau.yy) * omega.yz - tau.xz * omega.xy - tau.xy * omega.xz;
 		taudot[p].zz = EM.zz - 2.0f * tau.xz * omega.xz - 2.0f * tau.yz * omega.yz;
-
-		StrainDotSave[p] = TFloat3(gradvel.xx, gradvel.yy, gradvel.zz);
-		GradVelSave[p] = gradvel.xx + gradvel.yy + gradvel.zz;
 	}
 }
 
@@ -3477,7 +4673,7 @@ template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph t
 	, const tdouble3 *pos, const tfloat3 *pspos, const tfloat4 *velrhop, const typecode *code, const unsigned *idp
 	, const float *press, const float *pore, const float *mass
 	, float &viscdt, float* ar, tfloat3 *ace, float *delta
-	, tsymatrix3f *jautau, tsymatrix3f *jaugradvel, tsymatrix3f *jautaudot, tsymatrix3f *jauomega
+	, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 	, tmatrix3f *L
 	, TpShifting tshifting, tfloat3 *shiftpos, float *shiftdetect)const
 {
@@ -3539,7 +4735,7 @@ template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph t
 	, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
 	, const float* press, const float* pore, const float* mass
 	, float& viscdt, float* ar, tfloat3* ace, float* delta
-	, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+	, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 	, tmatrix3f* L, float* co 
 	, TpShifting tshifting, tfloat3* shiftpos, float* shiftdetect)const
 {
@@ -3550,7 +4746,9 @@ template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph t
 	const int hdiv = (CellMode == CELLMODE_H ? 2 : 1);
 
 	if (npf) {
+		TimersReg->Start(TmsCorrection);
 		ComputeNsphCorrection31<psingle, tker>(np, 0, nc, hdiv, cellfluid, begincell, cellzero, dcell, pos, pspos, velrhop, mass, L, co);
+		TimersReg->Stop(TmsCorrection);
 
 		//-Interaction Fluid-Fluid.
 		InteractionForces_V31_M<psingle, tker, ftmode, lamsps, tdelta, shift>
@@ -3598,7 +4796,7 @@ template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph t
 	, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
 	, const float* press, const float* pore, const float* mass
 	, float& viscdt, float* ar, tfloat3* ace, tfloat3* acesave, float* delta
-	, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+	, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 	, tmatrix3f* L, float* co
 	, TpShifting tshifting, tfloat3* shiftpos, float* shiftdetect)const
 {
@@ -3611,20 +4809,29 @@ template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph t
 	if (npf) {
 		// to_do: turn this switch into an interface method once it works.
 		// #correction #gradient #nsph
+		TimersReg->Start(TmsCorrection);
 		InterfaceGradientCorrection<psingle, tker>(np, 0, nc, hdiv, cellfluid,
 			begincell, cellzero, dcell, pos, pspos, velrhop, mass, L, co);
+		TimersReg->Stop(TmsCorrection);
 		
-		//-Interaction Fluid-Fluid.
-		InteractionForces_V31_M<psingle, tker, ftmode, lamsps, tdelta, shift>
-			(npf, npb, nc, hdiv, cellfluid, Visco, begincell, cellzero, dcell
-				, jautau, jaugradvel, jauomega, pos, pspos, velrhop, code, idp, press, pore, mass, L, viscdt, ar, ace, delta, tshifting, shiftpos, shiftdetect);
+		//-Interaction Fluid-Fluid (neighbour list built in BuildNeighbourList_M). #V38
+		if (NlSymmetric && ftmode == FTMODE_None && PrepareHalfBlocks38_M(npf, npb)) {
+			InteractionForcesSym38_M<tker, lamsps, tdelta, shift>
+				(npf, npb, Visco, jautau, velrhop, press, pore, mass, viscdt, ar, ace, delta, shiftpos, shiftdetect);
+			ApplySymmetricL38_M(npf, npb, L, ar, ace, jaugradvel, jauomega);
+		}
+		else if (SimdForcesFnc && tker == KERNEL_Wendland && ftmode == FTMODE_None) {
+			InteractionForcesSimd38_M<lamsps, tdelta, shift>
+				(npf, npb, Visco, jautau, jaugradvel, jauomega, velrhop, press, pore, mass, L, viscdt, ar, ace, delta, shiftpos, shiftdetect);
+		}
+		else InteractionForces_V38_M<tker, ftmode, lamsps, tdelta, shift>
+			(npf, npb, false, Visco, jautau, jaugradvel, jauomega, velrhop, code, idp, press, pore, mass, L, viscdt, ar, ace, delta, tshifting, shiftpos, shiftdetect);
 		
-		for (unsigned p = npb; p < np; p++) acesave[p] = ace[p];
+		if (acesave) memcpy(acesave + npb, ace + npb, sizeof(tfloat3) * npf);
 
 		//-Interaction Fluid-Bound.
-		InteractionForces_V31_M<psingle, tker, ftmode, lamsps, tdelta, shift>
-			(npf, npb, nc, hdiv, 0, Visco * ViscoBoundFactor, begincell, cellzero, dcell
-				, jautau, jaugradvel, jauomega, pos, pspos, velrhop, code, idp, press, pore, mass, L, viscdt, ar, ace, delta, tshifting, shiftpos, shiftdetect);
+		InteractionForces_V38_M<tker, ftmode, lamsps, tdelta, shift>
+			(npf, npb, true, Visco * ViscoBoundFactor, jautau, jaugradvel, jauomega, velrhop, code, idp, press, pore, mass, L, viscdt, ar, ace, delta, tshifting, shiftpos, shiftdetect);
 
 		//-Interaction of DEM Floating-Bound & Floating-Floating. //(DEM)
 		if (USE_DEM)InteractionForcesDEM<psingle>(CaseNfloat, nc, hdiv, cellfluid, begincell, cellzero, dcell, FtRidp, DemData, pos, pspos, velrhop, code, idp, viscdt, ace);
@@ -3632,13 +4839,14 @@ template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph t
 	}
 	if (npbok) {
 		//-Interaction Bound-Fluid.
-		InteractionForcesBound31_M<psingle, tker, ftmode>(npbok, 0, nc, hdiv, cellfluid, begincell, cellzero, dcell, pos, pspos, velrhop, code, idp, viscdt
-			, ar, mass, jaugradvel, jauomega, L);
+		InteractionForcesBound38_M<ftmode>(npbok, 0, velrhop, code, idp, viscdt, ar, mass, jaugradvel, jauomega, L);
 	}
 
 	// Computation of solid deformation
     // #young #anisotropy
+	TimersReg->Start(TmsDeformation);
 	computeDeformationSolid01(np, 0, jautaudot);
+	TimersReg->Stop(TmsDeformation);
 	//ComputeTauDot_Gradual_M(np, 0, jautaudot);
 }
 
@@ -4298,7 +5506,7 @@ void JSphSolidCpu::InteractionSimple_Forces_M(unsigned np, unsigned npb, unsigne
 	, const float *press, const float *pore, const float *mass
 	, tmatrix3f *L, float* Co_M
 	, float &viscdt, float* ar, tfloat3 *ace, float *delta
-	, tsymatrix3f *jautau, tsymatrix3f *jaugradvel, tsymatrix3f *jautaudot, tsymatrix3f *jauomega
+	, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 	, tfloat3 *shiftpos, float *shiftdetect)const
 {
 	tdouble3 *pos = NULL;
@@ -4618,7 +5826,7 @@ void JSphSolidCpu::Interaction_Forces_M(unsigned np, unsigned npb, unsigned npbo
 	, const float *press, const float *pore, const float *mass
 	, tmatrix3f *L, float* Co_M
 	, float &viscdt, float* ar, tfloat3 *ace, float *delta
-	, tsymatrix3f *jautau, tsymatrix3f *jaugradvel, tsymatrix3f *jautaudot, tsymatrix3f *jauomega
+	, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 	, tfloat3 *shiftpos, float *shiftdetect)const
 {
 	tfloat3 *pspos = NULL;
@@ -4937,7 +6145,7 @@ void JSphSolidCpu::Interaction_ForcesSimpSmall_M(unsigned np, unsigned npb, unsi
 	, const float* press, const float* pore, const float* mass
 	, tmatrix3f* L, float* Co_M
 	, float& viscdt, float* ar, tfloat3* ace, tfloat3* acesave, float* delta
-	, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+	, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 	, tfloat3* shiftpos, float* shiftdetect)const
 {
 	tdouble3* pos = NULL;
@@ -4962,7 +6170,7 @@ void JSphSolidCpu::Interaction_ForcesSmall_M(unsigned np, unsigned npb, unsigned
 	, const float* press, const float* pore, const float* mass
 	, tmatrix3f* L, float* Co_M
 	, float& viscdt, float* ar, tfloat3* ace, tfloat3* acesave, float* delta
-	, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+	, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 	, tfloat3* shiftpos, float* shiftdetect)const
 {
 	tfloat3* pspos = NULL;
@@ -4991,7 +6199,7 @@ void JSphSolidCpu::InteractionSimple_Forces_M(unsigned np, unsigned npb, unsigne
 	, const float* press, const float* pore, const float* mass
 	, tmatrix3f* L
 	, float& viscdt, float* ar, tfloat3* ace, float* delta
-	, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+	, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 	, tfloat3* shiftpos, float* shiftdetect)const
 {
 	tdouble3* pos = NULL;
@@ -5311,7 +6519,7 @@ void JSphSolidCpu::Interaction_Forces_M(unsigned np, unsigned npb, unsigned npbo
 	, const float* press, const float* pore, const float* mass
 	, tmatrix3f* L
 	, float& viscdt, float* ar, tfloat3* ace, float* delta
-	, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+	, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 	, tfloat3* shiftpos, float* shiftdetect)const
 {
 	tfloat3* pspos = NULL;
@@ -5735,8 +6943,8 @@ template<bool shift> void JSphSolidCpu::ComputeVerletVarsFluid(const tfloat4 *ve
 //==============================================================================
 /// Calculate new values of position, velocity & density for Solid (using Verlet). - Matthias
 //==============================================================================
-template<bool shift> void JSphSolidCpu::ComputeVerletVarsSolid_M(const tfloat4 *velrhop1, const tfloat4 *velrhop2, const tsymatrix3f *tau1, const tsymatrix3f *tau2, double dt, double dt2
-	, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3f *taunew)const
+template<bool shift> void JSphSolidCpu::ComputeVerletVarsSolid_M(const tfloat4 *velrhop1, const tfloat4 *velrhop2, const tsymatrix3fsoa tau1, const tsymatrix3fsoa tau2, double dt, double dt2
+	, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3fsoa taunew)const
 {
 	const double dt205 = 0.5*dt*dt;
 	const int pini = int(Npb), pfin = int(Np), npf = int(Np - Npb);
@@ -5784,8 +6992,8 @@ template<bool shift> void JSphSolidCpu::ComputeVerletVarsSolid_M(const tfloat4 *
 /// Verlet update with Solid, pore pressure and mass - Matthias
 //==============================================================================
 template<bool shift> void JSphSolidCpu::ComputeVerletVarsSolMass_M(const tfloat4 *velrhop1, const tfloat4 *velrhop2
-	, const tsymatrix3f *tau1, const tsymatrix3f *tau2, const float *mass1, const float *mass2
-	, double dt, double dt2, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3f *taunew, float *massnew)const
+	, const tsymatrix3fsoa tau1, const tsymatrix3fsoa tau2, const float *mass1, const float *mass2
+	, double dt, double dt2, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3fsoa taunew, float *massnew)const
 {
 	const double dt205 = 0.5*dt*dt;
 	const int pini = int(Npb), pfin = int(Np), npf = int(Np - Npb);
@@ -5855,8 +7063,8 @@ template<bool shift> void JSphSolidCpu::ComputeVerletVarsSolMass_M(const tfloat4
 /// Verlet update with Solid, pore, mass and quadratic form - Matthias
 //==============================================================================
 template<bool shift> void JSphSolidCpu::ComputeVerletVarsQuad_M(const tfloat4 *velrhop1, const tfloat4 *velrhop2
-	, const tsymatrix3f *tau1, const tsymatrix3f *tau2, const tsymatrix3f *qf1, const tsymatrix3f *qf2, const float *mass1, const float *mass2
-	, double dt, double dt2, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3f *taunew, tsymatrix3f *qfnew, float *massnew)const
+	, const tsymatrix3fsoa tau1, const tsymatrix3fsoa tau2, const tsymatrix3fsoa qf1, const tsymatrix3fsoa qf2, const float *mass1, const float *mass2
+	, double dt, double dt2, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3fsoa taunew, tsymatrix3fsoa qfnew, float *massnew)const
 {
 	const double dt205 = 0.5*dt*dt;
 	const int pini = int(Npb), pfin = int(Np), npf = int(Np - Npb);
@@ -5989,7 +7197,7 @@ template<bool shift> void JSphSolidCpu::ComputeEulerVarsFluid_M(tfloat4 *velrhop
 /// Matthias
 //==============================================================================
 template<bool shift> void JSphSolidCpu::ComputeEulerVarsSolid_M(tfloat4 *velrhop, double dt
-	, tdouble3 *pos, tsymatrix3f *tau, unsigned *dcell, word *code)const
+	, tdouble3 *pos, tsymatrix3fsoa tau, unsigned *dcell, word *code)const
 {
 	const int pini = int(Npb), pfin = int(Np), npf = int(Np - Npb);
 #ifdef _WITHOMP
@@ -6104,6 +7312,7 @@ void JSphSolidCpu::ComputeVerlet(double dt) {
 	swap(Tauc_M, TauM1c_M);     //-Swap Velrhopc & VelrhopM1c. | Intercambia Velrhopc y VelrhopM1c.
 	swap(QuadFormc_M, QuadFormM1c_M);     //-Swap Velrhopc & VelrhopM1c. | Intercambia Velrhopc y VelrhopM1c.
 	swap(Massc_M, MassM1c_M);     //-Swap Velrhopc & VelrhopM1c. | Intercambia Velrhopc y VelrhopM1c.
+	InvalidateTip_M();            //-Tip is only tracked by the symplectic updates.
 	TmcStop(Timers, TMC_SuComputeStep);
 }
 
@@ -6118,6 +7327,7 @@ void JSphSolidCpu::ComputeEuler_M(double dt) {
 
 	if (TShifting)ComputeEulerVarsSolid_M<true>(Velrhopc, dt, Posc, Tauc_M, Dcellc, Codec);
 	else         ComputeEulerVarsSolid_M<false>(Velrhopc, dt, Posc, Tauc_M, Dcellc, Codec);
+	InvalidateTip_M();            //-Tip is only tracked by the symplectic updates.
 
 	//ComputeJauTauDotImplicit_M(Np, Npb, dt, StrainDot_M, Tauc2_M, JauTauDot_M, JauOmega_M);
 	//if (TShifting)ComputeEulerVarsSolidImplicit_M<true>(Velrhopc, dt, Posc, Tauc2_M, StrainDot_M, JauOmega_M, Dcellc, Codec);
@@ -6279,22 +7489,42 @@ template<bool shift> void JSphSolidCpu::ComputeSymplecticCorrT(double dt) {
 // V37-Feat3
 /// /////////////////////////////////////////////
 void JSphSolidCpu::ComputeSymplecticPre_M(double dt) {
+	//-The growth or damping law is selected once per step.
 	if (typeDev) {
-		ComputeOneStepTwoStagesPreT_M<false>(dt);
+		const TpGrowth tgrow = GetTypeGrowth_M();
+		if (tgrow == GROWTH_Turgor)          ComputeOneStepTwoStagesPreT_M<false, GROWTH_Turgor>(dt);
+		else if (tgrow == GROWTH_KillConst)       ComputeOneStepTwoStagesPreT_M<false, GROWTH_KillConst>(dt);
+		else if (tgrow == GROWTH_SigGauss)        ComputeOneStepTwoStagesPreT_M<false, GROWTH_SigGauss>(dt);
+		else if (tgrow == GROWTH_SigGauDrop)      ComputeOneStepTwoStagesPreT_M<false, GROWTH_SigGauDrop>(dt);
+		else if (tgrow == GROWTH_TurgorSpace)     ComputeOneStepTwoStagesPreT_M<false, GROWTH_TurgorSpace>(dt);
+		else if (tgrow == GROWTH_TurgorSigGauDrop)ComputeOneStepTwoStagesPreT_M<false, GROWTH_TurgorSigGauDrop>(dt);
+		else if (tgrow == GROWTH_TurgorConst)     ComputeOneStepTwoStagesPreT_M<false, GROWTH_TurgorConst>(dt);
+		else if (tgrow == GROWTH_TurgorTriangle)  ComputeOneStepTwoStagesPreT_M<false, GROWTH_TurgorTriangle>(dt);
+		else if (tgrow == GROWTH_TurgorComposite) ComputeOneStepTwoStagesPreT_M<false, GROWTH_TurgorComposite>(dt);
+		else if (tgrow == GROWTH_KillComposite)   ComputeOneStepTwoStagesPreT_M<false, GROWTH_KillComposite>(dt);
+		else if (tgrow == GROWTH_Croser)          ComputeOneStepTwoStagesPreT_M<false, GROWTH_Croser>(dt);
+		else ComputeOneStepTwoStagesPreT_M<false, GROWTH_None>(dt);
 	}
 	else {
-		ComputeSymplecticPreT35_M<false>(dt);
+		const TpDamping tdamp = GetTypeDamping_M();
+		if (tdamp == DAMPING_Uniform)      ComputeSymplecticPreT35_M<false, DAMPING_Uniform>(dt);
+		else if (tdamp == DAMPING_Surface)      ComputeSymplecticPreT35_M<false, DAMPING_Surface>(dt);
+		else if (tdamp == DAMPING_Plateau)      ComputeSymplecticPreT35_M<false, DAMPING_Plateau>(dt);
+		else if (tdamp == DAMPING_Density)      ComputeSymplecticPreT35_M<false, DAMPING_Density>(dt);
+		else if (tdamp == DAMPING_DensityLength)ComputeSymplecticPreT35_M<false, DAMPING_DensityLength>(dt);
+		else ComputeSymplecticPreT35_M<false, DAMPING_None>(dt);
 	}
 }
 
-template<bool shift> void JSphSolidCpu::ComputeSymplecticPreT35_M(double dt) {
+template<bool shift, TpDamping tdamp> void JSphSolidCpu::ComputeSymplecticPreT35_M(double dt) {
 	TmcStart(Timers, TMC_SuComputeStep);
+	const JDampingModel_M<tdamp> damping(dampCoef);
 	//-Assign memory to variables Pre. | Asigna memoria a variables Pre.
 	PosPrec = ArraysCpu->ReserveDouble3();
 	VelrhopPrec = ArraysCpu->ReserveFloat4();
 	MassPrec_M = ArraysCpu->ReserveFloat();
-	TauPrec_M = ArraysCpu->ReserveSymatrix3f();
-	QuadFormPrec_M = ArraysCpu->ReserveSymatrix3f();
+	TauPrec_M = ArraysCpu->ReserveSymatrix3fSoa();
+	QuadFormPrec_M = ArraysCpu->ReserveSymatrix3fSoa();
 
 	//-Change data to variables Pre to calculate new data. | Cambia datos a variables Pre para calcular nuevos datos.
 	swap(PosPrec, Posc);         //Put value of Pos[] in PosPre[].         | Es decir... PosPre[] <= Pos[].
@@ -6334,11 +7564,16 @@ template<bool shift> void JSphSolidCpu::ComputeSymplecticPreT35_M(double dt) {
 
 	//-Calculate new values of fluid. | Calcula nuevos datos del fluido.
 	const int np = int(Np);
+	//-Tip of the root is obtained from the new positions. | Maximo de posicion (punta).
+	float tipth[OMP_MAXTHREADS * OMP_STRIDE];
+	unsigned tipp[OMP_MAXTHREADS * OMP_STRIDE];
+	TipThreadsInit_M(tipth, tipp);
 
 #ifdef OMP_USE
 #pragma omp parallel for schedule (static) if(np>OMP_LIMIT_COMPUTESTEP)
 #endif
 	for (int p = npb; p < np; p++) {
+		const int th = omp_get_thread_num();
 		//-Calculate density.
 		const float rhopnew = float(double(VelrhopPrec[p].w) + dt05 * Arc[p]); // Not const because of source update 
 
@@ -6359,8 +7594,8 @@ template<bool shift> void JSphSolidCpu::ComputeSymplecticPreT35_M(double dt) {
 			Velrhopc[p].z = float(double(VelrhopPrec[p].z) + double(Acec[p].z) * dt05);
 
 			// Apply damping
-			if(Posc[p].x > -0.1) {
-				tfloat3 av = ViscousDamping36(TFloat3(VelrhopPrec[p].x, VelrhopPrec[p].y, VelrhopPrec[p].z), Co_M[p], VelrhopPrec[p].w, 2.0f / sqrt(QuadFormPrec_M[p].xx));
+			if(tdamp != DAMPING_None && Posc[p].x > -0.1) {
+				const tfloat3 av = damping(TFloat3(VelrhopPrec[p].x, VelrhopPrec[p].y, VelrhopPrec[p].z), Co_M[p], VelrhopPrec[p].w, QuadFormPrec_M[p].xx);
 				Velrhopc[p].x -= av.x * float(dt05);
 				Velrhopc[p].y -= av.y * float(dt05);
 				Velrhopc[p].z -= av.z * float(dt05);
@@ -6403,7 +7638,9 @@ template<bool shift> void JSphSolidCpu::ComputeSymplecticPreT35_M(double dt) {
 																	 //-Copy position. | Copia posicion.
 			Posc[p] = PosPrec[p];
 		}
+		TipThreadsAdd_M(Posc[p], unsigned(p), tipth + th * OMP_STRIDE, tipp + th * OMP_STRIDE);
 	}
+	TipThreadsReduce_M(tipth, tipp);
 
 	//-Copy previous position of boundary. | Copia posicion anterior del contorno.
 	memcpy(Posc, PosPrec, sizeof(tdouble3) * Npb);
@@ -6412,15 +7649,65 @@ template<bool shift> void JSphSolidCpu::ComputeSymplecticPreT35_M(double dt) {
 
 }
 
-template<bool shift> void JSphSolidCpu::ComputeOneStepTwoStagesPreT_M(double dt) {
+//==============================================================================
+/// Updates Tauc_M=TauPrec_M+TauDotc_M*dt of the first np particles (floating
+/// particles are skipped). Without floatings the 6 streams are updated in one
+/// loop without branches so it can be vectorised.
+//==============================================================================
+void JSphSolidCpu::ComputeTauStreams_M(unsigned np, double dt)const {
+	const int n = int(np);
+	const tsymatrix3fsoa tau = Tauc_M, taupre = TauPrec_M, taudot = TauDotc_M;
+	if (!WithFloating) {
+#ifdef OMP_USE
+#pragma omp parallel if(n>OMP_LIMIT_COMPUTESTEP)
+#endif
+		{
+			const JTimerRegistry::ThreadScope ths(TimersReg, TmsTau);
+#ifdef OMP_USE
+#pragma omp for schedule (static) nowait
+#endif
+			for (int p = 0; p < n; p++) {
+				tau.xx[p] = float(double(taupre.xx[p]) + double(taudot.xx[p]) * dt);
+				tau.xy[p] = float(double(taupre.xy[p]) + double(taudot.xy[p]) * dt);
+				tau.xz[p] = float(double(taupre.xz[p]) + double(taudot.xz[p]) * dt);
+				tau.yy[p] = float(double(taupre.yy[p]) + double(taudot.yy[p]) * dt);
+				tau.yz[p] = float(double(taupre.yz[p]) + double(taudot.yz[p]) * dt);
+				tau.zz[p] = float(double(taupre.zz[p]) + double(taudot.zz[p]) * dt);
+			}
+		}
+	}
+	else {
+		const int npb = int(Npb);
+#ifdef OMP_USE
+#pragma omp parallel if(n>OMP_LIMIT_COMPUTESTEP)
+#endif
+		{
+			const JTimerRegistry::ThreadScope ths(TimersReg, TmsTau);
+#ifdef OMP_USE
+#pragma omp for schedule (static) nowait
+#endif
+			for (int p = 0; p < n; p++)if (p < npb || CODE_IsFluid(Codec[p])) {
+				tau[p] = TSymatrix3f(float(double(taupre.xx[p]) + double(taudot.xx[p]) * dt)
+					, float(double(taupre.xy[p]) + double(taudot.xy[p]) * dt)
+					, float(double(taupre.xz[p]) + double(taudot.xz[p]) * dt)
+					, float(double(taupre.yy[p]) + double(taudot.yy[p]) * dt)
+					, float(double(taupre.yz[p]) + double(taudot.yz[p]) * dt)
+					, float(double(taupre.zz[p]) + double(taudot.zz[p]) * dt));
+			}
+		}
+	}
+}
+
+template<bool shift, TpGrowth tgrow> void JSphSolidCpu::ComputeOneStepTwoStagesPreT_M(double dt) {
 // #37
 	TmcStart(Timers, TMC_SuComputeStep);
+	const JGrowthModel_M<tgrow> growth(GetGrowthCtes_M());
 	//-Assign memory to variables Pre. | Asigna memoria a variables Pre.
 	PosPrec = ArraysCpu->ReserveDouble3();
 	VelrhopPrec = ArraysCpu->ReserveFloat4();
 	MassPrec_M = ArraysCpu->ReserveFloat();
-	TauPrec_M = ArraysCpu->ReserveSymatrix3f();
-	QuadFormPrec_M = ArraysCpu->ReserveSymatrix3f();
+	TauPrec_M = ArraysCpu->ReserveSymatrix3fSoa();
+	QuadFormPrec_M = ArraysCpu->ReserveSymatrix3fSoa();
 
 	//-Change data to variables Pre to calculate new data. | Cambia datos a variables Pre para calcular nuevos datos.
 	swap(PosPrec, Posc);         //Put value of Pos[] in PosPre[].         | Es decir... PosPre[] <= Pos[].
@@ -6447,26 +7734,23 @@ template<bool shift> void JSphSolidCpu::ComputeOneStepTwoStagesPreT_M(double dt)
 		//-Avoid fluid particles being absorbed by boundary ones. | Evita q las boundary absorvan a las fluidas.
 		//Velrhopc[p] = TFloat4(vr.x, vr.y, vr.z, rhopnew);
 
-			// Update Shear stress
-		Tauc_M[p].xx = float(double(TauPrec_M[p].xx) + double(TauDotc_M[p].xx) * dt05);
-		Tauc_M[p].xy = float(double(TauPrec_M[p].xy) + double(TauDotc_M[p].xy) * dt05);
-		Tauc_M[p].xz = float(double(TauPrec_M[p].xz) + double(TauDotc_M[p].xz) * dt05);
-		Tauc_M[p].yy = float(double(TauPrec_M[p].yy) + double(TauDotc_M[p].yy) * dt05);
-		Tauc_M[p].yz = float(double(TauPrec_M[p].yz) + double(TauDotc_M[p].yz) * dt05);
-		Tauc_M[p].zz = float(double(TauPrec_M[p].zz) + double(TauDotc_M[p].zz) * dt05);
-
 		Massc_M[p] = MassPrec_M[p];
 	}
 
 	//-Calculate new values of fluid. | Calcula nuevos datos del fluido.
 	const int np = int(Np);
+	//-Tip of the root is obtained from the new positions. | Maximo de posicion (punta).
+	float tipth[OMP_MAXTHREADS * OMP_STRIDE];
+	unsigned tipp[OMP_MAXTHREADS * OMP_STRIDE];
+	TipThreadsInit_M(tipth, tipp);
 #ifdef OMP_USE
 #pragma omp parallel for schedule (static) if(np>OMP_LIMIT_COMPUTESTEP)
 #endif
 	for (int p = npb; p < np; p++) {
+		const int th = omp_get_thread_num();
 		//-Calculate density.
 		// #dev
-		const float gamma = GrowthInterface_M(VelrhopPrec[p].w, float(PosPrec[p].x));
+		const float gamma = growth.Rate(VelrhopPrec[p].w, float(PosPrec[p].x));
 		const float volume = MassPrec_M[p] / VelrhopPrec[p].w;
 		const float rhopnew = float(double(VelrhopPrec[p].w) + dt05 * (Arc[p]+gamma)); // Not const because of source update 
 		const float massnew = float(double(MassPrec_M[p]) + dt05 * (gamma * volume));
@@ -6496,14 +7780,6 @@ template<bool shift> void JSphSolidCpu::ComputeOneStepTwoStagesPreT_M(double dt)
 				Velrhopc[p].z = 0.0f;
 			}*/
 
-			// Update Shear stress
-			Tauc_M[p].xx = float(double(TauPrec_M[p].xx) + double(TauDotc_M[p].xx) * dt05);
-			Tauc_M[p].xy = float(double(TauPrec_M[p].xy) + double(TauDotc_M[p].xy) * dt05);
-			Tauc_M[p].xz = float(double(TauPrec_M[p].xz) + double(TauDotc_M[p].xz) * dt05);
-			Tauc_M[p].yy = float(double(TauPrec_M[p].yy) + double(TauDotc_M[p].yy) * dt05);
-			Tauc_M[p].yz = float(double(TauPrec_M[p].yz) + double(TauDotc_M[p].yz) * dt05);
-			Tauc_M[p].zz = float(double(TauPrec_M[p].zz) + double(TauDotc_M[p].zz) * dt05);
-
 
 			// Source Density and Mass - Commented since Source/Mass only in CorrT
 			Velrhopc[p].w = rhopnew;
@@ -6517,7 +7793,14 @@ template<bool shift> void JSphSolidCpu::ComputeOneStepTwoStagesPreT_M(double dt)
 																	 //-Copy position. | Copia posicion.
 			Posc[p] = PosPrec[p];
 		}
+		TipThreadsAdd_M(Posc[p], unsigned(p), tipth + th * OMP_STRIDE, tipp + th * OMP_STRIDE);
 	}
+	TipThreadsReduce_M(tipth, tipp);
+
+	//-Update shear stress. | Actualiza tensiones.
+	TimersReg->Start(TmsTau);
+	ComputeTauStreams_M(Np, dt05);
+	TimersReg->Stop(TmsTau);
 
 	//-Copy previous position of boundary. | Copia posicion anterior del contorno.
 	memcpy(Posc, PosPrec, sizeof(tdouble3) * Npb);
@@ -6533,8 +7816,8 @@ template<bool shift> void JSphSolidCpu::ComputeSymplecticPreT_M(double dt) {
 	PosPrec = ArraysCpu->ReserveDouble3();
 	VelrhopPrec = ArraysCpu->ReserveFloat4();
 	MassPrec_M = ArraysCpu->ReserveFloat();
-	TauPrec_M = ArraysCpu->ReserveSymatrix3f();
-	QuadFormPrec_M = ArraysCpu->ReserveSymatrix3f();
+	TauPrec_M = ArraysCpu->ReserveSymatrix3fSoa();
+	QuadFormPrec_M = ArraysCpu->ReserveSymatrix3fSoa();
 
 	//-Change data to variables Pre to calculate new data. | Cambia datos a variables Pre para calcular nuevos datos.
 	swap(PosPrec, Posc);         //Put value of Pos[] in PosPre[].         | Es decir... PosPre[] <= Pos[].
@@ -6636,11 +7919,30 @@ template<bool shift> void JSphSolidCpu::ComputeSymplecticPreT_M(double dt) {
 }
 
 void JSphSolidCpu::ComputeSymplecticCorr_M(double dt) {
+	//-The growth or damping law is selected once per step.
 	if (typeDev) {
-		ComputeOneStepTwoStagesCorrT37_M<false>(dt);
+		const TpGrowth tgrow = GetTypeGrowth_M();
+		if (tgrow == GROWTH_Turgor)          ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_Turgor>(dt);
+		else if (tgrow == GROWTH_KillConst)       ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_KillConst>(dt);
+		else if (tgrow == GROWTH_SigGauss)        ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_SigGauss>(dt);
+		else if (tgrow == GROWTH_SigGauDrop)      ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_SigGauDrop>(dt);
+		else if (tgrow == GROWTH_TurgorSpace)     ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_TurgorSpace>(dt);
+		else if (tgrow == GROWTH_TurgorSigGauDrop)ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_TurgorSigGauDrop>(dt);
+		else if (tgrow == GROWTH_TurgorConst)     ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_TurgorConst>(dt);
+		else if (tgrow == GROWTH_TurgorTriangle)  ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_TurgorTriangle>(dt);
+		else if (tgrow == GROWTH_TurgorComposite) ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_TurgorComposite>(dt);
+		else if (tgrow == GROWTH_KillComposite)   ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_KillComposite>(dt);
+		else if (tgrow == GROWTH_Croser)          ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_Croser>(dt);
+		else ComputeOneStepTwoStagesCorrT37_M<false, GROWTH_None>(dt);
 	}
 	else {
-		ComputeSymplecticCorrT35_M<false>(dt);
+		const TpDamping tdamp = GetTypeDamping_M();
+		if (tdamp == DAMPING_Uniform)      ComputeSymplecticCorrT35_M<false, DAMPING_Uniform>(dt);
+		else if (tdamp == DAMPING_Surface)      ComputeSymplecticCorrT35_M<false, DAMPING_Surface>(dt);
+		else if (tdamp == DAMPING_Plateau)      ComputeSymplecticCorrT35_M<false, DAMPING_Plateau>(dt);
+		else if (tdamp == DAMPING_Density)      ComputeSymplecticCorrT35_M<false, DAMPING_Density>(dt);
+		else if (tdamp == DAMPING_DensityLength)ComputeSymplecticCorrT35_M<false, DAMPING_DensityLength>(dt);
+		else ComputeSymplecticCorrT35_M<false, DAMPING_None>(dt);
 	}
 }
 
@@ -6781,16 +8083,18 @@ template<bool shift> void JSphSolidCpu::ComputeSymplecticCorrT_M(double dt) {
 	ArraysCpu->Free(PosPrec);         PosPrec = NULL;
 	ArraysCpu->Free(VelrhopPrec);	  VelrhopPrec = NULL;
 	ArraysCpu->Free(MassPrec_M);	  MassPrec_M = NULL;
-	ArraysCpu->Free(TauPrec_M);		  TauPrec_M = NULL;
-	ArraysCpu->Free(QuadFormPrec_M);  QuadFormPrec_M = NULL;
+	ArraysCpu->Free(TauPrec_M);		  TauPrec_M = TSymatrix3fSoa();
+	ArraysCpu->Free(QuadFormPrec_M);  QuadFormPrec_M = TSymatrix3fSoa();
 	TmcStop(Timers, TMC_SuComputeStep);
 }
 
-template<bool shift> void JSphSolidCpu::ComputeSymplecticCorrT35_M(double dt) {
+template<bool shift, TpDamping tdamp> void JSphSolidCpu::ComputeSymplecticCorrT35_M(double dt) {
 // #32 (merged from b): Include density treatment on boundary (removal of rho0 filter)
 // #34 BdVis: General damping term in acceleration
 // #35 ForceVisc: Update of Force Visc
 	TmcStart(Timers, TMC_SuComputeStep);
+	const JDampingModel_M<tdamp> damping(dampCoef);
+	tfloat3* forcevisc = ForceVisc; //-Only in output steps.
 
 	//-Calculate rhop of boudary and set velocity=0. | Calcula rhop de contorno y vel igual a cero.
 	const int npb = int(Npb);
@@ -6818,10 +8122,15 @@ template<bool shift> void JSphSolidCpu::ComputeSymplecticCorrT35_M(double dt) {
 	//-Calculate fluid values. | Calcula datos de fluido.
 	const double dt05 = dt * .5;
 	const int np = int(Np);
+	//-Tip of the root is obtained from the new positions. | Maximo de posicion (punta).
+	float tipth[OMP_MAXTHREADS * OMP_STRIDE];
+	unsigned tipp[OMP_MAXTHREADS * OMP_STRIDE];
+	TipThreadsInit_M(tipth, tipp);
 #ifdef OMP_USE
 #pragma omp parallel for schedule (static) if(np>OMP_LIMIT_COMPUTESTEP)
 #endif
 	for (int p = npb; p < np; p++) {
+		const int th = omp_get_thread_num();
 		const double epsilon_rdot = (-double(Arc[p]) / double(Velrhopc[p].w)) * dt;
 
 		float rhopnew = float(double(VelrhopPrec[p].w) * (2. - epsilon_rdot) / (2. + epsilon_rdot));
@@ -6836,136 +8145,14 @@ template<bool shift> void JSphSolidCpu::ComputeSymplecticCorrT35_M(double dt) {
 			Velrhopc[p].z = float(double(VelrhopPrec[p].z) + double(Acec[p].z) * dt);
 
 			// Apply damping
-			if (Posc[p].x > -0.1) {
-				ForceVisc[p] = ViscousDamping36(TFloat3(VelrhopPrec[p].x, VelrhopPrec[p].y, VelrhopPrec[p].z), Co_M[p], VelrhopPrec[p].w, 2.0f/sqrt(QuadFormPrec_M[p].xx));
-				Velrhopc[p].x -= ForceVisc[p].x * float(dt);
-				Velrhopc[p].y -= ForceVisc[p].y * float(dt);
-				Velrhopc[p].z -= ForceVisc[p].z * float(dt);
-			}
-			else ForceVisc[p] = TFloat3(0);
-
-
-			//-Calculate displacement and update position. | Calcula desplazamiento y actualiza posicion.
-			double dx = (double(VelrhopPrec[p].x) + double(Velrhopc[p].x)) * dt05;
-			double dy = (double(VelrhopPrec[p].y) + double(Velrhopc[p].y)) * dt05;
-			double dz = (double(VelrhopPrec[p].z) + double(Velrhopc[p].z)) * dt05;
-			if (shift) {
-				dx += double(ShiftPosc[p].x);
-				dy += double(ShiftPosc[p].y);
-				dz += double(ShiftPosc[p].z);
-			}
-			bool outrhop = (rhopnew<RhopOutMin || rhopnew>RhopOutMax);
-			UpdatePos(PosPrec[p], dx, dy, dz, outrhop, p, Posc, Dcellc, Codec);
-
-			// Update Shear stress
-			Tauc_M[p].xx = float(double(TauPrec_M[p].xx) + double(TauDotc_M[p].xx) * dt);
-			Tauc_M[p].xy = float(double(TauPrec_M[p].xy) + double(TauDotc_M[p].xy) * dt);
-			Tauc_M[p].xz = float(double(TauPrec_M[p].xz) + double(TauDotc_M[p].xz) * dt);
-			Tauc_M[p].yy = float(double(TauPrec_M[p].yy) + double(TauDotc_M[p].yy) * dt);
-			Tauc_M[p].yz = float(double(TauPrec_M[p].yz) + double(TauDotc_M[p].yz) * dt);
-			Tauc_M[p].zz = float(double(TauPrec_M[p].zz) + double(TauDotc_M[p].zz) * dt);
-
-			// Update Quadratic form
-			// ep+om modified 09042019
-			// #Velocity #Gradient
-			tmatrix3f Q = TMatrix3f(QuadFormPrec_M[p].xx, QuadFormPrec_M[p].xy, QuadFormPrec_M[p].xz
-				, QuadFormPrec_M[p].xy, QuadFormPrec_M[p].yy, QuadFormPrec_M[p].yz, QuadFormPrec_M[p].xz, QuadFormPrec_M[p].yz, QuadFormPrec_M[p].zz);
-
-			tmatrix3f GdVel = TMatrix3f(StrainDotc_M[p].xx, StrainDotc_M[p].xy, StrainDotc_M[p].xz
-				, StrainDotc_M[p].xy, StrainDotc_M[p].yy, StrainDotc_M[p].yz
-				, StrainDotc_M[p].xz, StrainDotc_M[p].yz, StrainDotc_M[p].zz) + TMatrix3f(Spinc_M[p].xx, Spinc_M[p].xy, Spinc_M[p].xz
-					, -Spinc_M[p].xy, Spinc_M[p].yy, Spinc_M[p].yz
-					, -Spinc_M[p].xz, -Spinc_M[p].yz, Spinc_M[p].zz);
-
-			tmatrix3f DQD = ToTMatrix3f((TMatrix3d(1, 0, 0, 0, 1, 0, 0, 0, 1) - dt
-				* ToTMatrix3d(Ttransp(GdVel))) * ToTMatrix3d(Q) * (TMatrix3d(1, 0, 0, 0, 1, 0, 0, 0, 1) - dt * ToTMatrix3d(GdVel)));
-			//27/03/19 - Is it possible to reduce this DQD line ? -> no because there is the complete multiplication of three dense matrices.
-			QuadFormc_M[p].xx = float(DQD.a11);
-			QuadFormc_M[p].xy = float(DQD.a12);
-			QuadFormc_M[p].xz = float(DQD.a13);
-			QuadFormc_M[p].yy = float(DQD.a22);
-			QuadFormc_M[p].yz = float(DQD.a23);
-			QuadFormc_M[p].zz = float(DQD.a33);
-
-			Velrhopc[p].w = rhopnew;
-		}
-		else {//-Floating Particles.
-			Velrhopc[p] = VelrhopPrec[p];
-			Velrhopc[p].w = (rhopnew < RhopZero ? RhopZero : rhopnew); //-Avoid fluid particles being absorbed by floating ones. | Evita q las floating absorvan a las fluidas.
-																	 //-Copy position. | Copia posicion.
-			Posc[p] = PosPrec[p];
-		}
-	}
-	// Growth function
-	GrowthCell_M(dt);
-
-	//-Free memory assigned to variables Pre and ComputeSymplecticPre(). | Libera memoria asignada a variables Pre en ComputeSymplecticPre().
-	ArraysCpu->Free(PosPrec);         PosPrec = NULL;
-	ArraysCpu->Free(VelrhopPrec);	  VelrhopPrec = NULL;
-	ArraysCpu->Free(MassPrec_M);	  MassPrec_M = NULL;
-	ArraysCpu->Free(TauPrec_M);		  TauPrec_M = NULL;
-	ArraysCpu->Free(QuadFormPrec_M);  QuadFormPrec_M = NULL;
-	TmcStop(Timers, TMC_SuComputeStep);
-}
-
-template<bool shift> void JSphSolidCpu::ComputeOneStepTwoStagesCorrT37_M(double dt) {
-	// #32 (merged from b): Include density treatment on boundary (removal of rho0 filter)
-	// #34 BdVis: General damping term in acceleration
-	// #35 ForceVisc: Update of Force Visc
-	TmcStart(Timers, TMC_SuComputeStep);
-
-	//-Calculate rhop of boudary and set velocity=0. | Calcula rhop de contorno y vel igual a cero.
-	const int npb = int(Npb);
-
-	//
-#ifdef OMP_USE
-#pragma omp parallel for schedule (static) if(npb>OMP_LIMIT_COMPUTESTEP)
-#endif
-	for (int p = 0; p < npb; p++) {
-		int idp = Idpc[p];
-		float ar = Arc[p];
-		float rp = Velrhopc[p].w;
-		const double epsilon_rdot = (-double(Arc[p]) / double(Velrhopc[p].w)) * dt;
-		const float rhopnew = float(double(VelrhopPrec[p].w) * (2. - epsilon_rdot) / (2. + epsilon_rdot));
-		Velrhopc[p] = TFloat4(0, 0, 0, (rhopnew < RhopZero ? RhopZero : rhopnew));
-		//Velrhopc[p] = TFloat4(0, 0, 0, rhopnew);
-
-		// Update Shear stress
-		Tauc_M[p].xx = float(double(TauPrec_M[p].xx) + double(TauDotc_M[p].xx) * dt);
-		Tauc_M[p].xy = float(double(TauPrec_M[p].xy) + double(TauDotc_M[p].xy) * dt);
-		Tauc_M[p].xz = float(double(TauPrec_M[p].xz) + double(TauDotc_M[p].xz) * dt);
-		Tauc_M[p].yy = float(double(TauPrec_M[p].yy) + double(TauDotc_M[p].yy) * dt);
-		Tauc_M[p].yz = float(double(TauPrec_M[p].yz) + double(TauDotc_M[p].yz) * dt);
-		Tauc_M[p].zz = float(double(TauPrec_M[p].zz) + double(TauDotc_M[p].zz) * dt);
-
-		QuadFormc_M[p] = QuadFormPrec_M[p];
-	}
-
-	//-Calculate fluid values. | Calcula datos de fluido.
-	const double dt05 = dt * .5;
-	const int np = int(Np);
-#ifdef OMP_USE
-#pragma omp parallel for schedule (static) if(np>OMP_LIMIT_COMPUTESTEP)
-#endif
-	for (int p = npb; p < np; p++) {
-		const float gamma = GrowthInterface_M(Velrhopc[p].w, float(Posc[p].x));
-		const float volume = Massc_M[p] / Velrhopc[p].w;
-		const double epsilon_rdot = (-double(Arc[p] + gamma) / double(Velrhopc[p].w)) * dt;
-		const float rhopnew = float(double(VelrhopPrec[p].w) * (2. - epsilon_rdot) / (2. + epsilon_rdot));
-
-		const double epsilon_mdot = (-double(gamma) / double(Velrhopc[p].w)) * dt;
-		const float massnew = float(double(MassPrec_M[p] * (2. - epsilon_mdot) / (2. + epsilon_mdot)));
-
-		// 27/03/19 - I need to find references for this equation, report on it
-		// 05/02/21 - Thread Dualsphysics and Pashnikov 2000
-
-		if (!WithFloating || CODE_IsFluid(Codec[p])) {//-Fluid Particles.
-													  //-Update velocity & density. | Actualiza velocidad y densidad.
-			Velrhopc[p].x = float(double(VelrhopPrec[p].x) + double(Acec[p].x) * dt);
-			Velrhopc[p].y = float(double(VelrhopPrec[p].y) + double(Acec[p].y) * dt);
-			Velrhopc[p].z = float(double(VelrhopPrec[p].z) + double(Acec[p].z) * dt);
-			Velrhopc[p].w = rhopnew;
-			Massc_M[p] = massnew;
+			if (tdamp != DAMPING_None && Posc[p].x > -0.1) {
+				const tfloat3 fvisc = damping(TFloat3(VelrhopPrec[p].x, VelrhopPrec[p].y, VelrhopPrec[p].z), Co_M[p], VelrhopPrec[p].w, QuadFormPrec_M[p].xx);
+				Velrhopc[p].x -= fvisc.x * float(dt);
+				Velrhopc[p].y -= fvisc.y * float(dt);
+				Velrhopc[p].z -= fvisc.z * float(dt);
+				if (forcevisc) forcevisc[p] = fvisc;
+			}
+
 
 			//-Calculate displacement and update position. | Calcula desplazamiento y actualiza posicion.
 			double dx = (double(VelrhopPrec[p].x) + double(Velrhopc[p].x)) * dt05;
@@ -7008,6 +8195,8 @@ template<bool shift> void JSphSolidCpu::ComputeOneStepTwoStagesCorrT37_M(double
 			QuadFormc_M[p].yy = float(DQD.a22);
 			QuadFormc_M[p].yz = float(DQD.a23);
 			QuadFormc_M[p].zz = float(DQD.a33);
+
+			Velrhopc[p].w = rhopnew;
 		}
 		else {//-Floating Particles.
 			Velrhopc[p] = VelrhopPrec[p];
@@ -7015,323 +8204,205 @@ template<bool shift> void JSphSolidCpu::ComputeOneStepTwoStagesCorrT37_M(double
 																	 //-Copy position. | Copia posicion.
 			Posc[p] = PosPrec[p];
 		}
+		TipThreadsAdd_M(Posc[p], unsigned(p), tipth + th * OMP_STRIDE, tipp + th * OMP_STRIDE);
 	}
+	TipThreadsReduce_M(tipth, tipp);
+	// Growth function
+	GrowthCell_M(dt);
 
 	//-Free memory assigned to variables Pre and ComputeSymplecticPre(). | Libera memoria asignada a variables Pre en ComputeSymplecticPre().
 	ArraysCpu->Free(PosPrec);         PosPrec = NULL;
 	ArraysCpu->Free(VelrhopPrec);	  VelrhopPrec = NULL;
 	ArraysCpu->Free(MassPrec_M);	  MassPrec_M = NULL;
-	ArraysCpu->Free(TauPrec_M);		  TauPrec_M = NULL;
-	ArraysCpu->Free(QuadFormPrec_M);  QuadFormPrec_M = NULL;
+	ArraysCpu->Free(TauPrec_M);		  TauPrec_M = TSymatrix3fSoa();
+	ArraysCpu->Free(QuadFormPrec_M);  QuadFormPrec_M = TSymatrix3fSoa();
 	TmcStop(Timers, TMC_SuComputeStep);
 }
-// End Symplectic_M
 
-void JSphSolidCpu::GrowthCell_M(double dt) {
-// #Growth #typeGrowth
-	//int typeGrowth = 2; // (default: no Growth, 0: old growth lambda, 1: 4.1%h-1, 2: variation Beemster1998)
-	// case3: beemster 2 cst lambda * f(x) in [0,1]
-	// case4: density variation + beemster fit for lambda 
-	// case5: Gaussian growth curve (centered 0.5, spread 0.15)
-	// case7: Constant lambda growth
+template<bool shift, TpGrowth tgrow> void JSphSolidCpu::ComputeOneStepTwoStagesCorrT37_M(double dt) {
+	// #32 (merged from b): Include density treatment on boundary (removal of rho0 filter)
+	// #34 BdVis: General damping term in acceleration
+	// #35 ForceVisc: Update of Force Visc
+	TmcStart(Timers, TMC_SuComputeStep);
+	const JGrowthModel_M<tgrow> growth(GetGrowthCtes_M());
+
+	//-Calculate rhop of boudary and set velocity=0. | Calcula rhop de contorno y vel igual a cero.
 	const int npb = int(Npb);
-	const int np = int(Np);
-	//maxPosX = 0.15f;
-	//maxPosX = MaxPosition().x;
 
+	//
 #ifdef OMP_USE
-#pragma omp parallel for schedule (static) if(np>OMP_LIMIT_COMPUTESTEP)
+#pragma omp parallel for schedule (static) if(npb>OMP_LIMIT_COMPUTESTEP)
 #endif
-	
-	for (int p = npb; p < np; p++) {
-		switch (typeGrowth) {
-			case 0: {// #Turgor growth model
-				const double volu = double(MassPrec_M[p]) / double(Velrhopc[p].w);
-				const double adens = float(LambdaMass) * (RhopZero / Velrhopc[p].w - 1);
-				Massc_M[p] = float(double(MassPrec_M[p]) + dt * adens * volu);
-				Velrhopc[p].w = float(Velrhopc[p].w + dt * adens);
-				break;
-			}
-			case 1: {// #Constant growth Cut-off Kill
-				const double volu = double(MassPrec_M[p]) / double(Velrhopc[p].w);
-				const double Gamma = KillSwitchSigmoid(float(Posc[p].x)) * LambdaMass;
-				Velrhopc[p].w = Velrhopc[p].w + float(dt * Gamma);
-				Massc_M[p] = Velrhopc[p].w * float(volu);		
-				break;
-			}
-			case 2: {// #Gaussian #Sigmoid growth
-				const double volu = double(MassPrec_M[p]) / double(Velrhopc[p].w);
-				float x = maxPosX - float(Posc[p].x);
-				float xs = 0.5f;
-				float xg = 0.6f;
-				float k = 15.0f;
-				float L = 0.125f;
-				float b = 0.15f;
-				const double Gamma = LambdaMass * (L - L / (1.0f + exp(-k * (x - xs))) + exp(-0.5f*pow((x-xg)/b,2.0f)));
-				Velrhopc[p].w = Velrhopc[p].w + float(dt * Gamma);
-				Massc_M[p] = Velrhopc[p].w * float(volu);
-				break;
-			}
-			case 3: {// #SigGauDrop
-				const double volu = double(MassPrec_M[p]) / double(Velrhopc[p].w);
-				float x = maxPosX - float(Posc[p].x);
-				// Sigmoid
-				float L = 0.125f;
-				float k = 15.0f;
-				float xs = 0.5f;
-				// Gaussian 				
-				float xg = 0.5f;
-				float b = 0.15f;
-				// Drop
-				float kd = 50.0f;
-				float xd = 0.65f;
-
-				double Gamma = 0.0;
-
-				if (x < xg) Gamma = LambdaMass / 1.065f * (L - L / (1.0f + exp(-k * (x - xs))) + exp(-0.5f * pow((x - xg) / b, 2.0f)));
-				else Gamma = LambdaMass * (1.0f - 1.0f / (1.0f + exp(-kd * (x - xd))));
-				
-				Velrhopc[p].w = Velrhopc[p].w + float(dt * Gamma);
-				Massc_M[p] = Velrhopc[p].w * float(volu);
-				break;
-			}
-			case 4: {
-				const double volu = double(MassPrec_M[p]) / double(Velrhopc[p].w);
-				const double Gamma = LambdaMass * GrowthRateSpaceNormalised(double(Posc[p].x)) * (RhopZero/ Velrhopc[p].w-1);
-				Velrhopc[p].w = Velrhopc[p].w + float(dt * Gamma);
-				Massc_M[p] = Velrhopc[p].w * float(volu);
-				break;
-			}
-
-			case 5: {// #Turgor growth model + Beemster
-				const double volu = double(MassPrec_M[p]) / double(Velrhopc[p].w);
-				float x = maxPosX - float(Posc[p].x);
-				// Sigmoid
-				float L = 0.125f;
-				float k = 15.0f;
-				float xs = 0.5f;
-				// Gaussian 				
-				float xg = 0.5f;
-				float b = 0.15f;
-				// Drop
-				float kd = 50.0f;
-				float xd = 0.65f;
-
-				double Gamma = 0.0;
-
-				if (x < xg) Gamma = LambdaMass / 1.065f * (L - L / (1.0f + exp(-k * (x - xs))) + exp(-0.5f * pow((x - xg) / b, 2.0f))) * (RhopZero / Velrhopc[p].w - 1);
-				else Gamma = LambdaMass * (1.0f - 1.0f / (1.0f + exp(-kd * (x - xd)))) * (RhopZero / Velrhopc[p].w - 1);
-
-				Velrhopc[p].w = Velrhopc[p].w + float(dt * Gamma);
-				Massc_M[p] = Velrhopc[p].w * float(volu);
-				break;
-			}
-			case 6: { // #Turgor growth model + Constant
-				const double volu = double(MassPrec_M[p]) / double(Velrhopc[p].w);
-
-				Velrhopc[p].w = Velrhopc[p].w + float(dt * LambdaMass * (RhopZero / Velrhopc[p].w - 1));
-				Massc_M[p] = Velrhopc[p].w * float(volu);
-				break;
-			}
-			case 7: { // #Turgor growth model + Triangle
-				const double volu = double(MassPrec_M[p]) / double(Velrhopc[p].w);
-				float pp = GrowthNormTrigle(float(Posc[p].x));
-				Velrhopc[p].w = Velrhopc[p].w + float(dt * GrowthNormTrigle(float(Posc[p].x)) * LambdaMass * (RhopZero / Velrhopc[p].w - 1));
-				
-				Massc_M[p] = Velrhopc[p].w * float(volu);
-				break;
-			}
-			case 8: { // #Composite distribution for turgor growth
-				const double volu = double(MassPrec_M[p]) / double(Velrhopc[p].w);
-				float pp = GrowthNormTrigle(float(Posc[p].x));
-				Velrhopc[p].w = Velrhopc[p].w + float(dt * GrowthNormComposite(float(Posc[p].x)) * LambdaMass * (RhopZero / Velrhopc[p].w - 1));
+	for (int p = 0; p < npb; p++) {
+		int idp = Idpc[p];
+		float ar = Arc[p];
+		float rp = Velrhopc[p].w;
+		const double epsilon_rdot = (-double(Arc[p]) / double(Velrhopc[p].w)) * dt;
+		const float rhopnew = float(double(VelrhopPrec[p].w) * (2. - epsilon_rdot) / (2. + epsilon_rdot));
+		Velrhopc[p] = TFloat4(0, 0, 0, (rhopnew < RhopZero ? RhopZero : rhopnew));
+		//Velrhopc[p] = TFloat4(0, 0, 0, rhopnew);
 
-				Massc_M[p] = Velrhopc[p].w * float(volu);
-				break;
-			}
-			case 9: { // #Kill #Composite distribution
-				const double volu = double(MassPrec_M[p]) / double(Velrhopc[p].w);
-				Velrhopc[p].w = Velrhopc[p].w + float(dt * KillSwitchSigmoid(float(Posc[p].x)) 
-					* GrowthNormComposite(float(Posc[p].x)) * LambdaMass * (RhopZero / Velrhopc[p].w - 1));
-				Massc_M[p] = Velrhopc[p].w * float(volu);
-				break;
-			}
-			case 10: { // #Composite distribution II: From Croser 1999 I, 6 parameters (2 baselines, 2 tip positions, 2 spreads
-				const double volu = double(MassPrec_M[p]) / double(Velrhopc[p].w);
-				Velrhopc[p].w = Velrhopc[p].w + float(dt * CroserGrowth(float(Posc[p].x)) * LambdaMass * (RhopZero / Velrhopc[p].w - 1));
-				Massc_M[p] = Velrhopc[p].w * float(volu);
-				break;
-			}
-		}
+		QuadFormc_M[p] = QuadFormPrec_M[p];
 	}
 
-}
+	//-Calculate fluid values. | Calcula datos de fluido.
+	const double dt05 = dt * .5;
+	const int np = int(Np);
+	//-Tip of the root is obtained from the new positions. | Maximo de posicion (punta).
+	float tipth[OMP_MAXTHREADS * OMP_STRIDE];
+	unsigned tipp[OMP_MAXTHREADS * OMP_STRIDE];
+	TipThreadsInit_M(tipth, tipp);
+	TimersReg->Start(TmsCorrector);
+#ifdef OMP_USE
+#pragma omp parallel if(np>OMP_LIMIT_COMPUTESTEP)
+#endif
+	{
+		const JTimerRegistry::ThreadScope ths(TimersReg, TmsCorrector);
+#ifdef OMP_USE
+#pragma omp for schedule (static) nowait
+#endif
+		for (int p = npb; p < np; p++) {
+			const int th = omp_get_thread_num();
+			const float gamma = growth.Rate(Velrhopc[p].w, float(Posc[p].x));
+			const float volume = Massc_M[p] / Velrhopc[p].w;
+			const double epsilon_rdot = (-double(Arc[p] + gamma) / double(Velrhopc[p].w)) * dt;
+			const float rhopnew = float(double(VelrhopPrec[p].w) * (2. - epsilon_rdot) / (2. + epsilon_rdot));
 
-float JSphSolidCpu::GrowthInterface_M(float density, float pos) const{
-	switch (typeGrowth) {
-	case 0: {// #Turgor growth model
-		return float(LambdaMass) * (RhopZero / density - 1);
-	}
-	case 1: {// #Constant growth Cut-off Kill
-		return KillSwitchSigmoid(pos) * LambdaMass;
-	}
-	case 2: {// #Gaussian #Sigmoid growth
-		float x = maxPosX - float(pos);
-		float xs = 0.5f;
-		float xg = 0.6f;
-		float k = 15.0f;
-		float L = 0.125f;
-		float b = 0.15f;
-		return LambdaMass * (L - L / (1.0f + exp(-k * (x - xs))) + exp(-0.5f * pow((x - xg) / b, 2.0f)));
-	}
-	case 3: {// #SigGauDrop
-		float x = maxPosX - pos;
-		// Sigmoid
-		float L = 0.125f;
-		float k = 15.0f;
-		float xs = 0.5f;
-		// Gaussian 				
-		float xg = 0.5f;
-		float b = 0.15f;
-		// Drop
-		float kd = 50.0f;
-		float xd = 0.65f;
+			const double epsilon_mdot = (-double(gamma) / double(Velrhopc[p].w)) * dt;
+			const float massnew = float(double(MassPrec_M[p] * (2. - epsilon_mdot) / (2. + epsilon_mdot)));
 
-		double Gamma = 0.0;
+			// 27/03/19 - I need to find references for this equation, report on it
+			// 05/02/21 - Thread Dualsphysics and Pashnikov 2000
 
-		if (x < xg) return LambdaMass / 1.065f * (L - L / (1.0f + exp(-k * (x - xs))) + exp(-0.5f * pow((x - xg) / b, 2.0f)));
-		else return LambdaMass * (1.0f - 1.0f / (1.0f + exp(-kd * (x - xd))));
-	}
-	case 4: {
-		return LambdaMass * GrowthRateSpaceNormalised(pos) * (RhopZero / density - 1);
-	}
+			if (!WithFloating || CODE_IsFluid(Codec[p])) {//-Fluid Particles.
+														  //-Update velocity & density. | Actualiza velocidad y densidad.
+				Velrhopc[p].x = float(double(VelrhopPrec[p].x) + double(Acec[p].x) * dt);
+				Velrhopc[p].y = float(double(VelrhopPrec[p].y) + double(Acec[p].y) * dt);
+				Velrhopc[p].z = float(double(VelrhopPrec[p].z) + double(Acec[p].z) * dt);
+				Velrhopc[p].w = rhopnew;
+				Massc_M[p] = massnew;
 
-	case 5: {// #Turgor growth model + Beemster
-		float x = maxPosX - pos;
-		// Sigmoid
-		float L = 0.125f;
-		float k = 15.0f;
-		float xs = 0.5f;
-		// Gaussian 				
-		float xg = 0.5f;
-		float b = 0.15f;
-		// Drop
-		float kd = 50.0f;
-		float xd = 0.65f;
+				//-Calculate displacement and update position. | Calcula desplazamiento y actualiza posicion.
+				double dx = (double(VelrhopPrec[p].x) + double(Velrhopc[p].x)) * dt05;
+				double dy = (double(VelrhopPrec[p].y) + double(Velrhopc[p].y)) * dt05;
+				double dz = (double(VelrhopPrec[p].z) + double(Velrhopc[p].z)) * dt05;
+				if (shift) {
+					dx += double(ShiftPosc[p].x);
+					dy += double(ShiftPosc[p].y);
+					dz += double(ShiftPosc[p].z);
+				}
+				bool outrhop = (rhopnew<RhopOutMin || rhopnew>RhopOutMax);
+				UpdatePos(PosPrec[p], dx, dy, dz, outrhop, p, Posc, Dcellc, Codec);
 
-		double Gamma = 0.0;
+				// Update Quadratic form
+				// ep+om modified 09042019
+				// #Velocity #Gradient
+				tmatrix3f Q = TMatrix3f(QuadFormPrec_M[p].xx, QuadFormPrec_M[p].xy, QuadFormPrec_M[p].xz
+					, QuadFormPrec_M[p].xy, QuadFormPrec_M[p].yy, QuadFormPrec_M[p].yz, QuadFormPrec_M[p].xz, QuadFormPrec_M[p].yz, QuadFormPrec_M[p].zz);
 
-		if (x < xg) return LambdaMass / 1.065f * (L - L / (1.0f + exp(-k * (x - xs))) + exp(-0.5f * pow((x - xg) / b, 2.0f)))
-			* (RhopZero / density - 1);
-		else return LambdaMass * (1.0f - 1.0f / (1.0f + exp(-kd * (x - xd)))) * (RhopZero / density - 1);
-	}
-	case 6: { // #Turgor growth model + Constant
-		return LambdaMass * (RhopZero / density);
-	}
-	case 7: { // #Turgor growth model + Triangle
-		return GrowthNormTrigle(pos) * LambdaMass * (RhopZero / density - 1);
-	}
-	case 8: { // #Composite distribution for turgor growth
-		return GrowthNormComposite(pos) * LambdaMass * (RhopZero / density - 1);
-	}
-	case 9: { // #Kill #Composite distribution
-		return KillSwitchSigmoid(pos)* GrowthNormComposite(pos) * LambdaMass * (RhopZero / density - 1);
-	}
-	case 10: { // #Composite distribution II: From Croser 1999 I, 6 parameters (2 baselines, 2 tip positions, 2 spreads
-		return CroserGrowth(pos) * LambdaMass * (RhopZero / density - 1);
-	}
-	default: return 0.0f;
-}
-}
+				tmatrix3f GdVel = TMatrix3f(StrainDotc_M[p].xx, StrainDotc_M[p].xy, StrainDotc_M[p].xz
+					, StrainDotc_M[p].xy, StrainDotc_M[p].yy, StrainDotc_M[p].yz
+					, StrainDotc_M[p].xz, StrainDotc_M[p].yz, StrainDotc_M[p].zz) + TMatrix3f(Spinc_M[p].xx, Spinc_M[p].xy, Spinc_M[p].xz
+						, -Spinc_M[p].xy, Spinc_M[p].yy, Spinc_M[p].yz
+						, -Spinc_M[p].xz, -Spinc_M[p].yz, Spinc_M[p].zz);
 
-// #Viscous function
-tfloat3 JSphSolidCpu::ViscousDamping36(tfloat3 vel, float co, float rho, float l) {
-	switch (typeDamping) {
-	case 0: {
-		// Homogeneous application of the damping
-		return vel * dampCoef;
-	}
-	case 1: {
-		// Weighted application of the damping only on the surface
-		return vel * dampCoef * co;
-	}
-	case 2: {
-		// Homogeneous application of the plaeteaued damping
-		return vel * dampCoef / (sqrt(pow(vel.x,2.0f)+ pow(vel.y, 2.0f)+ pow(vel.z, 2.0f))+1.0f);
-	}
-	case 3: {
-		// Homogeneous viscosity weighted by density  (Inspired from Monaghan1997Drag and Monaghan2006Toy1D)
-		return vel * dampCoef / rho;
-	}
-	case 4: {
-		// Sophisticated viscosity weighted by density, velocity and cell lenght (Inspired from Monaghan1997Drag)
-		return vel * vel * dampCoef / (rho * l);
-	}
-	default:
-		return TFloat3(0.0f);
+				tmatrix3f DQD = ToTMatrix3f((TMatrix3d(1, 0, 0, 0, 1, 0, 0, 0, 1) - dt
+					* ToTMatrix3d(Ttransp(GdVel))) * ToTMatrix3d(Q) * (TMatrix3d(1, 0, 0, 0, 1, 0, 0, 0, 1) - dt * ToTMatrix3d(GdVel)));
+				//27/03/19 - Is it possible to reduce this DQD line ? -> no because there is the complete multiplication of three dense matrices.
+				QuadFormc_M[p].xx = float(DQD.a11);
+				QuadFormc_M[p].xy = float(DQD.a12);
+				QuadFormc_M[p].xz = float(DQD.a13);
+				QuadFormc_M[p].yy = float(DQD.a22);
+				QuadFormc_M[p].yz = float(DQD.a23);
+				QuadFormc_M[p].zz = float(DQD.a33);
+			}
+			else {//-Floating Particles.
+				Velrhopc[p] = VelrhopPrec[p];
+				Velrhopc[p].w = (rhopnew < RhopZero ? RhopZero : rhopnew); //-Avoid fluid particles being absorbed by floating ones. | Evita q las floating absorvan a las fluidas.
+																		 //-Copy position. | Copia posicion.
+				Posc[p] = PosPrec[p];
+			}
+			TipThreadsAdd_M(Posc[p], unsigned(p), tipth + th * OMP_STRIDE, tipp + th * OMP_STRIDE);
+		}
 	}
-}
+	TimersReg->Stop(TmsCorrector);
+	TipThreadsReduce_M(tipth, tipp);
 
-// Growth function - Normalised Gauss
-float JSphSolidCpu::GrowthNormGauss(float pos) {
-	float distance = abs(pos - maxPosX);
-	return float(exp(-pow(distance - posGr, 2.0f) / (2.0f * pow(spGr, 2.0f))));
-}
+	//-Update shear stress. | Actualiza tensiones.
+	TimersReg->Start(TmsTau);
+	ComputeTauStreams_M(Np, dt);
+	TimersReg->Stop(TmsTau);
 
-// Growth function - Normalised Composite
-float JSphSolidCpu::GrowthNormComposite(float pos) const{
-	float distance = abs(pos - maxPosX);
-	return float(ctGr * (1.0f - 1.0f / (1.0f + exp(-20.0 * (distance - posGr)))) + exp(-pow(distance - posGr, 2.0f) / (2.0f * pow(spGr, 2.0f)))) / (ctGr + 1.0f);
-}
-
-// Growth function - From Croser 1999 I, sigmoid baseline + dGaussian
-// cs, cg are the scale parameters
-// ps, pg are the positions of the tilt of the sigmoid and the dGaussian
-// ss, sg are the spread parameters
-float JSphSolidCpu::CroserGrowth(float pos) const{
-	// Values in mm for a 15 mm long sample
-	/*float cs = 0.025f;
-	float cg = 0.16f;
-	float ps = 6.0f;
-	float pg = 0.0f;
-	float ss = 2.0f;
-	float sg = 4.0f;*/
-	float distance = abs(pos - maxPosX);
-	return ctGr * AntiSigmoid(distance, posGr, spGr) + abs(c2Gr - ctGr) * dGaussian(distance, po2Gr, s2Gr);
+	//-Free memory assigned to variables Pre and ComputeSymplecticPre(). | Libera memoria asignada a variables Pre en ComputeSymplecticPre().
+	ArraysCpu->Free(PosPrec);         PosPrec = NULL;
+	ArraysCpu->Free(VelrhopPrec);	  VelrhopPrec = NULL;
+	ArraysCpu->Free(MassPrec_M);	  MassPrec_M = NULL;
+	ArraysCpu->Free(TauPrec_M);		  TauPrec_M = TSymatrix3fSoa();
+	ArraysCpu->Free(QuadFormPrec_M);  QuadFormPrec_M = TSymatrix3fSoa();
+	TmcStop(Timers, TMC_SuComputeStep);
 }
+// End Symplectic_M
 
-// Anti Sigmoid function (1 minus Sigmoid)
-float JSphSolidCpu::AntiSigmoid(float x, float p, float s) const {
-	// x is evaluation position
-	// p is tilt position
-	// s is spread value
-	return 1.0f - 1.0f / (1.0f + exp(-s*(x - p)));
+//==============================================================================
+/// Returns the parameters of the growth laws for the current step.
+//==============================================================================
+StGrowthCtes JSphSolidCpu::GetGrowthCtes_M()const {
+	StGrowthCtes g;
+	g.lambda = LambdaMass;
+	g.rhopzero = RhopZero;
+	g.tipx = maxPosX;
+	g.posgr = posGr; g.spgr = spGr; g.ctgr = ctGr;
+	g.po2gr = po2Gr; g.s2gr = s2Gr; g.c2gr = c2Gr;
+	g.klgr = klGr;
+	return(g);
 }
 
-// Normalised space first derivative of Gaussian function (Bell and tail)
-float JSphSolidCpu::dGaussian(float x, float p, float s) const{
-	// x is evaluation position
-	// p is tilt position
-	// s is spread value
-	return (x-p)/s * exp(0.5f - pow(x-p, 2.0f) / (2*s*s));
+//==============================================================================
+/// Applies the growth of the step to density and mass of fluid particles.
+/// #Growth #typeGrowth (see TpGrowth)
+//==============================================================================
+void JSphSolidCpu::GrowthCell_M(double dt) {
+	const TpGrowth tgrow = GetTypeGrowth_M();
+	TimersReg->Start(TmsGrowth);
+	if (tgrow == GROWTH_Turgor)          GrowthCellT_M<GROWTH_Turgor>(dt);
+	else if (tgrow == GROWTH_KillConst)       GrowthCellT_M<GROWTH_KillConst>(dt);
+	else if (tgrow == GROWTH_SigGauss)        GrowthCellT_M<GROWTH_SigGauss>(dt);
+	else if (tgrow == GROWTH_SigGauDrop)      GrowthCellT_M<GROWTH_SigGauDrop>(dt);
+	else if (tgrow == GROWTH_TurgorSpace)     GrowthCellT_M<GROWTH_TurgorSpace>(dt);
+	else if (tgrow == GROWTH_TurgorSigGauDrop)GrowthCellT_M<GROWTH_TurgorSigGauDrop>(dt);
+	else if (tgrow == GROWTH_TurgorConst)     GrowthCellT_M<GROWTH_TurgorConst>(dt);
+	else if (tgrow == GROWTH_TurgorTriangle)  GrowthCellT_M<GROWTH_TurgorTriangle>(dt);
+	else if (tgrow == GROWTH_TurgorComposite) GrowthCellT_M<GROWTH_TurgorComposite>(dt);
+	else if (tgrow == GROWTH_KillComposite)   GrowthCellT_M<GROWTH_KillComposite>(dt);
+	else if (tgrow == GROWTH_Croser)          GrowthCellT_M<GROWTH_Croser>(dt);
+	TimersReg->Stop(TmsGrowth);
 }
 
-// Growth function - Normalised Triangle 0-0.6
-float JSphSolidCpu::GrowthNormTrigle(float pos)const {
-	float distance = abs(pos - maxPosX);
-	if (distance < 0.3f) {
-		return distance/ 0.3f;
-	}
-	else if (distance < 0.6f) {
-		return abs(2.0f - distance / 0.3f);
+//==============================================================================
+/// Applies the growth law tgrow (see JGrowthModel_M::Cell()).
+//==============================================================================
+template<TpGrowth tgrow> void JSphSolidCpu::GrowthCellT_M(double dt) {
+	const JGrowthModel_M<tgrow> growth(GetGrowthCtes_M());
+	const int npb = int(Npb);
+	const int np = int(Np);
+#ifdef OMP_USE
+#pragma omp parallel if(np>OMP_LIMIT_COMPUTESTEP)
+#endif
+	{
+		const JTimerRegistry::ThreadScope ths(TimersReg, TmsGrowth);
+#ifdef OMP_USE
+#pragma omp for schedule (static) nowait
+#endif
+		for (int p = npb; p < np; p++) {
+			growth.Cell(dt, MassPrec_M[p], float(Posc[p].x), Velrhopc[p].w, Massc_M[p]);
+		}
 	}
-	else return 0.0f;
 }
 
-// Growth function - Kill switch (Sigmoid)
-float JSphSolidCpu::KillSwitchSigmoid(float pos) const{
+// Growth function - Normalised Gauss
+float JSphSolidCpu::GrowthNormGauss(float pos) {
 	float distance = abs(pos - maxPosX);
-	return 1.0f - 1.0f / (1.0f + exp(-40.0f * (distance - klGr)));
+	return float(exp(-pow(distance - posGr, 2.0f) / (2.0f * pow(spGr, 2.0f))));
 }
 
 // #Growth function - Beemster 1998 approx
@@ -7348,13 +8419,6 @@ float JSphSolidCpu::GrowthRateSpace(float pos) {
 	}
 }
 
-// Growth function - Normalised
-float JSphSolidCpu::GrowthRateSpaceNormalised(float pos) const{
-	//float distance = 0.25f *abs(pos - maxPosX); // Beemster
-	float distance = 20.0f * abs(pos - maxPosX); // Rescale to Bassel_2014 meristem data
-	return exp(1.0f) * distance * exp(-distance);
-}
-
 // Growth function - Gaussian
 float JSphSolidCpu::GrowthRateGaussian(float pos) {
 	switch (typeGrowth) {
@@ -7371,14 +8435,6 @@ float JSphSolidCpu::GrowthRateGaussian(float pos) {
 	}
 }
 
-// Growth function - Normalised Double precision
-double JSphSolidCpu::GrowthRateSpaceNormalised(double pos) {
-	//float distance = 0.25f *abs(pos - maxPosX); // Beemster
-	//double distance = 20.0f * abs(pos - (double) maxPosX); // Rescale to Bassel_2014 meristem data
-	double distance = 1.0/5.0 * abs(pos - (double) maxPosX); // Rescale to Smooth Lambda growth
-	return distance * exp(1.0 -distance);
-}
-
 // Growth function - Normalised Double precision
 double JSphSolidCpu::GrowthRate2(double pos, double tip) {
 	//float distance = 0.25f *abs(pos - maxPosX); // Beemster
@@ -7395,17 +8451,155 @@ float JSphSolidCpu::MaxValueParticles(float* field) {
 	return maxValue;
 }
 
+//==============================================================================
+/// Returns the maximum of each component of the position of particles
+/// [Npb,Np) (not below 0). The value is kept by the position updates of the
+/// symplectic steps and is only computed again when it was invalidated.
+//==============================================================================
 tfloat3 JSphSolidCpu::MaxPosition() {
-	tfloat3 maxValue = TFloat3(0.0f);
+	if (!TipValid_M)UpdateTip_M();
+	return(TipPos_M);
+}
+
+//==============================================================================
+/// Returns the Idp of the tip particle (maximum x) or UINT_MAX when all
+/// particles have x<=0.
+//==============================================================================
+unsigned JSphSolidCpu::MaxPositionIdp() {
+	if (!TipValid_M)UpdateTip_M();
+	return(TipIdp_M.x);
+}
+
+//==============================================================================
+/// Initialises the maximum of each thread (3 values per thread with OMP_STRIDE).
+//==============================================================================
+void JSphSolidCpu::TipThreadsInit_M(float* tipth, unsigned* tipp)const {
+	for (int th = 0; th < OmpThreads; th++) {
+		float* tip = tipth + th * OMP_STRIDE;
+		unsigned* tp = tipp + th * OMP_STRIDE;
+		tip[0] = tip[1] = tip[2] = 0;
+		tp[0] = tp[1] = tp[2] = UINT_MAX;
+	}
+}
+
+//==============================================================================
+/// Combines the maximum of each thread in TipPos_M and TipIdp_M. Threads are
+/// visited in order so with equal values the first particle is kept.
+//==============================================================================
+void JSphSolidCpu::TipThreadsReduce_M(const float* tipth, const unsigned* tipp) {
+	float tip[3] = { 0,0,0 };
+	unsigned tp[3] = { UINT_MAX,UINT_MAX,UINT_MAX };
+	for (int th = 0; th < OmpThreads; th++)for (int c = 0; c < 3; c++) {
+		if (tipth[th * OMP_STRIDE + c] > tip[c]) { tip[c] = tipth[th * OMP_STRIDE + c]; tp[c] = tipp[th * OMP_STRIDE + c]; }
+	}
+	TipPos_M = TFloat3(tip[0], tip[1], tip[2]);
+	TipIdp_M.x = (tp[0] != UINT_MAX ? Idpc[tp[0]] : UINT_MAX);
+	TipIdp_M.y = (tp[1] != UINT_MAX ? Idpc[tp[1]] : UINT_MAX);
+	TipIdp_M.z = (tp[2] != UINT_MAX ? Idpc[tp[2]] : UINT_MAX);
+	TipValid_M = true;
+}
+
+//==============================================================================
+/// Computes the tip from the current positions of particles [Npb,Np).
+//==============================================================================
+void JSphSolidCpu::UpdateTip_M() {
+	float tipth[OMP_MAXTHREADS * OMP_STRIDE];
+	unsigned tipp[OMP_MAXTHREADS * OMP_STRIDE];
+	TipThreadsInit_M(tipth, tipp);
 	const int npb = int(Npb);
 	const int np = int(Np);
+#ifdef OMP_USE
+#pragma omp parallel for schedule (static) if(np>OMP_LIMIT_COMPUTELIGHT)
+#endif
 	for (int p = npb; p < np; p++) {
-		const tfloat3 ps = TFloat3((float) Posc[p].x, (float) Posc[p].y, (float) Posc[p].z);
-		maxValue.x = max(ps.x, maxValue.x);
-		maxValue.y = max(ps.y, maxValue.y);
-		maxValue.z = max(ps.z, maxValue.z);
+		const int th = omp_get_thread_num();
+		TipThreadsAdd_M(Posc[p], unsigned(p), tipth + th * OMP_STRIDE, tipp + th * OMP_STRIDE);
+	}
+	TipThreadsReduce_M(tipth, tipp);
+}
+
+//==============================================================================
+/// Updates the tip after the division of the ndiv particles in mark[] whose
+/// daughters were created in [np,np+ndiv). When one of the mothers was a tip
+/// particle (it was moved back) the tip is computed again in the next use.
+//==============================================================================
+void JSphSolidCpu::UpdateTipDivision_M(unsigned ndiv, const unsigned* mark, unsigned np) {
+	if (!TipValid_M || !ndiv)return;
+	float tip[3] = { TipPos_M.x,TipPos_M.y,TipPos_M.z };
+	unsigned tp[3] = { UINT_MAX,UINT_MAX,UINT_MAX };
+	for (unsigned n = 0; n < ndiv && TipValid_M; n++) {
+		const unsigned p = mark[n], idp = Idpc[p];
+		if (idp == TipIdp_M.x || idp == TipIdp_M.y || idp == TipIdp_M.z)TipValid_M = false;
+		else {
+			TipThreadsAdd_M(Posc[p], p, tip, tp);
+			TipThreadsAdd_M(Posc[np + n], np + n, tip, tp);
+		}
+	}
+	if (TipValid_M) {
+		TipPos_M = TFloat3(tip[0], tip[1], tip[2]);
+		if (tp[0] != UINT_MAX)TipIdp_M.x = Idpc[tp[0]];
+		if (tp[1] != UINT_MAX)TipIdp_M.y = Idpc[tp[1]];
+		if (tp[2] != UINT_MAX)TipIdp_M.z = Idpc[tp[2]];
+	}
+}
+
+//==============================================================================
+/// Reserves the diagnostic fields when the step of size dt ends at an output
+/// time, they are filled during the step (AceSave in the Fluid-Fluid
+/// interaction, ForceVisc in the corrector and StrainDotSave in DgCapture_M())
+/// and freed after saving. Returns true when they are reserved.
+/// Reserva los campos de diagnostico cuando el paso termina con una salida.
+//==============================================================================
+bool JSphSolidCpu::DgReserve_M(double dt) {
+	if (TimeStep + dt < TimePartNext)return(false);
+	if (!StrainDotSave) {
+		StrainDotSave = ArraysCpu->ReserveFloat3();
+		AceSave = ArraysCpu->ReserveFloat3();
+		ForceVisc = ArraysCpu->ReserveFloat3();
+	}
+	memset(StrainDotSave, 0, sizeof(tfloat3) * Np);
+	memset(AceSave, 0, sizeof(tfloat3) * Np);
+	memset(ForceVisc, 0, sizeof(tfloat3) * Np);
+	return(true);
+}
+
+//==============================================================================
+/// Stores the diagonal of StrainDot and, with acetotal, the total acceleration
+/// in the diagnostic fields. Used before PosInteraction_Forces() in the output
+/// steps (Verlet and Euler only know dt after the interaction, so they use the
+/// total acceleration instead of the Fluid-Fluid one).
+//==============================================================================
+void JSphSolidCpu::DgCapture_M(bool acetotal) {
+	if (!StrainDotSave)return;
+	const int np = int(Np);
+#ifdef OMP_USE
+#pragma omp parallel for schedule (static) if(np>OMP_LIMIT_COMPUTELIGHT)
+#endif
+	for (int p = 0; p < np; p++)StrainDotSave[p] = TFloat3(StrainDotc_M.xx[p], StrainDotc_M.yy[p], StrainDotc_M.zz[p]);
+	if (acetotal)memcpy(AceSave + Npb, Acec + Npb, sizeof(tfloat3) * (Np - Npb));
+}
+
+//==============================================================================
+/// Frees the diagnostic fields once they were saved.
+//==============================================================================
+void JSphSolidCpu::DgFree_M() {
+	ArraysCpu->Free(StrainDotSave); StrainDotSave = NULL;
+	ArraysCpu->Free(AceSave);       AceSave = NULL;
+	ArraysCpu->Free(ForceVisc);     ForceVisc = NULL;
+}
+
+//==============================================================================
+/// Computes the Von Mises stress of particles [pini,pini+n) from Tau.
+/// Calcula la tension de Von Mises a partir de Tau.
+//==============================================================================
+void JSphSolidCpu::DgVonMises_M(unsigned n, unsigned pini, float* vonmises)const {
+	const int pfin = int(pini + n);
+#ifdef OMP_USE
+#pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+#endif
+	for (int p = int(pini); p < pfin; p++) {
+		vonmises[p - pini] = VonMises_M(Tauc_M[p]);
 	}
-	return maxValue;
 }
 
 
@@ -7630,18 +8824,85 @@ void JSphSolidCpu::InitFloating() {
 }
 
 //============================================================================== 
-/// Show active timers.
+/// Registers the timers of the solid model. Each name starts with the fixed
+/// timer that contains it, so it is reported below that timer. A new timer
+/// only needs a line here and its Start()/Stop() (or a ThreadScope in the
+/// parallel regions to measure the load imbalance).
+//==============================================================================
+void JSphSolidCpu::ConfigTimers_M(bool active) {
+	TimersReg->SetActive(active);
+	TmsCorrection = TimersReg->Add("CF-Forces/Correction");
+	TmsDeformation = TimersReg->Add("CF-Forces/Deformation");
+	TmsCorrector = TimersReg->Add("SU-ComputeStep/Corrector");
+	TmsTau = TimersReg->Add("SU-ComputeStep/Tau");
+	TmsGrowth = TimersReg->Add("SU-ComputeStep/Growth");
+	TmsDivMark = TimersReg->Add("SU-Division/Mark");
+	TmsDivCreate = TimersReg->Add("SU-Division/Create");
+	TmsSaveData = TimersReg->Add("SU-SavePart/GetData");
+	TmsSaveWait = TimersReg->Add("SU-SavePart/WaitWriter");
+	TimersReg->ResetValues();
+}
+
+//============================================================================== 
+/// Creates the timeline of the execution when it was requested with -trace.
+/// The registered timers are also recorded, with their threads.
+//==============================================================================
+void JSphSolidCpu::ConfigTrace_M() {
+	delete Trace; Trace = NULL;
+	if (!TraceFile.empty())Trace = new JTraceEvents(TraceFile);
+	TimersReg->SetTrace(Trace);
+}
+
+//============================================================================== 
+/// Saves the timeline of the execution. The writer thread of PART files must
+/// be finished.
+//==============================================================================
+void JSphSolidCpu::SaveTrace_M() {
+	if (!Trace)return;
+	Trace->SaveFile();
+	Log->AddFileInfo(TraceFile, "Timeline of the execution in Chrome trace format (chrome://tracing or ui.perfetto.dev).");
+	Log->Printf("Trace events: %llu", Trace->GetCount());
+	if (Trace->GetLost())Log->PrintfWarning("The trace only keeps the last events, %llu events were overwritten.", Trace->GetLost());
+}
+
+//============================================================================== 
+/// Returns the text of a registered timer, indented below its parent and with
+/// the load imbalance when the threads were measured.
+//==============================================================================
+static std::string TimerRegToText(const JTimerRegistry *reg, unsigned id) {
+	std::string tx = std::string(2 * reg->GetLevel(id), ' ') + reg->GetShortName(id);
+	while (tx.length()<33)tx += ".";
+	tx = tx + ": " + fun::FloatStr(float(reg->GetTime(id) / 1000.)) + " sec.";
+	if (reg->GetThreaded(id))tx = tx + fun::PrintStr("  (imbalance %.2f)", reg->GetImbalance(id));
+	return(tx);
+}
+
+//============================================================================== 
+/// Show active timers, the registered timers are shown below their parents.
 /// Muestra los temporizadores activos.
 //==============================================================================
 void JSphSolidCpu::ShowTimers(bool onlyfile) {
 	JLog2::TpMode_Out mode = (onlyfile ? JLog2::Out_File : JLog2::Out_ScrFile);
 	Log->Print("[CPU Timers]", mode);
 	if (!SvTimers)Log->Print("none", mode);
-	else for (unsigned c = 0; c<TimerGetCount(); c++)if (TimerIsActive(c))Log->Print(TimerToText(c), mode);
+	else {
+		std::vector<bool> shown(TimersReg->GetCount(), false);
+		for (unsigned c = 0; c<TimerGetCount(); c++)if (TimerIsActive(c)) {
+			Log->Print(TimerToText(c), mode);
+			const std::vector<unsigned> ids = TimersReg->GetChildren(TimerGetName(c));
+			for (unsigned cr = 0; cr<unsigned(ids.size()); cr++) {
+				Log->Print(TimerRegToText(TimersReg, ids[cr]), mode);
+				shown[ids[cr]] = true;
+			}
+		}
+		const std::vector<unsigned> ids = TimersReg->GetChildren("");
+		for (unsigned cr = 0; cr<unsigned(ids.size()); cr++)if (!shown[ids[cr]])Log->Print(TimerRegToText(TimersReg, ids[cr]), mode);
+	}
 }
 
 //============================================================================== 
-/// Return string with names and values of active timers.
+/// Return string with names and values of active timers. The registered timers
+/// with thread data add a column with their load imbalance.
 /// Devuelve string con nombres y valores de los timers activos.
 //==============================================================================
 void JSphSolidCpu::GetTimersInfo(std::string &hinfo, std::string &dinfo)const {
@@ -7649,6 +8910,18 @@ void JSphSolidCpu::GetTimersInfo(std::string &hinfo, std::string &dinfo)const {
 		hinfo = hinfo + ";" + TimerGetName(c);
 		dinfo = dinfo + ";" + fun::FloatStr(TimerGetValue(c) / 1000.f);
 	}
+	if (TimersReg->GetActive()) {
+		const std::vector<unsigned> ids = TimersReg->GetChildren("");
+		for (unsigned cr = 0; cr<unsigned(ids.size()); cr++) {
+			const unsigned id = ids[cr];
+			hinfo = hinfo + ";" + TimersReg->GetName(id);
+			dinfo = dinfo + ";" + fun::FloatStr(float(TimersReg->GetTime(id) / 1000.));
+			if (TimersReg->GetThreaded(id)) {
+				hinfo = hinfo + ";" + TimersReg->GetName(id) + "-Imbalance";
+				dinfo = dinfo + ";" + fun::FloatStr(float(TimersReg->GetImbalance(id)));
+			}
+		}
+	}
 }
 
 
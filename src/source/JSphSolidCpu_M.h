@@ -25,11 +25,18 @@ You should have received a copy of the GNU Lesser General Public License along w
 #include "JSphTimersCpu.h"
 #include "JPartsLoad4.h"
 #include "JSph.h"
+#include "JSphSolidSimd_M.h"
+#include "JSphSolidModels_M.h"
+#include "JTraceEvents.h"
 #include <string>
+#include <vector>
 
 class JPartsOut;
 class JArraysCpu;
 class JCellDivCpu;
+class JNeighbourListCpu;
+class JBinaryData;
+class JTimerRegistry;
 
 //##############################################################################
 //# JSphSolidCpu
@@ -68,6 +75,22 @@ protected:
 						//-List of particle arrays on CPU. | Lista de arrays en CPU para particulas.
 	JArraysCpu* ArraysCpu;
 
+	//-Neighbour list shared by the interaction passes of each divide. #V38
+	JNeighbourListCpu* NbList;
+
+	//-Vectorised pair kernel selected in ConfigRunMode(). #simd
+	TpSimdMode SimdMode;
+	TpSimdForcesFn SimdForcesFnc;  ///<Pair kernel of SimdMode (NULL with SIMD_None).
+
+	//-Particle arrays reordered after each divide and stored in checkpoints (defined in ConfigSortArrays_M()). #sortarrays
+	typedef struct{
+		const char *name;     ///<Name of the array in checkpoint files.
+		void **ptr;           ///<Address of the pointer to the array (NULL for SoA arrays).
+		tsymatrix3fsoa *soa;  ///<Address of the SoA array (only when ptr is NULL).
+		unsigned size;        ///<Size of one element in bytes.
+	}StSortRegister;
+	std::vector<StSortRegister> SortRegister;
+
 	//-Execution Variables for particles (size=ParticlesSize). | Variables con datos de las particulas para ejecucion (size=ParticlesSize).
 	unsigned *Idpc;    ///<Identifier of particle | Identificador de particula.
 	typecode *Codec;   ///<Indicator of group of particles & other special markers. | Indica el grupo de las particulas y otras marcas especiales.
@@ -87,8 +110,8 @@ protected:
 
 	// Additional variables for #Symplectic_M
 	float *MassPrec_M;
-	tsymatrix3f *TauPrec_M;
-	tsymatrix3f *QuadFormPrec_M;
+	tsymatrix3fsoa TauPrec_M;
+	tsymatrix3fsoa QuadFormPrec_M;
 
 
 	//-Variables for floating bodies.
@@ -119,34 +142,54 @@ protected:
 	float *Massc_M; // Mass, Delta mass
 
 	// Augustin
-	float* VonMises;
-	float* GradVelSave;
 	unsigned* CellOffSpring;
-	tfloat3* StrainDotSave;
-	tfloat3* AceSave, *ForceVisc;
+
+	//-Diagnostic fields only reserved in the steps that end with an output (see DgReserve_M()).
+	//-VonMises and GradVelSave are computed from Tau and StrainDotSave in GetParticlesData.
+	tfloat3* StrainDotSave; ///<Diagonal of StrainDot.
+	tfloat3* AceSave;       ///<Acceleration of the Fluid-Fluid interaction.
+	tfloat3* ForceVisc;     ///<Damping acceleration of the corrector.
 
 	// Matthias - Root geometry data
 	float maxPosX;
+
+	//-Tip of the root: maximum position of particles [Npb,Np) computed as a
+	// by-product of the symplectic position updates (see MaxPosition()).
+	tfloat3 TipPos_M;      ///<Maximum of each component of position (0 when all are negative).
+	tuint3 TipIdp_M;       ///<Idp of the particle with the maximum of each component (UINT_MAX when none).
+	bool TipValid_M;       ///<TipPos_M and TipIdp_M correspond to the current positions.
 	
 						 //-Variables for Laminar+SPS viscosity.  
 	tsymatrix3f *SpsTauc;       ///<SPS sub-particle stress tensor.
 	tsymatrix3f *SpsGradvelc;   ///<Velocity gradients.
 
 								// Matthias - Solid
-	tsymatrix3f *Tauc_M;
-	tsymatrix3f *TauM1c_M;
-	tsymatrix3f *StrainDotc_M;
-	tsymatrix3f *TauDotc_M;
-	tsymatrix3f *Spinc_M;
+	tsymatrix3fsoa Tauc_M;
+	tsymatrix3fsoa TauM1c_M;
+	tsymatrix3fsoa StrainDotc_M;
+	tsymatrix3fsoa TauDotc_M;
+	tsymatrix3fsoa Spinc_M;
 
-	tsymatrix3f *QuadFormc_M;
-	tsymatrix3f *QuadFormM1c_M;
+	tsymatrix3fsoa QuadFormc_M;
+	tsymatrix3fsoa QuadFormM1c_M;
 
 	// NSPH
 	tmatrix3f   *L_M;
 	float* Co_M;
 
+	// Symmetric Fluid-Fluid terms before applying L (only with NlSymmetric). #symmetric
+	tmatrix3f   *SymAce_M;
+	tmatrix3f   *SymGrad_M;
+	tfloat3     *SymAr_M;
+
 	TimersCpu Timers;
+	//-Timers of the solid model registered by name (see ConfigTimers_M()). #timers
+	JTimerRegistry *TimersReg;
+	unsigned TmsCorrection, TmsDeformation;    ///<Parts of CF-Forces.
+	unsigned TmsCorrector, TmsTau, TmsGrowth;  ///<Parts of SU-ComputeStep.
+	unsigned TmsDivMark, TmsDivCreate;         ///<Parts of SU-Division.
+	unsigned TmsSaveData, TmsSaveWait;         ///<Parts of SU-SavePart.
+	JTraceEvents *Trace;                       ///<Timeline of the execution with -trace (NULL: not used). #trace
 
 
 	void InitVars();
@@ -156,6 +199,14 @@ protected:
 	void FreeCpuMemoryParticles();
 	void AllocCpuMemoryParticles(unsigned np, float over);
 
+	void RegisterSortArray_M(const char *name, void **ptr, unsigned size);
+	template<class T> void RegisterSortArray_M(const char *name, T **ptr) { RegisterSortArray_M(name, (void**)ptr, unsigned(sizeof(T))); }
+	void RegisterSortArray_M(const char *name, tsymatrix3fsoa *soa);
+	void ConfigSortArrays_M();
+	void SortParticleArrays_M(JCellDivCpu *celldiv);
+	void SaveCheckpointData_M(JBinaryData *bdat)const;
+	void LoadCheckpointData_M(JBinaryData *bdat);
+
 	void ResizeCpuMemoryParticles(unsigned np);
 	void ReserveBasicArraysCpu();
 
@@ -170,6 +221,7 @@ protected:
 	double*      SaveArrayCpu(unsigned np, const double      *datasrc)const { return(TSaveArrayCpu<double>(np, datasrc)); }
 	tdouble3*    SaveArrayCpu(unsigned np, const tdouble3    *datasrc)const { return(TSaveArrayCpu<tdouble3>(np, datasrc)); }
 	tsymatrix3f* SaveArrayCpu(unsigned np, const tsymatrix3f *datasrc)const { return(TSaveArrayCpu<tsymatrix3f>(np, datasrc)); }
+	tsymatrix3f* SaveArrayCpu(unsigned np, const tsymatrix3fsoa &datasrc)const;
 	// Matthias
 	tmatrix3f*   SaveArrayCpu(unsigned np, const tmatrix3f *datasrc)const { return(TSaveArrayCpu<tmatrix3f>(np, datasrc)); }
 	tfloat3*   SaveArrayCpu(unsigned np, const tfloat3 *datasrc)const { return(TSaveArrayCpu<tfloat3>(np, datasrc)); }
@@ -184,6 +236,7 @@ protected:
 	void RestoreArrayCpu(unsigned np, double      *data, double      *datanew)const { TRestoreArrayCpu<double>(np, data, datanew); }
 	void RestoreArrayCpu(unsigned np, tdouble3    *data, tdouble3    *datanew)const { TRestoreArrayCpu<tdouble3>(np, data, datanew); }
 	void RestoreArrayCpu(unsigned np, tsymatrix3f *data, tsymatrix3f *datanew)const { TRestoreArrayCpu<tsymatrix3f>(np, data, datanew); }
+	void RestoreArrayCpu(unsigned np, tsymatrix3f *data, tsymatrix3fsoa &datanew)const;
 	void RestoreArrayCpu(unsigned np, tmatrix3f *data, tmatrix3f *datanew)const { TRestoreArrayCpu<tmatrix3f>(np, data, datanew); }
 	// Matthias
 	void RestoreArrayCpu(unsigned np, bool *data, bool*datanew)const { TRestoreArrayCpu<bool>(np, data, datanew); }
@@ -217,6 +270,9 @@ protected:
 	float CalcVelMaxOmp(unsigned np, const tfloat4* velrhop)const;
 
 	void PreInteractionVars_Forces(TpInter tinter, unsigned np, unsigned npb);
+	template<unsigned gexp> void PreInteractionVars_ForcesT(unsigned np, unsigned npb);
+	void ComputePress_M(unsigned n, const tdouble3* pos, const tfloat4* velrhop, float tipx, float* press)const;
+	template<unsigned gexp> void ComputePressT_M(unsigned n, const tdouble3* pos, const tfloat4* velrhop, float tipx, float* press)const;
 	void PreInteraction_Forces(TpInter tinter);
 	void PosInteraction_Forces();
 
@@ -240,13 +296,13 @@ protected:
 	(unsigned n, unsigned pini, tint4 nc, int hdiv, unsigned cellinitial
 		, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
 		, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhopp, const typecode* code, const unsigned* id
-		, float& viscdt, float* ar, tsymatrix3f* gradvel, tsymatrix3f* omega, tmatrix3f* L)const;
+		, float& viscdt, float* ar, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega, tmatrix3f* L)const;
 
 	template<bool psingle, TpKernel tker, TpFtMode ftmode> void InteractionForcesBound31_M
 	(unsigned n, unsigned pini, tint4 nc, int hdiv, unsigned cellinitial
 		, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
 		, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhopp, const typecode* code, const unsigned* id
-		, float& viscdt, float* ar, const float* mass, tsymatrix3f* gradvel, tsymatrix3f* omega, tmatrix3f* L)const;
+		, float& viscdt, float* ar, const float* mass, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega, tmatrix3f* L)const;
 
 	template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph tdelta, bool shift> void InteractionForcesFluid
 	(unsigned n, unsigned pini, tint4 nc, int hdiv, unsigned cellfluid, float visco
@@ -284,7 +340,7 @@ protected:
 	template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph tdelta, bool shift> void InteractionForces_V11b_M
 	(unsigned n, unsigned pinit, tint4 nc, int hdiv, unsigned cellinitial, float visco
 		, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
-		, const tsymatrix3f* tau, tsymatrix3f* gradvel, tsymatrix3f* omega
+		, const tsymatrix3fsoa tau, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega
 		, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
 		, const float* press, const float* pore, const float* mass
 		, tmatrix3f* L
@@ -294,7 +350,7 @@ protected:
 	template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph tdelta, bool shift> void InteractionForces_V31_M
 	(unsigned n, unsigned pinit, tint4 nc, int hdiv, unsigned cellinitial, float visco
 		, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
-		, const tsymatrix3f* tau, tsymatrix3f* gradvel, tsymatrix3f* omega
+		, const tsymatrix3fsoa tau, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega
 		, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
 		, const float* press, const float* pore, const float* mass
 		, tmatrix3f* L
@@ -304,13 +360,67 @@ protected:
 	template<bool psingle, TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph tdelta, bool shift> void InteractionForces_V32_M
 	(unsigned n, unsigned pinit, tint4 nc, int hdiv, unsigned cellinitial, float visco
 		, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
-		, const tsymatrix3f* tau, tsymatrix3f* gradvel, tsymatrix3f* omega
+		, const tsymatrix3fsoa tau, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega
 		, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
 		, const float* press, const float* pore, const float* mass
 		, tmatrix3f* L
 		, float& viscdt, float* ar, tfloat3* ace, tfloat3* acesave, float* delta
 		, TpShifting tshifting, tfloat3* shiftpos, float* shiftdetect)const;
 
+	// #V38 Interaction on the neighbour list - Matthias
+	void BuildNeighbourList_M(unsigned np, tuint3 ncells, const unsigned* begincell, tuint3 cellmin, const unsigned* dcell
+		, const tdouble3* pos, const tfloat3* pspos);
+
+	template<bool psingle, TpKernel tker> void BuildNeighbourListT_M
+	(unsigned np, tint4 nc, int hdiv, unsigned cellfluid
+		, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
+		, const tdouble3* pos, const tfloat3* pspos);
+
+	template<bool psingle> void BuildNeighbourCandT_M
+	(unsigned np, tint4 nc, int hdiv, unsigned cellfluid
+		, const unsigned* beginendcell, tint3 cellzero, const unsigned* dcell
+		, const tdouble3* pos, const tfloat3* pspos);
+
+	template<bool psingle, TpKernel tker> void RefreshNeighbourListT_M
+	(unsigned np, const tdouble3* pos, const tfloat3* pspos);
+
+	bool CheckNeighbourSkin_M(unsigned np, const tdouble3* pos, const typecode* code)const;
+
+	void ComputeDFPM38(unsigned n, unsigned pinit, const tfloat4* velrhop, const float* mass, tmatrix3f* L, float* co) const;
+
+	template<TpKernel tker, TpFtMode ftmode, bool lamsps, TpDeltaSph tdelta, bool shift> void InteractionForces_V38_M
+	(unsigned n, unsigned pinit, bool boundp2, float visco
+		, const tsymatrix3fsoa tau, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega
+		, const tfloat4* velrhop, const typecode* code, const unsigned* idp
+		, const float* press, const float* pore, const float* mass
+		, tmatrix3f* L
+		, float& viscdt, float* ar, tfloat3* ace, float* delta
+		, TpShifting tshifting, tfloat3* shiftpos, float* shiftdetect)const;
+
+	template<TpFtMode ftmode> void InteractionForcesBound38_M
+	(unsigned n, unsigned pinit, const tfloat4* velrhop, const typecode* code, const unsigned* idp
+		, float& viscdt, float* ar, const float* mass, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega, tmatrix3f* L)const;
+
+	bool PrepareHalfBlocks38_M(unsigned n, unsigned pinit)const;
+
+	template<TpKernel tker, bool lamsps, TpDeltaSph tdelta, bool shift> void InteractionForcesSym38_M
+	(unsigned n, unsigned pinit, float visco
+		, const tsymatrix3fsoa tau, const tfloat4* velrhop
+		, const float* press, const float* pore, const float* mass
+		, float& viscdt, float* ar, tfloat3* ace, float* delta
+		, tfloat3* shiftpos, float* shiftdetect)const;
+
+	template<bool lamsps, TpDeltaSph tdelta, bool shift> void InteractionForcesSimd38_M
+	(unsigned n, unsigned pinit, float visco
+		, const tsymatrix3fsoa tau, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega
+		, const tfloat4* velrhop, const float* press, const float* pore, const float* mass
+		, const tmatrix3f* L
+		, float& viscdt, float* ar, tfloat3* ace, float* delta
+		, tfloat3* shiftpos, float* shiftdetect)const;
+
+	void ApplySymmetricL38_M(unsigned n, unsigned pinit, const tmatrix3f* L
+		, float* ar, tfloat3* ace, tsymatrix3fsoa gradvel, tsymatrix3fsoa omega)const;
+
 	template<bool psingle> void InteractionForcesDEM
 	(unsigned nfloat, tint4 nc, int hdiv, unsigned cellfluid
 		, const unsigned *beginendcell, tint3 cellzero, const unsigned *dcell
@@ -334,7 +444,7 @@ protected:
 		, const tdouble3 *pos, const tfloat3 *pspos, const tfloat4 *velrhop, const typecode *code, const unsigned *idp
 		, const float *press, const float *pore, const float *mass
 		, float &viscdt, float* ar, tfloat3 *ace, float *delta
-		, tsymatrix3f *jautau, tsymatrix3f *jaugradvel, tsymatrix3f *jautaudot, tsymatrix3f *jauomega
+		, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 		, tmatrix3f *L
 		, TpShifting tshifting, tfloat3 *shiftpos, float *shiftdetect)const;
 
@@ -345,7 +455,7 @@ protected:
 		, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
 		, const float* press, const float* pore, const float* mass
 		, float& viscdt, float* ar, tfloat3* ace, float* delta
-		, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+		, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 		, tmatrix3f* L, float* co
 		, TpShifting tshifting, tfloat3* shiftpos, float* shiftdetect)const;
 
@@ -356,7 +466,7 @@ protected:
 		, const tdouble3* pos, const tfloat3* pspos, const tfloat4* velrhop, const typecode* code, const unsigned* idp
 		, const float* press, const float* pore, const float* mass
 		, float& viscdt, float* ar, tfloat3* ace, tfloat3* acesave, float* delta
-		, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+		, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 		, tmatrix3f* L, float* co
 		, TpShifting tshifting, tfloat3* shiftpos, float* shiftdetect)const;
 
@@ -383,7 +493,7 @@ protected:
 		, const float *press, const float *pore, const float *mass
 		, tmatrix3f *L
 		, float &viscdt, float* ar, tfloat3 *ace, float *delta
-		, tsymatrix3f *jautau, tsymatrix3f *jaugradvel, tsymatrix3f *jautaudot, tsymatrix3f *jauomega
+		, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 		, tfloat3 *shiftpos, float *shiftdetect)const;
 
 	void Interaction_Forces_M(unsigned np, unsigned npb, unsigned npbok
@@ -392,7 +502,7 @@ protected:
 		, const float *press, const float *pore, const float *mass
 		, tmatrix3f *L
 		, float &viscdt, float* ar, tfloat3 *ace, float *delta
-		, tsymatrix3f *jautau, tsymatrix3f *jaugradvel, tsymatrix3f *jautaudot, tsymatrix3f *jauomega
+		, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 		, tfloat3 *shiftpos, float *shiftdetect)const;
 	
 
@@ -403,7 +513,7 @@ protected:
 			, const float* press, const float* pore, const float* mass
 			, tmatrix3f* L, float* Co_M
 			, float& viscdt, float* ar, tfloat3* ace, float* delta
-			, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+			, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 			, tfloat3* shiftpos, float* shiftdetect)const;
 
 	void Interaction_Forces_M(unsigned np, unsigned npb, unsigned npbok
@@ -412,7 +522,7 @@ protected:
 		, const float* press, const float* pore, const float* mass
 		, tmatrix3f* L, float* Co_M
 		, float& viscdt, float* ar, tfloat3* ace, float* delta
-		, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+		, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 		, tfloat3* shiftpos, float* shiftdetect)const;
 
 	void Interaction_ForcesSimpSmall_M(unsigned np, unsigned npb, unsigned npbok
@@ -421,7 +531,7 @@ protected:
 		, const float* press, const float* pore, const float* mass
 		, tmatrix3f* L, float* Co_M
 		, float& viscdt, float* ar, tfloat3* ace, tfloat3* acesave, float* delta
-		, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+		, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 		, tfloat3* shiftpos, float* shiftdetect)const;
 
 	void Interaction_ForcesSmall_M(unsigned np, unsigned npb, unsigned npbok
@@ -430,31 +540,31 @@ protected:
 		, const float* press, const float* pore, const float* mass
 		, tmatrix3f* L, float* Co_M
 		, float& viscdt, float* ar, tfloat3* ace, tfloat3* acesave, float* delta
-		, tsymatrix3f* jautau, tsymatrix3f* jaugradvel, tsymatrix3f* jautaudot, tsymatrix3f* jauomega
+		, tsymatrix3fsoa jautau, tsymatrix3fsoa jaugradvel, tsymatrix3fsoa jautaudot, tsymatrix3fsoa jauomega
 		, tfloat3* shiftpos, float* shiftdetect)const;
 
 
 	void ComputeSpsTau(unsigned n, unsigned pini, const tfloat4 *velrhop, const tsymatrix3f *gradvel, tsymatrix3f *tau)const;
-	void ComputeJauTauDot_M(unsigned n, unsigned pini, const tsymatrix3f *gradvel, tsymatrix3f *tau, tsymatrix3f *taudot, tsymatrix3f *omega)const;
-	void computeDeformationSolid01(unsigned n, unsigned pini, tsymatrix3f* taudot) const;
-	void ComputeTauDot_Gradual_M(unsigned n, unsigned pini, tsymatrix3f *taudot)const;
+	void ComputeJauTauDot_M(unsigned n, unsigned pini, const tsymatrix3fsoa gradvel, tsymatrix3fsoa tau, tsymatrix3fsoa taudot, tsymatrix3fsoa omega)const;
+	void computeDeformationSolid01(unsigned n, unsigned pini, tsymatrix3fsoa taudot) const;
+	void ComputeTauDot_Gradual_M(unsigned n, unsigned pini, tsymatrix3fsoa taudot)const;
 	
 	template<bool shift> void ComputeVerletVarsFluid(const tfloat4 *velrhop1, const tfloat4 *velrhop2, double dt, double dt2, tdouble3 *pos, unsigned *cell, typecode *code, tfloat4 *velrhopnew)const;
 	// Matthias
-	template<bool shift> void ComputeVerletVarsSolid_M(const tfloat4 *velrhop1, const tfloat4 *velrhop2, const tsymatrix3f *tau1, const tsymatrix3f *tau2, double dt, double dt2
-		, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3f *taunew)const;
+	template<bool shift> void ComputeVerletVarsSolid_M(const tfloat4 *velrhop1, const tfloat4 *velrhop2, const tsymatrix3fsoa tau1, const tsymatrix3fsoa tau2, double dt, double dt2
+		, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3fsoa taunew)const;
 	template<bool shift> void ComputeVerletVarsSolMass_M(const tfloat4 *velrhop1, const tfloat4 *velrhop2
-		, const tsymatrix3f *tau1, const tsymatrix3f *tau2, const float *mass1, const float *mass2
-		, double dt, double dt2, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3f *taunew, float *massnew)const;
+		, const tsymatrix3fsoa tau1, const tsymatrix3fsoa tau2, const float *mass1, const float *mass2
+		, double dt, double dt2, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3fsoa taunew, float *massnew)const;
 	template<bool shift> void ComputeVerletVarsQuad_M(const tfloat4 *velrhop1, const tfloat4 *velrhop2
-		, const tsymatrix3f *tau1, const tsymatrix3f *tau2, const tsymatrix3f *qf1, const tsymatrix3f *qf2, const float *mass1, const float *mass2
-		, double dt, double dt2, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3f *taunew, tsymatrix3f *qfnew, float *massnew)const;
+		, const tsymatrix3fsoa tau1, const tsymatrix3fsoa tau2, const tsymatrix3fsoa qf1, const tsymatrix3fsoa qf2, const float *mass1, const float *mass2
+		, double dt, double dt2, tdouble3 *pos, unsigned *dcell, typecode *code, tfloat4 *velrhopnew, tsymatrix3fsoa taunew, tsymatrix3fsoa qfnew, float *massnew)const;
 
 	void ComputeVelrhopBound(const tfloat4* velrhopold, double armul, tfloat4* velrhopnew)const;
 
 	// Matthias
 	template<bool shift> void ComputeEulerVarsFluid_M(tfloat4 *velrhop, double dt, tdouble3 *pos, unsigned *dcell, word *code)const;
-	template<bool shift> void ComputeEulerVarsSolid_M(tfloat4 *velrhop, double dt, tdouble3 *pos, tsymatrix3f *tau, unsigned *dcell, word *code)const;
+	template<bool shift> void ComputeEulerVarsSolid_M(tfloat4 *velrhop, double dt, tdouble3 *pos, tsymatrix3fsoa tau, unsigned *dcell, word *code)const;
 	
 	void ComputeVerlet(double dt);
 	template<bool shift> void ComputeSymplecticPreT(double dt);
@@ -466,35 +576,57 @@ protected:
 	void ComputeEuler_M(double dt);
 
 	template<bool shift> void ComputeSymplecticPreT_M(double dt);
-	template<bool shift> void ComputeSymplecticPreT35_M(double dt);
+	template<bool shift, TpDamping tdamp> void ComputeSymplecticPreT35_M(double dt);
 
-	template<bool shift> void ComputeOneStepTwoStagesPreT_M(double dt);
+	void ComputeTauStreams_M(unsigned np, double dt)const;
+	template<bool shift, TpGrowth tgrow> void ComputeOneStepTwoStagesPreT_M(double dt);
 
 
 	void ComputeSymplecticPre_M(double dt);
 	template<bool shift> void ComputeSymplecticCorrT_M(double dt);
-	template<bool shift> void ComputeSymplecticCorrT35_M(double dt);
-	template<bool shift> void ComputeOneStepTwoStagesCorrT37_M(double dt);
-	void ComputeOneStepTwoStagesCorrT37_M(double dt);
+	template<bool shift, TpDamping tdamp> void ComputeSymplecticCorrT35_M(double dt);
+	template<bool shift, TpGrowth tgrow> void ComputeOneStepTwoStagesCorrT37_M(double dt);
 	void ComputeSymplecticCorr_M(double dt);
 
+	//-Growth and damping laws (see JSphSolidModels_M.h).
+	TpGrowth GetTypeGrowth_M()const { return(typeGrowth >= 0 && typeGrowth < int(GROWTH_None) ? TpGrowth(typeGrowth) : GROWTH_None); }
+	TpDamping GetTypeDamping_M()const { return(typeDamping >= 0 && typeDamping < int(DAMPING_None) ? TpDamping(typeDamping) : DAMPING_None); }
+	StGrowthCtes GetGrowthCtes_M()const;
 	void GrowthCell_M(double dt);
-	float GrowthInterface_M(float density, float pos) const;
-	tfloat3 ViscousDamping36(tfloat3 vel, float co, float rho, float l);
+	template<TpGrowth tgrow> void GrowthCellT_M(double dt);
 	float GrowthNormGauss(float pos);
-	float GrowthNormComposite(float pos) const;
-	float CroserGrowth(float pos)const;
-	float AntiSigmoid(float x, float p, float s) const;
-	float dGaussian(float x, float p, float s)const;
-	float GrowthNormTrigle(float pos) const;
-	float KillSwitchSigmoid(float pos) const;
 	float GrowthRateSpace(float pos);
-	float GrowthRateSpaceNormalised(float pos) const;
 	float GrowthRateGaussian(float pos);
-	double GrowthRateSpaceNormalised(double pos);
 	double GrowthRate2(double pos, double tip);
 	float MaxValueParticles(float* field); 
 	tfloat3 MaxPosition();
+	unsigned MaxPositionIdp();
+
+	//-Tip tracking.
+	void InvalidateTip_M() { TipValid_M = false; }
+	void TipThreadsInit_M(float* tipth, unsigned* tipp)const;
+	//-Accumulates position ps of particle p in the maximum of one thread.
+	inline void TipThreadsAdd_M(const tdouble3 &ps, unsigned p, float* tip, unsigned* tipp)const {
+		const float px = float(ps.x), py = float(ps.y), pz = float(ps.z);
+		if (px > tip[0]) { tip[0] = px; tipp[0] = p; }
+		if (py > tip[1]) { tip[1] = py; tipp[1] = p; }
+		if (pz > tip[2]) { tip[2] = pz; tipp[2] = p; }
+	}
+	void TipThreadsReduce_M(const float* tipth, const unsigned* tipp);
+	void UpdateTip_M();
+	void UpdateTipDivision_M(unsigned ndiv, const unsigned* mark, unsigned np);
+
+	//-Diagnostic fields.
+	bool DgReserve_M(double dt);
+	void DgCapture_M(bool acetotal);
+	void DgFree_M();
+	void DgVonMises_M(unsigned n, unsigned pini, float* vonmises)const;
+	//-Von Mises stress of the deviatoric stress tau (plane formula in 2D).
+	inline float VonMises_M(const tsymatrix3f& tau)const {
+		if (Simulate2D)return(sqrt(tau.xx * tau.xx + tau.zz * tau.zz - tau.xx * tau.zz + 3.0f * tau.xz * tau.xz));
+		return(sqrt(((tau.xx - tau.yy) * (tau.xx - tau.yy) + (tau.yy - tau.zz) * (tau.yy - tau.zz) + (tau.xx - tau.zz) * (tau.xx - tau.zz)
+			+ 6.0f * (tau.xy * tau.xy + tau.xz * tau.xz + tau.yz * tau.yz)) / 2.0f));
+	}
 	// End Matthias
 
 	void RunShifting(double dt);
@@ -504,6 +636,12 @@ protected:
 	void MoveMatBound(unsigned np, unsigned ini, tmatrix4d m, double dt, const unsigned *ridpmv, tdouble3 *pos, unsigned *dcell, tfloat4 *velrhop, typecode *code)const;
 	void RunMotion(double stepdt);
 	
+	void ConfigTimers_M(bool active);
+	void ConfigTrace_M();
+	void SaveTrace_M();
+	void TraceBegin_M(const char *name)const { if (Trace)Trace->Begin(name); }
+	void TraceEnd_M(const char *name)const { if (Trace)Trace->End(name); }
+	void TraceCounter_M(const char *name, double value)const { if (Trace)Trace->Counter(name, value); }
 	void ShowTimers(bool onlyfile = false); 
 	void GetTimersInfo(std::string &hinfo, std::string &dinfo)const; 
 	unsigned TimerGetCount()const { return(TmcGetCount()); }
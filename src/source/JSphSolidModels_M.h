@@ -0,0 +1,165 @@
+//HEAD_DSPH
+/*
+<DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+This file is part of DualSPHysics.
+
+DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphSolidModels_M.h \brief Growth and damping laws of the solid as policy types.
+/// The integrators of JSphSolidCpu are instantiated for each law (TpGrowth,
+/// TpDamping) so the law is selected once per step and inlined in the loops.
+/// The parameters are copied in the policy when it is created.
+
+#ifndef _JSphSolidModels_M_
+#define _JSphSolidModels_M_
+
+#include "Types.h"
+#include <cmath>
+
+///Parameters of the growth laws (see JSphSolidCpu::GetGrowthCtes_M()).
+typedef struct{
+  float lambda;           ///<Growth rate (LambdaMass).
+  float rhopzero;         ///<Reference density.
+  float tipx;             ///<Position of the tip (maxPosX).
+  float posgr,spgr,ctgr;  ///<Position, spread and baseline of the composite distribution.
+  float po2gr,s2gr,c2gr;  ///<Position, spread and scale of the dGaussian (Croser 1999).
+  float klgr;             ///<Position of the kill switch.
+}StGrowthCtes;
+
+//##############################################################################
+//# JGrowthModel_M
+//##############################################################################
+/// \brief Growth law tgrow. Rate() is the source of density of the two-stage
+/// step and Cell() updates density and mass at the end of the corrector.
+template<TpGrowth tgrow> class JGrowthModel_M
+{
+protected:
+  //-Constants of the sigmoid, gaussian and drop of GROWTH_SigGauss/SigGauDrop.
+  static const float SgL,SgK,SgXs,SgB,SgKd,SgXd;
+  const StGrowthCtes G;
+  const float OvSpgr2;    ///<1/(2*spgr^2).
+  const float OvS2gr2;    ///<1/(2*s2gr^2).
+
+  float Dist(float pos)const{ return(fabs(pos-G.tipx)); }
+  float KillSwitch(float pos)const{ return(1.0f-1.0f/(1.0f+exp(-40.0f*(Dist(pos)-G.klgr)))); }
+  float NormComposite(float pos)const{
+    const float d=Dist(pos);
+    return(float(G.ctgr*(1.0f-1.0f/(1.0f+exp(-20.0*(d-G.posgr))))+exp(-(d-G.posgr)*(d-G.posgr)*OvSpgr2))/(G.ctgr+1.0f));
+  }
+  float Croser(float pos)const{
+    const float d=Dist(pos);
+    const float antisig=1.0f-1.0f/(1.0f+exp(-G.spgr*(d-G.posgr)));
+    const float dgauss=(d-G.po2gr)/G.s2gr*exp(0.5f-(d-G.po2gr)*(d-G.po2gr)*OvS2gr2);
+    return(G.ctgr*antisig+fabs(G.c2gr-G.ctgr)*dgauss);
+  }
+  float NormTriangle(float pos)const{
+    const float d=Dist(pos);
+    return(d<0.3f? d/0.3f: (d<0.6f? fabs(2.0f-d/0.3f): 0.0f));
+  }
+  //-Sigmoid plus gaussian at distance x to the tip (xg is the centre of the gaussian).
+  float SigGauss(float x,float xg)const{
+    const float xb=(x-xg)/SgB;
+    return(SgL-SgL/(1.0f+exp(-SgK*(x-SgXs)))+exp(-0.5f*xb*xb));
+  }
+  float SigGauDrop(float x)const{
+    return(x<0.5f? G.lambda/1.065f*SigGauss(x,0.5f): G.lambda*(1.0f-1.0f/(1.0f+exp(-SgKd*(x-SgXd)))));
+  }
+
+public:
+  JGrowthModel_M(const StGrowthCtes &g):G(g)
+    ,OvSpgr2(1.0f/(2.0f*g.spgr*g.spgr)),OvS2gr2(1.0f/(2.0f*g.s2gr*g.s2gr)){}
+
+  //==============================================================================
+  /// Returns the source of density for density rhop at position pos.
+  //==============================================================================
+  inline float Rate(float rhop,float pos)const{
+    const float turgor=G.rhopzero/rhop-1;
+    if(tgrow==GROWTH_Turgor)          return(G.lambda*turgor);
+    if(tgrow==GROWTH_KillConst)       return(KillSwitch(pos)*G.lambda);
+    if(tgrow==GROWTH_SigGauss)        return(G.lambda*SigGauss(G.tipx-pos,0.6f));
+    if(tgrow==GROWTH_SigGauDrop)      return(SigGauDrop(G.tipx-pos));
+    if(tgrow==GROWTH_TurgorSpace){
+      const float d=20.0f*Dist(pos); //-Rescale to Bassel_2014 meristem data.
+      return(G.lambda*(exp(1.0f)*d*exp(-d))*turgor);
+    }
+    if(tgrow==GROWTH_TurgorSigGauDrop)return(SigGauDrop(G.tipx-pos)*turgor);
+    if(tgrow==GROWTH_TurgorConst)     return(G.lambda*(G.rhopzero/rhop));
+    if(tgrow==GROWTH_TurgorTriangle)  return(NormTriangle(pos)*G.lambda*turgor);
+    if(tgrow==GROWTH_TurgorComposite) return(NormComposite(pos)*G.lambda*turgor);
+    if(tgrow==GROWTH_KillComposite)   return(KillSwitch(pos)*NormComposite(pos)*G.lambda*turgor);
+    if(tgrow==GROWTH_Croser)          return(Croser(pos)*G.lambda*turgor);
+    return(0);
+  }
+
+  //==============================================================================
+  /// Applies the growth of the step dt to density rhop and mass of the particle
+  /// at position pos (massprec is the mass at the beginning of the step).
+  //==============================================================================
+  inline void Cell(double dt,float massprec,float pos,float &rhop,float &mass)const{
+    if(tgrow==GROWTH_None)return;
+    const double volu=double(massprec)/double(rhop);
+    if(tgrow==GROWTH_Turgor){
+      const double adens=G.lambda*(G.rhopzero/rhop-1);
+      mass=float(double(massprec)+dt*adens*volu);
+      rhop=float(rhop+dt*adens);
+      return;
+    }
+    double gamma;
+    if(tgrow==GROWTH_TurgorSpace){
+      const double d=1.0/5.0*fabs(double(pos)-double(G.tipx)); //-Rescale to smooth lambda growth.
+      gamma=G.lambda*(d*exp(1.0-d))*(G.rhopzero/rhop-1);
+    }
+    else if(tgrow==GROWTH_TurgorConst)gamma=G.lambda*(G.rhopzero/rhop-1);
+    else gamma=Rate(rhop,pos);
+    rhop=rhop+float(dt*gamma);
+    mass=rhop*float(volu);
+  }
+};
+
+template<TpGrowth tgrow> const float JGrowthModel_M<tgrow>::SgL=0.125f;
+template<TpGrowth tgrow> const float JGrowthModel_M<tgrow>::SgK=15.0f;
+template<TpGrowth tgrow> const float JGrowthModel_M<tgrow>::SgXs=0.5f;
+template<TpGrowth tgrow> const float JGrowthModel_M<tgrow>::SgB=0.15f;
+template<TpGrowth tgrow> const float JGrowthModel_M<tgrow>::SgKd=50.0f;
+template<TpGrowth tgrow> const float JGrowthModel_M<tgrow>::SgXd=0.65f;
+
+//##############################################################################
+//# JDampingModel_M
+//##############################################################################
+/// \brief Damping law tdamp. Returns the damping acceleration of a particle.
+template<TpDamping tdamp> class JDampingModel_M
+{
+protected:
+  const float Coef;       ///<Damping coefficient (dampCoef).
+
+public:
+  JDampingModel_M(float coef):Coef(coef){}
+
+  //==============================================================================
+  /// Returns the damping of velocity vel for the surface weight co, density rhop
+  /// and qfxx the xx component of the quadratic form (length is 2/sqrt(qfxx)).
+  //==============================================================================
+  inline tfloat3 operator()(const tfloat3 &vel,float co,float rhop,float qfxx)const{
+    if(tdamp==DAMPING_Uniform)      return(vel*Coef);
+    if(tdamp==DAMPING_Surface)      return(vel*Coef*co);
+    if(tdamp==DAMPING_Plateau)      return(vel*Coef/(sqrt(vel.x*vel.x+vel.y*vel.y+vel.z*vel.z)+1.0f));
+    if(tdamp==DAMPING_Density)      return(vel*Coef/rhop);
+    if(tdamp==DAMPING_DensityLength)return(vel*vel*Coef/(rhop*(2.0f/sqrt(qfxx))));
+    return(TFloat3(0));
+  }
+};
+
+#endif
+
+
@@ -0,0 +1,67 @@
+//HEAD_DSPH
+/*
+<DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+This file is part of DualSPHysics.
+
+DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphSolidSimdAvx2_M.cpp \brief Implements the AVX2 version of the pair kernel (compiled with -mavx2 -mfma).
+
+#include "JSphSolidSimdKernel_M.h"
+#include <immintrin.h>
+
+namespace{
+
+///Operations on 8 lanes of AVX2.
+struct SimdAvx2{
+  typedef __m256 V;
+  typedef __m256i VI;
+  typedef __m256 M;
+  enum{ W=8 };
+  static inline V Zero(){ return(_mm256_setzero_ps()); }
+  static inline V Set1(float v){ return(_mm256_set1_ps(v)); }
+  static inline VI Iota(){ return(_mm256_setr_epi32(0,1,2,3,4,5,6,7)); }
+  static inline VI IMul(VI a,int b){ return(_mm256_mullo_epi32(a,_mm256_set1_epi32(b))); }
+  static inline VI IAdd(VI a,int b){ return(_mm256_add_epi32(a,_mm256_set1_epi32(b))); }
+  static inline M Lanes(unsigned k){ return(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(int(k)),Iota()))); }
+  static inline V Gather(const float *base,VI idx,M m){ return(_mm256_mask_i32gather_ps(_mm256_setzero_ps(),base,idx,m,4)); }
+  static inline VI GatherI(const int *base,VI idx,M m){ return(_mm256_mask_i32gather_epi32(_mm256_setzero_si256(),base,idx,_mm256_castps_si256(m),4)); }
+  static inline V Add(V a,V b){ return(_mm256_add_ps(a,b)); }
+  static inline V Sub(V a,V b){ return(_mm256_sub_ps(a,b)); }
+  static inline V Mul(V a,V b){ return(_mm256_mul_ps(a,b)); }
+  static inline V Div(V a,V b){ return(_mm256_div_ps(a,b)); }
+  static inline V Max(V a,V b){ return(_mm256_max_ps(a,b)); }
+  static inline M Lt(V a,V b){ return(_mm256_cmp_ps(a,b,_CMP_LT_OQ)); }
+  static inline V Select(M m,V a,V b){ return(_mm256_blendv_ps(b,a,m)); }
+  static inline float SumLanes(V a){
+    __m128 s=_mm_add_ps(_mm256_castps256_ps128(a),_mm256_extractf128_ps(a,1));
+    s=_mm_add_ps(s,_mm_movehl_ps(s,s));
+    return(_mm_cvtss_f32(_mm_add_ss(s,_mm_shuffle_ps(s,s,1))));
+  }
+  static inline float MaxLanes(V a){
+    __m128 s=_mm_max_ps(_mm256_castps256_ps128(a),_mm256_extractf128_ps(a,1));
+    s=_mm_max_ps(s,_mm_movehl_ps(s,s));
+    return(_mm_cvtss_f32(_mm_max_ss(s,_mm_shuffle_ps(s,s,1))));
+  }
+};
+
+}
+
+//==============================================================================
+/// Pair kernel with AVX2.
+//==============================================================================
+void SimdForcesAvx2(const StSimdForcesCtx &ctx,const StSimdForcesP1 &p1,unsigned cpini,unsigned cpfin,StSimdForcesAcc &acc){
+  SimdForcesT<SimdAvx2>(ctx,p1,cpini,cpfin,acc);
+}
+
@@ -0,0 +1,59 @@
+//HEAD_DSPH
+/*
+<DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+This file is part of DualSPHysics.
+
+DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphSolidSimdAvx512_M.cpp \brief Implements the AVX-512 version of the pair kernel (compiled with -mavx512f).
+
+#include "JSphSolidSimdKernel_M.h"
+#include <immintrin.h>
+
+namespace{
+
+///Operations on 16 lanes of AVX-512F with mask registers.
+struct SimdAvx512{
+  typedef __m512 V;
+  typedef __m512i VI;
+  typedef __mmask16 M;
+  enum{ W=16 };
+  static inline V Zero(){ return(_mm512_setzero_ps()); }
+  static inline V Set1(float v){ return(_mm512_set1_ps(v)); }
+  static inline VI Iota(){ return(_mm512_setr_epi32(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15)); }
+  static inline VI IMul(VI a,int b){ return(_mm512_mullo_epi32(a,_mm512_set1_epi32(b))); }
+  static inline VI IAdd(VI a,int b){ return(_mm512_add_epi32(a,_mm512_set1_epi32(b))); }
+  static inline M Lanes(unsigned k){ return(M(k>=16? 0xFFFFu: (1u<<k)-1u)); }
+  static inline V Gather(const float *base,VI idx,M m){ return(_mm512_mask_i32gather_ps(_mm512_setzero_ps(),m,idx,base,4)); }
+  static inline VI GatherI(const int *base,VI idx,M m){ return(_mm512_mask_i32gather_epi32(_mm512_setzero_si512(),m,idx,base,4)); }
+  static inline V Add(V a,V b){ return(_mm512_add_ps(a,b)); }
+  static inline V Sub(V a,V b){ return(_mm512_sub_ps(a,b)); }
+  static inline V Mul(V a,V b){ return(_mm512_mul_ps(a,b)); }
+  static inline V Div(V a,V b){ return(_mm512_div_ps(a,b)); }
+  static inline V Max(V a,V b){ return(_mm512_max_ps(a,b)); }
+  static inline M Lt(V a,V b){ return(_mm512_cmp_ps_mask(a,b,_CMP_LT_OQ)); }
+  static inline V Select(M m,V a,V b){ return(_mm512_mask_blend_ps(m,b,a)); }
+  static inline float SumLanes(V a){ return(_mm512_reduce_add_ps(a)); }
+  static inline float MaxLanes(V a){ return(_mm512_reduce_max_ps(a)); }
+};
+
+}
+
+//==============================================================================
+/// Pair kernel with AVX-512.
+//==============================================================================
+void SimdForcesAvx512(const StSimdForcesCtx &ctx,const StSimdForcesP1 &p1,unsigned cpini,unsigned cpfin,StSimdForcesAcc &acc){
+  SimdForcesT<SimdAvx512>(ctx,p1,cpini,cpfin,acc);
+}
+
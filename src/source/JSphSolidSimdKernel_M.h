@@ -0,0 +1,156 @@
+//HEAD_DSPH
+/*
+<DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+This file is part of DualSPHysics.
+
+DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphSolidSimdKernel_M.h \brief Pair kernel of InteractionForces_V38_M written on a vector type.
+/// Only included by JSphSolidSimdSse4_M.cpp, JSphSolidSimdAvx2_M.cpp and
+/// JSphSolidSimdAvx512_M.cpp, each one provides the class T with the
+/// operations on its registers (W lanes):
+///  - V, VI, M: float vector, int vector and mask of active lanes.
+///  - Lanes(k): mask with the first k lanes active.
+///  - Gather(base,idx,m), GatherI(base,idx,m): load base[idx] (0 in inactive lanes).
+///  - Iota(), IMul(), IAdd(), Set1(), Zero(), Add(), Sub(), Mul(), Div(), Max().
+///  - Lt(a,b), Select(m,a,b) (a where m), SumLanes(), MaxLanes().
+
+#ifndef _JSphSolidSimdKernel_M_
+#define _JSphSolidSimdKernel_M_
+
+#include "JSphSolidSimd_M.h"
+#include <cstddef>
+
+//==============================================================================
+/// Same terms as the Fluid-Fluid pass of InteractionForces_V38_M (Wendland,
+/// without floating bodies) for W pairs per iteration. The inactive lanes
+/// of the last iteration load zero mass so they add nothing.
+//==============================================================================
+template<class T> void SimdForcesT(const StSimdForcesCtx &ctx,const StSimdForcesP1 &p1
+  ,unsigned cpini,unsigned cpfin,StSimdForcesAcc &acc)
+{
+  typedef typename T::V V;
+  typedef typename T::VI VI;
+  typedef typename T::M M;
+  const V zero=T::Zero(),one=T::Set1(1.f);
+  const V velx1=T::Set1(p1.velx),vely1=T::Set1(p1.vely),velz1=T::Set1(p1.velz),rhop1=T::Set1(p1.rhop);
+  const V press1=T::Set1(p1.pressp);
+  const V tauxx1=T::Set1(p1.tauxx),tauxy1=T::Set1(p1.tauxy),tauxz1=T::Set1(p1.tauxz);
+  const V tauyy1=T::Set1(p1.tauyy),tauyz1=T::Set1(p1.tauyz),tauzz1=T::Set1(p1.tauzz);
+  const V eta2=T::Set1(ctx.eta2);
+  const V avcte=T::Set1(-ctx.visco*ctx.cbar*ctx.h*2.f);  //-(-visco*cbar*h)/robar with robar=(rhopp1+rhopp2)*0.5.
+  const V dlcte=T::Set1(ctx.delta2h*ctx.cbar);
+  const VI lane9=T::IMul(T::Iota(),9);
+
+  V a11=zero,a12=zero,a13=zero,a21=zero,a22=zero,a23=zero,a31=zero,a32=zero,a33=zero;
+  V g11=zero,g12=zero,g13=zero,g21=zero,g22=zero,g23=zero,g31=zero,g32=zero,g33=zero;
+  V arx=zero,ary=zero,arz=zero;
+  V avx=zero,avy=zero,avz=zero;
+  V vmax=zero,dlt=zero;
+  V shx=zero,shy=zero,shz=zero,shd=zero;
+
+  for(unsigned cp=cpini;cp<cpfin;cp+=T::W){
+    const unsigned k=(cpfin-cp<unsigned(T::W)? cpfin-cp: unsigned(T::W));
+    const M m=T::Lanes(k);
+    const float *pr=ctx.pairs+size_t(cp)*9;
+    //-Pair geometry.
+    const VI p2=T::GatherI((const int*)pr,lane9,m);
+    const V drx=T::Gather(pr,T::IAdd(lane9,1),m);
+    const V dry=T::Gather(pr,T::IAdd(lane9,2),m);
+    const V drz=T::Gather(pr,T::IAdd(lane9,3),m);
+    const V rr2=T::Gather(pr,T::IAdd(lane9,4),m);
+    const V frx=T::Gather(pr,T::IAdd(lane9,5),m);
+    const V fry=T::Gather(pr,T::IAdd(lane9,6),m);
+    const V frz=T::Gather(pr,T::IAdd(lane9,7),m);
+    //-Data of particles p2.
+    const VI p24=T::IMul(p2,4);
+    const V velx2=T::Gather(ctx.velrhop,p24,m);
+    const V vely2=T::Gather(ctx.velrhop,T::IAdd(p24,1),m);
+    const V velz2=T::Gather(ctx.velrhop,T::IAdd(p24,2),m);
+    const V rhop2=T::Select(m,T::Gather(ctx.velrhop,T::IAdd(p24,3),m),one);
+    const V press2=T::Add(T::Gather(ctx.press,p2,m),T::Gather(ctx.pore,p2,m));
+    const V mass2=T::Gather(ctx.mass,p2,m);
+
+    //===== Acceleration =====
+    const V mrhop=T::Div(mass2,T::Mul(rhop1,rhop2));
+    const V prs=T::Add(press1,press2);
+    const V mpxx=T::Mul(mrhop,T::Sub(T::Sub(prs,tauxx1),T::Gather(ctx.tauxx,p2,m)));
+    const V mpxy=T::Mul(mrhop,T::Sub(zero,T::Add(tauxy1,T::Gather(ctx.tauxy,p2,m))));
+    const V mpxz=T::Mul(mrhop,T::Sub(zero,T::Add(tauxz1,T::Gather(ctx.tauxz,p2,m))));
+    const V mpyy=T::Mul(mrhop,T::Sub(T::Sub(prs,tauyy1),T::Gather(ctx.tauyy,p2,m)));
+    const V mpyz=T::Mul(mrhop,T::Sub(zero,T::Add(tauyz1,T::Gather(ctx.tauyz,p2,m))));
+    const V mpzz=T::Mul(mrhop,T::Sub(T::Sub(prs,tauzz1),T::Gather(ctx.tauzz,p2,m)));
+    a11=T::Sub(a11,T::Mul(mpxx,frx)); a12=T::Sub(a12,T::Mul(mpxy,fry)); a13=T::Sub(a13,T::Mul(mpxz,frz));
+    a21=T::Sub(a21,T::Mul(mpxy,frx)); a22=T::Sub(a22,T::Mul(mpyy,fry)); a23=T::Sub(a23,T::Mul(mpyz,frz));
+    a31=T::Sub(a31,T::Mul(mpxz,frx)); a32=T::Sub(a32,T::Mul(mpyz,fry)); a33=T::Sub(a33,T::Mul(mpzz,frz));
+
+    //-Density derivative and velocity gradients.
+    const V dvx=T::Sub(velx1,velx2),dvy=T::Sub(vely1,vely2),dvz=T::Sub(velz1,velz2);
+    arx=T::Add(arx,T::Mul(mass2,T::Mul(dvx,frx)));
+    ary=T::Add(ary,T::Mul(mass2,T::Mul(dvy,fry)));
+    arz=T::Add(arz,T::Mul(mass2,T::Mul(dvz,frz)));
+    const V volp2=T::Sub(zero,T::Div(mass2,rhop2));
+    const V wdx=T::Mul(volp2,dvx),wdy=T::Mul(volp2,dvy),wdz=T::Mul(volp2,dvz);
+    g11=T::Add(g11,T::Mul(wdx,frx)); g12=T::Add(g12,T::Mul(wdx,fry)); g13=T::Add(g13,T::Mul(wdx,frz));
+    g21=T::Add(g21,T::Mul(wdy,frx)); g22=T::Add(g22,T::Mul(wdy,fry)); g23=T::Add(g23,T::Mul(wdy,frz));
+    g31=T::Add(g31,T::Mul(wdz,frx)); g32=T::Add(g32,T::Mul(wdz,fry)); g33=T::Add(g33,T::Mul(wdz,frz));
+
+    //-Density derivative (DeltaSPH Molteni) and shifting.
+    const V rr2eta=T::Add(rr2,eta2);
+    if(ctx.delta || ctx.shift){
+      const V dot3=T::Add(T::Add(T::Mul(drx,frx),T::Mul(dry,fry)),T::Mul(drz,frz));
+      if(ctx.delta){
+        const V visc_densi=T::Div(T::Mul(dlcte,T::Sub(T::Div(rhop1,rhop2),one)),rr2eta);
+        dlt=T::Add(dlt,T::Mul(T::Mul(visc_densi,dot3),mass2));
+      }
+      if(ctx.shift){
+        const V massrhop=T::Div(mass2,rhop2);
+        shx=T::Add(shx,T::Mul(massrhop,frx));
+        shy=T::Add(shy,T::Mul(massrhop,fry));
+        shz=T::Add(shz,T::Mul(massrhop,frz));
+        shd=T::Sub(shd,T::Mul(massrhop,dot3));
+      }
+    }
+
+    //===== Viscosity ======
+    const V dot=T::Add(T::Add(T::Mul(drx,dvx),T::Mul(dry,dvy)),T::Mul(drz,dvz));
+    const V dot_rr2=T::Div(dot,rr2eta);
+    vmax=T::Max(vmax,dot_rr2);
+    if(ctx.artvisc){
+      const M mneg=T::Lt(dot,zero);
+      const V pi_visc=T::Select(mneg,T::Div(T::Mul(T::Mul(avcte,dot_rr2),mass2),T::Add(rhop1,rhop2)),zero);
+      avx=T::Sub(avx,T::Mul(pi_visc,frx));
+      avy=T::Sub(avy,T::Mul(pi_visc,fry));
+      avz=T::Sub(avz,T::Mul(pi_visc,frz));
+    }
+  }
+
+  //-Reduction of lanes.
+  acc.ace[0]=T::SumLanes(a11); acc.ace[1]=T::SumLanes(a12); acc.ace[2]=T::SumLanes(a13);
+  acc.ace[3]=T::SumLanes(a21); acc.ace[4]=T::SumLanes(a22); acc.ace[5]=T::SumLanes(a23);
+  acc.ace[6]=T::SumLanes(a31); acc.ace[7]=T::SumLanes(a32); acc.ace[8]=T::SumLanes(a33);
+  acc.ar[0]=T::SumLanes(arx); acc.ar[1]=T::SumLanes(ary); acc.ar[2]=T::SumLanes(arz);
+  acc.grad[0]=T::SumLanes(g11); acc.grad[1]=T::SumLanes(g12); acc.grad[2]=T::SumLanes(g13);
+  acc.grad[3]=T::SumLanes(g21); acc.grad[4]=T::SumLanes(g22); acc.grad[5]=T::SumLanes(g23);
+  acc.grad[6]=T::SumLanes(g31); acc.grad[7]=T::SumLanes(g32); acc.grad[8]=T::SumLanes(g33);
+  acc.acevisc[0]=T::SumLanes(avx); acc.acevisc[1]=T::SumLanes(avy); acc.acevisc[2]=T::SumLanes(avz);
+  acc.viscmax=T::MaxLanes(vmax);
+  acc.delta=T::SumLanes(dlt);
+  acc.shift[0]=T::SumLanes(shx); acc.shift[1]=T::SumLanes(shy); acc.shift[2]=T::SumLanes(shz);
+  acc.shiftdetect=T::SumLanes(shd);
+}
+
+#endif
+
+
@@ -0,0 +1,73 @@
+//HEAD_DSPH
+/*
+<DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+This file is part of DualSPHysics.
+
+DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphSolidSimdSse4_M.cpp \brief Implements the SSE4.1 version of the pair kernel (compiled with -msse4.1).
+
+#include "JSphSolidSimdKernel_M.h"
+#include <smmintrin.h>
+
+namespace{
+
+///Operations on 4 lanes of SSE4.1 (without gather, loads are done lane by lane).
+struct SimdSse4{
+  typedef __m128 V;
+  typedef __m128i VI;
+  typedef __m128 M;
+  enum{ W=4 };
+  static inline V Zero(){ return(_mm_setzero_ps()); }
+  static inline V Set1(float v){ return(_mm_set1_ps(v)); }
+  static inline VI Iota(){ return(_mm_setr_epi32(0,1,2,3)); }
+  static inline VI IMul(VI a,int b){ return(_mm_mullo_epi32(a,_mm_set1_epi32(b))); }
+  static inline VI IAdd(VI a,int b){ return(_mm_add_epi32(a,_mm_set1_epi32(b))); }
+  static inline M Lanes(unsigned k){ return(_mm_castsi128_ps(_mm_cmplt_epi32(Iota(),_mm_set1_epi32(int(k))))); }
+  static inline V Gather(const float *base,VI idx,M m){
+    const int msk=_mm_movemask_ps(m);
+    return(_mm_setr_ps((msk&1? base[_mm_extract_epi32(idx,0)]: 0.f),(msk&2? base[_mm_extract_epi32(idx,1)]: 0.f)
+      ,(msk&4? base[_mm_extract_epi32(idx,2)]: 0.f),(msk&8? base[_mm_extract_epi32(idx,3)]: 0.f)));
+  }
+  static inline VI GatherI(const int *base,VI idx,M m){
+    const int msk=_mm_movemask_ps(m);
+    return(_mm_setr_epi32((msk&1? base[_mm_extract_epi32(idx,0)]: 0),(msk&2? base[_mm_extract_epi32(idx,1)]: 0)
+      ,(msk&4? base[_mm_extract_epi32(idx,2)]: 0),(msk&8? base[_mm_extract_epi32(idx,3)]: 0)));
+  }
+  static inline V Add(V a,V b){ return(_mm_add_ps(a,b)); }
+  static inline V Sub(V a,V b){ return(_mm_sub_ps(a,b)); }
+  static inline V Mul(V a,V b){ return(_mm_mul_ps(a,b)); }
+  static inline V Div(V a,V b){ return(_mm_div_ps(a,b)); }
+  static inline V Max(V a,V b){ return(_mm_max_ps(a,b)); }
+  static inline M Lt(V a,V b){ return(_mm_cmplt_ps(a,b)); }
+  static inline V Select(M m,V a,V b){ return(_mm_blendv_ps(b,a,m)); }
+  static inline float SumLanes(V a){
+    const V s=_mm_add_ps(a,_mm_movehl_ps(a,a));
+    return(_mm_cvtss_f32(_mm_add_ss(s,_mm_shuffle_ps(s,s,1))));
+  }
+  static inline float MaxLanes(V a){
+    const V s=_mm_max_ps(a,_mm_movehl_ps(a,a));
+    return(_mm_cvtss_f32(_mm_max_ss(s,_mm_shuffle_ps(s,s,1))));
+  }
+};
+
+}
+
+//==============================================================================
+/// Pair kernel with SSE4.1.
+//==============================================================================
+void SimdForcesSse4(const StSimdForcesCtx &ctx,const StSimdForcesP1 &p1,unsigned cpini,unsigned cpfin,StSimdForcesAcc &acc){
+  SimdForcesT<SimdSse4>(ctx,p1,cpini,cpfin,acc);
+}
+
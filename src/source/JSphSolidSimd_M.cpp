@@ -0,0 +1,91 @@
+//HEAD_DSPH
+/*
+<DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+This file is part of DualSPHysics.
+
+DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphSolidSimd_M.cpp \brief Implements the selection of the vectorised pair kernel.
+
+#include "JSphSolidSimd_M.h"
+#include "JNeighbourListCpu.h"
+#include <cstddef>
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
+//-The kernels read StNeighbourPair as 9 words of 4 bytes.
+typedef char StaticCheckNeighbourPair[sizeof(StNeighbourPair)==36? 1: -1];
+
+//==============================================================================
+/// Returns the best instruction set supported by the CPU and the OS.
+//==============================================================================
+TpSimdMode SimdDetectCpu(){
+  TpSimdMode ret=SIMD_None;
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int r[4];
+  __cpuid(r,0);
+  const int nids=r[0];
+  __cpuid(r,1);
+  const bool sse41=((r[2]>>19)&1)!=0;
+  const bool osxsave=((r[2]>>27)&1)!=0;
+  const bool avx=((r[2]>>28)&1)!=0;
+  const bool fma=((r[2]>>12)&1)!=0;
+  const unsigned long long xcr0=(osxsave? _xgetbv(0): 0);
+  const bool osavx=((xcr0&0x6)==0x6);
+  const bool osavx512=((xcr0&0xE6)==0xE6);
+  bool avx2=false,avx512f=false;
+  if(nids>=7){
+    __cpuidex(r,7,0);
+    avx2=((r[1]>>5)&1)!=0;
+    avx512f=((r[1]>>16)&1)!=0;
+  }
+  if(sse41)ret=SIMD_Sse4;
+  if(avx && avx2 && fma && osavx)ret=SIMD_Avx2;
+  if(avx512f && osavx512)ret=SIMD_Avx512;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("sse4.1"))ret=SIMD_Sse4;
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))ret=SIMD_Avx2;
+  if(__builtin_cpu_supports("avx512f"))ret=SIMD_Avx512;
+#endif
+  return(ret);
+}
+
+//==============================================================================
+/// Returns the name of the instruction set.
+//==============================================================================
+const char* SimdModeName(TpSimdMode tsimd){
+  switch(tsimd){
+    case SIMD_None:   break;
+    case SIMD_Sse4:   return("SSE4");
+    case SIMD_Avx2:   return("AVX2");
+    case SIMD_Avx512: return("AVX-512");
+  }
+  return("None");
+}
+
+//==============================================================================
+/// Returns the pair kernel of the instruction set (NULL for SIMD_None).
+//==============================================================================
+TpSimdForcesFn SimdForcesFn(TpSimdMode tsimd){
+  switch(tsimd){
+    case SIMD_None:   break;
+    case SIMD_Sse4:   return(SimdForcesSse4);
+    case SIMD_Avx2:   return(SimdForcesAvx2);
+    case SIMD_Avx512: return(SimdForcesAvx512);
+  }
+  return(NULL);
+}
+
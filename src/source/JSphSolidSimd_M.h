@@ -0,0 +1,88 @@
+//HEAD_DSPH
+/*
+<DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+This file is part of DualSPHysics.
+
+DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphSolidSimd_M.h \brief Declares the vectorised pair kernels of the solid Fluid-Fluid interaction.
+/// Each instruction set is compiled in its own file (JSphSolidSimdSse4_M.cpp,
+/// JSphSolidSimdAvx2_M.cpp, JSphSolidSimdAvx512_M.cpp) with the matching
+/// compiler flags and the best one supported by the CPU is selected at
+/// startup. Only plain structures are declared here so the files compiled
+/// with wider instruction sets do not emit inline code used by the rest of
+/// the program.
+
+#ifndef _JSphSolidSimd_M_
+#define _JSphSolidSimd_M_
+
+///Instruction sets for the vectorised pair kernels.
+typedef enum{
+  SIMD_None=0     ///<Scalar code.
+ ,SIMD_Sse4=1     ///<SSE4.1 (4 lanes).
+ ,SIMD_Avx2=2     ///<AVX2+FMA (8 lanes).
+ ,SIMD_Avx512=3   ///<AVX-512F (16 lanes).
+}TpSimdMode;
+
+///Constants and arrays used by the pair kernel.
+typedef struct{
+  const float *pairs;     ///<Neighbour pairs (StNeighbourPair as 9 words: p2,drx,dry,drz,rr2,frx,fry,frz,fr).
+  const float *velrhop;   ///<Velocity and density (tfloat4 as 4 floats).
+  const float *tauxx,*tauxy,*tauxz;  ///<Deviatoric stress (streams of tsymatrix3fsoa).
+  const float *tauyy,*tauyz,*tauzz;
+  const float *press;     ///<Pressure.
+  const float *pore;      ///<Pore pressure.
+  const float *mass;      ///<Mass.
+  float h,eta2,cbar;      ///<Smoothing length, Eta2 and speed of sound.
+  float visco;            ///<Artificial viscosity (used when artvisc).
+  float delta2h;          ///<Delta2H (used when delta).
+  bool artvisc;           ///<Computes artificial viscosity.
+  bool delta;             ///<Computes DeltaSPH term.
+  bool shift;             ///<Computes shifting terms.
+}StSimdForcesCtx;
+
+///Data of particle p1.
+typedef struct{
+  float velx,vely,velz,rhop;
+  float pressp;           ///<Pressure plus pore pressure.
+  float tauxx,tauxy,tauxz,tauyy,tauyz,tauzz;
+}StSimdForcesP1;
+
+///Sums of particle p1 before applying the correction matrix L.
+typedef struct{
+  float ace[9];           ///<Sum of -massp2*prs(i,j)*fr(j) [a11,a12,a13,a21,...,a33].
+  float ar[3];            ///<Sum of massp2*dv(i)*fr(i).
+  float grad[9];          ///<Sum of volp2*dv(i)*fr(j).
+  float acevisc[3];       ///<Artificial viscosity acceleration.
+  float viscmax;          ///<Maximum of dot/(rr2+Eta2).
+  float delta;            ///<DeltaSPH term.
+  float shift[3];         ///<Shifting displacement.
+  float shiftdetect;      ///<Shifting free-surface detection.
+}StSimdForcesAcc;
+
+///Computes the pairs [cpini,cpfin) of particle p1.
+typedef void (*TpSimdForcesFn)(const StSimdForcesCtx &ctx,const StSimdForcesP1 &p1
+  ,unsigned cpini,unsigned cpfin,StSimdForcesAcc &acc);
+
+void SimdForcesSse4(const StSimdForcesCtx &ctx,const StSimdForcesP1 &p1,unsigned cpini,unsigned cpfin,StSimdForcesAcc &acc);
+void SimdForcesAvx2(const StSimdForcesCtx &ctx,const StSimdForcesP1 &p1,unsigned cpini,unsigned cpfin,StSimdForcesAcc &acc);
+void SimdForcesAvx512(const StSimdForcesCtx &ctx,const StSimdForcesP1 &p1,unsigned cpini,unsigned cpfin,StSimdForcesAcc &acc);
+
+TpSimdMode SimdDetectCpu();
+const char* SimdModeName(TpSimdMode tsimd);
+TpSimdForcesFn SimdForcesFn(TpSimdMode tsimd);
+
+#endif
+
+
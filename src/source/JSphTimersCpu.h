@@ -53,8 +53,10 @@ typedef enum{
   ,TMC_SuPeriodic=11
   ,TMC_SuResizeNp=12
   ,TMC_SuSavePart=13
+  ,TMC_NlNeighbours=14
+  ,TMC_SuDivision=15
 }CsTypeTimerCPU;
-#define TMC_COUNT 14
+#define TMC_COUNT 16
 
 typedef StSphTimerCpu TimersCpu[TMC_COUNT];
 
@@ -77,6 +79,8 @@ inline const char* TmcGetName(CsTypeTimerCPU ct){
     case TMC_SuPeriodic:        return("SU-Periodic");
     case TMC_SuResizeNp:        return("SU-ResizeNp");
     case TMC_SuSavePart:        return("SU-SavePart");
+    case TMC_NlNeighbours:      return("NL-Neighbours");
+    case TMC_SuDivision:        return("SU-Division");
   }
   return("???");
 }
@@ -0,0 +1,206 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JTimerRegistry.cpp \brief Implements the class \ref JTimerRegistry.
+
+#include "JTimerRegistry.h"
+#include <cstring>
+#include <cstdlib>
+#ifdef _WIN32
+  #include <malloc.h>
+#endif
+#include <algorithm>
+
+using namespace std;
+
+//##############################################################################
+//# JTimerRegistry
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JTimerRegistry::JTimerRegistry(){
+  ClassName="JTimerRegistry";
+  Active=false;
+  Trace=NULL;
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JTimerRegistry::~JTimerRegistry(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Allocates the times of the threads of one timer aligned to ALIGNBYTES.
+//==============================================================================
+JTimerRegistry::StThreadTime* JTimerRegistry::AllocThreadTimes()const{
+  void* pointer=NULL;
+  const size_t bytes=sizeof(StThreadTime)*OMP_MAXTHREADS;
+#ifdef _WIN32
+  pointer=_aligned_malloc(bytes,ALIGNBYTES);
+#else
+  if(posix_memalign(&pointer,ALIGNBYTES,bytes))pointer=NULL;
+#endif
+  if(!pointer)RunException("AllocThreadTimes","Cannot allocate the requested memory.");
+  return((StThreadTime*)pointer);
+}
+
+//==============================================================================
+/// Frees the times of the threads allocated by AllocThreadTimes().
+//==============================================================================
+void JTimerRegistry::FreeThreadTimes(StThreadTime *th)const{
+#ifdef _WIN32
+  _aligned_free(th);
+#else
+  free(th);
+#endif
+}
+
+//==============================================================================
+/// Removes all the timers.
+//==============================================================================
+void JTimerRegistry::Reset(){
+  for(unsigned c=0;c<GetCount();c++){
+    FreeThreadTimes(Timers[c]->th);
+    delete Timers[c];
+  }
+  Timers.clear();
+}
+
+//==============================================================================
+/// Initialises the time accumulated by all timers.
+//==============================================================================
+void JTimerRegistry::ResetValues(){
+  for(unsigned c=0;c<GetCount();c++){
+    StTimer *t=Timers[c];
+    t->count=0; t->time=0;
+    t->regions=0; t->thmax=t->thmean=0;
+    memset(t->th,0,sizeof(StThreadTime)*OMP_MAXTHREADS);
+  }
+}
+
+//==============================================================================
+/// Returns the id of the timer with the given name, it is created when it does
+/// not exist yet.
+//==============================================================================
+unsigned JTimerRegistry::Add(const std::string &name){
+  if(name.empty() || name[0]=='/' || name[name.length()-1]=='/')RunException("Add","The name of the timer is invalid.");
+  const int id=Find(name);
+  if(id>=0)return(unsigned(id));
+  StTimer *t=new StTimer;
+  t->th=AllocThreadTimes();
+  t->name=name;
+  t->timer.Reset();
+  t->count=0; t->time=0;
+  t->regions=0; t->thmax=t->thmean=0;
+  memset(t->th,0,sizeof(StThreadTime)*OMP_MAXTHREADS);
+  Timers.push_back(t);
+  return(GetCount()-1);
+}
+
+//==============================================================================
+/// Returns the id of the timer with the given name (-1 when it does not exist).
+//==============================================================================
+int JTimerRegistry::Find(const std::string &name)const{
+  for(unsigned c=0;c<GetCount();c++)if(Timers[c]->name==name)return(int(c));
+  return(-1);
+}
+
+//==============================================================================
+/// Accumulates the time since Start(). When threads were measured in the
+/// interval, the busiest and the mean thread are accumulated for the imbalance.
+//==============================================================================
+void JTimerRegistry::Stop(unsigned id){
+  if(Trace)Trace->End(Timers[id]->name.c_str());
+  if(!Active)return;
+  StTimer *t=Timers[id];
+  t->timer.Stop();
+  t->time+=t->timer.GetElapsedTimeD();
+  t->count++;
+  unsigned nth=0;
+  double thmax=0,thsum=0;
+  for(unsigned th=0;th<OMP_MAXTHREADS;th++)if(t->th[th].used){
+    StThreadTime &v=t->th[th];
+    nth++;
+    thsum+=v.time;
+    thmax=max(thmax,v.time);
+    v.total+=v.time;
+    v.time=0; v.used=false;
+  }
+  if(nth){
+    t->regions++;
+    t->thmax+=thmax;
+    t->thmean+=thsum/nth;
+  }
+}
+
+//==============================================================================
+/// Returns the last level of the name.
+//==============================================================================
+std::string JTimerRegistry::GetShortName(unsigned id)const{
+  const string &name=Timers[id]->name;
+  const size_t pos=name.rfind('/');
+  return(pos==string::npos? name: name.substr(pos+1));
+}
+
+//==============================================================================
+/// Returns the number of parents in the name (0 for a top-level timer).
+//==============================================================================
+unsigned JTimerRegistry::GetLevel(unsigned id)const{
+  const string &name=Timers[id]->name;
+  return(unsigned(count(name.begin(),name.end(),'/')));
+}
+
+//==============================================================================
+/// Returns the load imbalance: time of the busiest thread over the mean time
+/// of the threads, summed over all the intervals (0 without thread data).
+//==============================================================================
+double JTimerRegistry::GetImbalance(unsigned id)const{
+  const StTimer *t=Timers[id];
+  return(t->thmean>0? t->thmax/t->thmean: 0);
+}
+
+//==============================================================================
+/// Returns the timers under parent (all the levels) sorted by name, so each
+/// timer is followed by its own children. With an empty parent it returns all
+/// the timers.
+//==============================================================================
+std::vector<unsigned> JTimerRegistry::GetChildren(const std::string &parent)const{
+  const string prefix=(parent.empty()? string(): parent+"/");
+  vector<string> names;
+  for(unsigned c=0;c<GetCount();c++){
+    const string &name=Timers[c]->name;
+    if(!name.compare(0,prefix.length(),prefix)){
+      string key=name;
+      replace(key.begin(),key.end(),'/','\x01'); //-Parents before any sibling with a longer name.
+      names.push_back(key);
+    }
+  }
+  sort(names.begin(),names.end());
+  vector<unsigned> ids;
+  for(unsigned c=0;c<unsigned(names.size());c++){
+    string name=names[c];
+    replace(name.begin(),name.end(),'\x01','/');
+    ids.push_back(unsigned(Find(name)));
+  }
+  return(ids);
+}
+
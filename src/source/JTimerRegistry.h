@@ -0,0 +1,141 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JTimerRegistry.h \brief Declares the class \ref JTimerRegistry.
+
+#ifndef _JTimerRegistry_
+#define _JTimerRegistry_
+
+#include "TypesDef.h"
+#include "JObject.h"
+#include "JTimer.h"
+#include "OmpDefs.h"
+#include "JTraceEvents.h"
+#include <string>
+#include <vector>
+
+//##############################################################################
+//# JTimerRegistry
+//##############################################################################
+/// \brief Timers registered by name at run time, they complete the fixed
+/// timers of JSphTimersCpu.h.
+/// Names are hierarchical with the levels separated by '/' (e.g.
+/// "CF-Forces/Correction"), so each timer is reported under the phase that
+/// contains it. Start() and Stop() measure the wall-clock time in the main
+/// thread. Inside a parallel region each thread can also measure its own share
+/// of the work with a ThreadScope. Stop() takes the busiest and the mean thread
+/// of the interval and the ratio of their sums is the load imbalance of the
+/// timer (1 is a perfect balance).
+/// With SetTrace() the timers and the ThreadScopes are also recorded as events
+/// of the timeline, even when the registry is not active.
+
+class JTimerRegistry : protected JObject
+{
+public:
+  /// Measures the time of the current thread from its construction to its
+  /// destruction. It is declared at the beginning of a parallel region whose
+  /// loop uses nowait, so the time of each thread ends with its own work.
+  class ThreadScope{
+  protected:
+    JTimerRegistry *Reg;
+    unsigned Id;
+    JTimer Timer;
+  public:
+    ThreadScope(JTimerRegistry *reg,unsigned id):Reg(reg && (reg->Active || reg->Trace)? reg: NULL),Id(id){
+      if(Reg){
+        if(Reg->Trace)Reg->Trace->Begin(Reg->Timers[Id]->name.c_str());
+        if(Reg->Active)Timer.Start();
+      }
+    }
+    ~ThreadScope(){
+      if(Reg){
+        if(Reg->Active){ Timer.Stop(); Reg->AddThreadTime(Id,Timer.GetElapsedTimeD()); }
+        if(Reg->Trace)Reg->Trace->End(Reg->Timers[Id]->name.c_str());
+      }
+    }
+  };
+
+protected:
+  ///Time of one thread, padded to a cache line. The array of each timer is
+  ///allocated aligned to ALIGNBYTES, so each thread writes its own cache line.
+  static const unsigned ALIGNBYTES=64;
+  typedef struct{
+    double time;       ///<Time in the current interval (ms).
+    double total;      ///<Time in all the intervals (ms).
+    bool used;         ///<The thread was measured in the current interval.
+    byte pad[ALIGNBYTES-2*sizeof(double)-sizeof(bool)];
+  }StThreadTime;
+
+  typedef struct{
+    std::string name;  ///<Hierarchical name.
+    JTimer timer;
+    unsigned count;    ///<Number of measured intervals.
+    double time;       ///<Wall-clock time (ms).
+    unsigned regions;  ///<Number of intervals measured per thread.
+    double thmax;      ///<Sum of the time of the busiest thread of each interval (ms).
+    double thmean;     ///<Sum of the mean time of the threads of each interval (ms).
+    StThreadTime *th;  ///<Time of each thread [OMP_MAXTHREADS], aligned to ALIGNBYTES.
+  }StTimer;
+
+  bool Active;
+  std::vector<StTimer*> Timers;
+  JTraceEvents *Trace;  ///<Timeline of the execution (NULL: not used).
+
+  StThreadTime* AllocThreadTimes()const;
+  void FreeThreadTimes(StThreadTime *th)const;
+
+  void AddThreadTime(unsigned id,double t){
+    const int th=omp_get_thread_num();
+    if(th<OMP_MAXTHREADS){ StThreadTime &v=Timers[id]->th[th]; v.time+=t; v.used=true; }
+  }
+
+public:
+  JTimerRegistry();
+  ~JTimerRegistry();
+  void Reset();
+  void ResetValues();
+
+  void SetActive(bool active){ Active=active; }
+  bool GetActive()const{ return(Active); }
+  void SetTrace(JTraceEvents *trace){ Trace=trace; }
+
+  unsigned Add(const std::string &name);
+  int Find(const std::string &name)const;
+
+  //-Main thread, outside the parallel regions.
+  void Start(unsigned id){
+    if(Trace)Trace->Begin(Timers[id]->name.c_str());
+    if(Active)Timers[id]->timer.Start();
+  }
+  void Stop(unsigned id);
+
+  unsigned GetCount()const{ return(unsigned(Timers.size())); }
+  std::string GetName(unsigned id)const{ return(Timers[id]->name); }
+  std::string GetShortName(unsigned id)const;
+  unsigned GetLevel(unsigned id)const;
+  double GetTime(unsigned id)const{ return(Timers[id]->time); }
+  unsigned GetIntervals(unsigned id)const{ return(Timers[id]->count); }
+  bool GetThreaded(unsigned id)const{ return(Timers[id]->regions>0); }
+  double GetImbalance(unsigned id)const;
+  double GetThreadTime(unsigned id,unsigned th)const{ return(th<OMP_MAXTHREADS? Timers[id]->th[th].total: 0); }
+
+  std::vector<unsigned> GetChildren(const std::string &parent)const;
+};
+
+#endif
+
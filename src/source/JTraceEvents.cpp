@@ -0,0 +1,117 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JTraceEvents.cpp \brief Implements the class \ref JTraceEvents.
+
+#include "JTraceEvents.h"
+#include "Functions.h"
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+//##############################################################################
+//# JTraceEvents
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JTraceEvents::JTraceEvents(const std::string &file,unsigned size)
+  :File(file),Size(size? size: SIZEDEF),TimeIni(std::chrono::steady_clock::now())
+{
+  ClassName="JTraceEvents";
+  memset(Buffers,0,sizeof(StBuffer)*(OMP_MAXTHREADS+1));
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JTraceEvents::~JTraceEvents(){
+  DestructorActive=true;
+  for(unsigned th=0;th<=OMP_MAXTHREADS;th++)delete[] Buffers[th].ev;
+}
+
+//==============================================================================
+/// Records an event in the buffer of thread th. Only thread th writes in its
+/// buffer, the memory is allocated with its first event.
+//==============================================================================
+void JTraceEvents::Add(unsigned th,char ph,const char *name,double value){
+  StBuffer &buf=Buffers[th];
+  if(!buf.ev)buf.ev=new StEvent[Size];
+  StEvent &e=buf.ev[buf.count%Size];
+  e.name=name;
+  e.ts=std::chrono::duration<double,std::micro>(std::chrono::steady_clock::now()-TimeIni).count();
+  e.value=value;
+  e.ph=ph;
+  buf.count++;
+}
+
+//==============================================================================
+/// Returns the number of recorded events.
+//==============================================================================
+ullong JTraceEvents::GetCount()const{
+  ullong n=0;
+  for(unsigned th=0;th<=OMP_MAXTHREADS;th++)n+=Buffers[th].count;
+  return(n);
+}
+
+//==============================================================================
+/// Returns the number of events overwritten in the rings.
+//==============================================================================
+ullong JTraceEvents::GetLost()const{
+  ullong n=0;
+  for(unsigned th=0;th<=OMP_MAXTHREADS;th++)if(Buffers[th].count>Size)n+=Buffers[th].count-Size;
+  return(n);
+}
+
+//==============================================================================
+/// Saves the events in Chrome trace format. It must be called when the threads
+/// do not record events. When a ring was overwritten, the end events whose
+/// begin was lost are skipped.
+//==============================================================================
+void JTraceEvents::SaveFile()const{
+  const char met[]="SaveFile";
+  ofstream pf;
+  pf.open(File.c_str());
+  if(!pf)RunException(met,"File could not be opened.",File);
+  pf << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << endl;
+  bool first=true;
+  for(unsigned th=0;th<=OMP_MAXTHREADS;th++)if(Buffers[th].count){
+    const StBuffer &buf=Buffers[th];
+    const string thname=(th==THWRITER? string("PART writer"): fun::PrintStr("Thread %u",th));
+    pf << (first? "": ",\n") << fun::PrintStr("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",th,thname.c_str());
+    pf << fun::PrintStr(",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}}",th,th);
+    first=false;
+    const ullong ini=(buf.count>Size? buf.count-Size: 0);
+    unsigned depth=0;
+    for(ullong c=ini;c<buf.count;c++){
+      const StEvent &e=buf.ev[c%Size];
+      if(e.ph=='E'){
+        if(!depth)continue;
+        depth--;
+      }
+      else if(e.ph=='B')depth++;
+      if(e.ph=='C')pf << fun::PrintStr(",\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"%s\":%.10g}}",e.name,e.ts,th,e.name,e.value);
+      else pf << fun::PrintStr(",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",e.name,e.ph,e.ts,th);
+    }
+  }
+  pf << "\n]}" << endl;
+  if(pf.fail())RunException(met,"Failed writing to file.",File);
+  pf.close();
+}
+
@@ -0,0 +1,96 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2017 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JTraceEvents.h \brief Declares the class \ref JTraceEvents.
+
+#ifndef _JTraceEvents_
+#define _JTraceEvents_
+
+#include "TypesDef.h"
+#include "JObject.h"
+#include "OmpDefs.h"
+#include <string>
+#include <chrono>
+
+//##############################################################################
+//# JTraceEvents
+//##############################################################################
+/// \brief Timeline of the execution saved in the Chrome trace format (JSON),
+/// it can be opened with chrome://tracing or https://ui.perfetto.dev.
+/// Each OpenMP thread writes its begin/end events in its own buffer, so no
+/// lock is needed. There is one more buffer for the writer thread of
+/// JSphSaveAsync. The buffers are rings, when one is full the oldest events
+/// are overwritten and the file keeps the last events of the run.
+/// The names of the events are stored as pointers, so they must remain valid
+/// until SaveFile() (string literals or names owned by JTimerRegistry).
+
+class JTraceEvents : protected JObject
+{
+public:
+  static const unsigned THWRITER=OMP_MAXTHREADS;  ///<Buffer of the writer thread of JSphSaveAsync.
+  static const unsigned SIZEDEF=1<<17;            ///<Events per thread by default.
+
+protected:
+  typedef struct{
+    const char *name;
+    double ts;         ///<Time since the creation of the object (microseconds).
+    double value;      ///<Value of counter events.
+    char ph;           ///<Type of event: 'B' begin, 'E' end, 'C' counter.
+  }StEvent;
+
+  ///Events of one thread, padded so each thread writes its own cache line.
+  typedef struct{
+    StEvent *ev;       ///<Ring of Size events, allocated with the first event of the thread.
+    ullong count;      ///<Number of events recorded (the last Size are in ev).
+    byte pad[64-sizeof(StEvent*)-sizeof(ullong)];
+  }StBuffer;
+
+  const std::string File;
+  const unsigned Size;
+  const std::chrono::steady_clock::time_point TimeIni;
+  StBuffer Buffers[OMP_MAXTHREADS+1];
+
+  void Add(unsigned th,char ph,const char *name,double value);
+
+  static unsigned CurrentThread(){
+    const int th=omp_get_thread_num();
+    return(th<OMP_MAXTHREADS? unsigned(th): OMP_MAXTHREADS-1);
+  }
+
+public:
+  JTraceEvents(const std::string &file,unsigned size=SIZEDEF);
+  ~JTraceEvents();
+
+  //-Events of the current OpenMP thread.
+  void Begin(const char *name){ Add(CurrentThread(),'B',name,0); }
+  void End(const char *name){ Add(CurrentThread(),'E',name,0); }
+  void Counter(const char *name,double value){ Add(CurrentThread(),'C',name,value); }
+
+  //-Events of another thread (e.g. THWRITER).
+  void BeginTh(unsigned th,const char *name){ Add(th,'B',name,0); }
+  void EndTh(unsigned th,const char *name){ Add(th,'E',name,0); }
+
+  std::string GetFile()const{ return(File); }
+  ullong GetCount()const;
+  ullong GetLost()const;
+
+  void SaveFile()const;
+};
+
+#endif
+
@@ -214,6 +214,32 @@ typedef enum{
   SHIFT_None=0              ///<Shifting is not applied.
 }TpShifting; 
 
+///Growth laws of the root (values of typeGrowth). | Leyes de crecimiento.
+typedef enum{
+  GROWTH_Turgor=0,            ///<Turgor growth model.
+  GROWTH_KillConst=1,         ///<Constant growth with kill switch.
+  GROWTH_SigGauss=2,          ///<Sigmoid plus gaussian along the distance to the tip.
+  GROWTH_SigGauDrop=3,        ///<Sigmoid plus gaussian with a drop after the elongation zone.
+  GROWTH_TurgorSpace=4,       ///<Turgor growth weighted by the normalised space rate.
+  GROWTH_TurgorSigGauDrop=5,  ///<Turgor growth weighted by GROWTH_SigGauDrop.
+  GROWTH_TurgorConst=6,       ///<Turgor growth with constant rate.
+  GROWTH_TurgorTriangle=7,    ///<Turgor growth weighted by a triangle function.
+  GROWTH_TurgorComposite=8,   ///<Turgor growth weighted by a composite distribution.
+  GROWTH_KillComposite=9,     ///<GROWTH_TurgorComposite with kill switch.
+  GROWTH_Croser=10,           ///<Turgor growth weighted by the distribution of Croser 1999.
+  GROWTH_None=11              ///<No growth (any other value of typeGrowth).
+}TpGrowth;
+
+///Damping laws of the solid (values of typeDamping). | Leyes de amortiguamiento.
+typedef enum{
+  DAMPING_Uniform=0,          ///<Homogeneous damping.
+  DAMPING_Surface=1,          ///<Damping weighted by the surface detection (Co_M).
+  DAMPING_Plateau=2,          ///<Homogeneous damping with plateau in velocity.
+  DAMPING_Density=3,          ///<Damping weighted by density.
+  DAMPING_DensityLength=4,    ///<Damping weighted by density, velocity and cell length.
+  DAMPING_None=5              ///<No damping (any other value of typeDamping).
+}TpDamping;
+
 ///Types of particles.
 typedef enum{ 
     PART_BoundFx=1,          ///<Fixed boundary particles.
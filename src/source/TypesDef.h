@@ -452,6 +452,32 @@ inline tsymatrix3f operator -(const tsymatrix3f& a, const tsymatrix3f& b) { retu
 inline tsymatrix3f abs_M(tsymatrix3f v) { return TSymatrix3f(abs_M(v.xx), abs_M(v.xy), abs_M(v.xz), abs_M(v.yy), abs_M(v.yz), abs_M(v.zz) ); }
 inline float max_M(tsymatrix3f v) {  return max_M(max_M(max_M(v.xx, v.xy), v.xz), max_M(max_M(v.yy, v.yz), v.zz)); }
 
+///Symmetric matrices 3x3 stored as 6 contiguous streams of float (structure of arrays).
+///The element p is available as m[p] with the same members as tsymatrix3f
+///or directly in the streams as m.xx[p], m.xy[p]...
+typedef struct tsymatrix3fsoa{
+  float *xx,*xy,*xz,*yy,*yz,*zz;
+
+  ///Reference to the element p of the streams.
+  struct ref{
+    float &xx,&xy,&xz,&yy,&yz,&zz;
+    operator tsymatrix3f()const{ tsymatrix3f m={xx,xy,xz,yy,yz,zz}; return(m); }
+    ref& operator =(const tsymatrix3f &v){ xx=v.xx; xy=v.xy; xz=v.xz; yy=v.yy; yz=v.yz; zz=v.zz; return(*this); }
+    ref& operator =(const ref &v){ xx=v.xx; xy=v.xy; xz=v.xz; yy=v.yy; yz=v.yz; zz=v.zz; return(*this); }
+  };
+  ref operator [](unsigned p)const{ ref r={xx[p],xy[p],xz[p],yy[p],yz[p],zz[p]}; return(r); }
+  float* Stream(unsigned c)const{ return(c==0? xx: (c==1? xy: (c==2? xz: (c==3? yy: (c==4? yz: zz))))); }
+  bool IsNull()const{ return(xx==0); }
+  void Zero(unsigned pini,unsigned n)const{ for(unsigned c=0;c<6;c++){ float *v=Stream(c)+pini; for(unsigned p=0;p<n;p++)v[p]=0; } }
+}tsymatrix3fsoa;
+
+///Constructor of type \ref tsymatrix3fsoa with the streams of 6*stride values starting in ptr.
+inline tsymatrix3fsoa TSymatrix3fSoa(float *ptr,unsigned stride){
+  tsymatrix3fsoa m={ptr,(ptr? ptr+stride: 0),(ptr? ptr+stride*2: 0),(ptr? ptr+stride*3: 0),(ptr? ptr+stride*4: 0),(ptr? ptr+stride*5: 0)};
+  return(m);
+}
+inline tsymatrix3fsoa TSymatrix3fSoa(){ return(TSymatrix3fSoa(0,0)); }
+
 
 //##############################################################################
 //# Basic data types.
@@ -130,6 +130,7 @@ int main(int argc, char** argv){
   printf("\n%s\n%s\n",appname.c_str(),appnamesub.c_str());
   JCfgRun cfg;
   JLog2 log;
+  bool preempted=false; //-Stopped with a checkpoint before TimeMax (exit code 3).
 
   try{
     cfg.LoadArgv(argc,argv);
@@ -149,6 +150,7 @@ int main(int argc, char** argv){
       if(cfg.Cpu){
 		JSphCpuSingle sph;
 		sph.Run(appname, &cfg, &log);
+		preempted = sph.GetPreempted();
       }
       #ifdef _WITHGPU
       else{
@@ -157,7 +159,7 @@ int main(int argc, char** argv){
 	  }
 	  #endif
     }
-    errcode=0;
+    errcode=(preempted? 3: 0);
   }
   catch(const char *cad){
     string tx=string("\n*** Exception: ")+cad+"\n";
@@ -0,0 +1,81 @@
+#!/bin/bash
+# Stop with a checkpoint on SIGTERM while excluded particles wait for the next
+# PART, resume with -restart and compare the count of excluded particles with
+# the uninterrupted run.
+#
+# Usage: ./RunPartsOut.sh <case> [rootsph] [rhopout] [delay]
+#   case    Case created by GenCase without extension (e.g. ../test-growth/DBG_out/DBG)
+#   rootsph Executable of RootSPH (default: ../../root_bin/RootSPH37c)
+#   rhopout Limits of -rhopout that exclude particles during the run (default: 0:10)
+#   delay   Seconds between Part_0000.bi4 and SIGTERM (default: 0.3)
+
+case=$1
+rootsph=${2:-../../root_bin/RootSPH37c}
+rhopout=${3:-0:10}
+delay=${4:-0.3}
+if [ -z "$case" ] || [ ! -e $case.xml ] || [ ! -e $case.bi4 ]; then
+  echo "Usage: $0 <case> [rootsph] [rhopout] [delay]"
+  exit 1
+fi
+
+name=$(basename $case)
+dirout=PARTSOUT_out
+rm -rf $dirout
+mkdir -p $dirout/ref $dirout/run
+cp $case.bi4 $dirout/
+
+# Excluded particles do not stop the run, no periodic checkpoints
+sed -e '/key="PartsOutMax"/d' -e '/key="CheckpointInterval"/d' \
+    -e "s|<parameters>|<parameters>\n            <parameter key=\"PartsOutMax\" value=\"1\" />|" \
+    $case.xml > $dirout/$name.xml
+
+fail(){
+  echo "FAILED: $1"
+  exit 1
+}
+
+# Last total of excluded particles and summary of the exclusions in the logs
+outtotal(){
+  cat $@ | grep -o "(total: [0-9]*)" | tail -1
+}
+outresume(){
+  grep "^Excluded particles" $1
+}
+
+# Uninterrupted run
+$rootsph $dirout/$name $dirout/ref -svres -rhopout:$rhopout > $dirout/Ref.out 2>&1
+errcode=$?
+[ $errcode -eq 0 ] || fail "exit code $errcode in the uninterrupted run"
+[ -n "$(outtotal $dirout/ref/Run.out)" ] || fail "no excluded particles with -rhopout:$rhopout"
+
+# Run stopped with SIGTERM while particles are being excluded
+$rootsph $dirout/$name $dirout/run -svres -rhopout:$rhopout > $dirout/Run1.out 2>&1 &
+pid=$!
+while [ ! -e $dirout/run/Part_0000.bi4 ]; do
+  kill -0 $pid 2> /dev/null || fail "the run finished before SIGTERM"
+  sleep 0.1
+done
+sleep $delay
+kill -TERM $pid
+wait $pid
+errcode=$?
+[ $errcode -eq 3 ] || fail "exit code $errcode after SIGTERM (expected 3)"
+[ -e $dirout/run/Checkpoint.cbi4 ] || fail "Checkpoint.cbi4 was not written"
+cp $dirout/run/Run.out $dirout/Run1.log
+
+# The restart keeps the count of excluded particles
+$rootsph $dirout/$name $dirout/run -svres -rhopout:$rhopout -restart > $dirout/Run2.out 2>&1
+errcode=$?
+[ $errcode -eq 0 ] || fail "exit code $errcode after -restart (expected 0)"
+ref=$(outtotal $dirout/ref/Run.out)
+res=$(outtotal $dirout/Run1.log $dirout/run/Run.out)
+[ "$ref" == "$res" ] || fail "particles out $res after -restart, $ref without stop"
+[ "$(outresume $dirout/ref/Run.out)" == "$(outresume $dirout/run/Run.out)" ] \
+  || fail "summary of excluded particles differs after -restart"
+
+# The stop must store excluded particles waiting for the next PART
+sed -n '/Stop requested/,$p' $dirout/Run1.log | grep -q "Particles out" \
+  || fail "no excluded particles pending at the stop, change the delay"
+echo "Particles out $res"
+
+echo "All done"
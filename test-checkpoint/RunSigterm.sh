@@ -0,0 +1,58 @@
+#!/bin/bash
+# Stop with a checkpoint on SIGTERM while the NeighbourSkin keeps the divide
+# and resume with -restart.
+#
+# Usage: ./RunSigterm.sh <case> [rootsph] [skin]
+#   case    Case created by GenCase without extension (e.g. ../test-growth/DBG_out/DBG)
+#   rootsph Executable of RootSPH (default: ../../root_bin/RootSPH37c)
+#   skin    Value of NeighbourSkin in metres (default: 0.05)
+
+case=$1
+rootsph=${2:-../../root_bin/RootSPH37c}
+skin=${3:-0.05}
+if [ -z "$case" ] || [ ! -e $case.xml ] || [ ! -e $case.bi4 ]; then
+  echo "Usage: $0 <case> [rootsph] [skin]"
+  exit 1
+fi
+
+name=$(basename $case)
+dirout=SIGTERM_out
+rm -rf $dirout
+mkdir -p $dirout/run
+cp $case.bi4 $dirout/
+
+# NeighbourSkin replaces the value of the case, with typeCorrection=2 (the only
+# one that keeps the skin), no periodic checkpoints
+sed -e '/key="NeighbourSkin"/d' -e '/key="CheckpointInterval"/d' \
+    -e 's|<typeCorrection value="[0-9]*"|<typeCorrection value="2"|' \
+    -e "s|<parameters>|<parameters>\n            <parameter key=\"NeighbourSkin\" value=\"$skin\" />|" \
+    $case.xml > $dirout/$name.xml
+
+fail(){
+  echo "FAILED: $1"
+  exit 1
+}
+
+# Run stopped with SIGTERM once the first PART after the initial one exists
+$rootsph $dirout/$name $dirout/run -svres > $dirout/Run1.out 2>&1 &
+pid=$!
+while [ ! -e $dirout/run/Part_0001.bi4 ]; do
+  kill -0 $pid 2> /dev/null || fail "the run finished before SIGTERM"
+  sleep 0.1
+done
+kill -TERM $pid
+wait $pid
+errcode=$?
+[ $errcode -eq 3 ] || fail "exit code $errcode after SIGTERM (expected 3)"
+[ -e $dirout/run/Checkpoint.cbi4 ] || fail "Checkpoint.cbi4 was not written"
+grep -q "Checkpoint saved" $dirout/run/Run.out || fail "no checkpoint in Run.out"
+cp $dirout/run/Run.out $dirout/Run1.log
+
+# The restart continues until TimeMax
+$rootsph $dirout/$name $dirout/run -svres -restart > $dirout/Run2.out 2>&1
+errcode=$?
+[ $errcode -eq 0 ] || fail "exit code $errcode after -restart (expected 0)"
+grep -q "Restart from checkpoint" $dirout/run/Run.out || fail "the run did not restart"
+grep -q "Simulation stopped" $dirout/run/Run.out && fail "the restarted run did not reach TimeMax"
+
+echo "All done"
@@ -0,0 +1,69 @@
+#!/bin/bash
+# Runs typeCorrection 1 and 3 with and without NeighbourSkin. These corrections
+# walk the cells of the last divide, so the skin is disabled and the PARTs must
+# be the same as without skin.
+#
+# Usage: ./RunSkin.sh <case> [rootsph] [skin]
+#   case    Case created by GenCase without extension (e.g. ../debug-correction/DBG_out/DBG)
+#   rootsph Executable of RootSPH (default: ../../root_bin/RootSPH37c)
+#   skin    Value of NeighbourSkin in metres (default: 0.05)
+
+case=$1
+rootsph=${2:-../../root_bin/RootSPH37c}
+skin=${3:-0.05}
+if [ -z "$case" ] || [ ! -e $case.xml ] || [ ! -e $case.bi4 ]; then
+  echo "Usage: $0 <case> [rootsph] [skin]"
+  exit 1
+fi
+
+name=$(basename $case)
+dirout=SKIN_out
+rm -rf $dirout
+mkdir -p $dirout
+
+fail(){
+  echo "FAILED: $1"
+  exit 1
+}
+
+# Writes the case with the given typeCorrection and NeighbourSkin in $1
+makecase(){
+  mkdir -p $1/out
+  cp $case.bi4 $1/
+  sed -e '/key="NeighbourSkin"/d' -e '/key="CheckpointInterval"/d' \
+      -e "s|<typeCorrection value=\"[0-9]*\"|<typeCorrection value=\"$2\"|" \
+      -e "s|<parameters>|<parameters>\n            <parameter key=\"NeighbourSkin\" value=\"$3\" />|" \
+      $case.xml > $1/$name.xml
+}
+
+# Number of different bytes of two PARTs out of the header (RunCode and date)
+# and of the values RunTime and timesim
+partdiff(){
+  local hdr=$(grep -obaF CaseNp $1 | head -1 | cut -d: -f1)
+  local rt=$(grep -obaF RunTime $1 | head -1 | cut -d: -f1)
+  local ts=$(grep -obaF timesim $1 | head -1 | cut -d: -f1)
+  cmp -l $1 $2 2> /dev/null | awk -v h=$hdr -v rt=$rt -v ts=$ts \
+    '$1>h && !($1>rt && $1<=rt+24) && !($1>ts && $1<=ts+24)' | wc -l
+}
+
+for corr in 1 3; do
+  for sk in 0 $skin; do
+    dir=$dirout/corr${corr}_skin$sk
+    makecase $dir $corr $sk
+    $rootsph $dir/$name $dir/out -svres > $dir/Run.log 2>&1
+    errcode=$?
+    [ $errcode -eq 0 ] || fail "exit code $errcode in $dir"
+  done
+  dir0=$dirout/corr${corr}_skin0
+  dir1=$dirout/corr${corr}_skin$skin
+  grep -q "NeighbourSkin is only compatible" $dir1/out/Run.out || fail "no warning with typeCorrection=$corr"
+  for part in $dir0/out/Part_*.bi4; do
+    part1=$dir1/out/$(basename $part)
+    [ -e $part1 ] || fail "$part1 was not written"
+    [ $(stat -c %s $part) -eq $(stat -c %s $part1) ] || fail "$(basename $part) differs with typeCorrection=$corr"
+    [ $(partdiff $part $part1) -eq 0 ] || fail "$(basename $part) differs with typeCorrection=$corr"
+  done
+  echo "typeCorrection=$corr: OK"
+done
+
+echo "All done"